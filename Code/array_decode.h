@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    array_decode.h
+ * @author  B. Premzel
+ * @brief   Conversion of the array values [nn:mmF*K] to double values. The
+ *          byte aligned 8, 16 and 32-bit integers and the 32 and 64-bit float
+ *          values are converted and scaled with the SSE2 instructions if they
+ *          are available at compile time. The scaling is done with a separate
+ *          addition and multiplication (no FMA) - the results are identical to
+ *          the scaling of the single values (see value_scaling()).
+ ******************************************************************************/
+
+#ifndef _ARRAY_DECODE_H
+#define _ARRAY_DECODE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define ARRAY_DECODE_SSE2
+#endif
+
+
+#if defined(ARRAY_DECODE_SSE2)
+/**
+ * @brief Converts four 32-bit signed integers to double values.
+ *
+ * @param values  Output: converted values.
+ * @param x       Integers to be converted.
+ */
+
+static inline void store_int32x4_as_double(double *values, __m128i x)
+{
+    _mm_storeu_pd(&values[0], _mm_cvtepi32_pd(x));
+    _mm_storeu_pd(&values[2], _mm_cvtepi32_pd(_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+
+/**
+ * @brief Converts eight 16-bit integers to double values.
+ *
+ * @param values     Output: converted values.
+ * @param x          Integers to be converted.
+ * @param is_signed  true - signed integers
+ */
+
+static inline void store_int16x8_as_double(double *values, __m128i x, bool is_signed)
+{
+    __m128i lo;
+    __m128i hi;
+
+    if (is_signed)
+    {
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+    }
+    else
+    {
+        lo = _mm_unpacklo_epi16(x, _mm_setzero_si128());
+        hi = _mm_unpackhi_epi16(x, _mm_setzero_si128());
+    }
+
+    store_int32x4_as_double(&values[0], lo);
+    store_int32x4_as_double(&values[4], hi);
+}
+#endif
+
+
+/**
+ * @brief Converts the elements of an array value to double values. Only the elements with
+ *        a byte aligned address and one of the sizes supported by the vector instructions
+ *        are converted here. The caller converts the remaining elements (the returned
+ *        number is smaller than count) one by one.
+ *
+ * @param data       Pointer to the first element of the array (byte aligned address).
+ * @param size       Size of an element in bits.
+ * @param type       'u' - unsigned integers, 'i' - signed integers, 'f' - float values
+ * @param count      Number of elements to convert.
+ * @param values     Output: converted values.
+ *
+ * @return Number of converted elements.
+ */
+
+static inline uint32_t convert_array_elements(const uint8_t *data, uint32_t size, char type,
+    uint32_t count, double *values)
+{
+    uint32_t i = 0;
+
+    if ((type == 'f') && (size == 64u))
+    {
+        memcpy(values, data, count * sizeof(double));
+        return count;
+    }
+
+#if defined(ARRAY_DECODE_SSE2)
+    bool is_signed = (type == 'i');
+
+    switch (size)
+    {
+        case 8u:
+            if (type == 'f')
+            {
+                break;
+            }
+
+            for ( ; (i + 8u) <= count; i += 8u)
+            {
+                __m128i x = _mm_loadl_epi64((const __m128i *)&data[i]);
+                x = is_signed ? _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8)
+                              : _mm_unpacklo_epi8(x, _mm_setzero_si128());
+                store_int16x8_as_double(&values[i], x, true);   // Already extended to 16 bits
+            }
+            break;
+
+        case 16u:
+            if (type == 'f')
+            {
+                break;      // Half precision float values are converted by the caller
+            }
+
+            for ( ; (i + 8u) <= count; i += 8u)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i *)&data[2u * i]);
+                store_int16x8_as_double(&values[i], x, is_signed);
+            }
+            break;
+
+        case 32u:
+            for ( ; (i + 4u) <= count; i += 4u)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i *)&data[4u * i]);
+
+                if (type == 'f')
+                {
+                    __m128 f = _mm_castsi128_ps(x);
+                    _mm_storeu_pd(&values[i], _mm_cvtps_pd(f));
+                    _mm_storeu_pd(&values[i + 2u], _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+                }
+                else if (is_signed)
+                {
+                    store_int32x4_as_double(&values[i], x);
+                }
+                else
+                {
+                    // The unsigned value is converted as (value - 2^31) + 2^31
+                    __m128i y = _mm_xor_si128(x, _mm_set1_epi32((int)0x80000000u));
+                    __m128d offset = _mm_set1_pd(2147483648.0);
+                    _mm_storeu_pd(&values[i], _mm_add_pd(_mm_cvtepi32_pd(y), offset));
+                    _mm_storeu_pd(&values[i + 2u], _mm_add_pd(
+                        _mm_cvtepi32_pd(_mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2))), offset));
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+#else
+    (void)data;
+    (void)size;
+    (void)type;
+    (void)values;
+#endif
+
+    return i;
+}
+
+
+/**
+ * @brief Scales the converted array elements: value = (value + offset) * mult.
+ *
+ * @param values  Array of values.
+ * @param count   Number of values.
+ * @param offset  Offset added before the multiplication.
+ * @param mult    Multiplier.
+ */
+
+static inline void scale_array_elements(double *values, uint32_t count, double offset, double mult)
+{
+    uint32_t i = 0;
+
+#if defined(ARRAY_DECODE_SSE2)
+    __m128d v_offset = _mm_set1_pd(offset);
+    __m128d v_mult = _mm_set1_pd(mult);
+
+    for ( ; (i + 2u) <= count; i += 2u)
+    {
+        __m128d x = _mm_loadu_pd(&values[i]);
+        _mm_storeu_pd(&values[i], _mm_mul_pd(_mm_add_pd(x, v_offset), v_mult));
+    }
+#endif
+
+    for ( ; i < count; i++)
+    {
+        values[i] = (values[i] + offset) * mult;
+    }
+}
+
+#endif  // _ARRAY_DECODE_H
+
+/*==== End of file ====*/
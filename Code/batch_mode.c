@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    batch_mode.c
+ * @author  B. Premzel
+ * @brief   Decoding of several binary data files in one run (-batch).
+ *          The files are decoded one after another - the decoding uses the
+ *          global g_msg and g_fmt[] data. The state which belongs to a single
+ *          binary data file (message counters, timestamps, error counters,
+ *          value statistics, MEMO values, output files) is prepared again
+ *          for every file. A fatal error stops the decoding of all files.
+ *          With -merge the Main.log files of all decoded files are merged
+ *          into Main.log of the output folder (see merge_logs.c). The decode
+ *          server (see server_mode.c) decodes its jobs the same way.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "format.h"
+#include "fmt_cache.h"
+#include "read_bin_data.h"
+#include "process_bin_data.h"
+#include "utf8_helpers.h"
+#include "merge_logs.h"
+#include "compress_output.h"
+#include "batch_mode.h"
+
+static rte_msg_t decoding_start_state;  // Main data structure after the format definitions have been prepared
+static char *output_folder;             // Output folder defined in the command line
+static char *data_file_folder;          // Output subfolder of the currently decoded binary data file
+static unsigned next_data_file;         // Index of the next binary data file in the g_msg.param.data_file_names[]
+static uint32_t batch_errors;           // Total number of errors for all decoded files
+static bool all_files_finished = true;  // false - the decoding of at least one file has not finished normally
+
+
+/**
+ * @brief Returns the length of the file name without its last extension.
+ *
+ * @param name    File name without the path.
+ * @param length  Length of the name to be checked.
+ *
+ * @return  Length of the name without the extension.
+ */
+
+static size_t length_without_extension(const char *name, size_t length)
+{
+    for (size_t i = length; i > 1u; i--)
+    {
+        if (name[i - 1u] == '.')
+        {
+            return i - 1u;
+        }
+    }
+
+    return length;
+}
+
+
+/**
+ * @brief Prepares the name of the output subfolder for a binary data file and creates
+ *        the subfolder if it does not exist yet. Both extensions of a compressed file
+ *        are removed (i.e. "data.bin.zst" is decoded to the "data" subfolder).
+ *
+ * @param data_file_name  Name of the binary data file.
+ *
+ * @return  Name of the subfolder relative to the start folder (or with the full path).
+ */
+
+static char *prepare_data_file_folder(const char *data_file_name)
+{
+    const char *name = data_file_name;
+
+    for (const char *p = data_file_name; *p != '\0'; p++)
+    {
+        if ((*p == '/') || (*p == '\\'))
+        {
+            name = p + 1;
+        }
+    }
+
+    size_t length = length_without_extension(name, strlen(name));
+
+    if (is_compressed_file_name(name))
+    {
+        length = length_without_extension(name, length);
+    }
+
+    size_t size = strlen(output_folder) + length + 2u;
+    char *folder = (char *)allocate_memory(size, "batchDir");
+    snprintf(folder, size, "%s%c%.*s", output_folder, PATH_SEPARATOR, (int)length, name);
+
+    // A problem with the folder creation is reported by the open_output_folder()
+    jump_to_start_folder();
+    _set_errno(0);
+    (void)utf8_mkdir(folder);
+
+    return folder;
+}
+
+
+/**
+ * @brief Clears the data collected for the message types during the decoding of the
+ *        previous binary data file (message counters, value statistics, column export,
+ *        logging rate statistics).
+ */
+
+static void reset_message_types(void)
+{
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        msg_data_t *p_fmt = g_fmt[fmt_id];
+
+        // Several format IDs share the same definitions - the data is cleared more than once
+        if (p_fmt == NULL)
+        {
+            continue;
+        }
+
+        p_fmt->counter = 0;
+        p_fmt->counter_total = 0;
+        p_fmt->total_data_received = 0;
+        p_fmt->time_last_message = 0;
+        p_fmt->size_verified = false;
+        p_fmt->verified_size = 0;
+        p_fmt->columns = NULL;
+        p_fmt->rate_window_no = 0;
+        p_fmt->peak_window_messages = 0;
+        p_fmt->peak_window_words = 0;
+        p_fmt->peak_window_start = 0;
+
+        for (value_format_t *fmt = p_fmt->format; fmt != NULL; fmt = fmt->format)
+        {
+            value_stats_t *stat = fmt->value_stat;
+
+            if (stat == NULL)
+            {
+                continue;
+            }
+
+            release_quantile_sketch(stat->sketch);
+            *stat = (value_stats_t){ .name = stat->name, .quantiles = stat->quantiles };
+        }
+    }
+}
+
+
+/**
+ * @brief Saves the state prepared by the format definition parsing. The OUT_FILE() files
+ *        and Timestamps.csv created in the output folder are removed - they are created
+ *        in the subfolders of the binary data files.
+ */
+
+void prepare_batch_decoding(void)
+{
+    output_folder = g_msg.param.working_folder;
+    close_out_files(true);
+
+    if (g_msg.file.timestamps != NULL)
+    {
+        close_output_file(g_msg.file.timestamps);
+        g_msg.file.timestamps = NULL;
+        remove_file(compressed_file_name(RTE_MSG_TIMESTAMPS_FILE));
+    }
+
+    jump_to_start_folder();
+    decoding_start_state = g_msg;
+}
+
+
+/**
+ * @brief Restores the state saved by the prepare_batch_decoding() before the decoding
+ *        of the next binary data file.
+ */
+
+void restore_decoding_start_state(void)
+{
+    // The buffers for the long timestamp search are reused
+    tstamp_checkpoint_t *checkpoint[2] =
+        { g_msg.timestamp.search[0].checkpoint, g_msg.timestamp.search[1].checkpoint };
+
+    g_msg = decoding_start_state;
+    g_msg.timestamp.search[0].checkpoint = checkpoint[0];
+    g_msg.timestamp.search[1].checkpoint = checkpoint[1];
+}
+
+
+/**
+ * @brief Clears the data of the message types and creates the OUT_FILE() files in the
+ *        output folder of the binary data file (g_msg.param.working_folder).
+ */
+
+void prepare_data_file_outputs(void)
+{
+    reset_message_types();
+    remove_old_files();
+    create_out_files();
+    jump_to_start_folder();
+}
+
+
+/**
+ * @brief Prepares the decoding of the next binary data file.
+ *
+ * @return  false - all binary data files have been decoded
+ */
+
+bool start_next_batch_file(void)
+{
+    if (next_data_file >= g_msg.param.data_files)
+    {
+        return false;
+    }
+
+    restore_decoding_start_state();
+
+    if (data_file_folder != NULL)
+    {
+        release_memory(data_file_folder, strlen(data_file_folder) + 1u, "batchDir");
+    }
+
+    g_msg.param.data_file_name = g_msg.param.data_file_names[next_data_file++];
+    data_file_folder = prepare_data_file_folder(g_msg.param.data_file_name);
+    g_msg.param.working_folder = data_file_folder;
+
+    fprintf(g_msg.file.error_log, get_message_text(MSG_BATCH_DATA_FILE),
+        g_msg.param.data_file_name, data_file_folder);
+    prepare_data_file_outputs();
+    return true;
+}
+
+
+/**
+ * @brief Closes the output files of the decoded binary data file and releases its data,
+ *        the output file buffers and the buffer for the assembled messages.
+ */
+
+void finish_batch_file(void)
+{
+    if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
+    {
+        close_output_file(g_msg.file.main_log);
+    }
+
+    if (g_msg.file.statistics_log != NULL)
+    {
+        fclose(g_msg.file.statistics_log);
+    }
+
+    if (g_msg.file.timestamps != NULL)
+    {
+        close_output_file(g_msg.file.timestamps);
+    }
+
+    if (g_msg.file.rates != NULL)
+    {
+        close_output_file(g_msg.file.rates);
+    }
+
+    g_msg.file.main_log = g_msg.file.error_log;
+    g_msg.file.statistics_log = NULL;
+    g_msg.file.timestamps = NULL;
+    g_msg.file.rates = NULL;
+    close_out_files(false);
+    release_binary_data();
+    release_message_assembly(&g_msg);   // Allocated again for the header of the next file
+    jump_to_start_folder();
+
+    batch_errors += g_msg.total_errors;
+
+    if (g_msg.param.merge_logs)
+    {
+        add_log_to_merge(data_file_folder, g_msg.param.data_file_name);
+    }
+
+    if (!g_msg.binary_file_decoding_finished)
+    {
+        all_files_finished = false;
+    }
+}
+
+
+/**
+ * @brief Merges the Main.log files if enabled (-merge) and prepares the error counter and
+ *        decoding status of all files for the exit code.
+ */
+
+void finish_batch_decoding(void)
+{
+    if (g_msg.param.merge_logs)
+    {
+        write_merged_main_log(output_folder);
+    }
+
+    g_msg.param.working_folder = output_folder;
+    g_msg.total_errors = batch_errors;
+    g_msg.binary_file_decoding_finished = all_files_finished;
+    fprintf(g_msg.file.error_log, "\n");
+}
+
+/*==== End of file ====*/
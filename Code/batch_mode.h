@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    batch_mode.h
+ * @author  B. Premzel
+ * @brief   Decoding of several binary data files in one run (-batch).
+ *
+ *          The format definitions are parsed (or loaded from the cache) only
+ *          once. Every binary data file is then decoded to its own subfolder
+ *          of the output folder - the subfolder name is the data file name
+ *          without the path and extension. The state prepared by the format
+ *          definition parsing is restored before every file is decoded.
+ ******************************************************************************/
+
+#ifndef _BATCH_MODE_H
+#define _BATCH_MODE_H
+
+#include <stdbool.h>
+
+
+/***** Function declarations *****/
+void prepare_batch_decoding(void);
+void restore_decoding_start_state(void);
+void prepare_data_file_outputs(void);
+bool start_next_batch_file(void);
+void finish_batch_file(void);
+void finish_batch_decoding(void);
+
+#endif  // _BATCH_MODE_H
+
+/*==== End of file ====*/
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    bit_field.h
+ * @author  B. Premzel
+ * @brief   Extraction of bit fields from the assembled message data.
+ ******************************************************************************/
+
+#ifndef _BIT_FIELD_H
+#define _BIT_FIELD_H
+
+#include <stdint.h>
+#include <string.h>
+
+
+/**
+ * @brief Extracts a value with 1 to 64 bits starting with the specified bit address
+ *        of the lowest value bit. The value is loaded with an unaligned 64-bit read and
+ *        (if it crosses the 64-bit boundary) one additional byte - the time does not
+ *        depend on the value size or address.
+ * @note  Up to 7 bytes after the last byte of the value are read. The assembled message
+ *        buffers contain at least two zero words after the message data.
+ *        The message data is little-endian (as are the supported host platforms).
+ *
+ * @param message   Pointer to the buffer containing the message to be processed.
+ * @param address   Bit address of the value (number of bits to the first bit of the value).
+ * @param size      Size of the value in bits (1 ... 64).
+ *
+ * @return Value aligned to the highest bit (bit 63) of the 64-bit unsigned integer.
+ */
+
+static inline uint64_t extract_bit_field(const uint8_t *message, uint32_t address, uint32_t size)
+{
+    const uint8_t *data = message + (address >> 3u);
+    unsigned shift = address & 7u;
+    uint64_t value;
+
+    memcpy(&value, data, sizeof(value));                // Compiled to a single unaligned load
+    value >>= shift;
+
+    if ((shift + size) > 64u)
+    {
+        value |= (uint64_t)data[8] << (64u - shift);    // The remaining highest bits
+    }
+
+    return value << (64u - size);
+}
+
+#endif  // _BIT_FIELD_H
+
+/*==== End of file ====*/
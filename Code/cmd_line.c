@@ -17,6 +17,8 @@
 #include "errors.h"
 #include "files.h"
 #include "decoder.h"
+#include "compress_output.h"
+#include "query.h"
 
 
 /**
@@ -132,22 +134,263 @@ static void process_the_N_value(const char *number, const char *parameter_text)
 
 
 /**
- * @brief Saves the name of the binary data file.
- *        Reports an error if a data file has already been defined (only one data file name is allowed).
+ * @brief Processes the -follow=x command line argument.
+ *        The value defines the time [s] without new data in the binary file after which the decoding is finished.
+ *
+ * @param number          String containing the number to parse.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_follow_value(const char *number, const char *parameter_text)
+{
+    unsigned int timeout = 0;
+    (void)sscanf(number, "%u", &timeout);  // The 'timeout' variable has a value 0 if the conversion fails
+
+    if (timeout == 0)
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_FOLLOW_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.follow_mode = true;
+    g_msg.param.follow_timeout = timeout;
+}
+
+
+/**
+ * @brief Processes the -threads=N command line argument.
+ *        The value defines the number of threads used for printing of the decoded messages.
+ *
+ * @param number          String containing the number to parse.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_threads_value(const char *number, const char *parameter_text)
+{
+    unsigned int threads = 0;
+    (void)sscanf(number, "%u", &threads);  // The 'threads' variable has a value 0 if the conversion fails
+
+    if ((threads == 0) || (threads > MAX_PRINT_THREADS))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_THREADS_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.decode_threads = threads;
+}
+
+
+/**
+ * @brief Processes the -outbuf=N command line argument.
+ *        The value defines the size of the output file buffers in kB (0 = default stdio buffers).
+ *
+ * @param number          String containing the number to parse.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_outbuf_value(const char *number, const char *parameter_text)
+{
+    unsigned int size = 0;
+
+    if ((sscanf(number, "%u", &size) != 1) || (size > MAX_OUTPUT_BUFFER_SIZE))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_OUTBUF_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.output_buffer_size = size;
+}
+
+
+/**
+ * @brief Processes the -errors=K command line argument.
+ *        Only the first K errors of each type are printed in detail. The remaining ones
+ *        are counted and summarized at the end of the Errors.log file.
+ *
+ * @param number          String containing the number to parse.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_errors_value(const char *number, const char *parameter_text)
+{
+    unsigned int limit = 0;
+
+    if ((sscanf(number, "%u", &limit) != 1) || (limit < 1u) || (limit > MAX_ERROR_REPORT_LIMIT))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_ERRORS_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.error_report_limit = limit;
+}
+
+
+/**
+ * @brief Processes the -rate=N command line argument.
+ *        The messages and words are counted in consecutive time windows of N milliseconds.
+ *
+ * @param number          String containing the number to parse.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_rate_value(const char *number, const char *parameter_text)
+{
+    unsigned int window = 0;
+
+    if ((sscanf(number, "%u", &window) != 1) || (window < 1u) || (window > MAX_RATE_WINDOW))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_RATE_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.rate_window = window;
+}
+
+
+/**
+ * @brief Processes the -context=N command line argument.
+ *        N messages following each message matching the -query=... conditions are decoded also.
+ *
+ * @param number          String containing the number to parse.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_context_value(const char *number, const char *parameter_text)
+{
+    unsigned int context = 0;
+
+    if ((sscanf(number, "%u", &context) != 1) || (context > MAX_QUERY_CONTEXT))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_CONTEXT_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.query_context = context;
+}
+
+
+/**
+ * @brief Processes the -window=t1;t2 command line argument.
+ *        Only the messages with timestamps between t1 and t2 [s] are decoded.
+ *
+ * @param values          String containing the start and end time of the window.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_window_value(const char *values, const char *parameter_text)
+{
+    int no_values = sscanf(values, "%lf;%lf", &g_msg.param.window_start, &g_msg.param.window_end);
+
+    if ((no_values != 2) || !(g_msg.param.window_start < g_msg.param.window_end))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_WINDOW_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.time_window = true;
+}
+
+
+/**
+ * @brief Processes the -range=N1;N2 command line argument.
+ *        Only the messages with numbers from N1 to N2 are decoded.
+ *        The decoding is finished after the message N2.
+ *
+ * @param values          String containing the first and last message number.
+ * @param parameter_text  Full parameter text to include in error message if validation fails.
+ */
+
+static void process_the_range_value(const char *values, const char *parameter_text)
+{
+    unsigned first = 0;
+    unsigned last = 0;
+    int no_values = sscanf(values, "%u;%u", &first, &last);
+
+    if ((no_values != 2) || (first == 0) || (first > last))
+    {
+        report_error_and_show_instructions(
+            get_message_text(FATAL_BAD_RANGE_PARAMETER_VALUE), parameter_text);
+    }
+
+    g_msg.param.message_range = true;
+    g_msg.param.first_message = first;
+    g_msg.param.last_message = last;
+}
+
+
+/**
+ * @brief Saves the name of the binary data file. More than one data file name is allowed
+ *        only with the -batch argument - see check_data_file_names().
  *
  * @param file_name The binary data file name to save.
  */
 
 static void save_data_file_name(char *file_name)
 {
-    if (g_msg.param.data_file_name == NULL)
+    char **names = (char **)allocate_memory((g_msg.param.data_files + 1u) * sizeof(char *), "dataFiles");
+
+    if (g_msg.param.data_file_names != NULL)
     {
-        g_msg.param.data_file_name = prepare_folder_name(file_name, 0);
+        memcpy(names, g_msg.param.data_file_names, g_msg.param.data_files * sizeof(char *));
+        release_memory(g_msg.param.data_file_names, g_msg.param.data_files * sizeof(char *), "dataFiles");
     }
-    else
+
+    names[g_msg.param.data_files++] = prepare_folder_name(file_name, 0);
+    g_msg.param.data_file_names = names;
+    g_msg.param.data_file_name = names[0];
+}
+
+
+/**
+ * @brief Checks the binary data file names after all command line arguments have been processed.
+ *        Reports an error if more than one data file has been defined without the -batch argument
+ *        or if the -batch is combined with arguments which can be used for a single file only.
+ *        The compressed files and the standard input are read sequentially - they cannot be
+ *        followed or indexed. The standard input can be decoded only once (no -batch).
+ *        The decode server (-server=name) gets the binary data file names from its clients.
+ */
+
+static void check_data_file_names(void)
+{
+    for (unsigned i = 0; i < g_msg.param.data_files; i++)
+    {
+        if ((g_msg.param.follow_mode || (g_msg.param.index_file != NULL))
+            && is_compressed_file_name(g_msg.param.data_file_names[i]))
+        {
+            report_error_and_show_instructions(get_message_text(FATAL_BAD_COMPRESSED_INPUT_PARAMETERS),
+                g_msg.param.data_file_names[i]);
+        }
+
+        if ((g_msg.param.follow_mode || (g_msg.param.index_file != NULL) || g_msg.param.batch_mode)
+            && (strcmp(g_msg.param.data_file_names[i], RTE_STDIN_DATA_FILE) == 0))
+        {
+            report_error_and_show_instructions(get_message_text(FATAL_BAD_STDIN_INPUT_PARAMETERS),
+                g_msg.param.data_file_names[i]);
+        }
+    }
+
+    if (g_msg.param.batch_mode)
+    {
+        if (g_msg.param.follow_mode || (g_msg.param.index_file != NULL))
+        {
+            report_error_and_show_instructions(get_message_text(FATAL_BAD_BATCH_PARAMETERS),
+                g_msg.param.merge_logs ? "-merge" : "-batch");
+        }
+    }
+    else if (g_msg.param.data_files > 1u)
     {
         report_error_and_show_instructions(
-            get_message_text(FATAL_UNKNOWN_PARAM_OR_FILE_DEFINED_TWICE), file_name);
+            get_message_text(FATAL_UNKNOWN_PARAM_OR_FILE_DEFINED_TWICE), g_msg.param.data_file_names[1]);
+    }
+
+    if (g_msg.param.server_name != NULL)
+    {
+        if (g_msg.param.batch_mode || g_msg.param.follow_mode || (g_msg.param.index_file != NULL)
+            || g_msg.param.check_syntax_and_compile || (g_msg.param.data_files > 0))
+        {
+            report_error_and_show_instructions(get_message_text(FATAL_BAD_SERVER_PARAMETERS),
+                g_msg.param.server_name);
+        }
     }
 }
 
@@ -218,7 +461,7 @@ static void set_default_parameters(void)
 
 static void process_one_cmd_line_parameter(char *argv)
 {
-    if (argv[0] != '-')
+    if ((argv[0] != '-') || (strcmp(argv, RTE_STDIN_DATA_FILE) == 0))
     {
         save_data_file_name(argv);
     }
@@ -253,6 +496,10 @@ static void process_one_cmd_line_parameter(char *argv)
     {
         g_msg.param.value_statistics_enabled = true;
     }
+    else if (strcmp(argv, "-stat=loss") == 0)
+    {
+        g_msg.param.loss_statistics_enabled = true;
+    }
     else if (strcmp(argv, "-debug") == 0)
     {
         g_msg.param.debug = true;
@@ -295,6 +542,106 @@ static void process_one_cmd_line_parameter(char *argv)
     {
         process_the_timestamp_diff_value(&argv[4], argv);
     }
+    else if (strcmp(argv, "-follow") == 0)
+    {
+        g_msg.param.follow_mode = true;
+    }
+    else if (strncmp(argv, "-follow=", 8) == 0)
+    {
+        process_the_follow_value(&argv[8], argv);
+    }
+    else if (strncmp(argv, "-threads=", 9) == 0)
+    {
+        process_the_threads_value(&argv[9], argv);
+    }
+    else if (strncmp(argv, "-outbuf=", 8) == 0)
+    {
+        process_the_outbuf_value(&argv[8], argv);
+    }
+    else if (strcmp(argv, "-lowmem") == 0)
+    {
+        g_msg.param.low_memory = true;
+    }
+    else if (strcmp(argv, "-profile") == 0)
+    {
+        g_msg.param.profile = true;
+    }
+    else if (strncmp(argv, "-fmtcache=", 10) == 0)
+    {
+        g_msg.param.fmt_cache_file = prepare_folder_name(&argv[10], 0);
+    }
+    else if (strcmp(argv, "-columns") == 0)
+    {
+        g_msg.param.column_export = true;
+    }
+    else if (strcmp(argv, "-columns=only") == 0)
+    {
+        g_msg.param.column_export = true;
+        g_msg.param.columns_only = true;
+    }
+    else if (strncmp(argv, "-select=", 8) == 0)
+    {
+        g_msg.param.select_names = &argv[8];
+    }
+    else if (strncmp(argv, "-query=", 7) == 0)
+    {
+        g_msg.param.query = &argv[7];
+
+        if (!parse_query_argument(g_msg.param.query))
+        {
+            report_error_and_show_instructions(get_message_text(FATAL_BAD_QUERY_PARAMETER_VALUE), argv);
+        }
+    }
+    else if (strncmp(argv, "-context=", 9) == 0)
+    {
+        process_the_context_value(&argv[9], argv);
+    }
+    else if (strncmp(argv, "-window=", 8) == 0)
+    {
+        process_the_window_value(&argv[8], argv);
+    }
+    else if (strncmp(argv, "-range=", 7) == 0)
+    {
+        process_the_range_value(&argv[7], argv);
+    }
+    else if (strncmp(argv, "-index=", 7) == 0)
+    {
+        g_msg.param.index_file = prepare_folder_name(&argv[7], 0);
+    }
+    else if (strncmp(argv, "-server=", 8) == 0)
+    {
+        if (argv[8] == '\0')
+        {
+            report_error_and_show_instructions(get_message_text(FATAL_BAD_SERVER_PARAMETERS), argv);
+        }
+
+        g_msg.param.server_name = &argv[8];
+    }
+    else if (strcmp(argv, "-batch") == 0)
+    {
+        g_msg.param.batch_mode = true;
+    }
+    else if (strcmp(argv, "-merge") == 0)
+    {
+        g_msg.param.batch_mode = true;
+        g_msg.param.merge_logs = true;
+    }
+    else if (strncmp(argv, "-errors=", 8) == 0)
+    {
+        process_the_errors_value(&argv[8], argv);
+    }
+    else if (strncmp(argv, "-rate=", 6) == 0)
+    {
+        process_the_rate_value(&argv[6], argv);
+    }
+    else if ((strcmp(argv, "-compress") == 0) || (strncmp(argv, "-compress=", 10) == 0))
+    {
+        if (!select_output_compression((argv[9] == '=') ? &argv[10] : "zstd"))
+        {
+            report_error_and_show_instructions(
+                get_message_text(FATAL_BAD_COMPRESS_PARAMETER_VALUE), argv);
+        }
+    }
     else
     {
         report_error_and_show_instructions(
@@ -401,6 +748,7 @@ void process_command_line_parameters(int argc, char *argv[])
     g_msg.param.time_multiplier = 1.0;
     g_msg.param.max_negative_tstamp_diff = DEFAULT_NEGATIVE_TIMESTAMP_DIFF;
     g_msg.param.max_positive_tstamp_diff = DEFAULT_POSITIVE_TIMESTAMP_DIFF;
+    g_msg.param.output_buffer_size = DEFAULT_OUTPUT_BUFFER_SIZE;
 
     if (argc == 2)
     {
@@ -432,6 +780,8 @@ void process_command_line_parameters(int argc, char *argv[])
         report_error_and_show_instructions(get_message_text(FATAL_PARAMETER_N_MISSING), "");
     }
 
+    check_data_file_names();
+
     // Set any remaining default parameters
     set_default_parameters();
 }
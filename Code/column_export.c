@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    column_export.c
+ * @author  B. Premzel
+ * @brief   Export of the decoded values to binary column files (-columns).
+ *          The values are collected in batches for every message type and
+ *          written with a single fwrite() per batch - see column_export.h
+ *          for the file format.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "format.h"
+#include "column_export.h"
+
+#define COLUMN_MESSAGE_NO       0u      // Column with the message number
+#define COLUMN_TIMESTAMP        1u      // Column with the timestamp
+#define COLUMN_FIRST_VALUE      2u      // First column with the message values
+
+static column_table_t *first_column_table;     // Linked list of the tables prepared for the message types
+
+
+/**
+ * @brief Returns the column type for a value or -1 if the value cannot be exported.
+ *
+ * @param fmt_type  Format type of the value.
+ */
+
+static int get_column_type(enum fmt_type_t fmt_type)
+{
+    switch (fmt_type)
+    {
+        case PRINT_UINT64:
+        case PRINT_BINARY:
+        case PRINT_SELECTED_TEXT:
+            return COLUMN_UINT64;
+
+        case PRINT_INT64:
+            return COLUMN_INT64;
+
+        case PRINT_DOUBLE:
+        case PRINT_TIMESTAMP:
+        case PRINT_dTIMESTAMP:
+            return COLUMN_DOUBLE;
+
+        default:
+            return -1;
+    }
+}
+
+
+/**
+ * @brief Copies a name to a fixed size buffer (truncated if too long).
+ */
+
+static void copy_column_name(char *destination, size_t size, const char *name)
+{
+    if (name != NULL)
+    {
+        strncpy(destination, name, size - 1u);
+    }
+}
+
+
+/**
+ * @brief Prepares the column export data for a message type.
+ *        Every value with a numeric type is exported to a separate column
+ *        (except the array values).
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ *
+ * @return  Pointer to the prepared table.
+ */
+
+static column_table_t *prepare_column_table(msg_data_t *p_fmt)
+{
+    column_table_t *table = (column_table_t *)allocate_memory(sizeof(column_table_t), "colTable");
+    table->op_column = (int32_t *)allocate_memory((p_fmt->plan_size + 1u) * sizeof(int32_t), "colOps");
+    uint32_t columns = COLUMN_FIRST_VALUE;
+
+    for (uint32_t i = 0; i < p_fmt->plan_size; i++)
+    {
+        const value_format_t *fmt = &p_fmt->plan[i].fmt;
+        table->op_column[i] = ((get_column_type(fmt->fmt_type) < 0) || (fmt->array_count > 0))
+            ? -1 : (int32_t)columns++;  // The array values [nn:mmF*K] are not exported
+    }
+
+    table->description =
+        (column_description_t *)allocate_memory(columns * sizeof(column_description_t), "colDescr");
+    strcpy(table->description[COLUMN_MESSAGE_NO].name, "message_no");
+    table->description[COLUMN_MESSAGE_NO].type = COLUMN_UINT64;
+    strcpy(table->description[COLUMN_TIMESTAMP].name, "timestamp");
+    table->description[COLUMN_TIMESTAMP].type = COLUMN_DOUBLE;
+
+    for (uint32_t i = 0; i < p_fmt->plan_size; i++)
+    {
+        int32_t column = table->op_column[i];
+
+        if (column < 0)
+        {
+            continue;
+        }
+
+        column_description_t *descr = &table->description[column];
+        const value_format_t *fmt = &p_fmt->plan[i].fmt;
+        descr->type = (uint32_t)get_column_type(fmt->fmt_type);
+
+        if ((fmt->value_stat != NULL) && (fmt->value_stat->name != NULL))
+        {
+            copy_column_name(descr->name, sizeof(descr->name), fmt->value_stat->name);
+        }
+        else
+        {
+            snprintf(descr->name, sizeof(descr->name), "value%u", (unsigned)(column - COLUMN_FIRST_VALUE + 1));
+        }
+    }
+
+    column_file_header_t *header = &table->header;
+    memcpy(header->magic, COLUMN_FILE_MAGIC, sizeof(header->magic));
+    header->header_size = (uint32_t)(sizeof(column_file_header_t) + columns * sizeof(column_description_t));
+    header->columns = columns;
+    header->batch_rows = COLUMN_BATCH_ROWS;
+    header->fmt_id = g_ctx->fmt_id;
+    copy_column_name(header->message_name, sizeof(header->message_name), p_fmt->message_name);
+
+    table->data = (uint64_t *)allocate_memory((size_t)columns * COLUMN_BATCH_ROWS * sizeof(uint64_t), "colData");
+
+    const char *name = (p_fmt->message_name != NULL) ? p_fmt->message_name : "unknown";
+    size_t name_size = strlen(name) + sizeof(COLUMN_FILE_EXTENSION);
+    table->file_name = (char *)allocate_memory(name_size, "colFile");
+    snprintf(table->file_name, name_size, "%s%s", name, COLUMN_FILE_EXTENSION);
+
+    table->next = first_column_table;
+    first_column_table = table;
+    return table;
+}
+
+
+/**
+ * @brief Writes the current batch of rows to the column file.
+ *        The file is created when the first batch is written.
+ *
+ * @param table  Pointer to the column export data of a message type.
+ */
+
+static void write_column_batch(column_table_t *table)
+{
+    if ((table->rows == 0) || table->write_failed)
+    {
+        table->rows = 0;
+        return;
+    }
+
+    open_output_folder();           // The binary data file name is relative to the start folder
+    FILE *out = fopen(table->file_name, table->file_created ? "ab" : "wb");
+    jump_to_start_folder();
+
+    if (out == NULL)
+    {
+        table->write_failed = true;
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, table->file_name);
+        return;
+    }
+
+    bool ok = true;
+
+    if (!table->file_created)
+    {
+        table->file_created = true;
+        ok = (fwrite(&table->header, sizeof(table->header), 1, out) == 1)
+            && (fwrite(table->description, sizeof(column_description_t), table->header.columns, out)
+                == table->header.columns);
+    }
+
+    // Move the columns of a partial batch together
+    uint64_t rows = table->rows;
+
+    for (uint32_t column = 1; column < table->header.columns; column++)
+    {
+        memmove(&table->data[column * rows], &table->data[column * COLUMN_BATCH_ROWS], rows * sizeof(uint64_t));
+    }
+
+    size_t values = (size_t)(rows * table->header.columns);
+    ok = ok && (fwrite(&rows, sizeof(rows), 1, out) == 1)
+        && (fwrite(table->data, sizeof(uint64_t), values, out) == values);
+
+    if ((fclose(out) != 0) || !ok)
+    {
+        table->write_failed = true;
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, table->file_name);
+    }
+
+    table->header.rows += rows;
+    table->rows = 0;
+}
+
+
+/**
+ * @brief Starts a new row of the column file for the current message
+ *        (message number and timestamp columns).
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ */
+
+void start_column_row(msg_data_t *p_fmt)
+{
+    if (p_fmt->columns == NULL)
+    {
+        p_fmt->columns = prepare_column_table(p_fmt);
+    }
+
+    column_table_t *table = p_fmt->columns;
+    table->data[COLUMN_MESSAGE_NO * COLUMN_BATCH_ROWS + table->rows] = g_ctx->message_cnt;
+    memcpy(&table->data[COLUMN_TIMESTAMP * COLUMN_BATCH_ROWS + table->rows], &g_ctx->timestamp, sizeof(double));
+}
+
+
+/**
+ * @brief Saves the value of the decoded plan operation to its column.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ * @param op     Decode operation which printed the value (g_ctx->value).
+ */
+
+void save_column_value(msg_data_t *p_fmt, const decode_op_t *op)
+{
+    column_table_t *table = p_fmt->columns;
+    int32_t column = table->op_column[op - p_fmt->plan];
+
+    if (column < 0)
+    {
+        return;
+    }
+
+    uint64_t *value = &table->data[(uint32_t)column * COLUMN_BATCH_ROWS + table->rows];
+
+    switch (table->description[column].type)
+    {
+        case COLUMN_INT64:
+            memcpy(value, &g_ctx->value.data_i64, sizeof(uint64_t));
+            break;
+
+        case COLUMN_DOUBLE:
+            memcpy(value, &g_ctx->value.data_double, sizeof(uint64_t));
+            break;
+
+        default:
+            *value = g_ctx->value.data_u64;
+            break;
+    }
+}
+
+
+/**
+ * @brief Finishes the row of the current message. The batch is written
+ *        to the file when it is full.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ */
+
+void finish_column_row(msg_data_t *p_fmt)
+{
+    column_table_t *table = p_fmt->columns;
+
+    if (++table->rows >= COLUMN_BATCH_ROWS)
+    {
+        write_column_batch(table);
+    }
+}
+
+
+/**
+ * @brief Writes the remaining rows to the column files and the total number of rows
+ *        to the file headers. The msg_data_t.columns must be cleared before the next
+ *        binary data file is decoded (-batch).
+ */
+
+void close_column_files(void)
+{
+    for (column_table_t *table = first_column_table; table != NULL; table = table->next)
+    {
+        write_column_batch(table);
+
+        if (!table->file_created || table->write_failed)
+        {
+            continue;
+        }
+
+        open_output_folder();
+        FILE *out = fopen(table->file_name, "r+b");
+        jump_to_start_folder();
+        bool ok = (out != NULL) && (fwrite(&table->header, sizeof(table->header), 1, out) == 1);
+
+        if ((out != NULL) && (fclose(out) != 0))
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            report_problem_with_string(FATAL_CANT_CREATE_FILE, table->file_name);
+        }
+    }
+
+    first_column_table = NULL;      // New tables are prepared for the next binary data file (-batch)
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    column_export.h
+ * @author  B. Premzel
+ * @brief   Export of the decoded values to binary column files (-columns).
+ *
+ *          A file "<message name>.col" is created in the output folder for every
+ *          message type found. All the numbers are little-endian and 8-byte aligned,
+ *          so the columns can be used directly from a memory-mapped file (e.g. with
+ *          numpy.frombuffer()). With -columns=only the message texts are not printed
+ *          to the Main.log and OUT_FILE() files - the values are only exported.
+ *
+ *          File header (column_file_header_t) followed by 'columns' column
+ *          descriptions (column_description_t). The first two columns are always
+ *          the message number (uint64) and the timestamp (double). Then follow
+ *          the numeric values of the message in the order of the format definitions.
+ *
+ *          Batches of rows follow the header until the end of the file:
+ *              uint64_t rows;              // Number of rows in the batch (1 .. batch_rows)
+ *              column 0 values [rows]      // 8 bytes per value
+ *              ...
+ *              column N-1 values [rows]
+ ******************************************************************************/
+
+#ifndef _COLUMN_EXPORT_H
+#define _COLUMN_EXPORT_H
+
+#include <stdint.h>
+#include "main.h"
+#include "format.h"
+
+#define COLUMN_FILE_MAGIC           "RTEcol1"   // File identification (8 bytes including the '\0')
+#define COLUMN_FILE_EXTENSION       ".col"
+#define COLUMN_NAME_LENGTH          48u         // Size of the column name (zero terminated)
+
+
+/* @brief Value types of the columns */
+enum column_type_t
+{
+    COLUMN_UINT64,                  /*!< Unsigned integer - %u, %x, %b, %Y (index of the text), ... */
+    COLUMN_INT64,                   /*!< Signed integer - %d, %i */
+    COLUMN_DOUBLE                   /*!< Floating point value - %f, %g, %e, %t, %T, ... */
+};
+
+
+/* @brief Header of the column file */
+typedef struct
+{
+    char magic[8];                  /*!< COLUMN_FILE_MAGIC */
+    uint32_t header_size;           /*!< Size of the header with the column descriptions [bytes] */
+    uint32_t columns;               /*!< Number of columns */
+    uint64_t rows;                  /*!< Total number of rows in all batches */
+    uint32_t batch_rows;            /*!< Max. number of rows in a batch */
+    uint32_t fmt_id;                /*!< The first format ID of the message */
+    char message_name[32];          /*!< Message name (truncated if longer) */
+} column_file_header_t;
+
+
+/* @brief Description of a column */
+typedef struct
+{
+    char name[COLUMN_NAME_LENGTH];  /*!< Name of the value statistics or "valueN" */
+    uint32_t type;                  /*!< Value type - see enum column_type_t */
+    uint32_t reserved;              /*!< Always zero */
+} column_description_t;
+
+
+/* @brief Column export data for one message type (see msg_data_t) */
+typedef struct column_table
+{
+    char *file_name;                /*!< Name of the column file */
+    column_file_header_t header;    /*!< File header */
+    column_description_t *description; /*!< Column descriptions */
+    int32_t *op_column;             /*!< Column index for every decode plan operation (-1 = not exported) */
+    uint64_t *data;                 /*!< Values of the current batch - 'batch_rows' values for every column */
+    uint32_t rows;                  /*!< Number of rows in the current batch */
+    bool file_created;              /*!< The file has been created and the header written */
+    bool write_failed;              /*!< The data could not be written to the file */
+    struct column_table *next;      /*!< Next table in the list of prepared tables */
+} column_table_t;
+
+
+/***** Function declarations *****/
+void start_column_row(msg_data_t *p_fmt);
+void save_column_value(msg_data_t *p_fmt, const decode_op_t *op);
+void finish_column_row(msg_data_t *p_fmt);
+void close_column_files(void);
+
+#endif  // _COLUMN_EXPORT_H
+
+/*==== End of file ====*/
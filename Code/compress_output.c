@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    compress_output.c
+ * @author  B. Premzel
+ * @brief   Compressed output files (-compress=tool or an OUT_FILE() file name
+ *          with the ".zst", ".lz4" or ".gz" extension). The text is written
+ *          to a pipe of the compression tool, which runs as a separate process
+ *          in parallel with the decoding and writes the compressed file. The
+ *          output file buffers (see set_output_file_buffer()) are passed to the
+ *          pipe in large blocks. The tool must be in the PATH - the -compress
+ *          tool is checked when the command line is processed. A tool which
+ *          fails later is reported as a write error of the file. The Main.log
+ *          files of the -merge and the compressed binary data files are read
+ *          from a pipe of the decompression tool the same way.
+ *          The tool is started directly (without a shell) with fixed arguments.
+ *          The file is opened by RTEmsg with utf8_fopen() and passed to the tool
+ *          as its standard input or output - the file name is not passed to the
+ *          tool at all.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "utf8_helpers.h"
+#include "compress_output.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+
+/* @brief Compression tool */
+typedef struct _compressor_t
+{
+    const char *name;               /*!< Name of the tool in the -compress=tool argument */
+    const char *extension;          /*!< Extension of the compressed files */
+    const char *compress[4];        /*!< Arguments of the tool which compresses the stdin to the stdout */
+    const char *decompress[5];      /*!< Arguments of the tool which decompresses the stdin to the stdout */
+} compressor_t;
+
+static const compressor_t compressor[] =
+{
+    { "zstd", ".zst", { "zstd", "-q", "-c", NULL }, { "zstd", "-q", "-d", "-c", NULL } },
+    { "lz4",  ".lz4", { "lz4",  "-q", "-c", NULL }, { "lz4",  "-q", "-d", "-c", NULL } },
+    { "gzip", ".gz",  { "gzip", "-c", NULL },       { "gzip", "-d", "-c", NULL }       }
+};
+
+#define NUMBER_OF_COMPRESSORS   (sizeof(compressor) / sizeof(compressor[0]))
+#define MAX_TOOL_COMMAND_LENGTH 64u     // Max. length of the tool command line (Windows)
+
+
+/* @brief Pipe of a compression tool */
+typedef struct
+{
+    FILE *file;                     /*!< Pipe to or from the tool */
+    process_compat_t process;       /*!< Process of the tool */
+} tool_pipe_t;
+
+static tool_pipe_t *pipe_file;      // Opened pipes of the compression tools
+static unsigned pipes;              // Number of opened pipes
+static unsigned pipes_allocated;    // Size of the pipe_file[] array
+
+
+/**
+ * @brief Processes the tool name of the -compress=tool command line argument. The tool is
+ *        started once to check that it is available - a missing tool could not be reported
+ *        to the compressed Errors.log.
+ *
+ * @param tool_name  Name of the compression tool (zstd, lz4 or gzip)
+ *
+ * @return false - unknown tool or the tool is not in the PATH
+ */
+
+bool select_output_compression(const char *tool_name)
+{
+    for (unsigned i = 0; i < NUMBER_OF_COMPRESSORS; i++)
+    {
+        if (strcmp(tool_name, compressor[i].name) == 0)
+        {
+            char command[64];
+            snprintf(command, sizeof(command), "%s -V >%s 2>&1", compressor[i].name, NULL_DEVICE_COMPAT);
+
+            if (system(command) != 0)
+            {
+                return false;
+            }
+
+            g_msg.param.compression = i + 1u;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Finds the compression tool according to the extension of the file name.
+ *
+ * @param file_name  Name of the file
+ *
+ * @return Pointer to the compression tool, NULL - not a compressed file name
+ */
+
+static const compressor_t *find_compressor(const char *file_name)
+{
+    size_t name_length = strlen(file_name);
+
+    for (unsigned i = 0; i < NUMBER_OF_COMPRESSORS; i++)
+    {
+        size_t ext_length = strlen(compressor[i].extension);
+
+        if ((name_length > ext_length)
+            && (strcmp(&file_name[name_length - ext_length], compressor[i].extension) == 0))
+        {
+            return &compressor[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Checks if the file name has the extension of a compressed file (.zst, .lz4 or .gz).
+ *
+ * @param file_name  Name of the file
+ *
+ * @return true - compressed file
+ */
+
+bool is_compressed_file_name(const char *file_name)
+{
+    return find_compressor(file_name) != NULL;
+}
+
+
+/**
+ * @brief Returns the name of the file as it is created in the output folder. The extension
+ *        of the -compress tool is appended unless the name already has a compressed file
+ *        extension. The returned string is valid until the next call.
+ *
+ * @param file_name  Name of the output file
+ *
+ * @return Name of the file with the compressed file extension if compression is enabled
+ */
+
+const char *compressed_file_name(const char *file_name)
+{
+    static char name[MAX_FILEPATH_LENGTH];
+
+    if ((g_msg.param.compression == 0) || (find_compressor(file_name) != NULL))
+    {
+        return file_name;
+    }
+
+    snprintf(name, sizeof(name), "%s%s", file_name,
+        compressor[g_msg.param.compression - 1u].extension);
+    return name;
+}
+
+
+/**
+ * @brief Adds the pipe to the list of pipes which must be closed before the application exits.
+ *
+ * @param file     Pointer to the pipe
+ * @param process  Process of the tool
+ */
+
+static void register_pipe(FILE *file, process_compat_t process)
+{
+    if (pipes >= pipes_allocated)
+    {
+        unsigned new_size = (pipes_allocated == 0) ? 16u : (2u * pipes_allocated);
+        tool_pipe_t *new_pipe_file = (tool_pipe_t *)realloc(pipe_file, new_size * sizeof(tool_pipe_t));
+
+        if (new_pipe_file == NULL)
+        {
+            report_fatal_error_and_exit(FATAL_MALLOC_FAILED, "pipes", new_size * sizeof(tool_pipe_t));
+        }
+
+        pipe_file = new_pipe_file;
+        pipes_allocated = new_size;
+    }
+
+    pipe_file[pipes].file = file;
+    pipe_file[pipes].process = process;
+    pipes++;
+}
+
+
+/**
+ * @brief Waits until the compression tool has finished.
+ *
+ * @param process  Process of the tool
+ *
+ * @return true - the tool has finished successfully
+ */
+
+static bool wait_for_tool(process_compat_t process)
+{
+#ifdef _WIN32
+    DWORD exit_code = 1;
+    (void)WaitForSingleObject(process, INFINITE);
+    (void)GetExitCodeProcess(process, &exit_code);
+    CloseHandle(process);
+    return exit_code == 0;
+#else
+    int status = 0;
+
+    while (waitpid(process, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    return WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+#endif
+}
+
+
+/**
+ * @brief Starts the compression tool without a shell. The file is the standard input of the
+ *        tool if its output is read or the standard output if the text is written to the tool.
+ *        The other standard stream is the returned pipe.
+ *
+ * @param argv         Arguments of the tool (NULL terminated, argv[0] - name of the tool)
+ * @param file         File opened by the caller - may be closed after the function returns
+ * @param read_output  true - the output of the tool is read from the pipe
+ * @param binary       false - text mode pipe (CR LF translation on Windows)
+ * @param process      Output: process of the tool
+ *
+ * @return Pointer to the pipe, NULL - the tool could not be started
+ */
+
+static FILE *start_tool(const char *const *argv, FILE *file, bool read_output, bool binary,
+    process_compat_t *process)
+{
+#ifdef _WIN32
+    wchar_t command[MAX_TOOL_COMMAND_LENGTH];
+    size_t length = 0;
+
+    // The arguments are fixed ASCII texts without spaces
+    for (unsigned i = 0; argv[i] != NULL; i++)
+    {
+        for (const char *c = argv[i]; *c != '\0'; c++)
+        {
+            if (length < (MAX_TOOL_COMMAND_LENGTH - 2u))
+            {
+                command[length++] = (wchar_t)*c;
+            }
+        }
+
+        command[length++] = (argv[i + 1u] != NULL) ? L' ' : L'\0';
+    }
+
+    SECURITY_ATTRIBUTES attributes = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE read_end;
+    HANDLE write_end;
+
+    if (!CreatePipe(&read_end, &write_end, &attributes, 0))
+    {
+        return NULL;
+    }
+
+    HANDLE parent_end = read_output ? read_end : write_end;
+    HANDLE child_end = read_output ? write_end : read_end;
+    HANDLE file_handle = NULL;
+    (void)SetHandleInformation(parent_end, HANDLE_FLAG_INHERIT, 0);    // Only the tool end is inherited
+
+    if (!DuplicateHandle(GetCurrentProcess(), (HANDLE)_get_osfhandle(_fileno(file)), GetCurrentProcess(),
+        &file_handle, 0, TRUE, DUPLICATE_SAME_ACCESS))
+    {
+        CloseHandle(read_end);
+        CloseHandle(write_end);
+        return NULL;
+    }
+
+    STARTUPINFOW startup_info;
+    PROCESS_INFORMATION process_info;
+    memset(&startup_info, 0, sizeof(startup_info));
+    startup_info.cb = sizeof(startup_info);
+    startup_info.dwFlags = STARTF_USESTDHANDLES;
+    startup_info.hStdInput = read_output ? file_handle : child_end;
+    startup_info.hStdOutput = read_output ? child_end : file_handle;
+    startup_info.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+    BOOL started = CreateProcessW(NULL, command, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL,
+        &startup_info, &process_info);
+    CloseHandle(file_handle);
+    CloseHandle(child_end);
+
+    if (!started)
+    {
+        CloseHandle(parent_end);
+        _set_errno(ENOENT);     // Reported as the missing tool
+        return NULL;
+    }
+
+    CloseHandle(process_info.hThread);
+    *process = process_info.hProcess;
+    int fd = _open_osfhandle((intptr_t)parent_end,
+        (read_output ? _O_RDONLY : _O_WRONLY) | (binary ? _O_BINARY : _O_TEXT));
+
+    if (fd < 0)
+    {
+        CloseHandle(parent_end);
+        (void)wait_for_tool(*process);
+        return NULL;
+    }
+
+    FILE *pipe = _fdopen(fd, read_output ? (binary ? "rb" : "rt") : (binary ? "wb" : "wt"));
+
+    if (pipe == NULL)
+    {
+        _close(fd);
+        (void)wait_for_tool(*process);
+    }
+
+    return pipe;
+#else
+    (void)binary;           // The POSIX pipes have no text mode
+    int pipe_fd[2];
+
+    if (pipe(pipe_fd) != 0)
+    {
+        return NULL;
+    }
+
+    int parent_fd = read_output ? pipe_fd[0] : pipe_fd[1];
+    int child_fd = read_output ? pipe_fd[1] : pipe_fd[0];
+    int file_fd = fileno(file);
+
+    // The tools started later must not inherit the pipes of the tools started before
+    (void)fcntl(parent_fd, F_SETFD, FD_CLOEXEC);
+    (void)fcntl(child_fd, F_SETFD, FD_CLOEXEC);
+    (void)fcntl(file_fd, F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t actions;
+    int error = posix_spawn_file_actions_init(&actions);
+
+    if (error == 0)
+    {
+        (void)posix_spawn_file_actions_adddup2(&actions, read_output ? file_fd : child_fd, STDIN_FILENO);
+        (void)posix_spawn_file_actions_adddup2(&actions, read_output ? child_fd : file_fd, STDOUT_FILENO);
+        error = posix_spawnp(process, argv[0], &actions, NULL, (char *const *)argv, environ);
+        (void)posix_spawn_file_actions_destroy(&actions);
+    }
+
+    close(child_fd);
+
+    if (error != 0)
+    {
+        close(parent_fd);
+        _set_errno(error);      // Reported as the missing tool
+        return NULL;
+    }
+
+    FILE *pipe = fdopen(parent_fd, read_output ? "r" : "w");
+
+    if (pipe == NULL)
+    {
+        close(parent_fd);
+        (void)wait_for_tool(*process);
+    }
+
+    return pipe;
+#endif
+}
+
+
+/**
+ * @brief Opens an output file. The file is compressed if the -compress option is enabled or
+ *        if the file name has a compressed file extension. Otherwise the file is opened with
+ *        utf8_fopen(). A compressed file is also decompressed for reading ("r" mode).
+ *
+ * @param file_name  Name of the file (without the extension added by the -compress option)
+ * @param mode       fopen() mode
+ *
+ * @return Pointer to the file or pipe, NULL - the file could not be opened
+ */
+
+FILE *compressed_fopen(const char *file_name, const char *mode)
+{
+    const char *name = compressed_file_name(file_name);
+    const compressor_t *tool = find_compressor(name);
+
+    if (tool == NULL)
+    {
+        return utf8_fopen(file_name, mode);
+    }
+
+    bool read_output = (mode[0] == 'r');
+    const char *file_mode = read_output ? "rb" : ((mode[0] == 'a') ? "ab" : "wb");
+    FILE *file = utf8_fopen(name, file_mode);   // Also reports a missing file (the tool would not)
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    if ((name != file_name) && (mode[0] == 'w'))
+    {
+        (void)utf8_remove(file_name);           // Uncompressed file of a previous run
+    }
+
+    ignore_broken_pipe_compat();    // A failed tool is reported as a write error
+    process_compat_t process;
+    FILE *pipe = start_tool(read_output ? tool->decompress : tool->compress, file, read_output,
+        strchr(mode, 'b') != NULL, &process);
+    int error = errno;
+    fclose(file);                   // The tool has its own copy of the file handle
+
+    if (pipe == NULL)
+    {
+        _set_errno(error);
+        return NULL;
+    }
+
+    register_pipe(pipe, process);
+    _set_errno(0);
+    return pipe;
+}
+
+
+/**
+ * @brief Closes a file opened with compressed_fopen(). The function waits until the
+ *        compression tool has written the compressed file.
+ *
+ * @param file  Pointer to the file or pipe
+ *
+ * @return 0 - file closed successfully, EOF - error
+ */
+
+int compressed_fclose(FILE *file)
+{
+    for (unsigned i = 0; i < pipes; i++)
+    {
+        if (pipe_file[i].file == file)
+        {
+            process_compat_t process = pipe_file[i].process;
+            pipe_file[i] = pipe_file[--pipes];
+            int result = fclose(file);
+            return (wait_for_tool(process) && (result == 0)) ? 0 : EOF;
+        }
+    }
+
+    return fclose(file);
+}
+
+
+/**
+ * @brief Closes all pipes of the compression tools, releases their output buffers and waits
+ *        for the tools to finish. Must be called before the _fcloseall() - the _fcloseall()
+ *        would close the pipes without waiting for the tools.
+ */
+
+void close_compressed_files(void)
+{
+    while (pipes > 0)
+    {
+        pipes--;
+        (void)fclose(pipe_file[pipes].file);
+        release_output_file_buffer(pipe_file[pipes].file);
+        (void)wait_for_tool(pipe_file[pipes].process);
+    }
+}
+
+/*==== End of file ====*/
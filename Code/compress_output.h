@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    compress_output.h
+ * @author  B. Premzel
+ * @brief   Header file for the compressed output files (-compress).
+ ******************************************************************************/
+
+#ifndef _COMPRESS_OUTPUT_H
+#define _COMPRESS_OUTPUT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+
+/***** Function declarations *****/
+bool select_output_compression(const char *tool_name);
+bool is_compressed_file_name(const char *file_name);
+const char *compressed_file_name(const char *file_name);
+FILE *compressed_fopen(const char *file_name, const char *mode);
+int compressed_fclose(FILE *file);
+void close_compressed_files(void);
+
+#endif  // _COMPRESS_OUTPUT_H
+
+/*==== End of file ====*/
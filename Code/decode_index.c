@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    decode_index.c
+ * @author  B. Premzel
+ * @brief   Index file for the seeking in the binary data file (-index=file).
+ *          The message numbers and 64-bit timestamps are known only after the
+ *          sequential processing of the binary data. The index file contains the
+ *          decoding states saved during a previous decoding, so the decoding of a
+ *          message range or time window can start close to the first selected
+ *          message - see decode_index.h for the file format.
+ *          The message and value statistics, MEMO values and time differences
+ *          to the previous messages start at the message from which the decoding
+ *          is resumed.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "main.h"
+#include "format.h"
+#include "errors.h"
+#include "files.h"
+#include "utf8_helpers.h"
+#include "decode_index.h"
+
+#define INDEX_CHECKSUM_SEED     14695981039346656037uLL     // FNV-1a offset basis
+#define INDEX_CHECKSUM_PRIME    1099511628211uLL            // FNV-1a prime
+
+static decode_index_header_t index_header;      // Header of the index file being written or loaded
+static FILE *index_out;                         // Index file being written (NULL - not written)
+static uint32_t next_entry_message = UINT32_MAX; // Message counter value for the next entry of the index file
+static const decode_index_entry_t *resume_entry; // Entry from which the decoding is resumed (NULL - from the start)
+static size_t stop_position;                    // Decoding is finished at this position (0 - at the end of data)
+
+
+/**
+ * @brief Adds data to the FNV-1a checksum.
+ */
+
+static uint64_t add_to_checksum(uint64_t checksum, const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        checksum = (checksum ^ p[i]) * INDEX_CHECKSUM_PRIME;
+    }
+
+    return checksum;
+}
+
+
+/**
+ * @brief Calculates the checksum of the message definitions on which the message framing depends.
+ */
+
+static uint64_t fmt_definitions_checksum(void)
+{
+    uint64_t checksum = INDEX_CHECKSUM_SEED;
+
+    for (uint32_t fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        const msg_data_t *p_fmt = g_fmt[fmt_id];
+
+        if (p_fmt == NULL)
+        {
+            continue;
+        }
+
+        uint32_t definition[4] = { fmt_id, (uint32_t)p_fmt->msg_type, p_fmt->ext_data_mask, p_fmt->msg_len };
+        checksum = add_to_checksum(checksum, definition, sizeof(definition));
+    }
+
+    return checksum;
+}
+
+
+/**
+ * @brief Prepares the header of the index file for the current binary data file and parameters.
+ */
+
+static void prepare_index_header(decode_index_header_t *header)
+{
+    memset(header, 0, sizeof(decode_index_header_t));
+    memcpy(header->magic, DECODE_INDEX_MAGIC, sizeof(header->magic));
+    header->header_size = (uint32_t)sizeof(decode_index_header_t);
+    header->entry_size = (uint32_t)sizeof(decode_index_entry_t);
+    header->interval = DECODE_INDEX_INTERVAL;
+    header->data_file_size = (uint64_t)get_file_size(g_msg.file.rte_data);
+    header->fmt_checksum = fmt_definitions_checksum();
+    header->max_positive_tstamp_diff = g_msg.param.max_positive_tstamp_diff;
+    header->max_negative_tstamp_diff = g_msg.param.max_negative_tstamp_diff;
+    header->rte_header = g_msg.rte_header;
+}
+
+
+/**
+ * @brief Loads the index file and checks if it belongs to the current binary data file.
+ *
+ * @return Index entries or NULL if the index file was not found or is not valid
+ */
+
+static decode_index_entry_t *load_index_file(void)
+{
+    jump_to_start_folder();
+    FILE *file = utf8_fopen(g_msg.param.index_file, "rb");
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    decode_index_header_t header;
+    decode_index_entry_t *entries = NULL;
+    int64_t file_size = get_file_size(file);
+
+    if ((fread(&header, sizeof(header), 1, file) == 1)
+        && (memcmp(&header, &index_header, offsetof(decode_index_header_t, entries)) == 0)
+        && (memcmp(&header.interval, &index_header.interval,
+            sizeof(header) - offsetof(decode_index_header_t, interval)) == 0)
+        && (header.entries > 0)
+        && (file_size == (int64_t)(sizeof(header) + (uint64_t)header.entries * sizeof(decode_index_entry_t))))
+    {
+        entries = (decode_index_entry_t *)malloc(header.entries * sizeof(decode_index_entry_t));
+
+        if ((entries != NULL) && (fread(entries, sizeof(decode_index_entry_t), header.entries, file) != header.entries))
+        {
+            free(entries);
+            entries = NULL;
+        }
+    }
+
+    fclose(file);
+    index_header.entries = (entries != NULL) ? header.entries : 0;
+    return entries;
+}
+
+
+/**
+ * @brief Finds the entry from which the decoding of the selected messages (-range=N1;N2 and
+ *        -window=t1;t2) can start and the position after which no selected messages are expected.
+ *        The time window search assumes increasing timestamps between the entries.
+ *
+ * @param entries  Index entries.
+ */
+
+static void find_resume_entry(const decode_index_entry_t *entries)
+{
+    uint32_t count = index_header.entries;
+    uint32_t start = 0;
+
+    if (g_msg.param.message_range)
+    {
+        for (uint32_t i = 0; (i < count) && (entries[i].message_cnt < g_msg.param.first_message); i++)
+        {
+            start = i;
+        }
+    }
+
+    if (g_msg.param.time_window)
+    {
+        uint32_t window_start = 0;
+
+        for (uint32_t i = 0; (i < count) && (entries[i].timestamp < g_msg.param.window_start); i++)
+        {
+            window_start = i;
+        }
+
+        if (window_start > start)
+        {
+            start = window_start;
+        }
+
+        // Find the first entry after which all the timestamps are after the end of the window
+        uint32_t end = count;
+
+        while ((end > (start + 1u)) && (entries[end - 1u].timestamp > g_msg.param.window_end))
+        {
+            end--;
+        }
+
+        if (end < count)
+        {
+            stop_position = (size_t)entries[end].position;
+        }
+    }
+
+    if (start > 0)
+    {
+        resume_entry = &entries[start];
+    }
+}
+
+
+/**
+ * @brief Loads the index file (-index=file) and prepares the position from which the decoding
+ *        is resumed. If no valid index file is found, it is written during the decoding of
+ *        all messages (without the -select=..., -range=N1;N2 and -window=t1;t2 arguments).
+ *        Must be called after the binary data file header has been loaded and the -ts values
+ *        prepared, but before the data is loaded.
+ */
+
+void prepare_decode_index(void)
+{
+    if (g_msg.param.index_file == NULL)
+    {
+        return;
+    }
+
+    prepare_index_header(&index_header);
+    decode_index_entry_t *entries = load_index_file();
+
+    if (entries != NULL)
+    {
+        if (g_msg.param.message_range || g_msg.param.time_window)
+        {
+            find_resume_entry(entries);
+        }
+
+        return;     // The index entries remain allocated until the end of decoding
+    }
+
+    _set_errno(0);
+
+    if ((g_msg.param.select_names != NULL) || (g_msg.param.query != NULL)
+        || g_msg.param.message_range || g_msg.param.time_window)
+    {
+        return;     // The decoding errors of the skipped messages are not detected - see print_message()
+    }
+
+    jump_to_start_folder();
+    index_out = utf8_fopen(g_msg.param.index_file, "wb");
+
+    if ((index_out == NULL) || (fwrite(&index_header, sizeof(index_header), 1, index_out) != 1))
+    {
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, g_msg.param.index_file);
+
+        if (index_out != NULL)
+        {
+            fclose(index_out);
+            index_out = NULL;
+        }
+
+        return;
+    }
+
+    next_entry_message = 0;
+}
+
+
+/**
+ * @brief Returns the position in the binary data from which the decoding is resumed.
+ *
+ * @return Number of 32b words after the binary data file header (0 - start of data)
+ */
+
+size_t get_decode_index_start(void)
+{
+    return (resume_entry != NULL) ? (size_t)resume_entry->position : 0;
+}
+
+
+/**
+ * @brief Restores the decoding state saved in the index file. Must be called after the
+ *        binary data has been loaded and the statistics reset.
+ */
+
+void resume_decoding_from_index(void)
+{
+    const decode_index_entry_t *entry = resume_entry;
+
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    if (g_msg.complete_file_loaded)
+    {
+        if (entry->position >= g_msg.in_size)
+        {
+            return;
+        }
+
+        g_msg.index = (uint32_t)entry->position;    // Post-mortem and single-shot data loaded completely
+    }
+
+    g_msg.message_cnt = entry->message_cnt;
+    g_msg.multiple_logging = entry->multiple_logging;
+    g_msg.messages_processed_after_restart = entry->messages_after_restart;
+
+    timestamp_t *timestamp = &g_msg.timestamp;
+    timestamp->f = entry->timestamp;
+    timestamp->multiplier = entry->multiplier;
+    timestamp->h = entry->timestamp_h;
+    timestamp->l = entry->timestamp_l;
+    timestamp->old = entry->timestamp_old;
+    timestamp->current_frequency = entry->current_frequency;
+    timestamp->msg_long_tstamp_incremented = entry->msg_long_tstamp_incremented;
+    timestamp->suspicious_timestamp = entry->suspicious_timestamp;
+    timestamp->no_previous_tstamp = entry->no_previous_tstamp != 0;
+    timestamp->long_timestamp_found = entry->long_timestamp_found != 0;
+    timestamp->mark_problematic_tstamps = entry->mark_problematic_tstamps != 0;
+    timestamp->searched_to_index = (entry->searched_to > g_msg.already_processed_data)
+        ? (uint32_t)(entry->searched_to - g_msg.already_processed_data) : 0;
+
+    fprintf(g_msg.file.main_log, get_message_text(MSG_DECODING_RESUMED_FROM_INDEX),
+        entry->message_cnt + 1u, (unsigned long long)entry->position);
+}
+
+
+/**
+ * @brief Writes the current decoding state to the index file.
+ */
+
+static void write_index_entry(void)
+{
+    const timestamp_t *timestamp = &g_msg.timestamp;
+    decode_index_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+
+    entry.position = g_msg.already_processed_data + g_msg.index;
+    entry.searched_to = g_msg.already_processed_data + timestamp->searched_to_index;
+    entry.timestamp = timestamp->f;
+    entry.multiplier = timestamp->multiplier;
+    entry.message_cnt = g_msg.message_cnt;
+    entry.multiple_logging = g_msg.multiple_logging;
+    entry.messages_after_restart = g_msg.messages_processed_after_restart;
+    entry.timestamp_h = timestamp->h;
+    entry.timestamp_l = timestamp->l;
+    entry.timestamp_old = timestamp->old;
+    entry.current_frequency = timestamp->current_frequency;
+    entry.msg_long_tstamp_incremented = timestamp->msg_long_tstamp_incremented;
+    entry.suspicious_timestamp = timestamp->suspicious_timestamp;
+    entry.no_previous_tstamp = timestamp->no_previous_tstamp;
+    entry.long_timestamp_found = timestamp->long_timestamp_found;
+    entry.mark_problematic_tstamps = timestamp->mark_problematic_tstamps;
+
+    if (fwrite(&entry, sizeof(entry), 1, index_out) == 1)
+    {
+        index_header.entries++;
+    }
+}
+
+
+/**
+ * @brief Called before every message is assembled. Saves the decoding state to the
+ *        index file every DECODE_INDEX_INTERVAL messages and checks if the decoding
+ *        of the selected messages (-range=N1;N2, -window=t1;t2) is finished.
+ *
+ * @return true - no more messages to decode
+ */
+
+bool decode_index_checkpoint(void)
+{
+    if (g_msg.message_cnt >= next_entry_message)
+    {
+        write_index_entry();
+        next_entry_message = g_msg.message_cnt + DECODE_INDEX_INTERVAL;
+    }
+
+    if (g_msg.param.message_range && (g_msg.message_cnt >= g_msg.param.last_message))
+    {
+        return true;
+    }
+
+    return (stop_position != 0) && ((g_msg.already_processed_data + g_msg.index) >= stop_position);
+}
+
+
+/**
+ * @brief Writes the number of entries to the header of the index file and closes it.
+ */
+
+void close_decode_index(void)
+{
+    if (index_out == NULL)
+    {
+        return;
+    }
+
+    bool ok = (fseek(index_out, 0, SEEK_SET) == 0)
+        && (fwrite(&index_header, sizeof(index_header), 1, index_out) == 1);
+
+    if ((fclose(index_out) != 0) || !ok)
+    {
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, g_msg.param.index_file);
+    }
+
+    index_out = NULL;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    decode_index.h
+ * @author  B. Premzel
+ * @brief   Index file for the seeking in the binary data file (-index=file).
+ *
+ *          The index file is written during a decoding of all messages in the
+ *          binary data file. Every DECODE_INDEX_INTERVAL messages the position
+ *          of the next message and the state of the timestamp reconstruction
+ *          are saved. A later decoding of the same binary data
+ *          file with the -range=N1;N2 or -window=t1;t2 argument continues from
+ *          the last entry before the first selected message.
+ *
+ *          File structure:
+ *              decode_index_header_t
+ *              decode_index_entry_t [entries]
+ ******************************************************************************/
+
+#ifndef _DECODE_INDEX_H
+#define _DECODE_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rtedbg.h"
+
+#define DECODE_INDEX_MAGIC          "RTEidx1"   // File identification (8 bytes including the '\0')
+
+
+/* @brief Header of the index file. The index is valid only for the same binary data file and decoding parameters. */
+typedef struct
+{
+    char magic[8];                  /*!< DECODE_INDEX_MAGIC */
+    uint32_t header_size;           /*!< Size of this header [bytes] */
+    uint32_t entry_size;            /*!< Size of an entry [bytes] */
+    uint32_t entries;               /*!< Number of entries (0 - index file not finished) */
+    uint32_t interval;              /*!< Number of messages between the entries */
+    uint64_t data_file_size;        /*!< Size of the binary data file [bytes] */
+    uint64_t fmt_checksum;          /*!< Checksum of the message types and lengths - the framing depends on them */
+    int64_t max_positive_tstamp_diff; /*!< Timestamp difference limits (-ts=...) */
+    int64_t max_negative_tstamp_diff;
+    rtedbg_header_t rte_header;     /*!< Header of the binary data file */
+} decode_index_header_t;
+
+
+/* @brief State of the decoding before a message */
+typedef struct
+{
+    uint64_t position;              /*!< Position of the message [32b words from the start of the data] */
+    uint64_t searched_to;           /*!< Position up to which the long timestamp search has been done */
+    double timestamp;               /*!< Timestamp of the previous message [s] */
+    double multiplier;              /*!< Time multiplier for the timestamp - see timestamp_t */
+    uint32_t message_cnt;           /*!< Number of messages before this one */
+    uint32_t multiple_logging;      /*!< Number of separate snapshots found before this message */
+    uint32_t messages_after_restart; /*!< Messages processed after the last reset/restart */
+    uint32_t timestamp_h;           /*!< Timestamp state - see timestamp_t */
+    uint32_t timestamp_l;
+    uint32_t timestamp_old;
+    uint32_t current_frequency;
+    uint32_t msg_long_tstamp_incremented;
+    uint32_t suspicious_timestamp;
+    uint8_t no_previous_tstamp;
+    uint8_t long_timestamp_found;
+    uint8_t mark_problematic_tstamps;
+    uint8_t reserved;
+} decode_index_entry_t;
+
+
+/***** Function declarations *****/
+void prepare_decode_index(void);
+size_t get_decode_index_start(void);
+void resume_decoding_from_index(void);
+bool decode_index_checkpoint(void);
+void close_decode_index(void);
+
+#endif  // _DECODE_INDEX_H
+
+/*==== End of file ====*/
@@ -20,6 +20,8 @@
 #include "statistics.h"
 #include "process_bin_data.h"
 #include "timestamp.h"
+#include "loss_report.h"
+#include "parallel_decode.h"
 
 
 /**
@@ -105,9 +107,11 @@ static void process_streaming_mode_messages(void)
         case SYS_DATA_OVERRUN_DETECTED:
             print_message_type_and_date(MSG_DATA_OVERRUN_DETECTED);
             reset_statistics();
+            report_data_loss(LOSS_OVERRUN);
             break;
 
         case SYS_MULTIPLE_LOGGING:
+            end_of_snapshot_for_parallel_printing();
             print_message_type_and_date(MSG_MULTIPLE_DATA_LOGGING);
             g_msg.multiple_logging++;
             reset_statistics();
@@ -316,13 +320,15 @@ void process_message(uint32_t last_index)
         return;
     }
 
+    const fmt_info_t *info = &g_fmt_info[current_fmt_id];
+
     if (g_msg.param.debug &&
-        (current_fmt_id < g_msg.fmt_ids_defined) && (g_fmt[current_fmt_id] != NULL))
+        (current_fmt_id < g_msg.fmt_ids_defined) && (info->p_fmt != NULL))
     {
         debug_print_message_hex(last_index); // In debug mode, print the hex contents first.
     }
 
-    msg_data_t *p_fmt = g_fmt[current_fmt_id];
+    msg_data_t *p_fmt = info->p_fmt;
 
     if (p_fmt == NULL)
     {
@@ -330,14 +336,14 @@ void process_message(uint32_t last_index)
         return;
     }
 
-    bool message_ok = prepare_msg_and_check_it(p_fmt->msg_type, p_fmt->ext_data_mask);
+    bool message_ok = prepare_msg_and_check_it(info->msg_type, info->ext_data_mask);
 
     // Verify if the message size matches the expected size as specified in the format file.
-    if ((p_fmt->msg_len != 0) && (g_msg.asm_size != p_fmt->msg_len))
+    if ((info->msg_len != 0) && (g_msg.asm_size != info->msg_len))
     {
-        report_problem2(ERR_MSG_SIZE_DOES_NOT_MATCH_DEFINITION, g_msg.asm_size, p_fmt->msg_len);
+        report_problem2(ERR_MSG_SIZE_DOES_NOT_MATCH_DEFINITION, g_msg.asm_size, info->msg_len);
 
-        if (p_fmt->msg_type == TYPE_EXT_MSG)
+        if (info->msg_type == TYPE_EXT_MSG)
         {
             g_msg.asm_words++;      // Also print the extended data.
         }
@@ -358,11 +364,15 @@ void process_message(uint32_t last_index)
     }
     else
     {
+        uint64_t start = profile_start();
         prepare_timestamp_value();
+        profile_stop(PROFILE_TIMESTAMP, start);
 
         if (message_ok)
         {
+            start = profile_start();
             print_message();
+            profile_stop(PROFILE_PRINT_MESSAGE, start);
         }
     }
 }
@@ -19,6 +19,51 @@
 #include "print_message.h"
 #include "print_helper.h"
 #include "utf8_helpers.h"
+#include "compress_output.h"
+#include "server_mode.h"
+
+
+static jmp_buf *fatal_error_return;     // Decoding library: return point of the API function (NULL - exit())
+
+
+/**
+ * @brief Sets the point to which the fatal errors return instead of terminating the application.
+ *        Used by the decoding library - the error must not terminate the host application.
+ *        The return point is reset when a fatal error returns to it.
+ *
+ * @param return_point  Buffer prepared with setjmp(), NULL - the fatal errors terminate the application
+ */
+
+void set_fatal_error_return(jmp_buf *return_point)
+{
+    fatal_error_return = return_point;
+}
+
+
+/**
+ * @brief Returns to the API function of the decoding library if its return point is set.
+ *        The files are not closed - they belong to the library contexts or to the host.
+ *
+ * @param exit_code  Exit code of the error (passed to the longjmp())
+ */
+
+static void return_to_api_after_fatal_error(int exit_code)
+{
+    if (fatal_error_return == NULL)
+    {
+        return;
+    }
+
+    jmp_buf *return_point = fatal_error_return;
+    fatal_error_return = NULL;
+
+    if (g_msg.file.error_log != NULL)
+    {
+        fflush(g_msg.file.error_log);
+    }
+
+    longjmp(*return_point, (exit_code != 0) ? exit_code : (int)EXIT_FATAL_DECODING_ERRORS_DETECTED);
+}
 
 
 /**
@@ -43,7 +88,10 @@ __declspec(noreturn) void report_error_and_exit(const char *error_message, int e
 
     wprintf(L"\n\n");
 
+    return_to_api_after_fatal_error(exit_code);
+    close_compressed_files();
     _fcloseall();
+    finish_server_job_after_fatal_error(exit_code);     // Reply to the client of the decode server
     exit(exit_code);
 }
 
@@ -77,6 +125,7 @@ __declspec(noreturn) void report_error_and_show_instructions(const char *error_m
     utf8_print_string(text, 0);
     snprintf(text, MAX_UTF8_TEXT_LENGTH, RTEMSG_INSTRUCTIONS);
     utf8_print_string(text, 0);
+    return_to_api_after_fatal_error(EXIT_FATAL_ERR_BAD_PARAMETERS);
     exit(EXIT_FATAL_ERR_BAD_PARAMETERS);
 }
 
@@ -149,11 +198,69 @@ __declspec(noreturn) void report_fatal_error_and_exit(uint32_t error_code,
     }
 
     wprintf(L"\n");
+    flush_message_line();       // Text of the message printed when the error was detected
+    return_to_api_after_fatal_error((int)error_code);
+    close_compressed_files();
     _fcloseall();
+    finish_server_job_after_fatal_error((int)error_code);
     exit(error_code);
 }
 
 
+/**
+ * @brief Checks if the limit of errors printed in detail (-errors=K) has been reached
+ *        for an error type.
+ *
+ * @param error_code  Number of the error
+ *
+ * @return true - the next error of this type is only counted
+ */
+
+bool error_report_limit_reached(uint32_t error_code)
+{
+    return (g_msg.param.error_report_limit != 0)
+        && (g_msg.error_counter[error_code] >= g_msg.param.error_report_limit);
+}
+
+
+/**
+ * @brief Records an error in the error summary instead of printing it if the limit of
+ *        errors printed in detail (-errors=K) has been reached for this error type.
+ *        Must be called before the error counter is incremented.
+ *
+ * @param error_code  Number of the error
+ * @param message_no  Number of the message in which the error has been detected
+ * @param fmt_id      Format ID of the message
+ * @param data1       Additional error information (part 1)
+ * @param data2       Additional error information (part 2)
+ *
+ * @return true - the error must not be printed
+ */
+
+bool aggregate_error(uint32_t error_code, uint32_t message_no, uint32_t fmt_id, uint32_t data1, uint32_t data2)
+{
+    if (!error_report_limit_reached(error_code))
+    {
+        return false;
+    }
+
+    error_summary_t *summary = &g_msg.error_summary[error_code];
+
+    if (summary->count == 0)
+    {
+        summary->first_message = message_no;
+        summary->fmt_id = fmt_id;
+        summary->data1 = data1;
+        summary->data2 = data2;
+    }
+
+    summary->count++;
+    summary->last_message = message_no;
+    g_msg.errors_not_shown++;
+    return true;
+}
+
+
 /**
  * @brief Worker function for the report_problem_with_string()
  *        Prints the information to the specified output file.
@@ -200,14 +307,17 @@ void report_problem_with_string(uint32_t error_code, const char *name)
         error_code = ERR_DECODE_UNKNOWN_ERROR;
     }
 
-    if (g_msg.file.error_log != NULL)
+    if (!aggregate_error(error_code, g_msg.message_cnt, g_msg.fmt_id, 0, 0))
     {
-        report_problem_with_string_worker(g_msg.file.error_log, error_code, name);
-    }
+        if (g_msg.file.error_log != NULL)
+        {
+            report_problem_with_string_worker(g_msg.file.error_log, error_code, name);
+        }
 
-    if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
-    {
-        report_problem_with_string_worker(g_msg.file.main_log, error_code, name);
+        if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
+        {
+            report_problem_with_string_worker(g_msg.file.main_log, error_code, name);
+        }
     }
 
     g_msg.total_errors++;
@@ -264,14 +374,17 @@ void report_problem2(uint32_t error_code, uint32_t additional_data, uint32_t add
         error_code = ERR_DECODE_UNKNOWN_ERROR;
     }
 
-    if (g_msg.file.error_log != NULL)
+    if (!aggregate_error(error_code, g_msg.message_cnt, g_msg.fmt_id, additional_data, additional_data2))
     {
-        report_problem2_worker(g_msg.file.error_log, error_code, additional_data, additional_data2);
-    }
+        if (g_msg.file.error_log != NULL)
+        {
+            report_problem2_worker(g_msg.file.error_log, error_code, additional_data, additional_data2);
+        }
 
-    if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
-    {
-        report_problem2_worker(g_msg.file.main_log, error_code, additional_data, additional_data2);
+        if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
+        {
+            report_problem2_worker(g_msg.file.main_log, error_code, additional_data, additional_data2);
+        }
     }
 
     g_msg.total_errors++;
@@ -342,14 +455,17 @@ void report_problem(uint32_t error_code, int additional_data)
         error_code = FATAL_LAST;        // Unknown error
     }
 
-    if (g_msg.file.error_log != NULL)
+    if (!aggregate_error(error_code, g_msg.message_cnt, g_msg.fmt_id, (uint32_t)additional_data, 0))
     {
-        report_problem_worker(g_msg.file.error_log, error_code, additional_data);
-    }
+        if (g_msg.file.error_log != NULL)
+        {
+            report_problem_worker(g_msg.file.error_log, error_code, additional_data);
+        }
 
-    if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
-    {
-        report_problem_worker(g_msg.file.main_log, error_code, additional_data);
+        if ((g_msg.file.main_log != NULL) && (g_msg.file.main_log != g_msg.file.error_log))
+        {
+            report_problem_worker(g_msg.file.main_log, error_code, additional_data);
+        }
     }
 
     g_msg.total_errors++;
@@ -358,6 +474,34 @@ void report_problem(uint32_t error_code, int additional_data)
 }
 
 
+/**
+ * @brief Prints the summary of errors not printed in detail (-errors=K) to the error log file.
+ */
+
+static void print_errors_not_shown(void)
+{
+    if (g_msg.errors_not_shown == 0)
+    {
+        return;
+    }
+
+    fprintf(g_msg.file.error_log, get_message_text(MSG_ERRORS_NOT_SHOWN_SUMMARY),
+        g_msg.param.error_report_limit);
+
+    for (uint32_t i = FIRST_FATAL_ERROR; i < TOTAL_ERRORS; i++)
+    {
+        const error_summary_t *summary = &g_msg.error_summary[i];
+
+        if (summary->count > 0)
+        {
+            fprintf(g_msg.file.error_log, get_message_text(MSG_ERRORS_NOT_SHOWN),
+                summary->count, i, summary->first_message, summary->last_message,
+                summary->fmt_id, summary->data1, summary->data2);
+        }
+    }
+}
+
+
 /**
  * @brief Write error and warning counters to the main and error log files.
  *        Provides a summary of errors and warnings detected.
@@ -377,6 +521,12 @@ void report_decode_error_summary(void)
         fprintf(g_msg.file.main_log, get_message_text(MSG_TOTAL_ERRORS), g_msg.total_errors);
     }
 
+    if (g_msg.errors_not_shown > 0)
+    {
+        fprintf(g_msg.file.main_log, get_message_text(MSG_ERRORS_NOT_SHOWN_TOTAL),
+            g_msg.errors_not_shown, g_msg.param.error_report_limit);
+    }
+
     if (g_msg.total_errors > 0)
     {
         fprintf(g_msg.file.error_log, "%s", get_message_text(MSG_ERROR_SUMMARY));
@@ -394,6 +544,8 @@ void report_decode_error_summary(void)
                     get_message_text(i));
             }
         }
+
+        print_errors_not_shown();
     }
 
     if (g_msg.total_errors != 0)
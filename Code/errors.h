@@ -14,6 +14,7 @@
 #ifndef _ERRORS_H
 #define _ERRORS_H
 
+#include <setjmp.h>
 #include "main.h"
 
 // Exit codes for various error scenarios
@@ -68,6 +69,9 @@ __declspec(noreturn) void report_error_and_exit(const char *error_message, int e
 __declspec(noreturn) void report_error_and_show_instructions(const char *error_message,
     const char *msg_extension);
 void report_decode_error_summary(void);
+bool error_report_limit_reached(uint32_t error_code);
+bool aggregate_error(uint32_t error_code, uint32_t message_no, uint32_t fmt_id, uint32_t data1, uint32_t data2);
+void set_fatal_error_return(jmp_buf *return_point);
 
 #endif  // _ERRORS_H
 
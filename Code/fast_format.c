@@ -0,0 +1,1038 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    fast_format.c
+ * @author  B. Premzel
+ * @brief   Printing of integer and floating point values without the fprintf().
+ *          The format specification is parsed once during the format definition
+ *          parsing. The values are then formatted directly into a buffer.
+ *          The results are identical to the fprintf() results. The fprintf() is
+ *          still used for the format specifications and values which are not
+ *          supported here (e.g. "%c", "%a", "%lld" for doubles, inf, nan, very
+ *          large or very small floating point values).
+ *
+ *          The floating point values are converted exactly - the integer part
+ *          is converted as a 64-bit integer and the fractional part (n / 2^k) is
+ *          converted digit by digit with a 128-bit fixed point number. The last
+ *          printed digit is rounded to the nearest value (ties to even) as with
+ *          the standard library functions. The "%f" values with up to nine
+ *          decimals (e.g. the timestamps printed with the -T=8.6f) are converted
+ *          as a scaled 64-bit integer if the rounding of the last digit is not
+ *          in doubt.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <string.h>
+#include <math.h>
+#include <locale.h>
+#include "fast_format.h"
+#include "print_helper.h"
+
+#define FAST_FORMAT_MAX_WIDTH       100     // Longer fields are printed with the fprintf()
+#define FAST_FORMAT_MAX_PRECISION   40      // Higher precisions are printed with the fprintf()
+#define FAST_FORMAT_MAX_FRACTION    124     // Max. number of fraction bits (fixed point number)
+#define FAST_FORMAT_LINE_SIZE       512u    // Buffer size for prefix + value + suffix
+#define FAST_FORMAT_FIXED_DECIMALS  9       // Max. precision of the "%f" fixed point conversion
+
+/*@brief Source of decimal digits for the floating point value conversion */
+typedef struct
+{
+    char int_digits[24];                    // Decimal digits of the integer part
+    unsigned int_len;                       // Number of integer part digits (0 if integer part = 0)
+    unsigned int_pos;                       // Index of the next integer digit
+    uint64_t hi;                            // Fractional part = (hi:lo) / 2^k
+    uint64_t lo;
+    unsigned k;
+} digit_source_t;
+
+static char decimal_point = '.';            // Decimal point of the current locale
+static bool double_formatting = true;       // false - locale with a multi-byte decimal point
+
+
+/**
+ * @brief Parses the printf() format specification and prepares the data for the printing
+ *        without the fprintf().
+ *
+ * @param fmt_string  Formatting string for a single value (text, specification, text).
+ *
+ * @return Pointer to the prepared data or NULL if the specification is not supported.
+ */
+
+fast_format_t *prepare_fast_format(const char *fmt_string)
+{
+    fast_format_t ff;
+    memset(&ff, 0, sizeof(ff));
+    const char *p = fmt_string;
+
+    // Find the value specification - skip the "%%"
+    size_t prefix_len = 0;
+
+    for ( ; ; p++)
+    {
+        if (*p == '\0')
+        {
+            return NULL;
+        }
+
+        if (*p == '%')
+        {
+            if (p[1] != '%')
+            {
+                break;
+            }
+
+            p++;
+        }
+
+        prefix_len++;
+    }
+
+    const char *spec = p;
+    p++;
+
+    for (bool flag = true; flag; )
+    {
+        switch (*p)
+        {
+            case '-': ff.left_align = true; p++; break;
+            case '+': ff.plus_sign = true;  p++; break;
+            case ' ': ff.space_sign = true; p++; break;
+            case '#': ff.alternate = true;  p++; break;
+            case '0': ff.zero_pad = true;   p++; break;
+            default:  flag = false;         break;
+        }
+    }
+
+    while ((*p >= '0') && (*p <= '9'))
+    {
+        ff.width = ff.width * 10 + (*p++ - '0');
+
+        if (ff.width > FAST_FORMAT_MAX_WIDTH)
+        {
+            return NULL;
+        }
+    }
+
+    ff.precision = -1;
+
+    if (*p == '.')
+    {
+        p++;
+        ff.precision = 0;
+
+        while ((*p >= '0') && (*p <= '9'))
+        {
+            ff.precision = ff.precision * 10 + (*p++ - '0');
+
+            if (ff.precision > FAST_FORMAT_MAX_PRECISION)
+            {
+                return NULL;
+            }
+        }
+    }
+
+    ff.int_size = (uint8_t)sizeof(int);
+    int modifiers = 0;          // Number of the 'h' or 'l' length modifier characters
+
+    if ((*p == 'h') || (*p == 'l'))
+    {
+        char modifier = *p;
+
+        while ((*p == modifier) && (modifiers < 2))
+        {
+            p++;
+            modifiers++;
+        }
+
+        if (modifier == 'h')
+        {
+            ff.int_size = (uint8_t)((modifiers == 1) ? sizeof(short) : sizeof(char));
+        }
+        else
+        {
+            ff.int_size = (uint8_t)((modifiers == 1) ? sizeof(long) : sizeof(long long));
+
+            if (modifiers == 1)
+            {
+                modifiers = 0;  // "%lf" is equal to "%f"
+            }
+        }
+    }
+
+    ff.conversion = *p++;
+
+    if ((ff.conversion == '\0') || (strchr("diouxXfFeEgG", ff.conversion) == NULL))
+    {
+        return NULL;
+    }
+
+    if ((modifiers != 0) && (strchr("fFeEgG", ff.conversion) != NULL))
+    {
+        return NULL;
+    }
+
+    // The "%#g" results differ between the standard libraries when the rounding changes
+    // the exponent (e.g. "1.e+03" instead of "1.00e+03" for 999.9999 with "%#.3g")
+    if (ff.alternate && ((ff.conversion == 'g') || (ff.conversion == 'G')))
+    {
+        return NULL;
+    }
+
+    if (strchr(p, '%') != NULL)
+    {
+        return NULL;            // Just a precaution - the suffix never contains a '%'
+    }
+
+    // Prepare the text before the value ("%%" => '%')
+    char *prefix = allocate_parse_memory(prefix_len + 1u, "fastPrefix");
+    ff.prefix = prefix;
+    ff.prefix_len = (uint32_t)prefix_len;
+
+    for (const char *t = fmt_string; t < spec; t++)
+    {
+        *prefix++ = *t;
+
+        if (*t == '%')
+        {
+            t++;
+        }
+    }
+
+    ff.suffix = p;
+    ff.suffix_len = (uint32_t)strlen(p);
+
+    fast_format_t *p_ff = allocate_parse_memory(sizeof(fast_format_t), "fastFmt");
+    *p_ff = ff;
+    return p_ff;
+}
+
+
+/**
+ * @brief Prepares the plain text (format string without a value specification) for the
+ *        printing without the fprintf(). The "%%" is replaced with '%' in the prefix, which
+ *        is then copied to the output as it is.
+ *
+ * @param fmt_string  Plain text formatting string.
+ *
+ * @return Pointer to the prepared data or NULL if the text contains a value specification.
+ */
+
+fast_format_t *prepare_plain_text_format(const char *fmt_string)
+{
+    fast_format_t ff;
+    memset(&ff, 0, sizeof(ff));
+    size_t length = strlen(fmt_string);
+    char *prefix = allocate_parse_memory(length + 1u, "fastPrefix");
+    ff.prefix = prefix;
+
+    for (const char *t = fmt_string; *t != '\0'; t++)
+    {
+        if (*t == '%')
+        {
+            if (t[1] != '%')
+            {
+                return NULL;
+            }
+
+            t++;
+        }
+
+        *prefix++ = *t;
+    }
+
+    ff.prefix_len = (uint32_t)(prefix - ff.prefix);
+    ff.suffix = fmt_string + length;    // Empty suffix in the format string (see put_fast_format())
+
+    fast_format_t *p_ff = allocate_parse_memory(sizeof(fast_format_t), "fastFmt");
+    *p_ff = ff;
+    return p_ff;
+}
+
+
+/**
+ * @brief Reads the decimal point of the message printing locale.
+ *        Must be called after the locale has been set and before the printing starts.
+ */
+
+void init_fast_formatting(void)
+{
+    struct lconv *lc = localeconv();
+    double_formatting = false;
+
+    if ((lc != NULL) && (lc->decimal_point != NULL)
+        && (lc->decimal_point[0] != '\0') && (lc->decimal_point[1] == '\0'))
+    {
+        decimal_point = lc->decimal_point[0];
+        double_formatting = true;
+    }
+}
+
+
+/**
+ * @brief Formats an integer value according to the prepared format specification.
+ *        The value is converted to the argument type first (as the fprintf() does
+ *        for the value passed as a 64-bit argument).
+ *
+ * @param buffer  Buffer for the formatted value (FAST_FORMAT_BUFFER_SIZE bytes).
+ * @param ff      Pointer to the prepared format specification.
+ * @param value   Value to be formatted.
+ *
+ * @return Length of the formatted value.
+ */
+
+size_t fast_format_integer(char *buffer, const fast_format_t *ff, uint64_t value)
+{
+    char sign = '\0';
+    unsigned base = 10u;
+    const char *digit_chars = "0123456789abcdef";
+
+    if ((ff->conversion == 'd') || (ff->conversion == 'i'))
+    {
+        int64_t signed_value;
+
+        switch (ff->int_size)
+        {
+            case 1:  signed_value = (signed char)value; break;
+            case 2:  signed_value = (int16_t)value;     break;
+            case 4:  signed_value = (int32_t)value;     break;
+            default: signed_value = (int64_t)value;     break;
+        }
+
+        value = (uint64_t)signed_value;
+
+        if (signed_value < 0)
+        {
+            sign = '-';
+            value = 0u - value;
+        }
+        else if (ff->plus_sign)
+        {
+            sign = '+';
+        }
+        else if (ff->space_sign)
+        {
+            sign = ' ';
+        }
+    }
+    else
+    {
+        if (ff->int_size < 8u)
+        {
+            value &= (1uLL << (ff->int_size * 8u)) - 1u;
+        }
+
+        if (ff->conversion == 'o')
+        {
+            base = 8u;
+        }
+        else if (ff->conversion != 'u')
+        {
+            base = 16u;
+
+            if (ff->conversion == 'X')
+            {
+                digit_chars = "0123456789ABCDEF";
+            }
+        }
+    }
+
+    char digits[24];
+    int n = 0;
+
+    for (uint64_t v = value; v != 0; v /= base)
+    {
+        digits[n++] = digit_chars[v % base];
+    }
+
+    int zeros = ((ff->precision < 0) ? 1 : ff->precision) - n;
+
+    if (zeros < 0)
+    {
+        zeros = 0;
+    }
+
+    if (ff->alternate && (base == 8u) && (zeros == 0))
+    {
+        zeros = 1;          // The octal number must start with a '0'
+    }
+
+    int prefix_len = (ff->alternate && (base == 16u) && (value != 0)) ? 2 : 0;
+    int length = (sign != '\0') + prefix_len + zeros + n;
+    int pad = ff->width - length;
+
+    if (pad < 0)
+    {
+        pad = 0;
+    }
+
+    bool zero_padding = ff->zero_pad && !ff->left_align && (ff->precision < 0);
+    char *p = buffer;
+
+    if (!ff->left_align && !zero_padding)
+    {
+        memset(p, ' ', (size_t)pad);
+        p += pad;
+    }
+
+    if (sign != '\0')
+    {
+        *p++ = sign;
+    }
+
+    if (prefix_len != 0)
+    {
+        *p++ = '0';
+        *p++ = ff->conversion;
+    }
+
+    if (zero_padding)
+    {
+        zeros += pad;
+    }
+
+    memset(p, '0', (size_t)zeros);
+    p += zeros;
+
+    while (n > 0)
+    {
+        *p++ = digits[--n];
+    }
+
+    if (ff->left_align)
+    {
+        memset(p, ' ', (size_t)pad);
+        p += pad;
+    }
+
+    return (size_t)(p - buffer);
+}
+
+
+/**
+ * @brief Prepares the digit source for the conversion of a floating point value.
+ *
+ * @param ds     Pointer to the digit source.
+ * @param value  Absolute value to be converted.
+ *
+ * @return false if the value is too large or has too many fraction bits.
+ */
+
+static bool init_digit_source(digit_source_t *ds, double value)
+{
+    if (!(value < 18446744073709551616.0))      // 2^64
+    {
+        return false;
+    }
+
+    uint64_t int_part = (uint64_t)value;
+    double fraction = value - (double)int_part;        // Exact
+    ds->int_len = 0;
+    ds->int_pos = 0;
+    ds->hi = 0;
+    ds->lo = 0;
+    ds->k = 0;
+
+    for (uint64_t v = int_part; v != 0; v /= 10u)
+    {
+        ds->int_len++;
+    }
+
+    for (unsigned i = ds->int_len; i > 0; i--)
+    {
+        ds->int_digits[i - 1u] = (char)('0' + int_part % 10u);
+        int_part /= 10u;
+    }
+
+    if (fraction != 0)
+    {
+        int exponent;
+        uint64_t mantissa = (uint64_t)ldexp(frexp(fraction, &exponent), 53);
+        int k = 53 - exponent;
+
+        while ((mantissa & 1u) == 0)
+        {
+            mantissa >>= 1u;
+            k--;
+        }
+
+        if (k > FAST_FORMAT_MAX_FRACTION)
+        {
+            return false;
+        }
+
+        ds->lo = mantissa;
+        ds->k = (unsigned)k;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Returns the next decimal digit of the value.
+ *
+ * @param ds  Pointer to the digit source.
+ *
+ * @return Decimal digit character.
+ */
+
+static char next_digit(digit_source_t *ds)
+{
+    if (ds->int_pos < ds->int_len)
+    {
+        return ds->int_digits[ds->int_pos++];
+    }
+
+    if ((ds->hi | ds->lo) == 0)
+    {
+        return '0';
+    }
+
+    // fraction * 10 = fraction * 8 + fraction * 2
+    uint64_t hi2 = (ds->hi << 1u) | (ds->lo >> 63u);
+    uint64_t lo2 = ds->lo << 1u;
+    uint64_t hi8 = (ds->hi << 3u) | (ds->lo >> 61u);
+    uint64_t lo8 = ds->lo << 3u;
+    uint64_t lo = lo2 + lo8;
+    uint64_t hi = hi2 + hi8 + (lo < lo2);
+    unsigned digit;
+    unsigned k = ds->k;
+
+    if (k >= 64u)
+    {
+        unsigned shift = k - 64u;
+        digit = (unsigned)(hi >> shift);
+        hi = (shift == 0) ? 0 : (hi & ((1uLL << shift) - 1u));
+    }
+    else
+    {
+        digit = (unsigned)((hi << (64u - k)) | (lo >> k));
+        hi = 0;
+        lo &= (1uLL << k) - 1u;
+    }
+
+    ds->hi = hi;
+    ds->lo = lo;
+    return (char)('0' + digit);
+}
+
+
+/**
+ * @brief Checks if any of the remaining digits is not zero.
+ *
+ * @param ds  Pointer to the digit source.
+ *
+ * @return true if the remaining part of the value is not zero.
+ */
+
+static bool remaining_digits_not_zero(const digit_source_t *ds)
+{
+    for (unsigned i = ds->int_pos; i < ds->int_len; i++)
+    {
+        if (ds->int_digits[i] != '0')
+        {
+            return true;
+        }
+    }
+
+    return (ds->hi | ds->lo) != 0;
+}
+
+
+/**
+ * @brief Rounds the digits to the nearest value (ties to even) using the remaining
+ *        digits of the digit source.
+ *
+ * @param digits  Digits to be rounded.
+ * @param len     Number of digits.
+ * @param ds      Pointer to the digit source.
+ *
+ * @return true if the rounding carry propagated beyond the first digit (all digits are '0').
+ */
+
+static bool round_digits(char *digits, int len, digit_source_t *ds)
+{
+    char next = next_digit(ds);
+    bool round_up = next > '5';
+
+    if (next == '5')
+    {
+        round_up = remaining_digits_not_zero(ds)
+            || ((len > 0) && (((digits[len - 1] - '0') & 1) != 0));
+    }
+
+    if (!round_up)
+    {
+        return false;
+    }
+
+    for (int i = len - 1; i >= 0; i--)
+    {
+        if (digits[i] != '9')
+        {
+            digits[i]++;
+            return false;
+        }
+
+        digits[i] = '0';
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Formats the value with the "%f" style using integer arithmetic. The value is
+ *        multiplied by 10^precision and rounded to an integer. The result is used only if
+ *        the value is not (almost) halfway between two integers - the error of the
+ *        multiplication could change the rounding and the ties must be rounded to even
+ *        according to the exact value (see round_digits()).
+ *
+ * @param buffer     Buffer for the formatted number.
+ * @param value      Absolute value to be formatted.
+ * @param precision  Number of digits after the decimal point.
+ * @param alternate  Always print the decimal point.
+ *
+ * @return Length of the formatted number (0 = the exact conversion must be used).
+ */
+
+static size_t format_f_style_fixed_point(char *buffer, double value, int precision, bool alternate)
+{
+    static const double power_of_10[FAST_FORMAT_FIXED_DECIMALS + 1] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+    };
+
+    if (precision > FAST_FORMAT_FIXED_DECIMALS)
+    {
+        return 0;
+    }
+
+    double scaled = value * power_of_10[precision];
+
+    if (!(scaled < 9007199254740992.0))         // 2^53 - the integer part must be exact
+    {
+        return 0;
+    }
+
+    double int_part = floor(scaled);
+    double fraction = scaled - int_part;        // Exact
+
+    // The rounding error of the multiplication is below 1 ulp (2^-52 * scaled)
+    if (fabs(fraction - 0.5) <= (scaled * 4.5e-16))
+    {
+        return 0;
+    }
+
+    uint64_t number = (uint64_t)int_part + (fraction > 0.5);
+    uint64_t divisor = (uint64_t)power_of_10[precision];
+    uint64_t integer = number / divisor;
+    uint64_t decimals = number - (integer * divisor);
+    char digits[24];
+    unsigned n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + integer % 10u);
+        integer /= 10u;
+    } while (integer != 0);
+
+    char *p = buffer;
+
+    while (n > 0)
+    {
+        *p++ = digits[--n];
+    }
+
+    if ((precision > 0) || alternate)
+    {
+        *p++ = decimal_point;
+    }
+
+    for (int i = precision - 1; i >= 0; i--)
+    {
+        p[i] = (char)('0' + decimals % 10u);
+        decimals /= 10u;
+    }
+
+    p += precision;
+    return (size_t)(p - buffer);
+}
+
+
+/**
+ * @brief Formats the value with the "%f" style.
+ *
+ * @param buffer     Buffer for the formatted number.
+ * @param value      Absolute value to be formatted.
+ * @param precision  Number of digits after the decimal point.
+ * @param alternate  Always print the decimal point.
+ *
+ * @return Length of the formatted number (0 = not supported).
+ */
+
+static size_t format_f_style(char *buffer, double value, int precision, bool alternate)
+{
+    size_t len = format_f_style_fixed_point(buffer, value, precision, alternate);
+
+    if (len != 0)
+    {
+        return len;
+    }
+
+    digit_source_t ds;
+
+    if (!init_digit_source(&ds, value))
+    {
+        return 0;
+    }
+
+    char digits[72];
+    int int_len = (int)ds.int_len;
+    int total = int_len + precision;
+
+    for (int i = 0; i < total; i++)
+    {
+        digits[i] = next_digit(&ds);
+    }
+
+    char *p = buffer;
+
+    if (round_digits(digits, total, &ds))
+    {
+        *p++ = '1';
+    }
+    else if (int_len == 0)
+    {
+        *p++ = '0';
+    }
+
+    memcpy(p, digits, (size_t)int_len);
+    p += int_len;
+
+    if ((precision > 0) || alternate)
+    {
+        *p++ = decimal_point;
+    }
+
+    memcpy(p, digits + int_len, (size_t)precision);
+    p += precision;
+    return (size_t)(p - buffer);
+}
+
+
+/**
+ * @brief Prepares the significant digits and decimal exponent for the "%e" style.
+ *
+ * @param digits       Buffer for the significant digits.
+ * @param value        Absolute value to be formatted.
+ * @param significant  Number of significant digits.
+ * @param exponent     Pointer to the decimal exponent.
+ *
+ * @return false if the value is not supported.
+ */
+
+static bool get_significant_digits(char *digits, double value, int significant, int *exponent)
+{
+    if (value == 0)
+    {
+        memset(digits, '0', (size_t)significant);
+        *exponent = 0;
+        return true;
+    }
+
+    digit_source_t ds;
+
+    if (!init_digit_source(&ds, value))
+    {
+        return false;
+    }
+
+    int i = 0;
+
+    if (ds.int_len > 0)
+    {
+        *exponent = (int)ds.int_len - 1;
+    }
+    else
+    {
+        int leading_zeros = 0;
+        char c;
+
+        while ((c = next_digit(&ds)) == '0')
+        {
+            leading_zeros++;
+        }
+
+        *exponent = -(leading_zeros + 1);
+        digits[i++] = c;
+    }
+
+    for ( ; i < significant; i++)
+    {
+        digits[i] = next_digit(&ds);
+    }
+
+    if (round_digits(digits, significant, &ds))
+    {
+        digits[0] = '1';
+        (*exponent)++;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Formats the significant digits and exponent with the "%e" style.
+ *
+ * @param buffer     Buffer for the formatted number.
+ * @param digits     Significant digits (precision + 1).
+ * @param precision  Number of digits after the decimal point.
+ * @param exponent   Decimal exponent.
+ * @param alternate  Always print the decimal point.
+ * @param upper      Upper case exponent character.
+ *
+ * @return Length of the formatted number.
+ */
+
+static size_t format_e_style(char *buffer, const char *digits, int precision, int exponent,
+    bool alternate, bool upper)
+{
+    char *p = buffer;
+    *p++ = digits[0];
+
+    if ((precision > 0) || alternate)
+    {
+        *p++ = decimal_point;
+    }
+
+    memcpy(p, digits + 1, (size_t)precision);
+    p += precision;
+    *p++ = upper ? 'E' : 'e';
+    *p++ = (exponent < 0) ? '-' : '+';
+
+    if (exponent < 0)
+    {
+        exponent = -exponent;
+    }
+
+    if (exponent >= 100)
+    {
+        *p++ = (char)('0' + exponent / 100);
+    }
+
+    *p++ = (char)('0' + (exponent / 10) % 10);
+    *p++ = (char)('0' + exponent % 10);
+    return (size_t)(p - buffer);
+}
+
+
+/**
+ * @brief Removes the trailing zeros of the fraction (and the decimal point if no
+ *        fraction digits remain) for the "%g" style.
+ *
+ * @param buffer  Formatted number.
+ * @param len     Length of the formatted number.
+ *
+ * @return New length of the formatted number.
+ */
+
+static size_t remove_trailing_zeros(char *buffer, size_t len)
+{
+    char *dp = memchr(buffer, decimal_point, len);
+
+    if (dp == NULL)
+    {
+        return len;
+    }
+
+    char *end = buffer + len;
+    char *exp = dp;
+
+    while ((exp < end) && (*exp != 'e') && (*exp != 'E'))
+    {
+        exp++;
+    }
+
+    char *last = exp;
+
+    while (last[-1] == '0')
+    {
+        last--;
+    }
+
+    if (last - 1 == dp)
+    {
+        last--;
+    }
+
+    size_t exp_len = (size_t)(end - exp);
+    memmove(last, exp, exp_len);
+    return (size_t)(last - buffer) + exp_len;
+}
+
+
+/**
+ * @brief Formats a floating point value according to the prepared format specification.
+ *
+ * @param buffer  Buffer for the formatted value (FAST_FORMAT_BUFFER_SIZE bytes).
+ * @param ff      Pointer to the prepared format specification.
+ * @param value   Value to be formatted.
+ *
+ * @return Length of the formatted value (0 = not supported - use the fprintf()).
+ */
+
+size_t fast_format_double(char *buffer, const fast_format_t *ff, double value)
+{
+    if (!double_formatting || !isfinite(value))
+    {
+        return 0;
+    }
+
+    char sign = '\0';
+
+    if (signbit(value))
+    {
+        sign = '-';
+        value = -value;
+    }
+    else if (ff->plus_sign)
+    {
+        sign = '+';
+    }
+    else if (ff->space_sign)
+    {
+        sign = ' ';
+    }
+
+    char number[FAST_FORMAT_BUFFER_SIZE];
+    char digits[FAST_FORMAT_MAX_PRECISION + 2];
+    int precision = (ff->precision < 0) ? 6 : ff->precision;
+    int exponent;
+    size_t len;
+
+    switch (ff->conversion)
+    {
+        case 'f':
+        case 'F':
+            len = format_f_style(number, value, precision, ff->alternate);
+            break;
+
+        case 'e':
+        case 'E':
+            if (!get_significant_digits(digits, value, precision + 1, &exponent))
+            {
+                return 0;
+            }
+
+            len = format_e_style(number, digits, precision, exponent, ff->alternate,
+                ff->conversion == 'E');
+            break;
+
+        default:    // 'g', 'G'
+            if (precision == 0)
+            {
+                precision = 1;
+            }
+
+            if (!get_significant_digits(digits, value, precision, &exponent))
+            {
+                return 0;
+            }
+
+            if ((exponent < precision) && (exponent >= -4))
+            {
+                len = format_f_style(number, value, precision - 1 - exponent, ff->alternate);
+            }
+            else
+            {
+                len = format_e_style(number, digits, precision - 1, exponent, ff->alternate,
+                    ff->conversion == 'G');
+            }
+
+            if ((len != 0) && !ff->alternate)
+            {
+                len = remove_trailing_zeros(number, len);
+            }
+            break;
+    }
+
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    int pad = ff->width - (int)len - (sign != '\0');
+
+    if (pad < 0)
+    {
+        pad = 0;
+    }
+
+    char *p = buffer;
+
+    if (!ff->left_align && !ff->zero_pad)
+    {
+        memset(p, ' ', (size_t)pad);
+        p += pad;
+    }
+
+    if (sign != '\0')
+    {
+        *p++ = sign;
+    }
+
+    if (!ff->left_align && ff->zero_pad)
+    {
+        memset(p, '0', (size_t)pad);
+        p += pad;
+    }
+
+    memcpy(p, number, len);
+    p += len;
+
+    if (ff->left_align)
+    {
+        memset(p, ' ', (size_t)pad);
+        p += pad;
+    }
+
+    return (size_t)(p - buffer);
+}
+
+
+/**
+ * @brief Writes the formatted value together with the text before and after it.
+ *
+ * @param out   Pointer to the output file.
+ * @param ff    Pointer to the prepared format specification.
+ * @param text  Formatted value.
+ * @param len   Length of the formatted value.
+ */
+
+void write_fast_formatted_value(FILE *out, const fast_format_t *ff, const char *text, size_t len)
+{
+    size_t total = ff->prefix_len + len + ff->suffix_len;
+
+    if (total <= FAST_FORMAT_LINE_SIZE)
+    {
+        char line[FAST_FORMAT_LINE_SIZE];
+        memcpy(line, ff->prefix, ff->prefix_len);
+        memcpy(line + ff->prefix_len, text, len);
+        memcpy(line + ff->prefix_len + len, ff->suffix, ff->suffix_len);
+        msg_write(out, line, total);
+    }
+    else
+    {
+        msg_write(out, ff->prefix, ff->prefix_len);
+        msg_write(out, text, len);
+        msg_write(out, ff->suffix, ff->suffix_len);
+    }
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    fast_format.h
+ * @author  B. Premzel
+ * @brief   Header file for the printing of integer and floating point values
+ *          without the fprintf().
+ ******************************************************************************/
+
+#ifndef _FAST_FORMAT_H
+#define _FAST_FORMAT_H
+
+#include "main.h"
+#include "format.h"
+
+#define FAST_FORMAT_BUFFER_SIZE     256u    // Buffer size for a single formatted value
+
+fast_format_t *prepare_fast_format(const char *fmt_string);
+fast_format_t *prepare_plain_text_format(const char *fmt_string);
+void init_fast_formatting(void);
+size_t fast_format_integer(char *buffer, const fast_format_t *ff, uint64_t value);
+size_t fast_format_double(char *buffer, const fast_format_t *ff, double value);
+void write_fast_formatted_value(FILE *out, const fast_format_t *ff, const char *text, size_t len);
+
+#endif // _FAST_FORMAT_H
+
+/*==== End of file ====*/
@@ -17,6 +17,25 @@
 #include "files.h"
 #include "decoder.h"
 #include "utf8_helpers.h"
+#include "rate_stats.h"
+#include "compress_output.h"
+#ifdef _WIN32
+#include <io.h>             // _get_osfhandle()
+#else
+#include <sys/mman.h>
+#endif
+
+
+/* @brief Output buffer assigned to a file (see set_output_file_buffer()).
+ *         The buffer follows the structure in the same allocation. */
+typedef struct _output_buffer_t
+{
+    FILE *file;                         /*!< File which uses the buffer */
+    size_t size;                        /*!< Size of the buffer in bytes */
+    struct _output_buffer_t *next;      /*!< Next buffer in the list */
+} output_buffer_t;
+
+static output_buffer_t *output_buffers;    // Buffers of the output files which have not been closed yet
 
 
 /**
@@ -35,6 +54,80 @@ int64_t get_file_size(FILE *fp)
 }
 
 
+/**
+ * @brief Map the complete file into memory for read-only access.
+ *        The mapping remains valid after the file has been closed. Pages are shared
+ *        with other processes that map the same file (i.e. several RTEmsg instances).
+ *
+ * @param  fp    Pointer to the opened file
+ * @param  size  File size [bytes]
+ *
+ * @return Pointer to the start of the mapped file or NULL if the file could not be mapped
+ */
+
+void *map_file_to_memory(FILE *fp, int64_t size)
+{
+    if ((fp == NULL) || (size <= 0) || ((uint64_t)size > (uint64_t)SIZE_MAX))
+    {
+        return NULL;
+    }
+
+#ifdef _WIN32
+    HANDLE file_handle = (HANDLE)_get_osfhandle(_fileno(fp));
+
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mapping == NULL)
+    {
+        return NULL;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+    CloseHandle(mapping);       // The view keeps a reference to the mapping object
+    return view;
+#else
+    void *view = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, fileno(fp), 0);
+
+    if (view == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // The data is decoded from the start towards the end of each part of the circular buffer
+    (void)madvise(view, (size_t)size, MADV_SEQUENTIAL);
+    return view;
+#endif
+}
+
+
+/**
+ * @brief Release the mapping created with the map_file_to_memory().
+ *
+ * @param  view  Pointer to the start of the mapped file (NULL - nothing to release)
+ * @param  size  File size [bytes]
+ */
+
+void unmap_file_from_memory(void *view, int64_t size)
+{
+    if (view == NULL)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    (void)size;
+    (void)UnmapViewOfFile(view);
+#else
+    (void)munmap(view, (size_t)size);
+#endif
+}
+
+
 /**
  * @brief Set current folder to the folder from which the application was started
  */
@@ -123,6 +216,73 @@ void setup_working_folder_info(void)
 }
 
 
+/**
+ * @brief Assigns a large output buffer to a newly created output file.
+ *        The stdio writes the full buffer with a single write to the operating system. This
+ *        reduces the number of system calls if many small values are printed to many files.
+ *        Must be called before anything is written to the file. The buffer is released
+ *        when the file is closed with the close_output_file().
+ *
+ * @param file  Pointer to the output file (nothing is done for NULL).
+ */
+
+void set_output_file_buffer(FILE *file)
+{
+    if ((file == NULL) || (g_msg.param.output_buffer_size == 0))
+    {
+        return;
+    }
+
+    size_t size = (size_t)g_msg.param.output_buffer_size * 1024u;
+    output_buffer_t *output = (output_buffer_t *)allocate_memory(sizeof(output_buffer_t) + size, "outBuff");
+    output->file = file;
+    output->size = size;
+    output->next = output_buffers;
+    output_buffers = output;
+    (void)setvbuf(file, (char *)(output + 1), _IOFBF, size);
+}
+
+
+/**
+ * @brief Releases the output buffer assigned to a file with the set_output_file_buffer().
+ *        Must be called right after the file has been closed (before any other file is opened).
+ *
+ * @param file  Pointer to the closed file (nothing is done if the file had no output buffer).
+ */
+
+void release_output_file_buffer(FILE *file)
+{
+    for (output_buffer_t **p_output = &output_buffers; *p_output != NULL; p_output = &(*p_output)->next)
+    {
+        output_buffer_t *output = *p_output;
+
+        if (output->file == file)
+        {
+            *p_output = output->next;
+            release_memory(output, sizeof(output_buffer_t) + output->size, "outBuff");
+            return;
+        }
+    }
+}
+
+
+/**
+ * @brief Closes an output file opened with the fopen() or compressed_fopen() and releases
+ *        its output buffer.
+ *
+ * @param file  Pointer to the output file
+ *
+ * @return 0 - file closed successfully, EOF - error
+ */
+
+int close_output_file(FILE *file)
+{
+    int result = compressed_fclose(file);
+    release_output_file_buffer(file);
+    return result;
+}
+
+
 /**
  * @brief Open all system files which are used during the data decoding and
  *        load the error and other messages
@@ -133,7 +293,7 @@ void create_error_file(void)
     // Create Error.log in the output folder
     open_output_folder();
 
-    g_msg.file.error_log = fopen(RTE_ERR_FILE, "w");
+    g_msg.file.error_log = compressed_fopen(RTE_ERR_FILE, "w");
 
     if (g_msg.file.error_log == NULL)
     {
@@ -141,12 +301,13 @@ void create_error_file(void)
             EXIT_FATAL_ERR_CREATE_ERR_FILE);
     }
 
+    set_output_file_buffer(g_msg.file.error_log);
     g_msg.file.main_log = g_msg.file.error_log;   // The complete output goes to the Errors.log until the format parsing is finished
 }
 
 
 /**
- * @brief Open the Main.log and Stat_main.log files.
+ * @brief Open the Main.log, Stat_main.log and Stat_rates.csv (-rate=N) files.
  *        The Main.log file is created during the binary file decoding process.
  */
 
@@ -156,21 +317,14 @@ void create_main_log_file(void)
     open_output_folder();
 
     // Create Main.log
-    g_msg.file.main_log = fopen(RTE_MAIN_LOG_FILE, "w");
+    g_msg.file.main_log = compressed_fopen(RTE_MAIN_LOG_FILE, "w");
 
     if (g_msg.file.main_log == NULL)
     {
-        report_problem_with_string(ERR_CANT_CREATE_DEBUG_FILE, RTE_MAIN_LOG_FILE);
+        report_problem_with_string(ERR_CANT_CREATE_DEBUG_FILE, compressed_file_name(RTE_MAIN_LOG_FILE));
     }
 
-#if defined STREAM_BUFF_SIZE
-    /* Allocate a buffer for the stream; a larger buffer may not significantly increase write speed
-     * The setvbuf function optimizes I/O performance by controlling stream buffering, reducing 
-     * frequent operations and improving efficiency.
-     */
-    char *stream_buffer = allocate_memory(STREAM_BUFF_SIZE, "strBuff");
-    int rez = setvbuf(g_msg.file.main_log, stream_buffer, _IOFBF, STREAM_BUFF_SIZE);
-#endif
+    set_output_file_buffer(g_msg.file.main_log);
 
     // Create main statistics log file
     g_msg.file.statistics_log = fopen(RTE_STAT_MAIN_FILE, "w");
@@ -179,6 +333,8 @@ void create_main_log_file(void)
     {
         report_problem_with_string(FATAL_CANT_CREATE_FILE, RTE_STAT_MAIN_FILE);
     }
+
+    create_rate_file();     // Logging rate in time windows (-rate=N)
 }
 
 
@@ -216,10 +372,16 @@ void remove_old_files(void)
     remove_file(RTE_STAT_MSG_COUNTERS_FILE);
     remove_file(RTE_STAT_MISSING_MSGS_FILE);
     remove_file(RTE_STAT_VALUES_FILE);
+    remove_file(RTE_STAT_LOSSES_FILE);
 
     if (g_msg.param.create_timestamp_file == 0)
     {
-        remove_file(RTE_MSG_TIMESTAMPS_FILE);
+        remove_file(compressed_file_name(RTE_MSG_TIMESTAMPS_FILE));
+    }
+
+    if (g_msg.param.rate_window == 0)
+    {
+        remove_file(RTE_STAT_RATES_FILE);
     }
 
     if (g_msg.param.debug == 0)
@@ -16,6 +16,9 @@
 #include <stdio.h>
 #include <stdint.h>
 
+void set_output_file_buffer(FILE *file);
+void release_output_file_buffer(FILE *file);
+int close_output_file(FILE *file);
 void create_error_file(void);
 void create_main_log_file(void);
 void open_output_folder(void);
@@ -23,6 +26,8 @@ void open_format_folder(void);
 void jump_to_start_folder(void);
 void setup_working_folder_info(void);
 int64_t get_file_size(FILE *fp);
+void *map_file_to_memory(FILE *fp, int64_t size);
+void unmap_file_from_memory(void *view, int64_t size);
 char *prepare_folder_name(char *name, unsigned error_code);
 void remove_old_files(void);
 void remove_file(const char *file_name);
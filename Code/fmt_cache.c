@@ -0,0 +1,1291 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    fmt_cache.c
+ * @author  B. Premzel
+ * @brief   Cache of the compiled format definitions (-fmtcache=file).
+ *          After an error-free parsing the g_fmt[] message definitions, value
+ *          format lists, value statistics structures, enums and indexed texts
+ *          are written to the cache file. The structures keep their in-memory
+ *          layout - the pointers are replaced with offsets from the start of the
+ *          file and listed in the relocation table. The next decoding loads the
+ *          file with a single read and relocates the pointers instead of parsing
+ *          the format definition files.
+ *          The cache is used only if its key matches - a hash of the RTEmsg build,
+ *          structure sizes, -N value, paths and contents of all format definition
+ *          files (loaded before the parsing by parse_file_preload.c). The IN_FILE()
+ *          files are checked separately. The OUT_FILE() files are created again.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "main.h"
+#include "format.h"
+#include "files.h"
+#include "errors.h"
+#include "utf8_helpers.h"
+#include "parse_file_handling.h"
+#include "parse_file_preload.h"
+#include "fmt_cache.h"
+#include "parse_directive.h"
+#include "parse_header_state.h"
+#include "compress_output.h"
+
+#define FMT_CACHE_MAGIC         "RTEfmtC"       // 7 characters + '\0'
+#define FMT_CACHE_ALIGNMENT     16u             // Alignment of the structures in the cache file
+#define HASH_SEED               0x27D4EB2F165667C5uLL
+#define HASH_PRIME1             0x9E3779B185EBCA87uLL
+#define HASH_PRIME2             0xC2B2AE3D27D4EB4FuLL
+#define HASH_PRIME3             0x165667B19E3779F9uLL
+
+
+/* @brief Header at the start of the cache file. All offsets are from the start of the file. */
+typedef struct
+{
+    char magic[8];                  /*!< FMT_CACHE_MAGIC */
+    uint64_t key;                   /*!< Hash of the RTEmsg build, parameters and format definition files */
+    uint64_t data_hash;             /*!< Hash of the data following the header */
+    uint32_t size;                  /*!< Size of the cache file */
+    uint32_t fmt_ids;               /*!< Number of entries in the g_fmt[] table */
+    uint32_t fmt_table;             /*!< Offset of the g_fmt[] table (message offsets, 0 = NULL) */
+    uint32_t enums_found;           /*!< Number of entries in the enum table */
+    uint32_t filter_enums;          /*!< Number of filters */
+    uint32_t fmt_ids_defined;       /*!< Value of g_msg.fmt_ids_defined after the parsing */
+    uint32_t fmt_align_value;       /*!< Value of g_msg.fmt_align_value after the parsing */
+    uint32_t enum_table;            /*!< Offset of the copy of the g_msg.enums[] */
+    uint32_t out_files;             /*!< Number of OUT_FILE() definitions */
+    uint32_t out_file_table;        /*!< Offset of the cached_out_file_t table */
+    uint32_t in_files;              /*!< Number of IN_FILE() definitions */
+    uint32_t in_file_table;         /*!< Offset of the cached_in_file_t table */
+    uint32_t relocations;           /*!< Number of pointers in the cache file */
+    uint32_t relocation_table;      /*!< Offset of the table with offsets of the pointers */
+} fmt_cache_header_t;
+
+
+/* @brief OUT_FILE() parameters needed to create the file again */
+typedef struct
+{
+    uint32_t enum_index;            /*!< Index of the OUT_FILE() in the enum table */
+    uint32_t file_mode;             /*!< Offset of the fopen() mode */
+    uint32_t initial_text;          /*!< Offset of the initial text (before the escape sequence processing) */
+} cached_out_file_t;
+
+
+/* @brief IN_FILE() file - used only if not changed after the cache has been saved */
+typedef struct
+{
+    uint32_t file_name;             /*!< Offset of the file name */
+    uint32_t reserved;
+    uint64_t size;                  /*!< File size */
+    uint64_t hash;                  /*!< Hash of the file contents */
+} cached_in_file_t;
+
+
+/* @brief Cache file preparation */
+static struct
+{
+    uint8_t *data;                  /*!< Cache file contents */
+    size_t size;                    /*!< Size of the prepared data */
+    size_t allocated;               /*!< Size of the allocated memory */
+    uint32_t *relocation;           /*!< Offsets of the pointers in the data */
+    size_t relocations;             /*!< Number of pointers */
+    size_t relocations_allocated;   /*!< Size of the relocation table */
+    const void **map_object;        /*!< Objects already written to the data (hash table) */
+    uint32_t *map_offset;           /*!< Offsets of the objects in the data */
+    size_t map_size;                /*!< Size of the hash table (power of 2) */
+    size_t map_used;                /*!< Number of objects in the hash table */
+    bool failed;                    /*!< Not enough memory or data too large - cache not saved */
+} writer;
+
+static char *out_file_mode[MAX_ENUMS];          // OUT_FILE() fopen() modes
+static char *out_file_initial_text[MAX_ENUMS];  // OUT_FILE() initial texts
+static bool saving_skipped;                     // A format file has not been included in the cache key
+static uint64_t loaded_definitions_key;          // Cache key of the loaded format definitions (-server=name)
+
+
+/**
+ * @brief Single step of the hash calculation - mixes a 64-bit input word to the accumulator.
+ */
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input)
+{
+    acc += input * HASH_PRIME2;
+    acc = (acc << 31) | (acc >> 33);
+    return acc * HASH_PRIME1;
+}
+
+
+/**
+ * @brief Calculates the 64-bit hash of the data (xxHash64-like algorithm - four 64-bit lanes
+ *        are processed in parallel). Used to detect changes of the files and cache data
+ *        (also by the incremental header regeneration - see parse_header_state.c).
+ *
+ * @param seed  Hash value of the previous data (or HASH_SEED)
+ * @param data  Data to add
+ * @param size  Data size
+ *
+ * @return New hash value
+ */
+
+uint64_t hash_data(uint64_t seed, const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    const uint8_t *end = p + size;
+    uint64_t lane[4] = { seed + HASH_PRIME1 + HASH_PRIME2, seed + HASH_PRIME2, seed, seed - HASH_PRIME1 };
+    uint64_t word;
+
+    for ( ; (end - p) >= 32; p += 32)
+    {
+        for (unsigned i = 0; i < 4u; i++)
+        {
+            memcpy(&word, p + 8u * i, sizeof(word));
+            lane[i] = hash_round(lane[i], word);
+        }
+    }
+
+    uint64_t hash = ((lane[0] << 1) | (lane[0] >> 63)) + ((lane[1] << 7) | (lane[1] >> 57))
+        + ((lane[2] << 12) | (lane[2] >> 52)) + ((lane[3] << 18) | (lane[3] >> 46)) + (uint64_t)size;
+
+    for ( ; (end - p) >= 8; p += 8)
+    {
+        memcpy(&word, p, sizeof(word));
+        hash ^= hash_round(0, word);
+        hash = ((hash << 27) | (hash >> 37)) * HASH_PRIME1 + HASH_PRIME3;
+    }
+
+    for ( ; p < end; p++)
+    {
+        hash ^= *p * HASH_PRIME3;
+        hash = ((hash << 11) | (hash >> 53)) * HASH_PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+
+/**
+ * @brief Calculates the cache key from the RTEmsg build, structure sizes, -N parameter value and
+ *        paths and contents of all format definition files loaded by preload_fmt_files().
+ *
+ * @return Cache key
+ */
+
+static uint64_t fmt_cache_key(void)
+{
+    char build[200];
+    snprintf(build, sizeof(build), "RTEmsg v%u.%02u.%02u %s %s %zu %zu %zu %zu %zu %zu %u",
+        RTEMSG_VERSION, RTEMSG_SUBVERSION, RTEMSG_REVISION, __DATE__, __TIME__,
+        sizeof(void *), sizeof(msg_data_t), sizeof(value_format_t), sizeof(value_stats_t),
+        sizeof(fast_format_t), sizeof(enum_data_t), g_msg.hdr_data.topmost_fmt_id);
+    uint64_t key = hash_data(HASH_SEED, build, strlen(build) + 1u);
+    unsigned files = number_of_preloaded_fmt_files();
+
+    for (unsigned i = 0; i < files; i++)
+    {
+        const preloaded_file_t *file = get_preloaded_fmt_file(i);
+        uint64_t size = (file->data == NULL) ? UINT64_MAX : (uint64_t)file->size;
+        key = hash_data(key, file->path, strlen(file->path) + 1u);
+        key = hash_data(key, &size, sizeof(size));
+
+        if (file->data != NULL)
+        {
+            key = hash_data(key, file->data, file->size);
+        }
+    }
+
+    return key;
+}
+
+
+/**
+ * @brief Calculates the hash of the file contents.
+ *
+ * @param file_name  File name (relative to the current folder)
+ * @param size       Output: file size
+ * @param hash       Output: hash of the file contents
+ *
+ * @return true if the file has been read successfully
+ */
+
+static bool hash_file(const char *file_name, uint64_t *size, uint64_t *hash)
+{
+    FILE *file = utf8_fopen(file_name, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    char buffer[0x4000];
+    size_t bytes_read;
+    *size = 0;
+    *hash = HASH_SEED;
+
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        *hash = hash_data(*hash, buffer, bytes_read);
+        *size += bytes_read;
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+
+/**
+ * @brief Finds the offset of an object already written to the cache data.
+ *
+ * @param object  Pointer to the object
+ *
+ * @return Offset of the object or 0 if not written yet
+ */
+
+static uint32_t find_object(const void *object)
+{
+    if (writer.map_size == 0)
+    {
+        return 0;
+    }
+
+    size_t i = (size_t)(((uint64_t)(uintptr_t)object * 0x9E3779B97F4A7C15uLL) >> 32) & (writer.map_size - 1u);
+
+    while (writer.map_object[i] != NULL)
+    {
+        if (writer.map_object[i] == object)
+        {
+            return writer.map_offset[i];
+        }
+
+        i = (i + 1u) & (writer.map_size - 1u);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Inserts an object to the hash table without the check if it is there already.
+ */
+
+static void insert_object(const void *object, uint32_t offset)
+{
+    size_t i = (size_t)(((uint64_t)(uintptr_t)object * 0x9E3779B97F4A7C15uLL) >> 32) & (writer.map_size - 1u);
+
+    while (writer.map_object[i] != NULL)
+    {
+        i = (i + 1u) & (writer.map_size - 1u);
+    }
+
+    writer.map_object[i] = object;
+    writer.map_offset[i] = offset;
+    writer.map_used++;
+}
+
+
+/**
+ * @brief Remembers the offset of an object written to the cache data.
+ *        The same object (e.g. a message definition used by several format IDs) is written only once.
+ *
+ * @param object  Pointer to the object
+ * @param offset  Offset of the object in the cache data
+ */
+
+static void add_object(const void *object, uint32_t offset)
+{
+    if (writer.failed)
+    {
+        return;
+    }
+
+    if (2u * (writer.map_used + 1u) > writer.map_size)
+    {
+        size_t old_size = writer.map_size;
+        const void **old_object = writer.map_object;
+        uint32_t *old_offset = writer.map_offset;
+        size_t new_size = (old_size == 0) ? 0x1000u : 2u * old_size;
+
+        writer.map_object = (const void **)calloc(new_size, sizeof(void *));
+        writer.map_offset = (uint32_t *)calloc(new_size, sizeof(uint32_t));
+
+        if ((writer.map_object == NULL) || (writer.map_offset == NULL))
+        {
+            free((void *)writer.map_object);
+            free(writer.map_offset);
+            writer.map_object = old_object;
+            writer.map_offset = old_offset;
+            writer.failed = true;
+            return;
+        }
+
+        writer.map_size = new_size;
+        writer.map_used = 0;
+
+        for (size_t i = 0; i < old_size; i++)
+        {
+            if (old_object[i] != NULL)
+            {
+                insert_object(old_object[i], old_offset[i]);
+            }
+        }
+
+        free((void *)old_object);
+        free(old_offset);
+    }
+
+    insert_object(object, offset);
+}
+
+
+/**
+ * @brief Reserves aligned space in the cache data.
+ *
+ * @param size  Number of bytes to reserve
+ *
+ * @return Offset of the reserved space (0 if not enough memory - writer.failed is set)
+ */
+
+static uint32_t reserve_space(size_t size)
+{
+    if (writer.failed)
+    {
+        return 0;
+    }
+
+    size_t position = (writer.size + FMT_CACHE_ALIGNMENT - 1u) & ~(size_t)(FMT_CACHE_ALIGNMENT - 1u);
+    size_t new_size = position + size;
+
+    if (new_size > UINT32_MAX)
+    {
+        writer.failed = true;
+        return 0;
+    }
+
+    if (new_size > writer.allocated)
+    {
+        size_t allocated = (writer.allocated == 0) ? 0x10000u : writer.allocated;
+
+        while (allocated < new_size)
+        {
+            allocated *= 2u;
+        }
+
+        uint8_t *data = (uint8_t *)realloc(writer.data, allocated);
+
+        if (data == NULL)
+        {
+            writer.failed = true;
+            return 0;
+        }
+
+        memset(data + writer.allocated, 0, allocated - writer.allocated);
+        writer.data = data;
+        writer.allocated = allocated;
+    }
+
+    writer.size = new_size;
+    return (uint32_t)position;
+}
+
+
+/**
+ * @brief Appends data to the cache data.
+ *
+ * @param data  Data to append
+ * @param size  Data size
+ *
+ * @return Offset of the data in the cache
+ */
+
+static uint32_t append_data(const void *data, size_t size)
+{
+    uint32_t position = reserve_space(size);
+
+    if (!writer.failed)
+    {
+        memcpy(writer.data + position, data, size);
+    }
+
+    return position;
+}
+
+
+/**
+ * @brief Sets a pointer in the cache data to the offset of the target and adds it to the
+ *        relocation table. The NULL pointers (target = 0) remain zero.
+ *
+ * @param position  Offset of the pointer in the cache data
+ * @param target    Offset of the object the pointer points to
+ */
+
+static void set_pointer(uint32_t position, uint32_t target)
+{
+    if (writer.failed || (target == 0))
+    {
+        return;
+    }
+
+    if (writer.relocations >= writer.relocations_allocated)
+    {
+        size_t allocated = (writer.relocations_allocated == 0) ? 0x1000u : 2u * writer.relocations_allocated;
+        uint32_t *relocation = (uint32_t *)realloc(writer.relocation, allocated * sizeof(uint32_t));
+
+        if (relocation == NULL)
+        {
+            writer.failed = true;
+            return;
+        }
+
+        writer.relocation = relocation;
+        writer.relocations_allocated = allocated;
+    }
+
+    uintptr_t offset = target;
+    memcpy(writer.data + position, &offset, sizeof(offset));
+    writer.relocation[writer.relocations++] = position;
+}
+
+
+/**
+ * @brief Writes a zero terminated string to the cache data.
+ *
+ * @return Offset of the string (0 for NULL)
+ */
+
+static uint32_t put_string(const char *text)
+{
+    if (text == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t position = find_object(text);
+
+    if (position == 0)
+    {
+        position = append_data(text, strlen(text) + 1u);
+        add_object(text, position);
+    }
+
+    return position;
+}
+
+
+/**
+ * @brief Writes the IN_FILE() indexed text prepared by read_file_to_indexed_text() to the cache data.
+ *        Every text starts with its length. The list ends with a zero length.
+ *
+ * @return Offset of the indexed text (0 for NULL)
+ */
+
+static uint32_t put_indexed_text(const char *text)
+{
+    if (text == NULL)
+    {
+        return 0;
+    }
+
+    const unsigned char *end = (const unsigned char *)text;
+
+    while (*end != 0)
+    {
+        end += *end + 1u;
+    }
+
+    return append_data(text, (size_t)(end - (const unsigned char *)text) + 1u);
+}
+
+
+/**
+ * @brief Writes the value statistics structure to the cache data.
+ *
+ * @return Offset of the structure (0 for NULL)
+ */
+
+static uint32_t put_value_stats(const value_stats_t *stat)
+{
+    if (stat == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t position = find_object(stat);
+
+    if (position == 0)
+    {
+        value_stats_t copy = *stat;
+        copy.name = NULL;
+        copy.sketch = NULL;             // Allocated during the decoding
+        position = append_data(&copy, sizeof(copy));
+        add_object(stat, position);
+        set_pointer(position + offsetof(value_stats_t, name), put_string(stat->name));
+    }
+
+    return position;
+}
+
+
+/**
+ * @brief Writes the fast formatting data to the cache data. The suffix points to the end of the
+ *        format string - see prepare_fast_format().
+ *
+ * @param fast_fmt             Fast formatting data
+ * @param fmt_string           Format string of the value
+ * @param fmt_string_position  Offset of the format string in the cache data
+ *
+ * @return Offset of the structure (0 for NULL)
+ */
+
+static uint32_t put_fast_format(const fast_format_t *fast_fmt, const char *fmt_string, uint32_t fmt_string_position)
+{
+    if (fast_fmt == NULL)
+    {
+        return 0;
+    }
+
+    fast_format_t copy = *fast_fmt;
+    copy.prefix = NULL;
+    copy.suffix = NULL;
+    uint32_t position = append_data(&copy, sizeof(copy));
+    set_pointer(position + offsetof(fast_format_t, prefix), put_string(fast_fmt->prefix));
+
+    uint32_t suffix_position;
+    uintptr_t suffix = (uintptr_t)fast_fmt->suffix;
+    uintptr_t start = (uintptr_t)fmt_string;
+
+    if ((fmt_string != NULL) && (fmt_string_position != 0)
+        && (suffix >= start) && (suffix <= (start + strlen(fmt_string))))
+    {
+        suffix_position = fmt_string_position + (uint32_t)(suffix - start);
+    }
+    else
+    {
+        suffix_position = put_string(fast_fmt->suffix);
+    }
+
+    set_pointer(position + offsetof(fast_format_t, suffix), suffix_position);
+    return position;
+}
+
+
+/**
+ * @brief Writes the linked list of value formatting definitions to the cache data.
+ *
+ * @return Offset of the first value definition (0 for NULL)
+ */
+
+static uint32_t put_value_formats(const value_format_t *fmt)
+{
+    uint32_t first = 0;
+    uint32_t previous_link = 0;     // Offset of the 'format' pointer of the previous definition
+
+    for ( ; fmt != NULL; fmt = fmt->format)
+    {
+        uint32_t position = find_object(fmt);
+        bool already_written = (position != 0);
+
+        if (!already_written)
+        {
+            value_format_t copy = *fmt;
+            copy.fmt_string = NULL;
+            copy.value_stat = NULL;
+            copy.fast_fmt = NULL;
+            copy.format = NULL;
+            position = append_data(&copy, sizeof(copy));
+            add_object(fmt, position);
+
+            uint32_t fmt_string_position = put_string(fmt->fmt_string);
+            set_pointer(position + offsetof(value_format_t, fmt_string), fmt_string_position);
+            set_pointer(position + offsetof(value_format_t, value_stat), put_value_stats(fmt->value_stat));
+            set_pointer(position + offsetof(value_format_t, fast_fmt),
+                put_fast_format(fmt->fast_fmt, fmt->fmt_string, fmt_string_position));
+        }
+
+        if (previous_link == 0)
+        {
+            first = position;
+        }
+        else
+        {
+            set_pointer(previous_link, position);
+        }
+
+        if (already_written)
+        {
+            break;                  // The rest of the list is already in the cache
+        }
+
+        previous_link = position + offsetof(value_format_t, format);
+    }
+
+    return first;
+}
+
+
+/**
+ * @brief Writes the message formatting definition to the cache data.
+ *        The decode plan is prepared after the loading by the compile_decode_plans().
+ *
+ * @return Offset of the structure (0 for NULL)
+ */
+
+static uint32_t put_message(const msg_data_t *msg)
+{
+    if (msg == NULL)
+    {
+        return 0;
+    }
+
+    uint32_t position = find_object(msg);
+
+    if (position == 0)
+    {
+        msg_data_t copy = *msg;
+        copy.message_name = NULL;
+        copy.format = NULL;
+        copy.plan = NULL;
+        copy.plan_size = 0;
+        copy.columns = NULL;
+        copy.query = NULL;
+        position = append_data(&copy, sizeof(copy));
+        add_object(msg, position);
+        set_pointer(position + offsetof(msg_data_t, message_name), put_string(msg->message_name));
+        set_pointer(position + offsetof(msg_data_t, format), put_value_formats(msg->format));
+    }
+
+    return position;
+}
+
+
+/**
+ * @brief Writes the g_fmt[] table (up to the last defined format ID) and message definitions.
+ */
+
+static void put_fmt_table(fmt_cache_header_t *header)
+{
+    uint32_t fmt_ids = MAX_FMT_IDS;
+
+    while ((fmt_ids > 0) && (g_fmt[fmt_ids - 1u] == NULL))
+    {
+        fmt_ids--;
+    }
+
+    header->fmt_ids = fmt_ids;
+    header->fmt_table = reserve_space((size_t)fmt_ids * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < fmt_ids; i++)
+    {
+        uint32_t position = put_message(g_fmt[i]);
+
+        if (!writer.failed)
+        {
+            memcpy(writer.data + header->fmt_table + i * sizeof(uint32_t), &position, sizeof(position));
+        }
+    }
+}
+
+
+/**
+ * @brief Writes the enums (filters, MEMO, IN_FILE, OUT_FILE and selected text definitions).
+ *        The OUT_FILE() file pointers are not saved - the files are created after the loading.
+ */
+
+static void put_enum_table(fmt_cache_header_t *header)
+{
+    header->enums_found = g_msg.enums_found;
+    header->filter_enums = g_msg.filter_enums;
+    header->enum_table = reserve_space(g_msg.enums_found * sizeof(enum_data_t));
+
+    for (uint32_t i = 0; i < g_msg.enums_found; i++)
+    {
+        const enum_data_t *p_enum = &g_msg.enums[i];
+        uint32_t position = header->enum_table + i * (uint32_t)sizeof(enum_data_t);
+        enum_data_t copy = *p_enum;
+        copy.name = NULL;
+        copy.file_name = NULL;
+        copy.text_offset = NULL;        // Prepared after the loading - see compile_decode_plans()
+        copy.no_texts = 0;
+        uint32_t data_position = 0;
+
+        switch (p_enum->type)
+        {
+            case FILTER_TYPE:
+                copy.u.filter_description = NULL;
+                data_position = put_string(p_enum->u.filter_description);
+                break;
+
+            case OUT_FILE_TYPE:
+                copy.u.p_file = NULL;
+                break;
+
+            case IN_FILE_TYPE:
+                copy.u.in_file_txt = NULL;
+                data_position = put_indexed_text(p_enum->u.in_file_txt);
+                break;
+
+            case Y_TEXT_TYPE:
+                copy.u.in_file_txt = NULL;
+                data_position = put_string(p_enum->u.in_file_txt);
+                break;
+
+            default:        // MEMO_TYPE
+                break;
+        }
+
+        if (writer.failed)
+        {
+            return;
+        }
+
+        memcpy(writer.data + position, &copy, sizeof(copy));
+        set_pointer(position + offsetof(enum_data_t, name), put_string(p_enum->name));
+        set_pointer(position + offsetof(enum_data_t, file_name), put_string(p_enum->file_name));
+        set_pointer(position + offsetof(enum_data_t, u), data_position);
+    }
+}
+
+
+/**
+ * @brief Writes the OUT_FILE() parameters and IN_FILE() hashes.
+ */
+
+static void put_file_tables(fmt_cache_header_t *header)
+{
+    for (uint32_t i = 0; i < g_msg.enums_found; i++)
+    {
+        if (g_msg.enums[i].type == OUT_FILE_TYPE)
+        {
+            header->out_files++;
+        }
+        else if (g_msg.enums[i].type == IN_FILE_TYPE)
+        {
+            header->in_files++;
+        }
+    }
+
+    header->out_file_table = reserve_space(header->out_files * sizeof(cached_out_file_t));
+    header->in_file_table = reserve_space(header->in_files * sizeof(cached_in_file_t));
+    uint32_t out_files = 0;
+    uint32_t in_files = 0;
+    open_format_folder();           // The IN_FILE() paths are relative to the format folder
+
+    for (uint32_t i = 0; (i < g_msg.enums_found) && !writer.failed; i++)
+    {
+        const enum_data_t *p_enum = &g_msg.enums[i];
+
+        if (p_enum->type == OUT_FILE_TYPE)
+        {
+            cached_out_file_t out_file;
+            out_file.enum_index = i;
+            out_file.file_mode = put_string(out_file_mode[i]);
+            out_file.initial_text = put_string(out_file_initial_text[i]);
+
+            if ((out_file.file_mode == 0) || (out_file.initial_text == 0))
+            {
+                writer.failed = true;
+                break;
+            }
+
+            memcpy(writer.data + header->out_file_table + (out_files++) * sizeof(cached_out_file_t),
+                &out_file, sizeof(out_file));
+        }
+        else if (p_enum->type == IN_FILE_TYPE)
+        {
+            cached_in_file_t in_file;
+            memset(&in_file, 0, sizeof(in_file));
+            in_file.file_name = put_string(p_enum->file_name);
+
+            if ((in_file.file_name == 0) || !hash_file(p_enum->file_name, &in_file.size, &in_file.hash))
+            {
+                writer.failed = true;
+                break;
+            }
+
+            memcpy(writer.data + header->in_file_table + (in_files++) * sizeof(cached_in_file_t),
+                &in_file, sizeof(in_file));
+        }
+    }
+}
+
+
+/**
+ * @brief Writes the prepared data to the cache file. A temporary file is renamed to the
+ *        cache file after it has been written completely.
+ */
+
+static void write_cache_file(void)
+{
+    char temp_name[MAX_FILEPATH_LENGTH];
+    int length = snprintf(temp_name, sizeof(temp_name), "%s.tmp", g_msg.param.fmt_cache_file);
+
+    if ((length < 0) || ((size_t)length >= sizeof(temp_name)))
+    {
+        return;
+    }
+
+    jump_to_start_folder();
+    FILE *file = utf8_fopen(temp_name, "wb");
+
+    if (file == NULL)
+    {
+        return;
+    }
+
+    bool ok = (fwrite(writer.data, 1, writer.size, file) == writer.size);
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok)
+    {
+        (void)utf8_remove(g_msg.param.fmt_cache_file);      // Rename does not replace files on Windows
+        ok = (utf8_rename(temp_name, g_msg.param.fmt_cache_file) == 0);
+    }
+
+    if (!ok)
+    {
+        (void)utf8_remove(temp_name);
+    }
+}
+
+
+/**
+ * @brief Releases the memory used for the cache file preparation.
+ */
+
+static void free_writer(void)
+{
+    free(writer.data);
+    free(writer.relocation);
+    free((void *)writer.map_object);
+    free(writer.map_offset);
+    memset(&writer, 0, sizeof(writer));
+}
+
+
+/**
+ * @brief Saves the compiled format definitions to the cache file (if enabled with -fmtcache=file).
+ *        Called after the parsing. Nothing is saved if errors were found or a format definition
+ *        file has not been included in the cache key. Problems with the cache file are not
+ *        reported - the format definitions are parsed again during the next decoding.
+ */
+
+void save_fmt_cache(void)
+{
+    if ((g_msg.param.fmt_cache_file == NULL) || g_msg.param.check_syntax_and_compile
+        || saving_skipped || (g_msg.total_errors > 0))
+    {
+        return;
+    }
+
+    fmt_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    (void)reserve_space(sizeof(header));
+
+    put_fmt_table(&header);
+    put_enum_table(&header);
+    put_file_tables(&header);
+    header.relocations = (uint32_t)writer.relocations;
+    header.relocation_table = append_data(writer.relocation, writer.relocations * sizeof(uint32_t));
+
+    if (!writer.failed)
+    {
+        memcpy(header.magic, FMT_CACHE_MAGIC, sizeof(header.magic));
+        header.key = fmt_cache_key();
+        header.size = (uint32_t)writer.size;
+        header.fmt_ids_defined = g_msg.fmt_ids_defined;
+        header.fmt_align_value = g_msg.fmt_align_value;
+        header.data_hash = hash_data(HASH_SEED, writer.data + sizeof(header), writer.size - sizeof(header));
+        memcpy(writer.data, &header, sizeof(header));
+        write_cache_file();
+    }
+
+    free_writer();
+    _set_errno(0);
+}
+
+
+/**
+ * @brief Checks if a table is completely inside the cache data.
+ */
+
+static bool table_in_cache(uint32_t offset, uint32_t entries, size_t entry_size, uint32_t size)
+{
+    return ((uint64_t)offset + (uint64_t)entries * entry_size) <= size;
+}
+
+
+/**
+ * @brief Checks if a zero terminated string is completely inside the cache data.
+ */
+
+static bool string_in_cache(const uint8_t *cache, uint32_t offset, uint32_t size)
+{
+    return (offset > 0) && (offset < size) && (memchr(cache + offset, '\0', size - offset) != NULL);
+}
+
+
+/**
+ * @brief Checks the cache file header, hash and tables.
+ *
+ * @param cache  Cache file contents
+ * @param size   Cache file size
+ *
+ * @return true if the cache file is valid for the current format definition files
+ */
+
+static bool cache_data_valid(const uint8_t *cache, uint32_t size)
+{
+    const fmt_cache_header_t *header = (const fmt_cache_header_t *)cache;
+
+    if ((memcmp(header->magic, FMT_CACHE_MAGIC, sizeof(header->magic)) != 0)
+        || (header->size != size)
+        || (header->key != fmt_cache_key())
+        || (header->data_hash != hash_data(HASH_SEED, cache + sizeof(*header), size - sizeof(*header)))
+        || (header->fmt_ids > MAX_FMT_IDS)
+        || (header->enums_found > MAX_ENUMS)
+        || (header->enums_found < NUMBER_OF_FILTER_BITS)
+        || (header->out_files > header->enums_found)
+        || !table_in_cache(header->fmt_table, header->fmt_ids, sizeof(uint32_t), size)
+        || !table_in_cache(header->enum_table, header->enums_found, sizeof(enum_data_t), size)
+        || !table_in_cache(header->out_file_table, header->out_files, sizeof(cached_out_file_t), size)
+        || !table_in_cache(header->in_file_table, header->in_files, sizeof(cached_in_file_t), size)
+        || !table_in_cache(header->relocation_table, header->relocations, sizeof(uint32_t), size))
+    {
+        return false;
+    }
+
+    const uint32_t *relocation = (const uint32_t *)(cache + header->relocation_table);
+
+    for (uint32_t i = 0; i < header->relocations; i++)
+    {
+        uintptr_t offset;
+
+        if (!table_in_cache(relocation[i], 1u, sizeof(offset), size))
+        {
+            return false;
+        }
+
+        memcpy(&offset, cache + relocation[i], sizeof(offset));
+
+        if ((offset == 0) || (offset >= size))
+        {
+            return false;
+        }
+    }
+
+    const cached_out_file_t *out_file = (const cached_out_file_t *)(cache + header->out_file_table);
+
+    for (uint32_t i = 0; i < header->out_files; i++)
+    {
+        if ((out_file[i].enum_index >= header->enums_found)
+            || !string_in_cache(cache, out_file[i].file_mode, size)
+            || !string_in_cache(cache, out_file[i].initial_text, size))
+        {
+            return false;
+        }
+    }
+
+    // The IN_FILE() contents must not have been changed
+    const cached_in_file_t *in_file = (const cached_in_file_t *)(cache + header->in_file_table);
+
+    if (header->in_files > 0)
+    {
+        open_format_folder();
+    }
+
+    for (uint32_t i = 0; i < header->in_files; i++)
+    {
+        uint64_t file_size;
+        uint64_t hash;
+
+        if (!string_in_cache(cache, in_file[i].file_name, size)
+            || !hash_file((const char *)cache + in_file[i].file_name, &file_size, &hash)
+            || (file_size != in_file[i].size) || (hash != in_file[i].hash))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Loads the cache file with a single read and checks it.
+ *
+ * @return Cache file contents or NULL if not found or not valid
+ */
+
+static uint8_t *read_cache_file(void)
+{
+    jump_to_start_folder();
+    FILE *file = utf8_fopen(g_msg.param.fmt_cache_file, "rb");
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    int64_t file_size = get_file_size(file);
+    uint8_t *cache = NULL;
+
+    if ((file_size > (int64_t)sizeof(fmt_cache_header_t)) && (file_size <= UINT32_MAX))
+    {
+        cache = (uint8_t *)malloc((size_t)file_size);
+
+        if ((cache != NULL) && (fread(cache, 1, (size_t)file_size, file) != (size_t)file_size))
+        {
+            free(cache);
+            cache = NULL;
+        }
+    }
+
+    fclose(file);
+
+    if ((cache != NULL) && !cache_data_valid(cache, (uint32_t)file_size))
+    {
+        free(cache);
+        cache = NULL;
+    }
+
+    return cache;
+}
+
+
+/**
+ * @brief Restores the compiled format definitions from the cache data and creates the OUT_FILE() files.
+ *        The cache data remains allocated - the format definitions point to it.
+ *
+ * @param cache  Checked cache file contents
+ */
+
+static void restore_fmt_definitions(uint8_t *cache)
+{
+    const fmt_cache_header_t *header = (const fmt_cache_header_t *)cache;
+    const uint32_t *relocation = (const uint32_t *)(cache + header->relocation_table);
+
+    for (uint32_t i = 0; i < header->relocations; i++)
+    {
+        uintptr_t pointer;
+        memcpy(&pointer, cache + relocation[i], sizeof(pointer));
+        pointer += (uintptr_t)cache;
+        memcpy(cache + relocation[i], &pointer, sizeof(pointer));
+    }
+
+    const uint32_t *fmt_table = (const uint32_t *)(cache + header->fmt_table);
+
+    for (uint32_t i = 0; i < header->fmt_ids; i++)
+    {
+        g_fmt[i] = (fmt_table[i] == 0) ? NULL : (msg_data_t *)(cache + fmt_table[i]);
+    }
+
+    memcpy(g_msg.enums, cache + header->enum_table, header->enums_found * sizeof(enum_data_t));
+    g_msg.enums_found = header->enums_found;
+    g_msg.filter_enums = header->filter_enums;
+    g_msg.fmt_ids_defined = header->fmt_ids_defined;
+    g_msg.fmt_align_value = header->fmt_align_value;
+
+    const cached_out_file_t *out_file = (const cached_out_file_t *)(cache + header->out_file_table);
+
+    if (header->out_files > 0)
+    {
+        open_output_folder();
+    }
+
+    for (uint32_t i = 0; i < header->out_files; i++)
+    {
+        enum_data_t *p_enum = &g_msg.enums[out_file[i].enum_index];
+        save_out_file_parameters(out_file[i].enum_index, (const char *)cache + out_file[i].file_mode,
+            (const char *)cache + out_file[i].initial_text);
+        p_enum->u.p_file = create_file(p_enum->file_name,
+            (char *)cache + out_file[i].initial_text, (const char *)cache + out_file[i].file_mode);
+
+        if (p_enum->u.p_file == NULL)
+        {
+            report_problem_with_string(FATAL_CANT_CREATE_FILE, p_enum->file_name);
+        }
+    }
+}
+
+
+/**
+ * @brief Loads the compiled format definitions from the cache file (if enabled with -fmtcache=file).
+ *        Must be called after the preload_fmt_files() - the cache key is calculated from the
+ *        format definition files loaded by it.
+ *
+ * @return true if the format definitions have been loaded and need not be parsed
+ */
+
+bool load_fmt_cache(void)
+{
+    if ((g_msg.param.fmt_cache_file == NULL) || g_msg.param.check_syntax_and_compile)
+    {
+        return false;
+    }
+
+    uint8_t *cache = read_cache_file();
+    _set_errno(0);
+
+    if (cache == NULL)
+    {
+        return false;
+    }
+
+    restore_fmt_definitions(cache);
+    return true;
+}
+
+
+/**
+ * @brief Remembers the OUT_FILE() parameters for the cache file and for the creation of the files
+ *        in the output folder of every binary data file (-batch, -server=name). Called before
+ *        the file is created (the initial text is modified by the create_file()).
+ *
+ * @param enum_index    Index of the OUT_FILE() in the g_msg.enums[]
+ * @param file_mode     fopen() mode
+ * @param initial_text  Initial text of the file
+ */
+
+void save_out_file_parameters(uint32_t enum_index, const char *file_mode, const char *initial_text)
+{
+    if (((g_msg.param.fmt_cache_file == NULL) && !g_msg.param.batch_mode && (g_msg.param.server_name == NULL))
+        || (enum_index >= MAX_ENUMS))
+    {
+        return;
+    }
+
+    out_file_mode[enum_index] = duplicate_parse_string(file_mode);
+    out_file_initial_text[enum_index] = duplicate_parse_string(initial_text);
+}
+
+
+/**
+ * @brief The format definitions are not saved to the cache file. Called by the parser if a format
+ *        definition file has been read line by line (it is not included in the cache key).
+ */
+
+void skip_fmt_cache_saving(void)
+{
+    saving_skipped = true;
+}
+
+
+/**
+ * @brief Closes the OUT_FILE() files (-batch).
+ *
+ * @param remove_files  true - delete the closed files from the current output folder
+ */
+
+void close_out_files(bool remove_files)
+{
+    open_output_folder();
+
+    for (uint32_t i = NUMBER_OF_FILTER_BITS; i < g_msg.enums_found; i++)
+    {
+        enum_data_t *p_enum = &g_msg.enums[i];
+
+        if ((p_enum->type != OUT_FILE_TYPE) || (p_enum->u.p_file == NULL))
+        {
+            continue;
+        }
+
+        close_output_file(p_enum->u.p_file);
+        p_enum->u.p_file = NULL;
+
+        if (remove_files)
+        {
+            remove_file(compressed_file_name(p_enum->file_name));
+        }
+    }
+}
+
+
+/**
+ * @brief Creates the OUT_FILE() files again in the current output folder (-batch).
+ *        The files are prepared with the parameters remembered by save_out_file_parameters().
+ */
+
+void create_out_files(void)
+{
+    open_output_folder();
+
+    for (uint32_t i = NUMBER_OF_FILTER_BITS; i < g_msg.enums_found; i++)
+    {
+        enum_data_t *p_enum = &g_msg.enums[i];
+
+        if ((p_enum->type != OUT_FILE_TYPE) || (out_file_mode[i] == NULL))
+        {
+            continue;
+        }
+
+        size_t initial_text_size = strlen(out_file_initial_text[i]) + 1u;
+        char *initial_text = duplicate_string(out_file_initial_text[i]);  // Modified by the create_file()
+        p_enum->u.p_file = create_file(p_enum->file_name, initial_text, out_file_mode[i]);
+        release_memory(initial_text, initial_text_size, "StringDup");
+
+        if (p_enum->u.p_file == NULL)
+        {
+            report_problem_with_string(FATAL_CANT_CREATE_FILE, p_enum->file_name);
+        }
+    }
+}
+
+
+/**
+ * @brief Prepares the format definitions for the binary data decoding. The compiled format
+ *        definitions are loaded from the cache file (-fmtcache=file) if it is up to date.
+ *        Otherwise the format definition files are parsed and saved to the cache file.
+ */
+
+void load_format_definitions(void)
+{
+    // Initialize the first 32 enum locations for filter information.
+    g_msg.enums_found = NUMBER_OF_FILTER_BITS;
+
+    preload_fmt_files(RTE_MAIN_FMT_FILE);       // Load the format definition files in parallel.
+
+    if (!load_fmt_cache())                      // Use the compiled format definitions (-fmtcache=file).
+    {
+        load_header_state();                    // Skip the unchanged headers (-c).
+        parse_fmt_file(RTE_MAIN_FMT_FILE, NULL);    // Begin parsing the main format file.
+        save_header_state();
+        save_fmt_cache();                       // Save them for the next decoding.
+    }
+
+    if (g_msg.param.server_name != NULL)
+    {
+        loaded_definitions_key = fmt_cache_key();   // Checked before every job of the decode server.
+    }
+
+    free_preloaded_fmt_files();
+}
+
+
+/**
+ * @brief Checks if the format definition files have been changed after they have been loaded
+ *        by the load_format_definitions(). The files are loaded again and compared with the
+ *        same key as the cache file (-fmtcache=file).
+ *
+ * @return true - at least one format definition file has been changed, added or removed
+ */
+
+bool format_definitions_changed(void)
+{
+    preload_fmt_files(RTE_MAIN_FMT_FILE);
+    uint64_t key = fmt_cache_key();
+    free_preloaded_fmt_files();
+    jump_to_start_folder();
+    return key != loaded_definitions_key;
+}
+
+/*==== End of file ====*/
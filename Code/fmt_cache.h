@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    fmt_cache.h
+ * @author  B. Premzel
+ * @brief   Cache of the compiled format definitions (-fmtcache=file).
+ ******************************************************************************/
+
+#ifndef _FMT_CACHE_H
+#define _FMT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+bool load_fmt_cache(void);
+void save_fmt_cache(void);
+void save_out_file_parameters(uint32_t enum_index, const char *file_mode, const char *initial_text);
+void skip_fmt_cache_saving(void);
+void close_out_files(bool remove_files);
+void create_out_files(void);
+uint64_t hash_data(uint64_t seed, const void *data, size_t size);
+void load_format_definitions(void);
+bool format_definitions_changed(void);
+
+#endif  // _FMT_CACHE_H
+
+/*==== End of file ====*/
@@ -17,6 +17,7 @@
 #include "files.h"
 #include "print_message.h"
 #include "print_helper.h"
+#include "name_index.h"
 
 
 /**
@@ -27,6 +28,16 @@
 msg_data_t *g_fmt[MAX_FMT_IDS];
 
 
+/**
+ * @brief Dense table with the data of every format ID used for the framing and assembly of
+ *        the messages. It is prepared from the g_fmt[] by prepare_format_info(), so the
+ *        decoding of a message does not have to read its msg_data_t structure before the
+ *        message is printed.
+ */
+
+CACHE_LINE_ALIGNED_COMPAT fmt_info_t g_fmt_info[MAX_FMT_IDS];
+
+
 /**
  * @brief Assigns a format ID to a new message type.
  *        Utilizes the first sufficiently large space aligned to no_fmt_ids.
@@ -117,47 +128,38 @@ unsigned assign_fmt_id(unsigned no_fmt_ids, msg_data_t *p_msg_data)
 }
 
 
+static name_index_t message_names;      // Index of the message names - format IDs of the messages
+
+
+/**
+ * @brief Adds a message name to the index used by find_message_format_index().
+ *
+ * @param name    Name of the message.
+ * @param fmt_id  The first format ID assigned to the message.
+ */
+
+void add_message_name_to_index(const char *name, uint32_t fmt_id)
+{
+    add_name_to_index(&message_names, name, fmt_id);
+}
+
+
 /**
  * @brief Finds the index of a message with a given name.
  *
  * @param name  Name of the message to search for.
  *
- * @return  Index of the message with the given name (in the enum_data_t enums[]).
+ * @return  Index of the message with the given name (in the g_fmt[]).
  *          MSG_NAME_NOT_FOUND if the message with the given name is not found.
  */
 
 uint32_t find_message_format_index(const char *name)
 {
-    uint32_t result = MSG_NAME_NOT_FOUND;
+    uint32_t result;
 
-    if (name == NULL)
+    if (!find_name_in_index(&message_names, name, &result))
     {
-        return result;
-    }
-
-    msg_data_t *p_already_processed = NULL;
-
-    for (uint16_t i = 0; i < g_msg.fmt_ids_defined; i++)
-    {
-        msg_data_t *p_fmt = g_fmt[i];
-
-        if (p_fmt == NULL)
-        {
-            continue;   // No formatting definitions for this message type.
-        }
-
-        if (p_already_processed == p_fmt)
-        {
-            continue;   // The format structure has already been processed.
-        }
-
-        p_already_processed = p_fmt;
-
-        if ((p_fmt->message_name != NULL) && (strcmp(p_fmt->message_name, name) == 0))
-        {
-            result = i;
-            break;
-        }
+        result = MSG_NAME_NOT_FOUND;
     }
 
     return result;
@@ -394,6 +396,26 @@ void print_format_decoding_information(void)
 }
 
 
+/**
+ * @brief Prepares the g_fmt_info[] table from the format definitions in the g_fmt[].
+ *        Must be called after the format definitions have been parsed or loaded from
+ *        the cache and the system message format has been prepared (see prepare_message_assembly()).
+ */
+
+void prepare_format_info(void)
+{
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        msg_data_t *p_fmt = g_fmt[fmt_id];
+        fmt_info_t *info = &g_fmt_info[fmt_id];
+        info->p_fmt = p_fmt;
+        info->msg_len = (p_fmt != NULL) ? p_fmt->msg_len : 0;
+        info->ext_data_mask = (p_fmt != NULL) ? p_fmt->ext_data_mask : 0;
+        info->msg_type = (uint8_t)((p_fmt != NULL) ? p_fmt->msg_type : TYPE_MSG0_4);
+    }
+}
+
+
 /**
  * @brief Get name of the format ID (as defined in the format definition file)
  *
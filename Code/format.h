@@ -14,6 +14,7 @@
 #define _FORMAT_H
 
 #include "main.h"
+#include "quantile_sketch.h"
 
 
 /**
@@ -30,6 +31,8 @@ typedef struct
     uint32_t max_msg_no[MIN_MAX_VALUES]; //!< Message numbers where the max. values were found
     double min[MIN_MAX_VALUES];          //!< Minimal values
     double max[MIN_MAX_VALUES];          //!< Maximal values
+    bool quantiles;                      //!< Estimate the quantiles and histogram ("|name:q|")
+    quantile_sketch_t *sketch;           //!< Quantile sketch (allocated for the first value)
 } value_stats_t;
 
 
@@ -77,6 +80,35 @@ enum data_type_t
 };
 
 
+/*@brief Value extraction method selected by compile_decode_plans() */
+enum extraction_t
+{
+    EXTRACT_CHECKED,                /*!< Size and address checked for every message (message length not known) */
+    EXTRACT_IN_MESSAGE              /*!< Value which is always inside of the message - no checks necessary */
+};
+
+/**
+ * @brief Pre-parsed printf() format specification for the values printed without the
+ *        fprintf() - see fast_format.c. The "%%" in the text before the value is already
+ *        replaced with a single '%'.
+ */
+typedef struct
+{
+    const char *prefix;             /*!< Text printed before the value */
+    const char *suffix;             /*!< Text printed after the value */
+    uint32_t prefix_len;            /*!< Length of the prefix text */
+    uint32_t suffix_len;            /*!< Length of the suffix text */
+    int width;                      /*!< Minimal field width (0 = not defined) */
+    int precision;                  /*!< Precision (-1 = not defined) */
+    uint8_t int_size;               /*!< Size of the integer argument in bytes (1, 2, 4 or 8) */
+    char conversion;                /*!< Conversion character (d, i, u, o, x, X, f, F, e, E, g, G) */
+    bool left_align;                /*!< '-' flag */
+    bool zero_pad;                  /*!< '0' flag */
+    bool plus_sign;                 /*!< '+' flag */
+    bool space_sign;                /*!< ' ' flag */
+    bool alternate;                 /*!< '#' flag */
+} fast_format_t;
+
 /**
  * @brief Formatting values for a single data value (single number or other data type).
  *        If a message contains more than one value then a linked list of structures is used.
@@ -92,16 +124,36 @@ typedef struct value_format
     uint32_t fmt_id_timer;          /*!< Format ID of message which is used for calculation of time difference */
     uint32_t bit_address;           /*!< Address of the first data bit in a message belonging to this value */
     uint32_t data_size;             /*!< Size of data to be printed [number of bits] */
+    uint32_t array_count;           /*!< Number of elements of an array value [nn:mmF*K] (0 = single value) */
     enum data_type_t data_type;     /*!< Type of data formatting (signed, unsigned, float, ...) */
     enum fmt_type_t fmt_type;       /*!< Which data type should be used for the fprintf() */
     bool print_copy_to_main_log;    /*!< != 0 => Print copy of data printed to defined file to Main.log file. */
     double mult;                    /*!< Multiplier for data scaling (0 = no scaling) */
     double offset;                  /*!< Offset added before the multiplication */
     value_stats_t *value_stat;      /*!< Value statistics (NULL = no statistics for this value) */
+    enum extraction_t extraction;   /*!< Value extraction method */
+    fast_format_t *fast_fmt;        /*!< Value printed without fprintf() (NULL = use the fprintf()) */
     struct value_format *format;    /*!< Pointer to the formatting data for the next value (NULL = end of linked list) */
 } value_format_t;
 
 
+/* Function printing a single value to the output file */
+typedef void (*print_value_t)(FILE *out, value_format_t *fmt);
+
+/**
+ * @brief Single operation of the decode plan prepared from the value_format_t linked list
+ *        by compile_decode_plans().
+ */
+typedef struct
+{
+    value_format_t fmt;             /*!< Copy of the value formatting definition */
+    print_value_t print;            /*!< Function which prints the value */
+    FILE *out;                      /*!< OUT_FILE() file (NULL = Main.log of the current printing context) */
+    bool check_out_file;            /*!< Bad OUT_FILE() definition - reported during the printing */
+    bool decimated;                 /*!< OUT_FILE() file with DECIMATE=N or MINMAX=T */
+} decode_op_t;
+
+
 /*@brief Define type of message for which the decoding function must expect. */
 enum msg_type_t
 {
@@ -111,35 +163,75 @@ enum msg_type_t
     TYPE_MSGX                       /*!< For MSGX - unknown length */
 };
 
+/*@brief Can the message be printed by the parallel printing workers (see parallel_decode.c)? */
+enum parallel_print_t
+{
+    PARALLEL_PRINT_UNKNOWN,         /*!< Format definitions not checked yet */
+    PARALLEL_PRINT_POSSIBLE,        /*!< The printing does not depend on other messages */
+    PARALLEL_PRINT_NOT_POSSIBLE     /*!< MEMO, OUT_FILE, statistics, ... - sequential printing only */
+};
+
 /**
- * @brief Structure containing information for one message type
+ * @brief Structure containing information for one message type.
+ *        The data used for the decoding and printing of every message is at the start.
  */
-typedef struct
+typedef struct _msg_data_t
 {
-    const char *message_name;       /*!< Name of this message type - i.e. MSG2_NAME */
-    enum msg_type_t msg_type;       /*!< Type of message (most message types have known length) */
-    uint16_t ext_data_mask;         /*!< AND mask used to select the extended info from the format_id */
-    uint32_t msg_len;               /*!< Expected message length in bytes (0 - unknown at compile time) */
+    decode_op_t *plan;              /*!< Decode plan - array of operations prepared from the linked list */
+    uint32_t plan_size;             /*!< Number of operations in the decode plan */
     uint32_t counter;               /*!< Number of same message type received and successfully processed after
                                      *   reset, sleep or single-shot, snap-shot. */
     uint32_t counter_total;         /*!< Total number of same message type received and successfully processed */
     uint32_t total_data_received;   /*!< Total number of words received with this message type - including the FMT word */
     double time_last_message;       /*!< Time stamp value [s] - time when the last message was logged */
+    enum parallel_print_t parallel_print; /*!< Parallel printing possible for this message type */
+    bool not_selected;              /*!< true - the message is only counted, but not decoded (-select=...) */
+    bool size_verified;             /*!< true - a message with verified_size has been printed without errors */
+    uint32_t verified_size;         /*!< Size [bytes] of the last message printed without decoding errors */
+    struct column_table *columns;   /*!< Column export data (-columns), NULL = not prepared yet */
+    struct message_query *query;    /*!< Values of the -query=... conditions, NULL = no condition for this message */
+    enum msg_type_t msg_type;       /*!< Type of message (most message types have known length) */
+    uint16_t ext_data_mask;         /*!< AND mask used to select the extended info from the format_id */
+    uint32_t msg_len;               /*!< Expected message length in bytes (0 - unknown at compile time) */
+    uint32_t rate_window_no;        /*!< Window of the logging rate statistics in which the counters below were updated */
+    uint32_t rate_window_messages;  /*!< Number of messages in this window (-rate=N) */
+    uint32_t rate_window_words;     /*!< Number of words in this window */
+    uint32_t peak_window_messages;  /*!< Number of messages in the window with the most words of this message type */
+    uint32_t peak_window_words;     /*!< Number of words in that window */
+    double peak_window_start;       /*!< Start time of that window [s] */
+    const char *message_name;       /*!< Name of this message type - i.e. MSG2_NAME */
     value_format_t *format;         /*!< Pointer to start of a linked list with formatting data */
 } msg_data_t;
 
 
+/**
+ * @brief Data of a format ID needed for the framing and assembly of every message in the
+ *        dense g_fmt_info[] table (see prepare_format_info()). The msg_data_t structure
+ *        of the message is accessed only when the message is decoded.
+ */
+typedef struct
+{
+    msg_data_t *p_fmt;              /*!< Formatting definitions (NULL - format ID not defined) */
+    uint32_t msg_len;               /*!< Expected message length in bytes (0 - unknown at compile time) */
+    uint16_t ext_data_mask;         /*!< AND mask used to select the extended info from the format_id */
+    uint8_t msg_type;               /*!< Type of message (enum msg_type_t) */
+} fmt_info_t;
+
+
 /***** Global variables *****/
 extern msg_data_t *g_fmt[MAX_FMT_IDS]; /*!< Pointers to structures with formatting definitions */
+extern fmt_info_t g_fmt_info[MAX_FMT_IDS]; /*!< Decode data of all format IDs (see prepare_format_info()) */
 
 #define MSG_NAME_NOT_FOUND 0xFFFFFFFF
 
 
 /***** Function declarations *****/
 void print_format_decoding_information(void);
+void prepare_format_info(void);
 const char *get_format_id_name(unsigned fmt_id);
 void print_format_id_name(FILE *out);
 unsigned assign_fmt_id(unsigned no_fmt_ids, msg_data_t *p_fmt);
+void add_message_name_to_index(const char *name, uint32_t fmt_id);
 uint32_t find_message_format_index(const char *name);
 
 #endif   // _FORMAT_H
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    globals.c
+ * @author  B. Premzel
+ * @brief   Global data structures and memory allocation functions shared by the
+ *          RTEmsg command line utility and the decoding library (librtemsg).
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "errors.h"
+#include "rtemsg_config.h"
+
+
+/**********************************************/
+/*****  G L O B A L   V A R I A B L E S  ******/
+/**********************************************/
+
+CACHE_LINE_ALIGNED_COMPAT rte_msg_t g_msg;    /*!< Main data structure: file pointers, raw and assembled data, etc. */
+    // All other structures and buffers are allocated according to the amount of data in
+    // the binary file, specifications in format definition files etc.
+THREAD_LOCAL_COMPAT msg_context_t *g_ctx = &g_msg.ctx; /*!< Printing context (parallel printing workers use their own) */
+
+/**
+ * @brief  Check if the value is a power of 2
+ *
+ * @param n   The number to check.
+ *
+ * @return TRUE if the number is a power of 2, FALSE otherwise.
+ */
+
+bool is_power_of_two(size_t n)
+{
+    if (n == 0)
+        return false;
+
+    double log2_val = log2((double)n);
+    return ceil(log2_val) == floor(log2_val);
+}
+
+
+/* @brief Memory usage by the allocation names (see allocate_memory()) */
+static struct
+{
+    mutex_compat_t lock;            /*!< Protects the memory usage counters */
+    bool lock_initialized;          /*!< The first allocation is done before the threads are started */
+    memory_usage_t name[MAX_MEMORY_NAMES + 1u]; /*!< The last entry accumulates the names not found in the table */
+    unsigned names;                 /*!< Number of used entries in the name[] */
+    const char *cached_name[MEMORY_NAME_CACHE_SIZE];  /*!< Name pointers found recently (see find_memory_usage()) */
+    memory_usage_t *cached_usage[MEMORY_NAME_CACHE_SIZE]; /*!< Counters of the cached_name[] */
+    size_t current;                 /*!< Total memory currently allocated */
+    size_t peak;                    /*!< Max. total memory allocated */
+} memory_usage;
+
+
+/**
+ * @brief Finds the memory usage counters of an allocation name. A new entry is added
+ *        for a new name. The names are usually string literals, so the counters are found
+ *        with the name pointer in a small direct mapped cache first - the parsing allocates
+ *        hundreds of thousands of objects with alternating names.
+ *        Must be called with the memory_usage.lock locked.
+ *
+ * @param memory_name  Name of the buffer or structure.
+ *
+ * @return Pointer to the memory usage counters.
+ */
+
+static memory_usage_t *find_memory_usage(const char *memory_name)
+{
+    if (memory_name == NULL)
+    {
+        memory_name = "?";
+    }
+
+    unsigned slot = (unsigned)(((uintptr_t)memory_name >> 3u) % MEMORY_NAME_CACHE_SIZE);
+
+    if (memory_usage.cached_name[slot] == memory_name)
+    {
+        return memory_usage.cached_usage[slot];
+    }
+
+    memory_usage_t *usage = NULL;
+
+    for (unsigned i = 0; i < memory_usage.names; i++)
+    {
+        if (strcmp(memory_usage.name[i].name, memory_name) == 0)
+        {
+            usage = &memory_usage.name[i];
+            break;
+        }
+    }
+
+    if (usage == NULL)
+    {
+        if (memory_usage.names >= MAX_MEMORY_NAMES)
+        {
+            usage = &memory_usage.name[MAX_MEMORY_NAMES];
+            usage->name = "other";
+        }
+        else
+        {
+            usage = &memory_usage.name[memory_usage.names++];
+            usage->name = memory_name;
+        }
+    }
+
+    memory_usage.cached_name[slot] = memory_name;
+    memory_usage.cached_usage[slot] = usage;
+    return usage;
+}
+
+
+/**
+ * @brief Updates the peak memory usage of an allocation name and the total peak.
+ *        Must be called with the memory_usage.lock locked.
+ *
+ * @param usage  Memory usage counters of the allocation name.
+ */
+
+static void update_peak_memory_usage(memory_usage_t *usage)
+{
+    if (usage->current > usage->peak)
+    {
+        usage->peak = usage->current;
+    }
+
+    if (memory_usage.current > memory_usage.peak)
+    {
+        memory_usage.peak = memory_usage.current;
+    }
+}
+
+
+/**
+ * @brief Adds the allocated memory to the memory usage counters of the allocation name.
+ *        It is used also for the memory not allocated with the allocate_memory()
+ *        (e.g. the mapped binary data file or a reallocated buffer).
+ *
+ * @param size          Number of bytes allocated.
+ * @param memory_name   Name of the buffer or structure.
+ */
+
+void count_allocated_memory(size_t size, const char *memory_name)
+{
+    if (!memory_usage.lock_initialized)
+    {
+        mutex_init_compat(&memory_usage.lock);
+        memory_usage.lock_initialized = true;
+    }
+
+    mutex_lock_compat(&memory_usage.lock);
+    memory_usage_t *usage = find_memory_usage(memory_name);
+    usage->current += size;
+    usage->allocations++;
+    memory_usage.current += size;
+    update_peak_memory_usage(usage);
+    mutex_unlock_compat(&memory_usage.lock);
+}
+
+
+/**
+ * @brief Subtracts the released memory from the memory usage counters of the allocation name.
+ *
+ * @param size          Number of bytes released.
+ * @param memory_name   Name used when the memory was allocated.
+ */
+
+void count_released_memory(size_t size, const char *memory_name)
+{
+    if (!memory_usage.lock_initialized)
+    {
+        return;
+    }
+
+    mutex_lock_compat(&memory_usage.lock);
+    memory_usage_t *usage = find_memory_usage(memory_name);
+    usage->current = (usage->current > size) ? (usage->current - size) : 0;
+    memory_usage.current = (memory_usage.current > size) ? (memory_usage.current - size) : 0;
+    mutex_unlock_compat(&memory_usage.lock);
+}
+
+
+/**
+ * @brief Moves an object allocated from a parse arena block from the "parseArena" memory
+ *        usage counters to the counters of the object name. The total is not changed.
+ *
+ * @param size          Size of the object in bytes.
+ * @param memory_name   Name of the object.
+ */
+
+static void count_parse_arena_object(size_t size, const char *memory_name)
+{
+    mutex_lock_compat(&memory_usage.lock);
+    memory_usage_t *arena = find_memory_usage("parseArena");
+    arena->current = (arena->current > size) ? (arena->current - size) : 0;
+    memory_usage_t *usage = find_memory_usage(memory_name);
+    usage->current += size;
+    usage->allocations++;
+    update_peak_memory_usage(usage);
+    mutex_unlock_compat(&memory_usage.lock);
+}
+
+
+/**
+ * @brief Returns the memory usage counters of all allocation names.
+ *        The counters may change while they are read if other threads are running.
+ *
+ * @param names  Output: number of entries in the returned array.
+ * @param peak   Output: max. total memory allocated.
+ *
+ * @return Pointer to the array of memory usage counters.
+ */
+
+const memory_usage_t *get_memory_usage(unsigned *names, size_t *peak)
+{
+    *names = memory_usage.names + ((memory_usage.name[MAX_MEMORY_NAMES].name != NULL) ? 1u : 0);
+    *peak = memory_usage.peak;
+    return memory_usage.name;
+}
+
+
+/**
+ * @brief Allocate memory for buffers and structures and initialize it to zero.
+ *        The function does not return to the caller if the memory cannot be allocated.
+ *        The memory is counted in the memory usage counters of the memory_name.
+ *
+ * @param size Size of the memory to allocate in bytes.
+ * @param memory_name Name of the buffer or structure for error reporting and memory usage report.
+ *
+ * @return  Pointer to the allocated memory buffer.
+ */
+
+void *allocate_memory(size_t size, const char *memory_name)
+{
+    if (size == 0)
+    {
+        report_fatal_error_and_exit(FATAL_BAD_MALLOC_PARAMETER, NULL, 0);
+    }
+
+    void *buffer = calloc(size, 1);   // Allocate and zero-initialize memory
+    if (buffer == NULL)
+    {
+        report_fatal_error_and_exit(FATAL_MALLOC_FAILED, memory_name, memory_usage.current);
+    }
+
+    count_allocated_memory(size, memory_name);
+    return buffer;
+}
+
+
+/**
+ * @brief Releases the memory allocated with the allocate_memory() and updates the
+ *        memory usage counters.
+ *
+ * @param buffer        Pointer to the memory (NULL - nothing to release).
+ * @param size          Size of the allocated memory in bytes.
+ * @param memory_name   Name used when the memory was allocated.
+ */
+
+void release_memory(void *buffer, size_t size, const char *memory_name)
+{
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    free(buffer);
+    count_released_memory(size, memory_name);
+}
+
+
+/**
+ * @brief  Allocates memory for a string that is large enough to store a copy of the input string.
+ *         Then copies the input string contents to the newly allocated string.
+ *
+ * @param string_to_duplicate    The string to duplicate.
+ *
+ * @return  Pointer to the duplicated string.
+ */
+
+char *duplicate_string(const char *string_to_duplicate)
+{
+    if (string_to_duplicate == NULL)
+    {
+        report_fatal_error_and_exit(FATAL_BAD_MALLOC_PARAMETER, NULL, 0);
+    }
+
+    size_t strSize = strlen(string_to_duplicate) + 1;
+    char *string_duplicate = allocate_memory(strSize, "StringDup");
+    strcpy_s(string_duplicate, strSize, string_to_duplicate);
+
+    return string_duplicate;
+}
+
+
+/**
+ * @brief Allocates memory from the arena used for the structures and texts prepared during
+ *        the format definition parsing. They are never released, so they are allocated
+ *        one after another from large memory blocks. The definitions of a message (value formats,
+ *        format strings, etc.) are therefore stored next to each other, which improves the cache
+ *        locality during the message printing. Larger buffers are allocated separately.
+ *        The arena is used by the main thread only.
+ *
+ * @param size          Size of the memory to allocate in bytes.
+ * @param alignment     Required alignment (power of 2).
+ * @param memory_name   Name of the buffer or structure for error reporting.
+ *
+ * @return  Pointer to the zero-initialized memory.
+ */
+
+static void *allocate_from_parse_arena(size_t size, size_t alignment, const char *memory_name)
+{
+    static char *arena_position = NULL;     // First free byte in the current arena block
+    static size_t arena_free = 0;           // Number of free bytes in the current arena block
+
+    if (size > PARSE_ARENA_MAX_OBJECT_SIZE)
+    {
+        return allocate_memory(size, memory_name);
+    }
+
+    if (size == 0)
+    {
+        report_fatal_error_and_exit(FATAL_BAD_MALLOC_PARAMETER, NULL, 0);
+    }
+
+    size_t padding = (size_t)(0u - (uintptr_t)arena_position) & (alignment - 1u);
+
+    if ((padding + size) > arena_free)
+    {
+        arena_position = (char *)allocate_memory(PARSE_ARENA_BLOCK_SIZE, "parseArena");
+        arena_free = PARSE_ARENA_BLOCK_SIZE;
+        padding = 0;
+    }
+
+    void *buffer = arena_position + padding;
+    arena_position += padding + size;
+    arena_free -= padding + size;
+
+    // The memory is counted under the object name - the "parseArena" remains with the unused memory
+    count_parse_arena_object(size, memory_name);
+
+    return buffer;
+}
+
+
+/**
+ * @brief Allocates zero-initialized memory for the structures prepared during the format
+ *        definition parsing. The memory cannot be released.
+ *        The function does not return to the caller if the memory cannot be allocated.
+ *
+ * @param size          Size of the memory to allocate in bytes.
+ * @param memory_name   Name of the structure for error reporting.
+ *
+ * @return  Pointer to the allocated memory.
+ */
+
+void *allocate_parse_memory(size_t size, const char *memory_name)
+{
+    return allocate_from_parse_arena(size, PARSE_ARENA_ALIGNMENT, memory_name);
+}
+
+
+/**
+ * @brief Copies a string prepared during the format definition parsing to the parse arena.
+ *        The memory cannot be released.
+ *
+ * @param string_to_duplicate    The string to duplicate.
+ *
+ * @return  Pointer to the duplicated string.
+ */
+
+char *duplicate_parse_string(const char *string_to_duplicate)
+{
+    if (string_to_duplicate == NULL)
+    {
+        report_fatal_error_and_exit(FATAL_BAD_MALLOC_PARAMETER, NULL, 0);
+    }
+
+    size_t strSize = strlen(string_to_duplicate) + 1;
+    char *string_duplicate = allocate_from_parse_arena(strSize, 1u, "StringDup");
+    memcpy(string_duplicate, string_to_duplicate, strSize);
+
+    return string_duplicate;
+}
+
+
+/*==== End of file ====*/
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    hex_text.h
+ * @author  B. Premzel
+ * @brief   Table based conversion of binary data to the hexadecimal (upper case,
+ *          with leading zeros) and binary text for the hex dumps and %B values.
+ *          The text is written to a buffer and the functions return a pointer
+ *          to the end of the written text. The buffer is not zero terminated.
+ ******************************************************************************/
+
+#ifndef _HEX_TEXT_H
+#define _HEX_TEXT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define HEX_TEXT_ROW(h) \
+    h "0" h "1" h "2" h "3" h "4" h "5" h "6" h "7" h "8" h "9" h "A" h "B" h "C" h "D" h "E" h "F"
+
+// Two hexadecimal digits of every byte value
+static const char hex_text_bytes[2u * 256u + 1u] =
+    HEX_TEXT_ROW("0") HEX_TEXT_ROW("1") HEX_TEXT_ROW("2") HEX_TEXT_ROW("3")
+    HEX_TEXT_ROW("4") HEX_TEXT_ROW("5") HEX_TEXT_ROW("6") HEX_TEXT_ROW("7")
+    HEX_TEXT_ROW("8") HEX_TEXT_ROW("9") HEX_TEXT_ROW("A") HEX_TEXT_ROW("B")
+    HEX_TEXT_ROW("C") HEX_TEXT_ROW("D") HEX_TEXT_ROW("E") HEX_TEXT_ROW("F");
+
+// Four binary digits of every nibble value
+static const char binary_text_nibbles[4u * 16u + 1u] =
+    "0000" "0001" "0010" "0011" "0100" "0101" "0110" "0111"
+    "1000" "1001" "1010" "1011" "1100" "1101" "1110" "1111";
+
+
+/**
+ * @brief Writes a byte as two hexadecimal digits.
+ *
+ * @param p      Pointer to the buffer
+ * @param value  Value to be written (8 bits)
+ *
+ * @return Pointer to the end of the written text
+ */
+
+static inline char *put_hex8(char *p, uint32_t value)
+{
+    memcpy(p, &hex_text_bytes[2u * (value & 0xFFu)], 2u);
+    return p + 2u;
+}
+
+
+/**
+ * @brief Writes a 16-bit value as four hexadecimal digits.
+ *
+ * @param p      Pointer to the buffer
+ * @param value  Value to be written (16 bits)
+ *
+ * @return Pointer to the end of the written text
+ */
+
+static inline char *put_hex16(char *p, uint32_t value)
+{
+    p = put_hex8(p, value >> 8u);
+    return put_hex8(p, value);
+}
+
+
+/**
+ * @brief Writes a 32-bit value as eight hexadecimal digits.
+ *
+ * @param p      Pointer to the buffer
+ * @param value  Value to be written
+ *
+ * @return Pointer to the end of the written text
+ */
+
+static inline char *put_hex32(char *p, uint32_t value)
+{
+    p = put_hex16(p, value >> 16u);
+    return put_hex16(p, value);
+}
+
+
+/**
+ * @brief Writes the lowest bits of a value as binary digits. The groups of eight bits
+ *        (counted from the lowest bit) are separated with the ' character (e.g. 10'00000001).
+ *
+ * @param p      Pointer to the buffer (at least 71 characters for 64 bits)
+ * @param value  Value to be written
+ * @param size   Number of bits to be written (1 ... 64)
+ *
+ * @return Pointer to the end of the written text
+ */
+
+static inline char *put_binary_digits(char *p, uint64_t value, uint32_t size)
+{
+    uint32_t bits = size % 8u;      // Bits of the highest (incomplete) group
+
+    for (uint32_t i = bits; i > 0; i--)
+    {
+        *p++ = ((value >> (size - bits + i - 1u)) & 1u) ? '1' : '0';
+    }
+
+    for (uint32_t shift = size - bits; shift > 0; shift -= 8u)
+    {
+        if (shift != size)          // Not the first group
+        {
+            *p++ = '\'';
+        }
+
+        uint32_t byte = (uint32_t)(value >> (shift - 8u)) & 0xFFu;
+        memcpy(p, &binary_text_nibbles[4u * (byte >> 4u)], 4u);
+        memcpy(p + 4u, &binary_text_nibbles[4u * (byte & 0x0Fu)], 4u);
+        p += 8u;
+    }
+
+    return p;
+}
+
+#endif  // _HEX_TEXT_H
+
+/*==== End of file ====*/
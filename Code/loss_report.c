@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    loss_report.c
+ * @author  B. Premzel
+ * @brief   Report of the data losses found during the decoding (-stat=loss).
+ *          A loss is either a data overrun mark added by the host utility in
+ *          the streaming mode or a too large timestamp difference between two
+ *          consecutive messages (see process_timestamp_value()). Its duration
+ *          is the time between the last message before and the first message
+ *          after the loss. The number of lost words and messages is estimated
+ *          from the average logging rate outside of the losses. The logging time
+ *          is the total duration of the segments of data without a loss. A new
+ *          segment also starts if the timestamps restart (e.g. a new snapshot).
+ *          The format IDs
+ *          of the last messages before every loss are kept in a ring buffer.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "format.h"
+#include "print_helper.h"
+#include "loss_report.h"
+
+
+/* @brief Data loss found during the decoding */
+typedef struct _loss_event_t
+{
+    enum loss_type_t type;          /*!< Data overrun or timestamp gap */
+    uint32_t message_no;            /*!< Number of the first message after the loss (0 - not decoded) */
+    double time_before;             /*!< Timestamp of the last message before the loss [s] */
+    double time_after;              /*!< Timestamp of the first message after the loss [s] */
+    bool duration_known;            /*!< Both timestamps are known and the time after is not earlier */
+    uint32_t recent_messages;       /*!< Number of messages in the recent_fmt_id[] */
+    uint32_t recent_fmt_id[LOSS_HISTORY_MESSAGES]; /*!< Format IDs of the messages before the loss (oldest first) */
+} loss_event_t;
+
+/* Upper limits of the loss duration distribution bins [s] (the last two bins: longer, unknown) */
+static const double duration_limit[LOSS_DURATION_BINS - 2u] = { 0.001, 0.01, 0.1, 1.0, 10.0 };
+
+/* Field widths for the distribution counters - the same as the column titles in MSG_LOSS_DURATIONS */
+static const int duration_width[LOSS_DURATION_BINS] = { 8, 9, 10, 9, 9, 9, 9 };
+
+
+/**
+ * @brief Adds the loss duration to the distribution.
+ *
+ * @param duration        Duration of the loss [s]
+ * @param duration_known  false - the duration could not be determined
+ */
+
+static void count_loss_duration(double duration, bool duration_known)
+{
+    loss_report_t *loss = &g_msg.loss;
+    unsigned bin = LOSS_DURATION_BINS - 1u;         // Unknown duration
+
+    if (duration_known)
+    {
+        loss->total_duration += duration;
+
+        for (bin = 0; bin < (LOSS_DURATION_BINS - 2u); bin++)
+        {
+            if (duration < duration_limit[bin])
+            {
+                break;
+            }
+        }
+    }
+
+    loss->duration_count[bin]++;
+}
+
+
+/**
+ * @brief Finishes the loss which has been detected before the current message.
+ *
+ * @param message_no  Number of the first message after the loss (0 - end of data)
+ * @param timestamp   Timestamp of this message [s]
+ */
+
+static void finish_pending_loss(uint32_t message_no, double timestamp)
+{
+    loss_report_t *loss = &g_msg.loss;
+    loss_event_t *event = loss->pending_saved ? &loss->event[loss->events - 1u] : NULL;
+    bool start_known = (event == NULL) || (event->recent_messages > 0);
+    bool duration_known = (message_no != 0) && start_known && (loss->messages > 0)
+        && (timestamp >= loss->last_timestamp);
+
+    count_loss_duration(timestamp - loss->last_timestamp, duration_known);
+
+    if (event != NULL)
+    {
+        event->message_no = message_no;
+        event->time_after = timestamp;
+        event->duration_known = duration_known;
+    }
+
+    loss->loss_pending = false;
+    loss->pending_saved = false;
+}
+
+
+/**
+ * @brief Saves a data loss detected before the current message. Called for the data overrun
+ *        marks and for the timestamp differences which are too large (-stat=loss only).
+ *
+ * @param type  Type of the loss
+ */
+
+void report_data_loss(enum loss_type_t type)
+{
+    loss_report_t *loss = &g_msg.loss;
+
+    if (!g_msg.param.loss_statistics_enabled)
+    {
+        return;
+    }
+
+    if (loss->loss_pending)
+    {
+        finish_pending_loss(0, 0);      // No message between two losses - duration unknown
+    }
+
+    if (type == LOSS_OVERRUN)
+    {
+        loss->overruns++;
+    }
+    else
+    {
+        loss->timestamp_gaps++;
+    }
+
+    loss->loss_pending = true;
+
+    if (loss->events >= MAX_LOSS_EVENTS)
+    {
+        return;         // The loss is only counted
+    }
+
+    if (loss->events >= loss->events_allocated)
+    {
+        uint32_t new_size = (loss->events_allocated == 0) ? 256u : (2u * loss->events_allocated);
+        loss_event_t *new_event = (loss_event_t *)realloc(loss->event, new_size * sizeof(loss_event_t));
+
+        if (new_event == NULL)
+        {
+            return;
+        }
+
+        loss->event = new_event;
+        loss->events_allocated = new_size;
+    }
+
+    loss_event_t *event = &loss->event[loss->events++];
+    *event = (loss_event_t){ .type = type, .time_before = loss->last_timestamp };
+
+    // Copy the format IDs of the last messages in the order of their decoding
+    uint32_t recent = (loss->messages < LOSS_HISTORY_MESSAGES) ? loss->messages : LOSS_HISTORY_MESSAGES;
+
+    for (uint32_t i = 0; i < recent; i++)
+    {
+        event->recent_fmt_id[i] = loss->recent_fmt_id[(loss->messages - recent + i) % LOSS_HISTORY_MESSAGES];
+    }
+
+    event->recent_messages = recent;
+    loss->pending_saved = true;
+}
+
+
+/**
+ * @brief Counts a decoded message for the average logging rate and saves its format ID
+ *        to the list of recent messages (-stat=loss only).
+ *
+ * @param fmt_id      Format ID of the message
+ * @param message_no  Number of the message
+ * @param words       Number of words of the message (including the FMT words)
+ * @param timestamp   Timestamp of the message [s]
+ */
+
+void count_message_for_loss_report(uint32_t fmt_id, uint32_t message_no, uint32_t words, double timestamp)
+{
+    loss_report_t *loss = &g_msg.loss;
+
+    // The first message, the first message after a loss, or the timestamps restarted
+    bool new_segment = (loss->messages == 0) || loss->loss_pending || (timestamp < loss->segment_start);
+
+    if (loss->loss_pending)
+    {
+        finish_pending_loss(message_no, timestamp);
+    }
+
+    if (new_segment)
+    {
+        loss->active_time += loss->segment_end - loss->segment_start;
+        loss->segment_start = timestamp;
+        loss->segment_end = timestamp;
+    }
+    else if (timestamp > loss->segment_end)
+    {
+        loss->segment_end = timestamp;
+    }
+
+    loss->recent_fmt_id[loss->messages % LOSS_HISTORY_MESSAGES] = fmt_id;
+    loss->messages++;
+    loss->words += words;
+    loss->last_timestamp = timestamp;
+}
+
+
+/**
+ * @brief Writes the names of the messages decoded before a loss. Consecutive messages of
+ *        the same type are written once together with their number.
+ *
+ * @param out    Pointer to the output file
+ * @param event  Pointer to the loss
+ */
+
+static void write_messages_before_loss(FILE *out, const loss_event_t *event)
+{
+    for (uint32_t i = 0; i < event->recent_messages; )
+    {
+        uint32_t fmt_id = event->recent_fmt_id[i];
+        uint32_t count = 1;
+
+        while (((i + count) < event->recent_messages) && (event->recent_fmt_id[i + count] == fmt_id))
+        {
+            count++;
+        }
+
+        fprintf(out, (i == 0) ? "%s" : ", %s", get_format_id_name(fmt_id));
+
+        if (count > 1u)
+        {
+            fprintf(out, " x%u", count);
+        }
+
+        i += count;
+    }
+}
+
+
+/**
+ * @brief Writes the detected losses to the Stat_losses.csv file.
+ *
+ * @param words_per_second     Average logging rate outside of the losses [words/s] (0 - unknown)
+ * @param messages_per_second  Average logging rate outside of the losses [messages/s]
+ */
+
+static void write_loss_events(double words_per_second, double messages_per_second)
+{
+    const loss_report_t *loss = &g_msg.loss;
+    FILE *out = fopen(RTE_STAT_LOSSES_FILE, "w");
+
+    if (out == NULL)
+    {
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, RTE_STAT_LOSSES_FILE);
+        return;
+    }
+
+    fprintf(out, get_message_text(MSG_LOSS_FILE_HEADER));
+
+    for (uint32_t i = 0; i < loss->events; i++)
+    {
+        const loss_event_t *event = &loss->event[i];
+
+        fprintf(out, "%u;%s;", i + 1u, get_message_text(
+            (event->type == LOSS_OVERRUN) ? MSG_LOSS_TYPE_OVERRUN : MSG_LOSS_TYPE_TIMESTAMP_GAP));
+
+        if (event->message_no != 0)
+        {
+            print_message_number(out, event->message_no);
+        }
+
+        fprintf(out, ";");
+
+        if (event->recent_messages > 0)
+        {
+            fprintf(out, "%.6f", event->time_before);
+        }
+
+        fprintf(out, ";");
+
+        if (event->message_no != 0)
+        {
+            fprintf(out, "%.6f", event->time_after);
+        }
+
+        if (event->duration_known && (words_per_second > 0))
+        {
+            double duration = event->time_after - event->time_before;
+            fprintf(out, ";%.6f;%.0f;%.0f;", duration,
+                duration * words_per_second, duration * messages_per_second);
+        }
+        else if (event->duration_known)
+        {
+            fprintf(out, ";%.6f;;;", event->time_after - event->time_before);
+        }
+        else
+        {
+            fprintf(out, ";;;;");
+        }
+
+        write_messages_before_loss(out, event);
+        fprintf(out, "\n");
+    }
+
+    fclose(out);
+}
+
+
+/**
+ * @brief Writes the data loss summary to Stat_main.log and the list of losses to the
+ *        Stat_losses.csv file (-stat=loss). The current folder must be the output folder.
+ */
+
+void write_loss_report(void)
+{
+    loss_report_t *loss = &g_msg.loss;
+    FILE *out = g_msg.file.statistics_log;
+
+    if (!g_msg.param.loss_statistics_enabled)
+    {
+        return;
+    }
+
+    if (loss->loss_pending)
+    {
+        finish_pending_loss(0, 0);      // Loss at the end of the binary data
+    }
+
+    // Average logging rate without the time of the losses
+    double words_per_second = 0;
+    double messages_per_second = 0;
+
+    double active_time = loss->active_time + (loss->segment_end - loss->segment_start);
+
+    if ((loss->messages > 1u) && (active_time > 0))
+    {
+        words_per_second = (double)loss->words / active_time;
+        messages_per_second = (double)loss->messages / active_time;
+    }
+
+    uint32_t unknown_durations = loss->duration_count[LOSS_DURATION_BINS - 1u];
+    uint32_t losses = loss->overruns + loss->timestamp_gaps;
+
+    write_loss_events(words_per_second, messages_per_second);
+
+    if (out != NULL)
+    {
+        fprintf(out, get_message_text(MSG_LOSS_SUMMARY),
+            loss->overruns, loss->timestamp_gaps, loss->total_duration);
+
+        if ((words_per_second <= 0) || ((losses > 0) && (unknown_durations >= losses)))
+        {
+            fprintf(out, get_message_text(MSG_LOSS_ESTIMATE_UNKNOWN));
+        }
+        else
+        {
+            fprintf(out, get_message_text(MSG_LOSS_ESTIMATE),
+                loss->total_duration * words_per_second, loss->total_duration * messages_per_second,
+                words_per_second, messages_per_second);
+
+            if (unknown_durations > 0)
+            {
+                fprintf(out, get_message_text(MSG_LOSS_ESTIMATE_INCOMPLETE), unknown_durations);
+            }
+        }
+
+        fprintf(out, get_message_text(MSG_LOSS_DURATIONS));
+
+        for (unsigned i = 0; i < LOSS_DURATION_BINS; i++)
+        {
+            fprintf(out, "%*u", duration_width[i], loss->duration_count[i]);
+        }
+
+        if (losses > loss->events)
+        {
+            fprintf(out, get_message_text(MSG_LOSS_EVENTS_NOT_SAVED), loss->events);
+        }
+    }
+
+    free(loss->event);
+    loss->event = NULL;
+    loss->events = 0;
+    loss->events_allocated = 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    loss_report.h
+ * @author  B. Premzel
+ * @brief   Header file for the data overrun and timestamp gap report (-stat=loss).
+ ******************************************************************************/
+
+#ifndef _LOSS_REPORT_H
+#define _LOSS_REPORT_H
+
+#include <stdint.h>
+
+
+/*@brief Type of the detected data loss */
+enum loss_type_t
+{
+    LOSS_OVERRUN,                   /*!< Data overrun reported by the host utility (streaming mode) */
+    LOSS_TIMESTAMP_GAP              /*!< Too large timestamp difference between consecutive messages */
+};
+
+
+/***** Function declarations *****/
+void report_data_loss(enum loss_type_t type);
+void count_message_for_loss_report(uint32_t fmt_id, uint32_t message_no, uint32_t words, double timestamp);
+void write_loss_report(void);
+
+#endif  // _LOSS_REPORT_H
+
+/*==== End of file ====*/
@@ -25,97 +25,26 @@
 #include "print_message.h"
 #include "print_helper.h"
 #include "read_bin_data.h"
-#include "parse_directive.h"
+#include "fmt_cache.h"
 #include "cmd_line.h"
 #include "utf8_helpers.h"
+#include "parallel_decode.h"
+#include "profile.h"
+#include "column_export.h"
+#include "decode_index.h"
+#include "batch_mode.h"
+#include "msg_framing.h"
+#include "side_channel.h"
+#include "compress_output.h"
+#include "server_mode.h"
+#include "out_file_decimation.h"
 
 #ifdef _MSC_VER
 #pragma comment(linker, "/STACK:8388608")       // Increase stack size to 8 MB
 #endif
 
-
-/**********************************************/
-/*****  G L O B A L   V A R I A B L E S  ******/
-/**********************************************/
-
-rte_msg_t g_msg;    /*!< Main data structure: file pointers, raw and assembled data, etc. */
-    // All other structures and buffers are allocated according to the amount of data in
-    // the binary file, specifications in format definition files etc.
-
 static unsigned number_of_fatal_exceptions = 0; // Prevents lockup during fatal error reporting
 
-/**
- * @brief  Check if the value is a power of 2
- *
- * @param n   The number to check.
- *
- * @return TRUE if the number is a power of 2, FALSE otherwise.
- */
-
-bool is_power_of_two(size_t n)
-{
-    if (n == 0)
-        return false;
-
-    double log2_val = log2((double)n);
-    return ceil(log2_val) == floor(log2_val);
-}
-
-
-/**
- * @brief Allocate memory for buffers and structures and initialize it to zero.
- *        The function does not return to the caller if the memory cannot be allocated.
- *
- * @param size Size of the memory to allocate in bytes.
- * @param memory_name Name of the buffer or structure for error reporting.
- *
- * @return  Pointer to the allocated memory buffer.
- */
-
-void *allocate_memory(size_t size, const char *memory_name)
-{
-    static size_t memory_allocated = 0;
-
-    if (size == 0)
-    {
-        report_fatal_error_and_exit(FATAL_BAD_MALLOC_PARAMETER, NULL, 0);
-    }
-
-    void *buffer = calloc(size, 1);   // Allocate and zero-initialize memory
-    if (buffer == NULL)
-    {
-        report_fatal_error_and_exit(FATAL_MALLOC_FAILED, memory_name, memory_allocated);
-    }
-
-    memory_allocated += size;
-    return buffer;
-}
-
-
-/**
- * @brief  Allocates memory for a string that is large enough to store a copy of the input string.
- *         Then copies the input string contents to the newly allocated string.
- *
- * @param string_to_duplicate    The string to duplicate.
- *
- * @return  Pointer to the duplicated string.
- */
-
-char *duplicate_string(const char *string_to_duplicate)
-{
-    if (string_to_duplicate == NULL)
-    {
-        report_fatal_error_and_exit(FATAL_BAD_MALLOC_PARAMETER, NULL, 0);
-    }
-
-    size_t strSize = strlen(string_to_duplicate) + 1;
-    char *string_duplicate = allocate_memory(strSize, "StringDup");
-    strcpy_s(string_duplicate, strSize, string_to_duplicate);
-
-    return string_duplicate;
-}
-
-
 /**
  * @brief Prints command line parameters and RTEmsg utility version and revision.
  * 
@@ -177,6 +106,7 @@ static void check_print_errors(void)
     check_file_errors(g_msg.file.main_log, RTE_MAIN_LOG_FILE);
     check_file_errors(g_msg.file.statistics_log, RTE_STAT_MAIN_FILE);
     check_file_errors(g_msg.file.timestamps, RTE_MSG_TIMESTAMPS_FILE);
+    check_file_errors(g_msg.file.rates, RTE_STAT_RATES_FILE);
 
     // Check the user defined output files
     for (size_t i = 32U; i < g_msg.enums_found; i++)
@@ -200,12 +130,15 @@ static void print_data_file_name_and_date(void)
 
     fprintf(out, TXT_MSG_RTEMSG_VERSION, RTEMSG_VERSION, RTEMSG_SUBVERSION, RTEMSG_REVISION, __DATE__);
 
+    // The data read from the standard input is dated with the start of the decoding
     struct _stat stbuf;
-    int rez = _stat(g_msg.param.data_file_name, &stbuf);
+    bool from_stdin = (strcmp(g_msg.param.data_file_name, RTE_STDIN_DATA_FILE) == 0);
+    int rez = from_stdin ? 0 : _stat(g_msg.param.data_file_name, &stbuf);
     if (rez == 0)
     {
         fprintf(out, get_message_text(MSG_BIN_FILE_NAME_DATE));
-        struct tm *tmp = localtime(&stbuf.st_mtime);
+        time_t file_time = from_stdin ? time(NULL) : stbuf.st_mtime;
+        struct tm *tmp = localtime(&file_time);
         strftime(g_msg.date_string, BIN_FILE_DATE_LENGTH, "%Y-%m-%d %H:%M:%S", tmp);
         fprintf(out, "\"%s\" %s\n", g_msg.param.data_file_name, g_msg.date_string);
     }
@@ -226,13 +159,10 @@ static void create_timestamps_file(void)
     open_output_folder();
     if (g_msg.param.create_timestamp_file)
     {
-        g_msg.file.timestamps = fopen(RTE_MSG_TIMESTAMPS_FILE, "w");
+        g_msg.file.timestamps = compressed_fopen(RTE_MSG_TIMESTAMPS_FILE, "w");
         if (g_msg.file.timestamps != NULL)
         {
-#if defined STREAM_BUFF_SIZE
-            char *stream_buffer = allocate_memory(STREAM_BUFF_SIZE, "strBuff");
-            int rez = setvbuf(g_msg.file.main_log, stream_buffer, _IOFBF, STREAM_BUFF_SIZE);
-#endif
+            set_output_file_buffer(g_msg.file.timestamps);
             fprintf(g_msg.file.timestamps, get_message_text(MSG_TIMESTAMP_DIFFERENCES));
             switch (g_msg.param.time_unit)
             {
@@ -321,6 +251,7 @@ static void report_fatal_error_during_message_decoding(void)
             fprintf(g_msg.file.main_log, "\nFatal exception occurred while processing binary files!");
         }
         fprintf(g_msg.file.error_log, "\nFatal exception occurred while processing binary files!");
+        close_compressed_files();
         _fcloseall();
         (void)_wchdir(g_msg.file.start_folder);      // Return to the initial working directory
     }
@@ -339,7 +270,8 @@ static void report_fatal_error_during_format_file_processing(void)
         fprintf(g_msg.file.error_log, "\nFatal exception occurred during format file processing!");
         // TODO: Report the name and line of the currently processed format definition file
         open_output_folder();
-        remove_file(RTE_MAIN_LOG_FILE);             // Remove the Main.log file
+        remove_file(compressed_file_name(RTE_MAIN_LOG_FILE));   // Remove the Main.log file
+        close_compressed_files();
         _fcloseall();
         (void)_wchdir(g_msg.file.start_folder);     // Return to the initial working directory
     }
@@ -353,9 +285,10 @@ static void report_fatal_error_during_format_file_processing(void)
 
 static void remove_invalid_files(void)
 {
+    close_compressed_files();
     _fcloseall();
     open_output_folder();               // Open the folder where output files are created
-    remove_file(RTE_MAIN_LOG_FILE);
+    remove_file(compressed_file_name(RTE_MAIN_LOG_FILE));
     remove_file(RTE_STAT_MAIN_FILE);
     remove_file(RTE_STAT_MSG_COUNTERS_FILE);
     remove_file(RTE_STAT_MISSING_MSGS_FILE);
@@ -392,23 +325,6 @@ static void print_notes_and_warnings(void)
 }
 
 
-/**
- * @brief Prepare the data structure for the topmost format definition used
- *        for MSG1_SYS_STREAMING_MODE_LOGGING (internal system messages).
- *        This is the only system message format structure not initialized
- *        during 'rte_system.h' format file parsing.
- */
-
-static void prepare_sys_msg_fmt_structure(void)
-{
-    msg_data_t *p_fmt = allocate_memory(sizeof(msg_data_t), "sysFmt");
-    g_fmt[MSG1_SYS_STREAMING_MODE_LOGGING] = p_fmt;
-    p_fmt->msg_len = 4u;
-    p_fmt->msg_type = TYPE_MSG0_4;
-    p_fmt->message_name = "sys";
-}
-
-
 /**
  * @brief Main function for processing binary data files.
  * 
@@ -424,8 +340,14 @@ static void Process_binary_data_file(int argc, char *argv[])
     print_cmd_line_parameters(argc, argv);
     print_bin_file_header_info();
     check_timestamp_diff_values();      // Check the values of the -ts command line argument (the timestamp period is known here)
+    start_profiling();                  // Measure the execution times if enabled with -profile
+    prepare_decode_index();             // Load the index file or start writing it (-index=file)
+
+    uint64_t start = profile_start();
     load_data_from_binary_file();
+    profile_stop(PROFILE_LOAD_DATA, start);
     reset_statistics();
+    resume_decoding_from_index();
 
     if (data_in_the_buffer() == NO_DATA_FOUND)
     {
@@ -438,25 +360,77 @@ static void Process_binary_data_file(int argc, char *argv[])
         fprintf(g_msg.file.main_log, "\n");
     }
 
-    // Allocate buffer for message processing
-    size_t buffer_size = sizeof(uint32_t) * 4u * (1u + (size_t)g_msg.hdr_data.max_msg_blocks) + 20u;
-
-    if (buffer_size < (256U + 16U))
-    {
-        buffer_size = 256U + 16U;        // The buffer should accommodate at least the MSGX-style message
-    }
-
-    g_msg.assembled_msg = (uint32_t *)allocate_memory(buffer_size, "Asm_msg");
-    prepare_sys_msg_fmt_structure();
+    prepare_message_assembly();         // Buffer for the assembled messages and the system message format
+    prepare_message_framing();          // Packet length table for the framing of the binary data
+    compile_decode_plans();             // The OUT_FILE() files have been opened during the format file parsing
+    start_parallel_printing();
+    start_side_channel();               // Timestamps.csv and value statistics thread
 
     print_msg_intro();
     process_bin_data_worker();           // Process the loaded binary data
+    flush_side_channel();
+    close_column_files();                // Write the remaining values (-columns)
+    flush_decimated_out_files();         // Write the last min/max values (OUT_FILE() with MINMAX=T)
+    close_decode_index();
+
+    start = profile_start();
     write_statistics_to_file();          // Generate various statistics files (if enabled)
+    profile_stop(PROFILE_WRITE_STATISTICS, start);
+    write_profile_report();
     report_decode_error_summary();
     print_notes_and_warnings();
 }
 
 
+/**
+ * @brief Decodes all binary data files defined in the command line or parameter file (-batch).
+ *        Every file is decoded to its own subfolder of the output folder.
+ *
+ * @param argc Number of command line parameters
+ * @param argv Array of command line parameter strings
+ */
+
+static void process_batch_files(int argc, char *argv[])
+{
+    prepare_batch_decoding();
+
+    while (start_next_batch_file())
+    {
+        create_timestamps_file();
+        Process_binary_data_file(argc, argv);
+        check_print_errors();
+        finish_batch_file();
+    }
+
+    finish_batch_decoding();
+}
+
+
+/**
+ * @brief Decodes the jobs of the decode server (-server=name) until it is stopped by a client.
+ *        Every job is decoded to the output folder defined by the client.
+ *
+ * @param argc Number of command line parameters
+ * @param argv Array of command line parameter strings
+ */
+
+static void process_server_jobs(int argc, char *argv[])
+{
+    prepare_server_jobs();
+
+    while (start_next_server_job())
+    {
+        create_timestamps_file();
+        Process_binary_data_file(argc, argv);
+        check_print_errors();
+        finish_batch_file();
+        finish_server_job();
+    }
+
+    finish_decode_server();
+}
+
+
 /**
  * @brief RTEmsg - Main function for the binary data decoding utility.
  *        Refer to the RTEdbg library and tools manual for more details.
@@ -483,6 +457,7 @@ int main(int argc, char *argv[])
     }
 
     create_error_file();                // Create default output files and load error messages.
+    start_decode_server(argv);          // Open the socket or take over the restarted server's one (-server=name).
 
     __try
     {
@@ -490,10 +465,7 @@ int main(int argc, char *argv[])
         create_timestamps_file();
         remove_old_files();
 
-        // Initialize the first 32 enum locations for filter information.
-        g_msg.enums_found = NUMBER_OF_FILTER_BITS;
-
-        parse_fmt_file(RTE_MAIN_FMT_FILE, NULL);    // Begin parsing the main format file.
+        load_format_definitions();      // Parse the format definition files or load the compiled ones.
     }
     __except (EXCEPTION_EXECUTE_HANDLER)
     {
@@ -513,6 +485,12 @@ int main(int argc, char *argv[])
             utf8_print_string(text, 0);
         }
         remove_invalid_files();
+
+        if (g_msg.param.server_name != NULL)
+        {
+            reject_server_jobs(EXIT_FATAL_FMT_PARSING_ERRORS);  // Wait for the corrected format definitions.
+        }
+
         (void)_wchdir(g_msg.file.start_folder);      // Return to the initial working directory.
         return EXIT_FATAL_FMT_PARSING_ERRORS;
     }
@@ -524,7 +502,18 @@ int main(int argc, char *argv[])
     {
         __try
         {
-            Process_binary_data_file(argc, argv);
+            if (g_msg.param.batch_mode)
+            {
+                process_batch_files(argc, argv);
+            }
+            else if (g_msg.param.server_name != NULL)
+            {
+                process_server_jobs(argc, argv);
+            }
+            else
+            {
+                Process_binary_data_file(argc, argv);
+            }
         }
         __except (EXCEPTION_EXECUTE_HANDLER)
         {
@@ -544,6 +533,7 @@ int main(int argc, char *argv[])
 
     check_print_errors();
     print_execution_time(begin_parsing, end_parsing);
+    close_compressed_files();
     _fcloseall();
     (void)_wchdir(g_msg.file.start_folder);      // Return to the initial working directory.
     return ret_value;
@@ -44,15 +44,43 @@ typedef struct _param_t
     char *working_folder;               //!< Output folder in which all output files are created
     char *fmt_folder;                   //!< Folder containing formatting specification files
     char *data_file_name;               //!< Binary data file name
+    char **data_file_names;             //!< Names of all binary data files defined (more than one with -batch)
+    unsigned data_files;                //!< Number of binary data file names
+    bool batch_mode;                    //!< Decode every binary data file to its own output subfolder (-batch)
+    bool merge_logs;                    //!< Merge the Main.log files of all data files ordered by timestamps (-merge)
+    uint32_t error_report_limit;        //!< Number of errors of each type printed in detail (-errors=K), 0 - all
+    uint32_t rate_window;               //!< Length of the logging rate statistics window [ms] (-rate=N), 0 - disabled
+    uint32_t compression;               //!< Compression tool of the output files (-compress=tool), 0 - not compressed
     bool check_syntax_and_compile;      //!< Check the format file syntax and generate format definition headers
     bool create_backup;                 //!< Enable the parser to generate file backups
     bool value_statistics_enabled;      //!< Execute statistics and print report
     bool message_statistics_enabled;    //!< Generate files with information about number of received messages and missed messages
+    bool loss_statistics_enabled;       //!< Report the data overruns and timestamp gaps (-stat=loss)
     bool debug;                         //!< Enable additional debugging support
     bool create_timestamp_file;         //!< Generate statistic files for check of timestamps
     bool purge_defines;                 //!< Eliminate all #define directives from the format files during parsing
     bool additional_newline;            //!< Print additional newline after information for every message to Main.log
     bool codepage_utf8;                 //!< Use the CP_UTF8 while printing the parsing error messages to the console
+    bool follow_mode;                   //!< Decode the data appended to a streaming mode binary file until stopped
+    unsigned follow_timeout;            //!< Finish the follow mode after this time [s] without new data (0 - no limit)
+    unsigned decode_threads;            //!< Number of threads printing the decoded messages (0/1 - no parallel printing)
+    unsigned output_buffer_size;        //!< Size of the output file buffers [kB] (0 - default stdio buffers)
+    bool low_memory;                    //!< Decode the post-mortem and single-shot data in blocks (-lowmem)
+    bool profile;                       //!< Write the execution time profile of the decoding to Stat_main.log
+    char *fmt_cache_file;               //!< Cache file for the compiled format definitions (-fmtcache=file)
+    bool column_export;                 //!< Write the decoded values to binary column files (-columns)
+    bool columns_only;                  //!< Export the values without printing the message texts (-columns=only)
+    char *select_names;                 //!< Comma separated names of the decoded messages (-select=...), NULL - all
+    char *query;                        //!< Value conditions of the decoded messages (-query=...), NULL - all
+    unsigned query_context;             //!< Number of messages decoded after each message matching the query (-context=N)
+    bool time_window;                   //!< Decode only the messages in the time window (-window=t1;t2)
+    double window_start;                //!< Start of the decoded time window [s]
+    double window_end;                  //!< End of the decoded time window [s]
+    bool message_range;                 //!< Decode only the messages first_message ... last_message (-range=N1;N2)
+    uint32_t first_message;             //!< Number of the first decoded message
+    uint32_t last_message;              //!< Number of the last decoded message
+    char *index_file;                   //!< Index file for the seeking in the binary data file (-index=file)
+    char *server_name;                  //!< Local socket or named pipe of the decode server (-server=name), NULL - no server
     char time_unit;                     //!< Specify time unit for the timestamps
     double time_multiplier;             //!< Time multiplier - used for printing of timestamps
     char number_of_format_id_bits;      //!< Number of bits used for the format ID
@@ -77,6 +105,7 @@ typedef struct _rte_files_t
     FILE *error_log;                /*!< Pointer to the Error.log file structure */
     FILE *statistics_log;           /*!< Pointer to the Stat_main.txt file structure */
     FILE *timestamps;               /*!< Pointer to the Timestamps.csv file structure */
+    FILE *rates;                    /*!< Pointer to the Stat_rates.csv file structure (-rate=N) */
 } rte_files_t;
 
 
@@ -141,6 +170,10 @@ typedef struct _enum_data_t
         double memo_value;           /*!< MEMO:     memorizing of temporary values */
     } u;
     char *file_name;                 /*!< Name of the file defined with OUT_FILE() or IN_FILE() */
+    uint32_t *text_offset;           /*!< IN_FILE and Y_TEXT_TYPE: offsets of the texts in 'in_file_txt' */
+    uint32_t no_texts;               /*!< IN_FILE and Y_TEXT_TYPE: number of texts in 'in_file_txt' */
+    uint32_t decimation;             /*!< OUT_FILE: only every N-th message is written (0 - all messages) */
+    double minmax_window;            /*!< OUT_FILE: time window [s] for the min/max decimation (0 - not used) */
 } enum_data_t;
 
 
@@ -170,9 +203,145 @@ typedef struct _error_log_t
     uint32_t data1;           //!< Additional data saved
     uint32_t data2;           //!< Additional data saved
     const char *fmt_text;     //!< Pointer to formatting string for which the problem was found
+    bool not_shown;           //!< The error is only counted (see -errors=K)
 } error_log_t;
 
 
+/**
+ * @brief Summary of the errors of one type which have not been printed in detail
+ *        because the limit defined with the -errors=K argument has been reached.
+ */
+typedef struct _error_summary_t
+{
+    uint32_t count;           //!< Number of errors not printed
+    uint32_t first_message;   //!< Number of the message with the first error not printed
+    uint32_t last_message;    //!< Number of the message with the last error not printed
+    uint32_t fmt_id;          //!< Format ID of the message with the first error not printed
+    uint32_t data1;           //!< Additional data of the first error not printed
+    uint32_t data2;
+} error_summary_t;
+
+
+/**
+ * @brief Number of messages and words logged in one time window of the logging rate
+ *        statistics (-rate=N).
+ */
+typedef struct _rate_window_t
+{
+    double start;             //!< Start time of the window [s]
+    uint32_t messages;        //!< Number of messages in the window
+    uint32_t words;           //!< Number of words (including the FMT words) in the window
+    uint32_t top_fmt_id;      //!< Format ID of the message type with the most words in the window
+    uint32_t top_words;       //!< Number of words of this message type in the window
+} rate_window_t;
+
+
+/**
+ * @brief Logging rate statistics - the numbers of messages and words in consecutive time
+ *        windows of g_msg.param.rate_window milliseconds (see rate_stats.c).
+ */
+typedef struct _rate_stats_t
+{
+    int64_t window_index;     //!< Timestamp of the current window divided by the window length
+    uint32_t window_no;       //!< Sequence number of the current window (0 - no message found yet)
+    rate_window_t current;    //!< Counters of the current window
+    rate_window_t peak[TOP_MESSAGES]; //!< Windows with the highest number of words
+    uint32_t peak_windows;    //!< Number of windows in the peak[]
+} rate_stats_t;
+
+
+/**
+ * @brief Data overruns and timestamp gaps found during the decoding (-stat=loss).
+ *        The detected losses are stored in the event[] array (see loss_report.c).
+ */
+typedef struct _loss_report_t
+{
+    struct _loss_event_t *event; //!< Detected losses
+    uint32_t events;          //!< Number of losses in the event[]
+    uint32_t events_allocated; //!< Size of the event[]
+    uint32_t overruns;        //!< Number of data overruns reported by the host utility
+    uint32_t timestamp_gaps;  //!< Number of large timestamp differences between consecutive messages
+    bool loss_pending;        //!< The message after the last loss has not been decoded yet
+    bool pending_saved;       //!< The pending loss is the last one in the event[]
+    double total_duration;    //!< Total duration of the losses with a known duration [s]
+    uint32_t duration_count[LOSS_DURATION_BINS]; //!< Distribution of the loss durations
+    uint32_t messages;        //!< Number of decoded messages
+    uint64_t words;           //!< Number of words of these messages
+    double active_time;       //!< Total duration of the finished segments without a loss [s]
+    double segment_start;     //!< Timestamp of the first message of the current segment [s]
+    double segment_end;       //!< Max. timestamp of the messages in the current segment [s]
+    double last_timestamp;    //!< Timestamp of the last decoded message [s]
+    uint32_t recent_fmt_id[LOSS_HISTORY_MESSAGES]; //!< Format IDs of the last decoded messages (ring buffer)
+} loss_report_t;
+
+
+/**
+ * @brief Per-message printing context. It contains a copy of the message prepared by the
+ *        sequential decoding (framing and timestamp reconstruction) together with the values
+ *        and errors prepared while the message is printed. The main thread prints with g_msg.ctx,
+ *        every parallel printing worker has its own context (see parallel_decode.c).
+ */
+typedef struct _msg_context_t
+{
+    FILE *main_log;                 //!< Main.log or the output buffer of a printing worker
+    uint32_t *assembled_msg;        //!< Message data (including additional data bits)
+    uint32_t asm_size;              //!< Assembled message size [bytes]
+    uint32_t fmt_id;                //!< Format ID of the message
+    uint32_t message_cnt;           //!< Number of the message
+    double timestamp;               //!< Full timestamp of the message in seconds
+    bool mark_problematic_tstamp;   //!< Add '#' before the message number
+
+    value_t value;                  //!< Currently processed/printed numerical value
+
+    /* Error information logged during a single message decoding */
+    error_log_t error_log[MAX_ERRORS_IN_SINGLE_MESSAGE];
+    uint32_t msg_error_counter;     //!< Errors detected during single message decoding
+    uint32_t msg_errors_shown;      //!< Errors to be printed after the message (see -errors=K)
+    uint32_t error_value_no;        //!< 0 = first decoded value of message, 1 = second one, etc.
+                                    //!< The number applies to the %x - x = type
+    struct _print_profile_t *profile; //!< Printing time counters (NULL - profiling not enabled)
+} msg_context_t;
+
+
+/* State of the long timestamp search after a message (see long_timestamp_found()) */
+typedef struct _tstamp_checkpoint_t
+{
+    size_t   position;              /*!< Position after the FMT word - already_processed_data + index */
+    uint32_t old_timestamp_l;       /*!< Timestamp used for the check of the difference to the next message */
+    uint32_t tstamp_h_counter;      /*!< Number of timestamp.l overflows from the start of the search */
+} tstamp_checkpoint_t;
+
+
+/* Result of the last long timestamp search */
+typedef enum
+{
+    TSTAMP_SEARCH_STOPPED,          /*!< Stopped - no usable long timestamp found */
+    TSTAMP_SEARCH_END_OF_DATA,      /*!< End of the loaded data reached */
+    TSTAMP_SEARCH_LONG_TSTAMP       /*!< Long timestamp message found */
+} tstamp_search_end_t;
+
+
+/* Saved states and the result of the last long timestamp search. A later search that reaches
+ * one of the saved states continues exactly as the saved one and can use its result.
+ * The search depends on the half of the timestamp period in which the timestamp.old is,
+ * so the last search is saved for both halves. */
+typedef struct _tstamp_search_t
+{
+    tstamp_checkpoint_t *checkpoint; /*!< Saved search states (LONG_TSTAMP_CHECKPOINTS) in the position order */
+    uint32_t checkpoints;           /*!< Number of saved states */
+    uint32_t interval;              /*!< Number of messages between the saved states */
+    uint32_t messages;              /*!< Number of messages since the last saved state */
+    bool     valid;                 /*!< The saved states and result are valid */
+    tstamp_search_end_t end;        /*!< How the search ended */
+    size_t   end_position;          /*!< Position after the last word checked */
+    size_t   data_end;              /*!< End of the loaded data during the search */
+    uint32_t timestamp_h;           /*!< Value of the long timestamp found */
+    uint32_t counter_before;        /*!< tstamp_h_counter before the long timestamp message */
+    uint32_t counter_after;         /*!< tstamp_h_counter after the long timestamp message */
+    bool     difference_ok;         /*!< The long timestamp message follows the previous one closely */
+} tstamp_search_t;
+
+
 /* Timestamp processing */
 typedef struct _timestamp_t
 {
@@ -188,41 +357,56 @@ typedef struct _timestamp_t
     bool mark_problematic_tstamps;  /*!< Add asterisk before the message number */
     bool no_previous_tstamp;        /*!< The timestamp.old value is not valid */
     bool long_timestamp_found;      /*!< At least one long timestamp found */
+    tstamp_search_t search[2];      /*!< Saved long timestamp searches - for timestamp.old in the lower/upper half */
 } timestamp_t;
 
 
-/* @brief Main data structure */
+struct _msg_data_t;                     /* Formatting definitions of a message type (see format.h) */
+
+/* @brief Main data structure. The data used for every decoded message is at the start of the
+ *        structure (g_msg is aligned to the cache line) and the rarely used data at the end. */
 typedef struct _rte_msg_t
 {
-    rte_files_t file;                  /*!< Pointers to input and output files used during data decoding */
-    param_t param;                     /*!< Parsed values of command line parameters */
-    rtedbg_header_t rte_header;        /*!< Header of the embedded system debug structure dbgData */
-    rte_header_data_t hdr_data;        /*!< Pre-processed data from the RTEdbg structure header */
+    /* Binary data file processing variables (used for every data word) */
+    uint32_t *rte_buffer;               /*!< Pointer to data from the embedded system circular data logging buffer */
+    uint32_t index;                     /*!< Index to the rte_buffer */
+    uint32_t in_size;                   /*!< Total size of the loaded buffer [number of words] */
+    uint32_t *rte_buffer_wrap;          /*!< Data following the wrap_index (circular buffer decoded in place) */
+    uint32_t wrap_index;                /*!< Words with index >= wrap_index are read from rte_buffer_wrap */
+    bool     complete_file_loaded;      /*!< true - binary file completely loaded, false - partially loaded */
+    size_t   already_processed_data;    /*!< Total number of data already processed in the working buffer */
 
     /* Variables for the currently processed message from the binary data file */
-    timestamp_t timestamp;
     uint32_t fmt_id;                    /*!< Format ID of currently processed message */
     uint32_t additional_data;           /*!< Additional data packed together with timestamp/format ID to the same word */
     uint32_t asm_words;                 /*!< Assembled message size [# DATA words] - not including additional data */
     uint32_t asm_size;                  /*!< Assembled message size [bytes] - including additional data word if available */
     uint32_t *assembled_msg;            /*!< Message data (including additional data bits) */
+    uint32_t message_cnt;               /*!< Counter of all messages found - including messages with problems */
+    uint32_t messages_processed_after_restart; /*!< Counter of messages processed after reset/restart */
+
+    /* Error counting during a single message decoding */
+    uint32_t unfinished_words;          /*!< Number of consecutive words with a value of 0xFFFFFFFF.
+                                         *   Such a value indicates that the default value in the buffer was not 
+                                         * overwritten with the logged one during writing to the circular buffer.*/
+    uint32_t bad_packet_words;          /*!< Number of DATA words in a packet without a FMT word */
+    void (*message_callback)(struct _msg_data_t *p_fmt); /*!< Receives the decoded messages instead of the
+                                         *   message printing (see rtemsg_api.c), NULL - print to Main.log */
+
+    timestamp_t timestamp;
+    msg_context_t ctx;                  /*!< Printing context of the main thread */
+
+    rte_files_t file;                  /*!< Pointers to input and output files used during data decoding */
+    param_t param;                     /*!< Parsed values of command line parameters */
+    rtedbg_header_t rte_header;        /*!< Header of the embedded system debug structure dbgData */
+    rte_header_data_t hdr_data;        /*!< Pre-processed data from the RTEdbg structure header */
 
     /* Various values */
     char date_string[BIN_FILE_DATE_LENGTH]; /*!< String with date and time of binary data file creation - for "%D" */
-    uint32_t messages_processed_after_restart; /*!< Counter of messages processed after reset/restart */
-    value_t value;                      /*!< Currently processed/printed numerical value */
-
-    /* Binary data file processing variables */
-    uint32_t index;                     /*!< Index to the rte_buffer */
-    uint32_t message_cnt;               /*!< Counter of all messages found - including messages with problems */
     uint32_t multiple_logging;          /*!< Number of separate snapshots in the binary data file */
-    size_t   already_processed_data;    /*!< Total number of data already processed in the working buffer */
-    uint32_t in_size;                   /*!< Total size of the loaded buffer [number of words] */
     uint32_t error_warning_in_msg;      /*!< Number of message in which a warning is displayed after the error(s) - if any */
-    uint32_t *rte_buffer;               /*!< Pointer to data from the embedded system circular data logging buffer */
     uint32_t rte_buffer_size;           /*!< Size of the allocated memory for the buffer [32b words] */
     uint32_t raw_data[MAX_RAW_DATA_SIZE + 8u]; /*!< Raw data copied from the rte_buffer */
-    bool     complete_file_loaded;      /*!< true - binary file completely loaded, false - partially loaded */
 
     /* Enumerated value types: IN_FILE, OUT_FILE, MEMO, FILTER, inline selected text definition */
     enum_data_t enums[MAX_ENUMS + 1u];  /*!< Enumerated values: filters, memos, in_files and out_files.
@@ -235,36 +419,48 @@ typedef struct _rte_msg_t
     uint32_t fmt_ids_defined;           /*!< Number includes empty space reserved using ALIGN */
     uint32_t fmt_align_value;           /*!< Minimal value of the next format ID */
 
-    /* Error counting during a single message decoding */
-    uint32_t unfinished_words;          /*!< Number of consecutive words with a value of 0xFFFFFFFF.
-                                         *   Such a value indicates that the default value in the buffer was not 
-                                         * overwritten with the logged one during writing to the circular buffer.*/
-    uint32_t bad_packet_words;          /*!< Number of DATA words in a packet without a FMT word */
-    
-    /* Error information logged during a single message decoding */
-    error_log_t error_log[MAX_ERRORS_IN_SINGLE_MESSAGE];
-    uint32_t msg_error_counter;         /*!< Errors detected during single message decoding */
-    uint32_t error_value_no;            /*!< 0 = first decoded value of message, 1 = second one, etc. */
-                                        /* The number applies to the %x - x = type */
     /* General error counters */
     uint32_t total_unfinished_words;    /*!< Total number of unfinished_words containing 0xFFFFFFFF */
     uint32_t total_bad_packet_words;    /*!< Total number of bad_packet_words */
     uint32_t total_errors;              /*!< Total number of errors detected during the RTEmsg app execution */
     uint32_t error_counter[TOTAL_ERRORS+1]; /*!< Counters for individual error message types */
+    error_summary_t error_summary[TOTAL_ERRORS+1]; /*!< Errors not printed in detail (-errors=K) */
+    uint32_t errors_not_shown;          /*!< Total number of errors not printed in detail */
     bool binary_file_decoding_finished; /*!< true - the binary file decoding finished normally */
+    rate_stats_t rate;                  /*!< Logging rate statistics (-rate=N) */
+    loss_report_t loss;                 /*!< Data overruns and timestamp gaps (-stat=loss) */
+    struct _decimation_state_t **decimation; /*!< Decimation of the OUT_FILE() files (NULL - not used yet,
+                                         *   see out_file_decimation.c) */
 
     // Messages loaded from the Message.txt file
     char *message_text[TOTAL_MESSAGES+1];  /*!< Pointers to the text messages loaded from the file */
 } rte_msg_t;
 
 
+/* @brief Memory usage of the buffers and structures with the same allocation name (see allocate_memory()) */
+typedef struct
+{
+    const char *name;                   /*!< Allocation name */
+    size_t current;                     /*!< Memory currently allocated [bytes] */
+    size_t peak;                        /*!< Max. memory allocated [bytes] */
+    uint64_t allocations;               /*!< Number of allocations */
+} memory_usage_t;
+
+
 /***** Global variables *****/
 extern rte_msg_t g_msg;                 /*!< Main global data structure for the binary data file decoding */
+extern THREAD_LOCAL_COMPAT msg_context_t *g_ctx; /*!< Printing context of the current thread */
 
 
 /***** Function declarations *****/
 void *allocate_memory(size_t size, const char *memory_name);
+void release_memory(void *buffer, size_t size, const char *memory_name);
+void count_allocated_memory(size_t size, const char *memory_name);
+void count_released_memory(size_t size, const char *memory_name);
+const memory_usage_t *get_memory_usage(unsigned *names, size_t *peak);
 char *duplicate_string(const char *string_to_duplicate);
+void *allocate_parse_memory(size_t size, const char *memory_name);
+char *duplicate_parse_string(const char *string_to_duplicate);
 bool   is_power_of_two(size_t n);
 
 #endif   // _MAIN_H
@@ -0,0 +1,550 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    merge_logs.c
+ * @author  B. Premzel
+ * @brief   Merging of the Main.log files of binary data files decoded with
+ *          -batch into a single Main.log ordered by the message timestamps
+ *          (-merge). Every decoded Main.log is read as a stream of records.
+ *          A record starts with the line of a decoded message (message number
+ *          and timestamp) and contains all following lines until the next
+ *          message (multi-line texts, error reports, system messages).
+ *          The header of the Main.log ends with a separator line (see
+ *          print_msg_intro()). The lines between the separator and the first
+ *          decoded message (e.g. the errors found at the start of a wrapped
+ *          circular buffer) are a record with the timestamp of the first message.
+ *          The records are merged with a k-way merge - a binary heap holds
+ *          the next record of every file, ordered by the timestamp and file
+ *          number, so records with equal timestamps keep the file order.
+ *          Every line is prefixed with the name of the output subfolder of
+ *          the binary data file.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "merge_logs.h"
+#include "compress_output.h"
+
+#define MAIN_LOG_HEADER_END  "- - - "   // Start of the separator line at the end of the Main.log header
+
+
+/* Decoded Main.log which is being merged */
+typedef struct
+{
+    char *folder;                   /*!< Output subfolder of the binary data file */
+    char *data_file_name;           /*!< Name of the binary data file */
+    const char *label;              /*!< Last part of the subfolder name - printed before every line */
+    FILE *file;                     /*!< Main.log of the binary data file */
+    char *line;                     /*!< Line read ahead - the first line of the next record */
+    size_t line_size;               /*!< Size of the line[] buffer */
+    bool line_available;            /*!< false - end of file reached */
+    double line_timestamp;          /*!< Timestamp of the message in the line[] */
+    char *record;                   /*!< Current record - lines separated by '\n' */
+    size_t record_length;           /*!< Length of the text in the record[] */
+    size_t record_size;             /*!< Size of the record[] buffer */
+    double timestamp;               /*!< Timestamp of the current record */
+} merge_input_t;
+
+
+static merge_input_t *input;        // Main.log files of the decoded binary data files
+static unsigned inputs;             // Number of files in the input[]
+
+
+/**
+ * @brief Saves the output subfolder of a decoded binary data file for the merging of the
+ *        Main.log files. Must be called after the decoding of every file (-merge only).
+ *
+ * @param folder          Output subfolder of the binary data file
+ * @param data_file_name  Name of the binary data file
+ */
+
+void add_log_to_merge(const char *folder, const char *data_file_name)
+{
+    merge_input_t *new_input = (merge_input_t *)allocate_memory((inputs + 1u) * sizeof(merge_input_t), "mergeIn");
+
+    if (input != NULL)
+    {
+        memcpy(new_input, input, inputs * sizeof(merge_input_t));
+        release_memory(input, inputs * sizeof(merge_input_t), "mergeIn");
+    }
+
+    merge_input_t *in = &new_input[inputs++];
+    in->folder = duplicate_string(folder);
+    in->data_file_name = duplicate_string(data_file_name);
+    in->label = in->folder;
+
+    for (const char *p = in->folder; *p != '\0'; p++)
+    {
+        if ((*p == '/') || (*p == '\\'))
+        {
+            in->label = p + 1;
+        }
+    }
+
+    input = new_input;
+}
+
+
+/**
+ * @brief Enlarges a text buffer if it is smaller than the required size.
+ *
+ * @param buffer  Pointer to the buffer pointer
+ * @param size    Pointer to the buffer size
+ * @param needed  Required buffer size
+ */
+
+static void reserve_text_buffer(char **buffer, size_t *size, size_t needed)
+{
+    if (needed <= *size)
+    {
+        return;
+    }
+
+    size_t new_size = (*size == 0) ? MERGE_LINE_BUFFER_SIZE : *size;
+
+    while (new_size < needed)
+    {
+        new_size *= 2u;
+    }
+
+    char *new_buffer = (char *)realloc(*buffer, new_size);
+
+    if (new_buffer == NULL)
+    {
+        report_fatal_error_and_exit(FATAL_MALLOC_FAILED, "mergeBuf", new_size);
+    }
+
+    *buffer = new_buffer;
+    *size = new_size;
+}
+
+
+/**
+ * @brief Checks if the line contains a decoded message - an optional '#' (problematic
+ *        timestamp), the message number and the timestamp.
+ *
+ * @param line       Line from the Main.log file
+ * @param timestamp  Pointer to the timestamp of the message
+ *
+ * @return true - the line starts a new record
+ */
+
+static bool is_message_line(const char *line, double *timestamp)
+{
+    const char *p = line;
+    bool number_found = false;
+
+    if (*p == '#')
+    {
+        p++;
+    }
+
+    // Message number - printed with the default or -msgnum format
+    for ( ; (*p != '\0') && !isspace((unsigned char)*p); p++)
+    {
+        if (isdigit((unsigned char)*p))
+        {
+            number_found = true;
+        }
+    }
+
+    if (!number_found || (*p != ' '))
+    {
+        return false;
+    }
+
+    while (*p == ' ')
+    {
+        p++;
+    }
+
+    if (!isdigit((unsigned char)*p) && (*p != '-') && (*p != '+'))
+    {
+        return false;
+    }
+
+    char *end;
+    *timestamp = strtod(p, &end);
+
+    return (end != p) && ((*end == '\0') || isspace((unsigned char)*end));
+}
+
+
+/**
+ * @brief Reads the next line of a Main.log file to the line[] buffer.
+ *
+ * @param in  Pointer to the input file
+ *
+ * @return false - end of file
+ */
+
+static bool read_merge_line(merge_input_t *in)
+{
+    size_t length = 0;
+
+    for ( ;; )
+    {
+        reserve_text_buffer(&in->line, &in->line_size, length + MERGE_LINE_BUFFER_SIZE);
+
+        if (fgets(in->line + length, (int)(in->line_size - length), in->file) == NULL)
+        {
+            break;
+        }
+
+        length += strlen(in->line + length);
+
+        if ((length > 0) && (in->line[length - 1u] == '\n'))
+        {
+            break;
+        }
+    }
+
+    in->line[length] = '\0';
+    return length > 0;
+}
+
+
+/**
+ * @brief Skips the header of a Main.log file - all lines up to and including the separator
+ *        line printed before the first decoded message. Returns at the end of file.
+ *
+ * @param in  Pointer to the input file
+ */
+
+static void skip_main_log_header(merge_input_t *in)
+{
+    while ((in->line_available = read_merge_line(in)) == true)
+    {
+        if (strncmp(in->line, MAIN_LOG_HEADER_END, sizeof(MAIN_LOG_HEADER_END) - 1u) == 0)
+        {
+            return;
+        }
+    }
+}
+
+
+/**
+ * @brief Appends a line to the current record. A missing newline is added.
+ *
+ * @param in    Pointer to the input file
+ * @param line  Line to append
+ */
+
+static void append_to_record(merge_input_t *in, const char *line)
+{
+    size_t length = strlen(line);
+    reserve_text_buffer(&in->record, &in->record_size, in->record_length + length + 2u);
+    memcpy(in->record + in->record_length, line, length);
+    in->record_length += length;
+
+    if ((length == 0) || (line[length - 1u] != '\n'))
+    {
+        in->record[in->record_length++] = '\n';
+    }
+}
+
+
+/**
+ * @brief Loads the next record - the line of a decoded message and the lines following it.
+ *
+ * @param in  Pointer to the input file
+ *
+ * @return false - no more records in the file
+ */
+
+static bool load_next_record(merge_input_t *in)
+{
+    if (!in->line_available)
+    {
+        return false;
+    }
+
+    in->record_length = 0;
+    in->timestamp = in->line_timestamp;
+    append_to_record(in, in->line);
+
+    while ((in->line_available = read_merge_line(in)) == true)
+    {
+        if (is_message_line(in->line, &in->line_timestamp))
+        {
+            break;
+        }
+
+        append_to_record(in, in->line);
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Loads the lines found between the header and the first decoded message as the first
+ *        record. The record gets the timestamp of the first message (0 - no message found).
+ *
+ * @param in  Pointer to the input file
+ *
+ * @return false - no lines found before the first decoded message
+ */
+
+static bool load_first_record(merge_input_t *in)
+{
+    in->record_length = 0;
+    in->line_timestamp = 0;
+
+    while ((in->line_available = read_merge_line(in)) == true)
+    {
+        if (is_message_line(in->line, &in->line_timestamp))
+        {
+            break;
+        }
+
+        append_to_record(in, in->line);
+    }
+
+    in->timestamp = in->line_timestamp;
+    return in->record_length > 0;
+}
+
+
+/**
+ * @brief Compares the current records of two input files.
+ *
+ * @param a  Index of the first file
+ * @param b  Index of the second file
+ *
+ * @return true - the record of the first file has to be written first
+ */
+
+static bool record_is_earlier(unsigned a, unsigned b)
+{
+    if (input[a].timestamp != input[b].timestamp)
+    {
+        return input[a].timestamp < input[b].timestamp;
+    }
+
+    return a < b;
+}
+
+
+/**
+ * @brief Moves the heap element down to restore the heap order.
+ *
+ * @param heap      Heap of the input file indexes (the earliest record at index 0)
+ * @param elements  Number of elements in the heap
+ * @param position  Position of the element to move down
+ */
+
+static void sift_down(unsigned *heap, unsigned elements, unsigned position)
+{
+    for ( ;; )
+    {
+        unsigned child = 2u * position + 1u;
+
+        if (child >= elements)
+        {
+            break;
+        }
+
+        if (((child + 1u) < elements) && record_is_earlier(heap[child + 1u], heap[child]))
+        {
+            child++;
+        }
+
+        if (!record_is_earlier(heap[child], heap[position]))
+        {
+            break;
+        }
+
+        unsigned temp = heap[position];
+        heap[position] = heap[child];
+        heap[child] = temp;
+        position = child;
+    }
+}
+
+
+/**
+ * @brief Writes the current record with the file label before every line.
+ *
+ * @param out    Pointer to the merged Main.log
+ * @param in     Pointer to the input file
+ * @param width  Width of the label column
+ */
+
+static void write_record(FILE *out, const merge_input_t *in, int width)
+{
+    const char *line = in->record;
+    const char *end = in->record + in->record_length;
+
+    while (line < end)
+    {
+        const char *next = (const char *)memchr(line, '\n', (size_t)(end - line)) + 1;
+        fprintf(out, "%-*s ", width, in->label);
+        fwrite(line, 1, (size_t)(next - line), out);
+        line = next;
+    }
+}
+
+
+/**
+ * @brief Opens the Main.log files of all decoded binary data files and loads their first records.
+ *
+ * @param heap  Heap of the input file indexes
+ *
+ * @return Number of files with at least one record
+ */
+
+static unsigned open_logs_to_merge(unsigned *heap)
+{
+    unsigned elements = 0;
+
+    for (unsigned i = 0; i < inputs; i++)
+    {
+        merge_input_t *in = &input[i];
+        size_t size = strlen(in->folder) + sizeof(RTE_MAIN_LOG_FILE) + 1u;
+        char *name = (char *)allocate_memory(size, "mergeName");
+        snprintf(name, size, "%s%c%s", in->folder, PATH_SEPARATOR, RTE_MAIN_LOG_FILE);
+        in->file = compressed_fopen(name, "r");
+
+        if (in->file == NULL)
+        {
+            fprintf(g_msg.file.error_log, get_message_text(MSG_MERGE_LOG_NOT_FOUND), compressed_file_name(name));
+        }
+        else
+        {
+            setvbuf(in->file, NULL, _IOFBF, MERGE_INPUT_BUFFER_SIZE);
+            skip_main_log_header(in);
+
+            if (load_first_record(in) || load_next_record(in))
+            {
+                heap[elements++] = i;
+            }
+        }
+
+        release_memory(name, size, "mergeName");
+    }
+
+    for (unsigned i = elements / 2u; i-- > 0; )
+    {
+        sift_down(heap, elements, i);
+    }
+
+    return elements;
+}
+
+
+/**
+ * @brief Writes the list of merged files to the beginning of the merged Main.log.
+ *
+ * @param out  Pointer to the merged Main.log
+ *
+ * @return Width of the label column
+ */
+
+static int write_merge_header(FILE *out)
+{
+    int width = 0;
+
+    for (unsigned i = 0; i < inputs; i++)
+    {
+        int length = (int)strlen(input[i].label);
+
+        if (length > width)
+        {
+            width = length;
+        }
+    }
+
+    fprintf(out, get_message_text(MSG_MERGE_HEADER), inputs);
+
+    for (unsigned i = 0; i < inputs; i++)
+    {
+        fprintf(out, get_message_text(MSG_MERGE_FILE), width, input[i].label, input[i].data_file_name);
+    }
+
+    fprintf(out, "\n");
+    return width;
+}
+
+
+/**
+ * @brief Merges the Main.log files of all binary data files decoded with -batch into the
+ *        Main.log file of the output folder (-merge). The records of the files are written
+ *        in the order of their timestamps.
+ *
+ * @param output_folder  Output folder defined in the command line
+ */
+
+void write_merged_main_log(const char *output_folder)
+{
+    if (inputs == 0)
+    {
+        return;
+    }
+
+    jump_to_start_folder();
+    size_t size = strlen(output_folder) + sizeof(RTE_MAIN_LOG_FILE) + 1u;
+    char *name = (char *)allocate_memory(size, "mergeName");
+    snprintf(name, size, "%s%c%s", output_folder, PATH_SEPARATOR, RTE_MAIN_LOG_FILE);
+    FILE *out = compressed_fopen(name, "w");
+
+    if (out == NULL)
+    {
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, compressed_file_name(name));
+        release_memory(name, size, "mergeName");
+        return;
+    }
+
+    set_output_file_buffer(out);
+    unsigned *heap = (unsigned *)allocate_memory(inputs * sizeof(unsigned), "mergeHeap");
+    unsigned elements = open_logs_to_merge(heap);
+    int width = write_merge_header(out);
+
+    while (elements > 0)
+    {
+        merge_input_t *in = &input[heap[0]];
+        write_record(out, in, width);
+
+        if (!load_next_record(in))
+        {
+            heap[0] = heap[--elements];
+        }
+
+        sift_down(heap, elements, 0);
+    }
+
+    close_output_file(out);
+
+    for (unsigned i = 0; i < inputs; i++)
+    {
+        merge_input_t *in = &input[i];
+
+        if (in->file != NULL)
+        {
+            compressed_fclose(in->file);
+        }
+
+        release_memory(in->folder, strlen(in->folder) + 1u, "StringDup");
+        release_memory(in->data_file_name, strlen(in->data_file_name) + 1u, "StringDup");
+        free(in->line);             // The line[] and record[] buffers are enlarged with realloc()
+        free(in->record);
+    }
+
+    release_memory(input, inputs * sizeof(merge_input_t), "mergeIn");
+    release_memory(heap, inputs * sizeof(unsigned), "mergeHeap");
+    release_memory(name, size, "mergeName");
+    input = NULL;
+    inputs = 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    merge_logs.h
+ * @author  B. Premzel
+ * @brief   Header file for the merging of the Main.log files (-merge).
+ ******************************************************************************/
+
+#ifndef _MERGE_LOGS_H
+#define _MERGE_LOGS_H
+
+
+/***** Function declarations *****/
+void add_log_to_merge(const char *folder, const char *data_file_name);
+void write_merged_main_log(const char *output_folder);
+
+#endif  // _MERGE_LOGS_H
+
+/*==== End of file ====*/
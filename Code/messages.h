@@ -98,24 +98,26 @@ enum error_and_other_messages
    FATAL_MISSING_FMT_FOLDER,                    // "Missing format definition folder name or syntax error."
    FATAL_BAD_PARAM_FILE,                        // "The RTEmsg parameter file name must be preceded by an '@' character to pass the parameter file to the program."
    FATAL_READ_FROM_CMD_LINE_PARAM_FILE,         // "Failed to read from the command line parameter file"
+   FATAL_BAD_FOLLOW_PARAMETER_VALUE,            // "Incorrect '-follow=x' argument value (x = time in seconds without new data after which the decoding is finished)."
+   FATAL_BAD_THREADS_PARAMETER_VALUE,           // "Incorrect '-threads=N' argument value (N = 1 ... 16 threads for printing of the decoded messages)."
+   FATAL_BAD_OUTBUF_PARAMETER_VALUE,            // "Incorrect '-outbuf=N' argument value (N = 0 ... 65536 kB output file buffer size, 0 = default buffering)."
+   FATAL_BAD_SELECT_PARAMETER_VALUE,            // "Incorrect '-select=...' argument value - message name '%s' not found in the format definitions."
+   FATAL_BAD_WINDOW_PARAMETER_VALUE,            // "Incorrect '-window=t1;t2' argument value (t1 < t2 = start and end of the decoded time window in seconds)."
+   FATAL_BAD_RANGE_PARAMETER_VALUE,             // "Incorrect '-range=N1;N2' argument value (N1 <= N2 = numbers of the first and last decoded message)."
+   FATAL_BAD_BATCH_PARAMETERS,                  // "The '-batch' argument cannot be used together with the '-follow' and '-index=file' arguments."
+   FATAL_BAD_ERRORS_PARAMETER_VALUE,            // "Incorrect '-errors=K' argument value (K = 1 ... 1000000 errors of each type printed in detail)."
+   FATAL_BAD_RATE_PARAMETER_VALUE,              // "Incorrect '-rate=N' argument value (N = 1 ... 3600000 ms long windows of the logging rate statistics)."
+   FATAL_BAD_COMPRESS_PARAMETER_VALUE,          // "Incorrect '-compress=tool' argument value (tool = zstd, lz4 or gzip - it must be in the PATH)."
+   FATAL_BAD_COMPRESSED_INPUT_PARAMETERS,       // "A compressed binary data file cannot be decoded with the '-follow' and '-index=file' arguments."
+   FATAL_BAD_QUERY_PARAMETER_VALUE,             // "Incorrect '-query=...' argument value (conditions [MSG_NAME.]value_name<op>number joined with & and |, op = <, <=, >, >=, == or !=)."
+   FATAL_QUERY_VALUE_NOT_FOUND,                 // "Incorrect '-query=...' argument value - numeric value '%s' not found in the format definitions (names are defined with |name|)."
+   FATAL_BAD_CONTEXT_PARAMETER_VALUE,           // "Incorrect '-context=N' argument value (N = 0 ... 1000000 messages decoded after each message matching the '-query=...')."
+   FATAL_BAD_SERVER_PARAMETERS,                 // "The '-server=name' argument cannot be used together with the binary data file name and the '-batch', '-follow', '-index=file' and '-c' arguments."
+   FATAL_CANT_START_SERVER,                     // "The decode server '%s' could not be started (local socket or named pipe)"
+   FATAL_BAD_STDIN_INPUT_PARAMETERS,            // "The binary data cannot be read from the standard input ('-') with the '-follow', '-index=file' and '-batch' arguments."
    /* - - - - - - - - - - - - - - - - - - - - - - */
    FATAL_LAST,                                  // "Unknown error (error number out of range)"
 
-   ERR_PLACE_HOLDER00,                          // " "
-   ERR_PLACE_HOLDER01,                          // " "
-   ERR_PLACE_HOLDER02,                          // " "
-   ERR_PLACE_HOLDER03,                          // " "
-   ERR_PLACE_HOLDER04,                          // " "
-   ERR_PLACE_HOLDER05,                          // " "
-   ERR_PLACE_HOLDER06,                          // " "
-   ERR_PLACE_HOLDER07,                          // " "
-   ERR_PLACE_HOLDER08,                          // " "
-   ERR_PLACE_HOLDER09,                          // " "
-   ERR_PLACE_HOLDER0a,                          // " "
-   ERR_PLACE_HOLDER0b,                          // " "
-   ERR_PLACE_HOLDER0c,                          // " "
-   ERR_PLACE_HOLDER0d,                          // " "
-   ERR_PLACE_HOLDER0e,                          // " "
    ERR_PLACE_HOLDER0f,                          // " "
    ERR_PLACE_HOLDER0g,                          // " "
    ERR_PLACE_HOLDER0h,                          // " "
@@ -131,8 +133,6 @@ enum error_and_other_messages
    ERR_PLACE_HOLDER0s,                          // " "
    ERR_PLACE_HOLDER0t,                          // " "
    ERR_PLACE_HOLDER0u,                          // " "
-   ERR_PLACE_HOLDER0v,                          // " "
-   ERR_PLACE_HOLDER0w,                          // " "
    ERR_PLACE_HOLDER0z,                          // " "
 
 /****** Non fatal errors ******/
@@ -181,8 +181,8 @@ enum error_and_other_messages
    ERR_MSGX_SIZE_EMPTY,                         // "Suspicious MSGX message - missing DATA word (should have at least one)"
    ERR_MSGX_CORRUPTED,                          // "Suspicious MSGX message - unused portion of last DATA word not zero"
    ERR_BIN_DATA_FILE_FSEEK,                     // "Problem with reading a binary data file - fseek issue %s#u"
+   ERR_DECOMPRESSION_FAILED,                    // "The decompression tool could not decompress the complete binary file '%s'. Data may be truncated or corrupted."
 
-   ERR_PLACE_HOLDER3,                           // " "
    ERR_PLACE_HOLDER4,                           // " "
    ERR_PLACE_HOLDER5,                           // " "
    ERR_PLACE_HOLDER6,                           // " "
@@ -345,6 +345,9 @@ enum error_and_other_messages
    ERR_PARSE_EXPECTING_UNDERSCORE,              // "Expected underscore in front of the y-value in EXT_MSGx_y format ID name"
    ERR_PARSE_FILE_WORK_CANNOT_COMPARE,          // "Cannot read from file during file comparison (work and/or destination file)"
    ERR_PARSE_FILE_CANNOT_WRITE_TO_WORK_FILE,    // "Errors found while writing in the work file"
+   ERR_PARSE_ARRAY_ELEMENTS,                    // "The number of array elements K in the [nn:mmF*K] or [mmF*K] definition must be between 2 and 8192"
+   ERR_PARSE_ARRAY_FORMAT_TYPE,                 // "Array values [nn:mmF*K] must be integer or float values printed with %d, %i, %u, %o, %x, %X, %e, %f or %g (no '#' with %g, max. field width 100)"
+   ERR_PARSE_OUT_FILE_DECIMATION,               // "OUT_FILE() decimation must be DECIMATE=N (N = 2 ... 1000000) or MINMAX=T (time window T = 1e-9 ... 1e9 [s])"
    /******* Parsing error messages end *******/
 
    /******  Other text messages ******/
@@ -408,6 +411,47 @@ enum error_and_other_messages
    MSG_SIZE_SHOULD_BE,                          // " (the data size should be %u words)"
    MSG_WARN_ERROR_IN_FIRST_SNAPSHOT_MSG,        // "\n  Note: The first message of a snapshot may be partially overwritten when the last message is written, and this may be the cause of the error shown above.\n"
    MSG_PROBLEMS_WRITING_TO_OUTPUT_FILES,        // "\n\nErrors were detected while writing to the following files during data decoding:"
+   MSG_FOLLOW_MODE_ACTIVE,                      // "\nDecoding the data appended to the binary file. Press Ctrl+C to finish."
+   MSG_PROFILE_TITLE,                           // "\n\nExecution profile: %.3f s binary file processing, %.1f M cycles/s"
+   MSG_PROFILE_STAGES,                          // "\n\nDecoding stage                      time [s]      %%         calls   cycles/call"
+   MSG_PROFILE_LOAD_DATA,                       // "Binary data loading"
+   MSG_PROFILE_ASSEMBLE_MESSAGE,                // "Message assembly"
+   MSG_PROFILE_TIMESTAMP,                       // "Timestamp reconstruction"
+   MSG_PROFILE_LONG_TIMESTAMP,                  // "  long timestamp search"
+   MSG_PROFILE_PRINT_MESSAGE,                   // "Message printing"
+   MSG_PROFILE_PARALLEL_PRINTING,               // "  parallel printing and merge"
+   MSG_PROFILE_VALUE_STATISTICS,                // "  value statistics"
+   MSG_PROFILE_WRITE_STATISTICS,                // "Statistics file writing"
+   MSG_PROFILE_MESSAGES,                        // "\n\nMessages with the longest printing time (all threads)\nMessage name                        time [s]      %%      messages    cycles/msg"
+   MSG_PROFILE_VALUE_TYPES,                     // "\n\nValue printing time by the format type (all threads)\nFormat type                         time [s]      %%        values  cycles/value"
+   MSG_PROFILE_LINE,                            // "\n%-32s %11.3f %6.1f %13llu %13.0f"
+   MSG_VALUE_STATISTICS_QUANTILES,              // "\n ;Quantile"
+   MSG_VALUE_STATISTICS_QUANTILE_VALUES,        // "\n ;Value (estimate)"
+   MSG_VALUE_STATISTICS_HISTOGRAM,              // "\n ;Histogram bin from"
+   MSG_VALUE_STATISTICS_HISTOGRAM_COUNT,        // "\n ;Number of samples"
+   MSG_DECODING_RESUMED_FROM_INDEX,             // "\nDecoding resumed from the index file at message #%u (word %llu of the binary data).\n"
+   MSG_BATCH_DATA_FILE,                         // "\n\nDecoding the binary data file \"%s\" to the output folder \"%s\"."
+   MSG_ERRORS_NOT_SHOWN_SUMMARY,                // "\n\nErrors not printed in detail (-errors=%u):"
+   MSG_ERRORS_NOT_SHOWN,                        // "\n%3u x ERR_%03u in messages %u ... %u (first one: format ID %u, data 0x%X 0x%X)"
+   MSG_ERRORS_NOT_SHOWN_TOTAL,                  // "\n%u errors have not been printed in detail (-errors=%u) - see the error summary in the Errors.log file."
+   MSG_RATE_FILE_HEADER,                        // "Window start [s];Messages;Words;Words/s;Top message;Top message words\n"
+   MSG_RATE_PEAK_WINDOWS,                       // "\n\nTime windows with the highest logging rate (%u ms windows, %u windows with messages):\n      Start [s]  Messages     Words      Words/s  Message with the most words"
+   MSG_RATE_PEAK_MESSAGES,                      // "\n\nMessage types with the highest peak logging rate (%u ms windows):\n   Peak words/s  Messages  Window start [s]  Message"
+   MSG_LOSS_FILE_HEADER,                        // "Loss;Type;First message after the loss;Last timestamp before [s];First timestamp after [s];Duration [s];Estimated lost words;Estimated lost messages;Messages before the loss\n"
+   MSG_LOSS_TYPE_OVERRUN,                       // "data overrun"
+   MSG_LOSS_TYPE_TIMESTAMP_GAP,                 // "timestamp gap"
+   MSG_LOSS_SUMMARY,                            // "\n\nData losses: %u data overruns and %u timestamp gaps with a total duration of %.6f s (see Stat_losses.csv)."
+   MSG_LOSS_ESTIMATE,                           // "\nEstimated lost data: %.0f words and %.0f messages (average logging rate %.0f words/s and %.0f messages/s)."
+   MSG_LOSS_DURATIONS,                          // "\nDistribution of the loss durations:\n  < 1 ms  < 10 ms  < 100 ms    < 1 s   < 10 s  >= 10 s  unknown\n"
+   MSG_LOSS_EVENTS_NOT_SAVED,                   // "\nOnly the first %u losses are listed in the Stat_losses.csv file."
+   MSG_MERGE_HEADER,                            // "Merged Main.log files of %u binary data files (records ordered by the message timestamps)\n"
+   MSG_MERGE_FILE,                              // "%-*s = %s\n"
+   MSG_MERGE_LOG_NOT_FOUND,                     // "\nThe file '%s' could not be opened - it is not included in the merged Main.log."
+   MSG_SERVER_FORMATS_CHANGED,                  // "\n\nThe format definition files have been changed - the decode server is restarted."
+   MSG_MEMORY_USAGE_TITLE,                      // "\n\nMemory usage: %.1f kB peak allocated, %.1f kB peak process memory (resident set)\nAllocation name                   peak [kB]   current [kB]   allocations"
+   MSG_MEMORY_USAGE_LINE,                       // "\n%-32s %10.1f %14.1f %13llu"
+   MSG_LOSS_ESTIMATE_UNKNOWN,                   // "\nEstimated lost data: unknown (the duration of the losses or the average logging rate could not be determined)."
+   MSG_LOSS_ESTIMATE_INCOMPLETE,                // "\nThe estimate does not include %u losses with an unknown duration."
 
    TOTAL_MESSAGES                               /* Total number of all text messages */
 };
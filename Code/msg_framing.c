@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    msg_framing.c
+ * @author  B. Premzel
+ * @brief   Framing of the single-packet messages in the loaded binary data.
+ *          A block of contiguous words is checked against the end of the loaded
+ *          data once. The position of the FMT word in the next five words is
+ *          found with a table lookup and the packet length limits are taken
+ *          from the packet_type[] table indexed by the format ID.
+ *          The found messages are stored in the descriptor[] array and
+ *          assembled one after another by the assemble_framed_message().
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "format.h"
+#include "read_bin_data.h"
+#include "msg_framing.h"
+
+#define UNKNOWN_PACKET_LENGTH   0xFFu   // Format ID without a format definition
+
+
+/* @brief Packet length limits of a format ID */
+typedef struct
+{
+    uint8_t packet_length;          /*!< Length of the first packet (DATA words + FMT word) or UNKNOWN_PACKET_LENGTH */
+    uint8_t single_packet_length;   /*!< Max. length of a packet which is a complete message */
+    bool ext_msg;                   /*!< true - EXT_MSG (the FMT word contains more than 4 bits of additional data) */
+} packet_type_t;
+
+static packet_type_t packet_type[MAX_FMT_IDS];          // Packet length limits for all format IDs
+static msg_descriptor_t descriptor[FRAME_BLOCK_WORDS];  // Messages found in the last block
+static unsigned descriptors;                            // Number of messages in the descriptor[]
+static unsigned next_descriptor;                        // Index of the next message to be assembled
+static size_t frame_data_start;                         // g_msg.already_processed_data during the framing
+
+/* Number of words up to and including the first FMT word (bit 0 set) for the bit 0 values
+ * of five consecutive words (bit N = bit 0 of the word N). 0 - no FMT word in five words. */
+static const uint8_t fmt_word_position[32] =
+{
+    0, 1, 2, 1, 3, 1, 2, 1, 4, 1, 2, 1, 3, 1, 2, 1,
+    5, 1, 2, 1, 3, 1, 2, 1, 4, 1, 2, 1, 3, 1, 2, 1
+};
+
+
+/**
+ * @brief Check if the assembled message has reached the length defined in the format definition.
+ *
+ * @param fmt_id     Format ID of the message (without the bits used for the 31st bit of DATA words).
+ * @param asm_words  Number of DATA words assembled.
+ *
+ * @return  true - the message has the defined length or is too long.
+ *          false - the length is not known or additional data might be in the next packet.
+ */
+
+bool message_length_reached(uint32_t fmt_id, uint32_t asm_words)
+{
+    // Check if a format definition exists for the current format ID.
+    if (fmt_id < MAX_FMT_IDS)
+    {
+        const fmt_info_t *info = &g_fmt_info[fmt_id];
+
+        if (info->p_fmt != NULL)
+        {
+            // Do not search for other parts of the message if the message has the correct length already
+            unsigned length = info->msg_len;        // Length [bytes]
+
+            if (length == 0)
+            {
+                return false;       // Message length zero (MSG0) or unknown
+            }
+
+            if ((info->msg_type == TYPE_EXT_MSG) && (length >= 4uL))
+            {
+                // Exclude the extended data since the message has not been identified as EXT_MSG yet
+                length -= 4uL;
+            }
+
+            if (length <= (asm_words * 4uL)) // Is the message the correct length or too long?
+            {
+                return true; // Message size matches the format definition or is too long.
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Determines the expected length of the first packet for a given format ID
+ *        from the format definitions (1 to 5 words including FMT).
+ *
+ * @param fmt_id  Format ID of the current message.
+ *
+ * @return Length of the packet (number of DATA words including one FMT word).
+ *         Returns 0xFFFFFFFF if no definition exists.
+ */
+
+static uint32_t find_packet_length(uint32_t fmt_id)
+{
+    const fmt_info_t *info = &g_fmt_info[fmt_id];
+
+    while ((fmt_id & 0xF) != 0)
+    {
+        info = &g_fmt_info[fmt_id];  // The format definition exists?
+
+        if (info->p_fmt != NULL)
+        {
+            break;
+        }
+
+        fmt_id--;
+    }
+
+    if (info->p_fmt == NULL)
+    {
+        return 0xFFFFFFFFu;     // Use the actual packet length since the length is unknown
+    }
+
+    uint32_t len = info->msg_len / 4u; // Calculate number of DATA words.
+
+    switch (g_fmt_info[fmt_id].msg_type)
+    {
+        case TYPE_MSG0_4:
+            break;
+
+        case TYPE_EXT_MSG:
+            if (len > 0)
+            {
+                len--;  // One data element (up to 8 bits) is part of the FMT word.
+            }
+            break;
+
+        case TYPE_MSGN:
+            if ((len == 0) || (len > 4))
+            {
+                // Assume a length of 4 DATA words or more if unknown at compile time.
+                len = 4u;
+            }
+            break;
+            // The code above assumes that there is an invalid message that should be skipped
+            // before the start of the MSGN message and not in the middle of the message.
+
+        case TYPE_MSGX:
+            len = 4u;           // Sub packet can could hold up to 4 DATA words
+            break;
+    }
+
+    len++;                      // Add one for the FMT word
+    return len;
+}
+
+
+/**
+ * @brief Prepares the g_fmt_info[] and the packet length table from the format definitions
+ *        in the g_fmt[].
+ *        Must be called after the format definitions have been parsed or loaded from
+ *        the cache and before the decoding of a binary data file.
+ */
+
+void prepare_message_framing(void)
+{
+    prepare_format_info();
+
+    for (uint32_t fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        packet_type_t *type = &packet_type[fmt_id];
+        uint32_t length = find_packet_length(fmt_id);
+
+        // The message of unknown length ends with the packet (see process_the_message_packet())
+        type->packet_length = (length > 5u) ? UNKNOWN_PACKET_LENGTH : (uint8_t)length;
+        type->single_packet_length = (length > 5u) ? 5u : (uint8_t)length;
+
+        // A packet with 4 DATA words can be followed by a continuation of the message
+        if ((length == 5u) && !message_length_reached(fmt_id & 0xFFFFFFF0u, 4u))
+        {
+            type->single_packet_length = 4u;
+        }
+
+        type->ext_msg = (g_fmt_info[fmt_id].p_fmt != NULL) && (g_fmt_info[fmt_id].msg_type == TYPE_EXT_MSG);
+    }
+
+    discard_message_descriptors();
+}
+
+
+/**
+ * @brief Retrieves the expected length of the first packet for a given format ID.
+ *
+ * @param fmt_id  Format ID of the current message.
+ *
+ * @return Length of the message (number of DATA words including one FMT word).
+ *         Returns 0xFFFFFFFF if the format ID is invalid or no definition exists.
+ */
+
+uint32_t get_packet_length(uint32_t fmt_id)
+{
+    if (fmt_id >= MAX_FMT_IDS)
+    {
+        return 0xFFFFFFFFu;
+    }
+
+    uint32_t length = packet_type[fmt_id].packet_length;
+
+    return (length == UNKNOWN_PACKET_LENGTH) ? 0xFFFFFFFFu : length;
+}
+
+
+/**
+ * @brief Finds the single-packet messages in the next block of the loaded data starting
+ *        at the g_msg.index. The block ends at the end of the loaded data, at the wrap
+ *        index (see get_bin_word()) or after FRAME_BLOCK_WORDS words. The framing stops
+ *        at the first packet that has to be checked by the assemble_message().
+ */
+
+static void frame_next_block(void)
+{
+    uint32_t index = g_msg.index;
+    uint32_t end = g_msg.in_size;
+    const uint32_t *data;
+
+    descriptors = 0;
+    next_descriptor = 0;
+    frame_data_start = g_msg.already_processed_data;
+
+    if (index >= end)
+    {
+        return;
+    }
+
+    if (index < g_msg.wrap_index)
+    {
+        if (end > g_msg.wrap_index)
+        {
+            end = g_msg.wrap_index;
+        }
+
+        data = &g_msg.rte_buffer[index];
+    }
+    else
+    {
+        data = &g_msg.rte_buffer_wrap[index - g_msg.wrap_index];
+    }
+
+    uint32_t words_left = end - index;
+
+    if (words_left > FRAME_BLOCK_WORDS)
+    {
+        words_left = FRAME_BLOCK_WORDS;     // Every packet has at least one word
+    }
+
+    uint32_t fmt_id_shift = g_msg.hdr_data.fmt_id_shift;
+
+    // The last packets of a block are processed by the assemble_message()
+    while (words_left >= 5u)
+    {
+        unsigned fmt_bits = (data[0] & 1u) | ((data[1] & 1u) << 1u) | ((data[2] & 1u) << 2u)
+            | ((data[3] & 1u) << 3u) | ((data[4] & 1u) << 4u);
+        unsigned length = fmt_word_position[fmt_bits];
+
+        if (length == 0)
+        {
+            break;                      // Too many DATA words without a FMT word
+        }
+
+        uint32_t fmt_word = data[length - 1u];
+        uint32_t fmt_id = fmt_word >> fmt_id_shift;     // Always lower than MAX_FMT_IDS
+
+        // The erased word (0xFFFFFFFF) has bit 0 set and is found as the FMT word
+        if ((fmt_word == 0xFFFFFFFFuL) || (length > packet_type[fmt_id].single_packet_length))
+        {
+            break;
+        }
+
+        descriptor[descriptors++] = (msg_descriptor_t)
+        {
+            .offset = index,
+            .fmt_word = fmt_word,
+            .fmt_id = (uint16_t)(fmt_id & (0xFFFFFFFFu << (length - 1u))),
+            .length = (uint16_t)length
+        };
+
+        index += length;
+        data += length;
+        words_left -= length;
+    }
+}
+
+
+/**
+ * @brief Returns the descriptor of the message which starts at the g_msg.index.
+ *        The next block is framed if the descriptors have been used or are not valid
+ *        anymore (the message has been assembled by the assemble_message() or the
+ *        data has been moved by the load_data_block()).
+ *
+ * @return Pointer to the message descriptor or NULL if the message has to be assembled
+ *         by the assemble_message().
+ */
+
+const msg_descriptor_t *get_message_descriptor(void)
+{
+    if ((next_descriptor >= descriptors)
+        || (frame_data_start != g_msg.already_processed_data)
+        || (descriptor[next_descriptor].offset != g_msg.index))
+    {
+        frame_next_block();
+
+        if (descriptors == 0)
+        {
+            return NULL;
+        }
+    }
+
+    return &descriptor[next_descriptor++];
+}
+
+
+/**
+ * @brief Assembles the next single-packet message found by the framing. The DATA words are
+ *        reconstructed (bit 0 restored from the FMT word) directly into the g_msg.assembled_msg.
+ *
+ * @return true if the message has been assembled (equal to DATA_FOUND of the assemble_message()).
+ */
+
+bool assemble_framed_message(void)
+{
+    const msg_descriptor_t *msg = get_message_descriptor();
+
+    if (msg == NULL)
+    {
+        return false;
+    }
+
+    uint32_t fmt_id = msg->fmt_word >> g_msg.hdr_data.fmt_id_shift;
+    uint32_t data_words = msg->length - 1u;
+    uint32_t additional_data = packet_type[fmt_id].ext_msg ? fmt_id : (fmt_id & 0x0Fu);
+    uint32_t *message = g_msg.assembled_msg;
+
+    // The last DATA word gets the lowest bit of the additional data
+    for (uint32_t n = 0; n < data_words; n++)
+    {
+        message[n] = (get_bin_word(msg->offset + n) >> 1)
+            | (((additional_data >> (data_words - 1u - n)) & 1u) << 31);
+    }
+
+    g_msg.fmt_id = msg->fmt_id;
+    g_msg.timestamp.l = (msg->fmt_word & 0xFFFFFFFEu) << g_msg.hdr_data.fmt_id_bits;
+    g_msg.additional_data = additional_data >> data_words;
+    g_msg.asm_words = data_words;
+    g_msg.index = msg->offset + msg->length;
+    return true;
+}
+
+
+/**
+ * @brief Discards the framed messages. Called after new data has been loaded.
+ */
+
+void discard_message_descriptors(void)
+{
+    descriptors = 0;
+    next_descriptor = 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    msg_framing.h
+ * @author  B. Premzel
+ * @brief   Framing of the single-packet messages in the loaded binary data.
+ *
+ *          The loaded data is scanned in blocks of contiguous words. The packet
+ *          lengths and types are taken from a table indexed by the format ID
+ *          which is prepared from the g_fmt[] after the format definitions have
+ *          been parsed. The messages found are stored in an array of message
+ *          descriptors. The packets which need the complete checks (messages
+ *          consisting of several packets, unfinished words, bad blocks) stop
+ *          the scan and are processed by the assemble_message().
+ ******************************************************************************/
+
+#ifndef _MSG_FRAMING_H
+#define _MSG_FRAMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* @brief Message found in the loaded binary data */
+typedef struct
+{
+    uint32_t offset;                /*!< Index of the first word of the message (see get_bin_word()) */
+    uint32_t fmt_word;              /*!< FMT word with the timestamp and format ID */
+    uint16_t fmt_id;                /*!< Format ID without the bits used for the 31st bit of DATA words */
+    uint16_t length;                /*!< Number of words including the FMT word */
+} msg_descriptor_t;
+
+
+/***** Function declarations *****/
+bool message_length_reached(uint32_t fmt_id, uint32_t asm_words);
+void prepare_message_framing(void);
+uint32_t get_packet_length(uint32_t fmt_id);
+const msg_descriptor_t *get_message_descriptor(void);
+bool assemble_framed_message(void);
+void discard_message_descriptors(void);
+
+#endif  // _MSG_FRAMING_H
+
+/*==== End of file ====*/
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    name_index.c
+ * @author  B. Premzel
+ * @brief   Hash table index of the names defined in the format definition files
+ *          (enums, file names and message names). Replaces the linear searches
+ *          during the parsing - the parsing time would otherwise grow with the
+ *          square of the number of definitions.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "name_index.h"
+
+#define NAME_INDEX_INITIAL_SIZE     256u    // Must be a power of 2
+
+
+/**
+ * @brief Calculates the FNV-1a hash value of a name.
+ */
+
+static uint32_t name_hash(const char *name)
+{
+    uint32_t hash = 2166136261uL;
+
+    for (const unsigned char *p = (const unsigned char *)name; *p != '\0'; p++)
+    {
+        hash = (hash ^ *p) * 16777619uL;
+    }
+
+    return hash;
+}
+
+
+/**
+ * @brief Inserts an entry to the table without checking if the name is already there.
+ */
+
+static void insert_entry(name_index_t *index, const name_index_entry_t *new_entry)
+{
+    uint32_t mask = index->size - 1u;
+    uint32_t i = new_entry->hash & mask;
+
+    while (index->entry[i].name != NULL)
+    {
+        i = (i + 1u) & mask;
+    }
+
+    index->entry[i] = *new_entry;
+    index->used++;
+}
+
+
+/**
+ * @brief Doubles the table size (or allocates the first table).
+ */
+
+static void enlarge_index(name_index_t *index)
+{
+    name_index_entry_t *old_entry = index->entry;
+    uint32_t old_size = index->size;
+
+    index->size = (old_size == 0) ? NAME_INDEX_INITIAL_SIZE : (2u * old_size);
+    index->entry = (name_index_entry_t *)allocate_memory(index->size * sizeof(name_index_entry_t), "nameIdx");
+    index->used = 0;
+
+    for (uint32_t i = 0; i < old_size; i++)
+    {
+        if (old_entry[i].name != NULL)
+        {
+            insert_entry(index, &old_entry[i]);
+        }
+    }
+
+    release_memory(old_entry, old_size * sizeof(name_index_entry_t), "nameIdx");
+}
+
+
+/**
+ * @brief Adds a name to the index. If the name is already in the index, the first value remains.
+ *
+ * @param index  Name index
+ * @param name   Name - must remain allocated while the index is used
+ * @param value  Value belonging to the name
+ */
+
+void add_name_to_index(name_index_t *index, const char *name, uint32_t value)
+{
+    if (name == NULL)
+    {
+        return;
+    }
+
+    uint32_t old_value;
+
+    if (find_name_in_index(index, name, &old_value))
+    {
+        return;
+    }
+
+    if ((2u * (index->used + 1u)) > index->size)
+    {
+        enlarge_index(index);
+    }
+
+    name_index_entry_t new_entry = { name, name_hash(name), value };
+    insert_entry(index, &new_entry);
+}
+
+
+/**
+ * @brief Finds a name in the index.
+ *
+ * @param index  Name index
+ * @param name   Name to find
+ * @param value  Output: value belonging to the name
+ *
+ * @return true if the name has been found
+ */
+
+bool find_name_in_index(const name_index_t *index, const char *name, uint32_t *value)
+{
+    if ((index->size == 0) || (name == NULL))
+    {
+        return false;
+    }
+
+    uint32_t hash = name_hash(name);
+    uint32_t mask = index->size - 1u;
+
+    for (uint32_t i = hash & mask; index->entry[i].name != NULL; i = (i + 1u) & mask)
+    {
+        if ((index->entry[i].hash == hash) && (strcmp(index->entry[i].name, name) == 0))
+        {
+            *value = index->entry[i].value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    name_index.h
+ * @author  B. Premzel
+ * @brief   Hash table index of the names defined in the format definition files.
+ ******************************************************************************/
+
+#ifndef _NAME_INDEX_H
+#define _NAME_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* @brief Single name in the index */
+typedef struct
+{
+    const char *name;               /*!< Indexed name (NULL = empty entry) */
+    uint32_t hash;                  /*!< Hash value of the name */
+    uint32_t value;                 /*!< Value belonging to the name - e.g. index of the enum */
+} name_index_entry_t;
+
+
+/* @brief Hash table with open addressing. A zero initialized structure is an empty index. */
+typedef struct
+{
+    name_index_entry_t *entry;      /*!< Table of entries */
+    uint32_t size;                  /*!< Number of entries in the table (power of 2) */
+    uint32_t used;                  /*!< Number of names in the table */
+} name_index_t;
+
+
+void add_name_to_index(name_index_t *index, const char *name, uint32_t value);
+bool find_name_in_index(const name_index_t *index, const char *name, uint32_t *value);
+
+#endif  // _NAME_INDEX_H
+
+/*==== End of file ====*/
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    out_file_decimation.c
+ * @author  B. Premzel
+ * @brief   Decimation of the OUT_FILE() outputs for the plotting of high-rate
+ *          signals, e.g. OUT_FILE(CSV, "current.csv", "w", "t;I\n", MINMAX=0.01).
+ *          DECIMATE=N - only every N-th message writing to the file is written.
+ *          MINMAX=T   - only the messages with the min. and max. value in each
+ *                       time window of T seconds are written (in their original
+ *                       order). The value is the first numeric value written to
+ *                       the file by the message.
+ *          The decision is made before the values of a message are printed to
+ *          the file. The text of the messages that are not written is not
+ *          formatted at all (see capture_file_output()). The text of the current
+ *          min. and max. candidates of the time window is collected in buffers
+ *          and written when the next window starts. The values are prepared
+ *          as before, so the Main.log, MEMO values and statistics see all values.
+ *          The messages writing to the OUT_FILE() files are always printed by
+ *          the decoding thread (see parallel_decode.c). The decimation state is
+ *          a part of the g_msg, so each decoding library context has its own.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "main.h"
+#include "format.h"
+#include "print_helper.h"
+#include "print_message.h"
+#include "out_file_decimation.h"
+
+
+/* @brief Decimation state of an OUT_FILE() file */
+typedef struct _decimation_state_t
+{
+    uint32_t decided_message;       /*!< Message number of the last decision + 1 (0 - none) */
+    captured_text_t *target;        /*!< Buffer for the text of the current message (NULL - discarded) */
+    bool written;                   /*!< true - the current message is written directly to the file */
+    uint32_t messages;              /*!< DECIMATE=N: messages found since the last message written */
+
+    // MINMAX=T
+    bool window_started;            /*!< true - the candidates of the current window are valid */
+    double window;                  /*!< Number of the current time window (integral value) */
+    double min_value;               /*!< Min. value in the current window */
+    double max_value;               /*!< Max. value in the current window */
+    captured_text_t min_text;       /*!< Text of the message with the min. value */
+    captured_text_t max_text;       /*!< Text of the message with the max. value */
+    bool max_is_min;                /*!< true - the same message (min_text) has the min. and max. value */
+    bool min_first;                 /*!< true - the message with the min. value was found first */
+} decimation_state_t;
+
+
+/**
+ * @brief Checks if the output of an OUT_FILE() is decimated.
+ *
+ * @param out_file  Index of the OUT_FILE() definition in the g_msg.enums[].
+ *
+ * @return true - DECIMATE=N or MINMAX=T defined for the file
+ */
+
+bool out_file_is_decimated(unsigned out_file)
+{
+    if ((out_file < NUMBER_OF_FILTER_BITS) || (out_file >= MAX_ENUMS)
+        || (g_msg.enums[out_file].type != OUT_FILE_TYPE))
+    {
+        return false;
+    }
+
+    return (g_msg.enums[out_file].decimation > 1u) || (g_msg.enums[out_file].minmax_window > 0);
+}
+
+
+/**
+ * @brief Finds the first numeric value which the current message writes to the OUT_FILE().
+ *
+ * @param op        First operation of the message which writes to the file.
+ * @param plan_end  End of the decode plan of the message.
+ *
+ * @return Value (0 - no numeric value written to the file)
+ */
+
+static double get_minmax_value(const decode_op_t *op, const decode_op_t *plan_end)
+{
+    double value = 0;
+    rte_enum_t out_file = op->fmt.out_file;
+
+    for ( ; op < plan_end; op++)
+    {
+        value_format_t fmt = op->fmt;      // The decode plan is shared with the printing threads
+
+        if ((op->fmt.out_file == out_file) && prepare_query_value(&fmt))
+        {
+            value = g_ctx->value.data_double;
+            break;
+        }
+    }
+
+    memset(&g_ctx->value, 0, sizeof(g_ctx->value));
+    return value;
+}
+
+
+/**
+ * @brief Writes the text of the min. and max. candidates of the finished time window.
+ *
+ * @param state  Decimation state of the file.
+ * @param out    Output file.
+ */
+
+static void write_minmax_window(decimation_state_t *state, FILE *out)
+{
+    if (!state->window_started)
+    {
+        return;
+    }
+
+    captured_text_t *first = state->min_first ? &state->min_text : &state->max_text;
+    captured_text_t *second = state->min_first ? &state->max_text : &state->min_text;
+
+    if (state->max_is_min)
+    {
+        first = &state->min_text;
+        second = NULL;
+    }
+
+    fwrite(first->text, 1, first->length, out);
+
+    if (second != NULL)
+    {
+        fwrite(second->text, 1, second->length, out);
+    }
+
+    state->window_started = false;
+}
+
+
+/**
+ * @brief Selects the candidate buffer for the current message (MINMAX=T).
+ *
+ * @param state     Decimation state of the file.
+ * @param out_file  Index of the OUT_FILE() definition.
+ * @param op        First operation of the message which writes to the file.
+ * @param plan_end  End of the decode plan of the message.
+ */
+
+static void select_minmax_candidate(decimation_state_t *state, unsigned out_file,
+    const decode_op_t *op, const decode_op_t *plan_end)
+{
+    // The window number is kept as a double - very long captures or short windows may exceed int64_t
+    double window = floor(g_ctx->timestamp / g_msg.enums[out_file].minmax_window);
+    double value = get_minmax_value(op, plan_end);
+    state->target = NULL;
+
+    if (!state->window_started || (window != state->window))
+    {
+        write_minmax_window(state, op->out);
+        state->window_started = true;
+        state->window = window;
+        state->min_value = value;
+        state->max_value = value;
+        state->max_is_min = true;
+        state->min_first = true;
+        state->target = &state->min_text;
+    }
+    else if (value < state->min_value)
+    {
+        if (state->max_is_min)
+        {
+            // The previous message remains the max. candidate
+            captured_text_t text = state->max_text;
+            state->max_text = state->min_text;
+            state->min_text = text;
+            state->max_is_min = false;
+        }
+
+        state->min_value = value;
+        state->min_first = false;
+        state->target = &state->min_text;
+    }
+    else if (value > state->max_value)
+    {
+        state->max_is_min = false;
+        state->max_value = value;
+        state->min_first = true;
+        state->target = &state->max_text;
+    }
+
+    if (state->target != NULL)
+    {
+        state->target->length = 0;
+    }
+}
+
+
+/**
+ * @brief Decides if the text of a decode plan operation is written to its decimated OUT_FILE(),
+ *        collected as a candidate of the time window or discarded. The decision is made for the
+ *        first operation of a message writing to the file. The capturing must be stopped with
+ *        capture_file_output(NULL, NULL) after the operation has been printed.
+ *
+ * @param op        Decode plan operation writing to a decimated OUT_FILE() (op->out != NULL).
+ * @param plan_end  End of the decode plan of the message.
+ */
+
+void select_decimated_output(const decode_op_t *op, const decode_op_t *plan_end)
+{
+    unsigned out_file = op->fmt.out_file;
+
+    if (g_msg.decimation == NULL)
+    {
+        g_msg.decimation = (decimation_state_t **)allocate_memory(MAX_ENUMS * sizeof(decimation_state_t *),
+            "outDecim");
+    }
+
+    decimation_state_t *state = g_msg.decimation[out_file];
+
+    if (state == NULL)
+    {
+        state = (decimation_state_t *)allocate_memory(sizeof(decimation_state_t), "outDecim");
+        g_msg.decimation[out_file] = state;
+    }
+
+    if (state->decided_message != (g_ctx->message_cnt + 1u))
+    {
+        state->decided_message = g_ctx->message_cnt + 1u;
+
+        if (g_msg.enums[out_file].minmax_window > 0)
+        {
+            select_minmax_candidate(state, out_file, op, plan_end);
+            state->written = false;
+        }
+        else
+        {
+            state->written = (state->messages == 0);
+            state->target = NULL;
+
+            if (++state->messages >= g_msg.enums[out_file].decimation)
+            {
+                state->messages = 0;
+            }
+        }
+    }
+
+    if (!state->written)
+    {
+        capture_file_output(op->out, state->target);
+    }
+}
+
+
+/**
+ * @brief Releases the decimation state of the OUT_FILE() files.
+ *
+ * @param state      Decoding state (g_msg or the state of a decoding library context)
+ * @param write_out  true - write the candidates of the last time windows (MINMAX=T) to the files
+ */
+
+static void release_decimation(rte_msg_t *state, bool write_out)
+{
+    if (state->decimation == NULL)
+    {
+        return;
+    }
+
+    for (unsigned i = NUMBER_OF_FILTER_BITS; i < MAX_ENUMS; i++)
+    {
+        decimation_state_t *file_state = state->decimation[i];
+
+        if (file_state == NULL)
+        {
+            continue;
+        }
+
+        if (write_out && (state->enums[i].type == OUT_FILE_TYPE) && (state->enums[i].u.p_file != NULL))
+        {
+            write_minmax_window(file_state, state->enums[i].u.p_file);
+        }
+
+        release_memory(file_state->min_text.text, file_state->min_text.size, "outDecim");
+        release_memory(file_state->max_text.text, file_state->max_text.size, "outDecim");
+        release_memory(file_state, sizeof(decimation_state_t), "outDecim");
+    }
+
+    release_memory(state->decimation, MAX_ENUMS * sizeof(decimation_state_t *), "outDecim");
+    state->decimation = NULL;
+}
+
+
+/**
+ * @brief Writes the candidates of the last time windows (MINMAX=T) to the files and resets
+ *        the decimation for the next binary data file (-batch, -server) or the next data
+ *        of a decoding library context (rtemsg_finish()).
+ */
+
+void flush_decimated_out_files(void)
+{
+    release_decimation(&g_msg, true);
+}
+
+
+/**
+ * @brief Releases the decimation state of a decoding library context without writing
+ *        the candidates of the last time windows (see rtemsg_delete_context()).
+ *
+ * @param state  Decoding state of the context
+ */
+
+void discard_decimated_out_files(rte_msg_t *state)
+{
+    release_decimation(state, false);
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    out_file_decimation.h
+ * @author  B. Premzel
+ * @brief   Header file for the decimation of the OUT_FILE() outputs
+ *          (DECIMATE=N and MINMAX=T arguments of the OUT_FILE() directive).
+ ******************************************************************************/
+
+#ifndef _OUT_FILE_DECIMATION_H
+#define _OUT_FILE_DECIMATION_H
+
+#include <stdbool.h>
+#include "main.h"
+#include "format.h"
+
+
+/***** Function declarations *****/
+bool out_file_is_decimated(unsigned out_file);
+void select_decimated_output(const decode_op_t *op, const decode_op_t *plan_end);
+void flush_decimated_out_files(void);
+void discard_decimated_out_files(rte_msg_t *state);
+
+#endif  // _OUT_FILE_DECIMATION_H
+
+/*==== End of file ====*/
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    parallel_decode.c
+ * @author  B. Premzel
+ * @brief   Parallel printing of the decoded messages (-threads=N).
+ *          The binary data is decoded sequentially (message assembly, timestamp
+ *          reconstruction, statistics). Messages whose printing does not depend
+ *          on other messages are copied to a batch and printed by the printing
+ *          workers into their own output buffers. Everything else printed to
+ *          Main.log while the batch is collected goes to a separate buffer.
+ *          A full batch is printed by the workers while the decoding thread
+ *          collects the next one. The texts of the printed batch are merged in
+ *          the message order before the next batch is handed over, so Main.log
+ *          is identical to the one from the sequential printing. The batches of
+ *          the multiple data capture files end at the snapshot boundaries, i.e.
+ *          a snapshot is printed while the following one is decoded.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <string.h>
+#include "main.h"
+#include "format.h"
+#include "print_message.h"
+#include "parallel_decode.h"
+#include "profile.h"
+
+
+/* Output buffer of a printing worker or for the sequentially printed text */
+typedef struct
+{
+    FILE *file;                     /*!< Memory stream (Linux) or temporary file (Windows) */
+    char *buffer;                   /*!< Memory stream contents - valid after the fflush() */
+    size_t size;                    /*!< Memory stream size */
+} output_buffer_t;
+
+
+/* Message handed over to the printing workers */
+typedef struct
+{
+    msg_data_t *p_fmt;              /*!< Formatting definitions of the message */
+    uint32_t fmt_id;                /*!< Format ID of the message */
+    uint32_t message_cnt;           /*!< Number of the message */
+    uint32_t asm_size;              /*!< Assembled message size [bytes] */
+    uint32_t data_index;            /*!< Index of the message data in the data[] of the batch */
+    double timestamp;               /*!< Full timestamp of the message in seconds */
+    bool mark_problematic_tstamp;   /*!< Add '#' before the message number */
+    long seq_position;              /*!< Size of the sequentially printed text before this message */
+    long text_start;                /*!< Start of the message text in the worker output buffer */
+    long text_end;                  /*!< End of the message text in the worker output buffer */
+} print_job_t;
+
+
+/* Batch of messages - one is collected by the decoding thread while the other is printed */
+typedef struct
+{
+    print_job_t *job;
+    uint32_t jobs;                  /*!< Number of messages in the batch */
+    uint32_t *data;                 /*!< Copy of the message data for the batch */
+    uint32_t data_used;             /*!< Number of data words used in the batch */
+    output_buffer_t seq;            /*!< Text printed to Main.log while the batch was collected */
+} print_batch_t;
+
+
+/* Printing worker thread */
+typedef struct
+{
+    thread_compat_t thread;
+    mutex_compat_t lock;
+    cond_compat_t batch_available;  /*!< Signalled when the jobs have been assigned to the worker */
+    cond_compat_t batch_printed;    /*!< Signalled when the worker has printed all assigned jobs */
+    bool printing;                  /*!< true - the assigned jobs have not been printed yet */
+    print_batch_t *batch;           /*!< Batch with the assigned jobs */
+    uint32_t first_job;             /*!< Index of the first job assigned to the worker */
+    uint32_t last_job;              /*!< Index after the last assigned job */
+    output_buffer_t out;            /*!< Text printed by the worker */
+    msg_context_t ctx;              /*!< Printing context of the worker */
+} print_worker_t;
+
+
+static struct
+{
+    bool enabled;                   /*!< Parallel printing active */
+    bool collecting;                /*!< Main.log is replaced by the seq.file of the collected batch */
+    bool batch_printing;            /*!< The batch handed over to the workers has not been merged yet */
+    unsigned workers;               /*!< Number of printing workers (without the decoding thread) */
+    print_worker_t *worker;
+    print_batch_t batch[2];
+    unsigned collected;             /*!< Index of the batch collected by the decoding thread */
+    uint32_t jobs_per_worker;       /*!< Number of jobs assigned to each worker for the printed batch */
+    FILE *main_log;                 /*!< Main.log - replaced by seq.file while the batch is collected */
+} printer;
+
+
+/**
+ * @brief Opens an output buffer for the printing.
+ *
+ * @param out  Pointer to the output buffer structure
+ *
+ * @return true - the buffer is ready, false - the buffer could not be created
+ */
+
+static bool open_output_buffer(output_buffer_t *out)
+{
+#ifdef _WIN32
+    out->file = tmpfile();
+#else
+    out->file = open_memstream(&out->buffer, &out->size);
+#endif
+    return out->file != NULL;
+}
+
+
+/**
+ * @brief Copies part of the output buffer contents to a file.
+ *        The buffer must have been flushed before the first call after the printing.
+ *
+ * @param out     File to which the text is copied
+ * @param buffer  Output buffer from which the text is copied
+ * @param from    Index of the first character
+ * @param to      Index after the last character
+ */
+
+static void copy_output_buffer(FILE *out, output_buffer_t *buffer, long from, long to)
+{
+    if (to <= from)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    char text[CMP_BUFSIZ];
+    (void)fseek(buffer->file, from, SEEK_SET);
+
+    while (from < to)
+    {
+        size_t size = sizeof(text);
+
+        if ((size_t)(to - from) < size)
+        {
+            size = (size_t)(to - from);
+        }
+
+        size = fread(text, 1, size, buffer->file);
+
+        if (size == 0)
+        {
+            break;
+        }
+
+        fwrite(text, 1, size, out);
+        from += (long)size;
+    }
+#else
+    fwrite(buffer->buffer + from, 1, (size_t)(to - from), out);
+#endif
+}
+
+
+/**
+ * @brief Prints the jobs assigned to the worker to its output buffer.
+ *        Each job is printed with the worker's own printing context.
+ *
+ * @param worker  Pointer to the worker
+ */
+
+static void print_assigned_jobs(print_worker_t *worker)
+{
+    msg_context_t *ctx = &worker->ctx;
+    print_batch_t *batch = worker->batch;
+    long position = 0;
+    rewind(worker->out.file);
+
+    for (uint32_t i = worker->first_job; i < worker->last_job; i++)
+    {
+        print_job_t *job = &batch->job[i];
+
+        ctx->main_log = worker->out.file;
+        ctx->assembled_msg = &batch->data[job->data_index];
+        ctx->asm_size = job->asm_size;
+        ctx->fmt_id = job->fmt_id;
+        ctx->message_cnt = job->message_cnt;
+        ctx->timestamp = job->timestamp;
+        ctx->mark_problematic_tstamp = job->mark_problematic_tstamp;
+        ctx->error_value_no = 0;
+        ctx->msg_error_counter = 0;
+        ctx->msg_errors_shown = 0;
+
+        print_message_text(job->p_fmt);
+
+        job->text_start = position;
+        position = ftell(worker->out.file);
+        job->text_end = position;
+    }
+
+    fflush(worker->out.file);
+}
+
+
+/**
+ * @brief Printing worker thread. Prints the jobs assigned by print_batch_in_background().
+ *
+ * @param arg  Pointer to the worker
+ *
+ * @return Always 0 (the thread runs until the application exits)
+ */
+
+static thread_ret_compat_t THREAD_API_COMPAT print_worker_thread(void *arg)
+{
+    print_worker_t *worker = (print_worker_t *)arg;
+    g_ctx = &worker->ctx;
+
+    for ( ;; )
+    {
+        mutex_lock_compat(&worker->lock);
+
+        while (!worker->printing)
+        {
+            cond_wait_compat(&worker->batch_available, &worker->lock);
+        }
+
+        mutex_unlock_compat(&worker->lock);
+
+        print_assigned_jobs(worker);
+
+        mutex_lock_compat(&worker->lock);
+        worker->printing = false;
+        cond_signal_compat(&worker->batch_printed);
+        mutex_unlock_compat(&worker->lock);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Starts the printing workers if enabled with the -threads=N command line argument.
+ *        The messages are printed sequentially if the output buffers cannot be created.
+ *        Fewer workers are used if some of the threads cannot be started.
+ */
+
+void start_parallel_printing(void)
+{
+    unsigned threads = g_msg.param.decode_threads;
+
+    if ((threads < 2u) || (printer.worker != NULL))
+    {
+        return;     // The workers are started only once for all binary data files (-batch)
+    }
+
+    // The decoding thread collects the next batch while the workers print
+    printer.worker = (print_worker_t *)allocate_memory((threads - 1u) * sizeof(print_worker_t), "printWrk");
+
+    if (!open_output_buffer(&printer.batch[0].seq) || !open_output_buffer(&printer.batch[1].seq))
+    {
+        return;
+    }
+
+    for (unsigned i = 1u; i < threads; i++)
+    {
+        print_worker_t *worker = &printer.worker[printer.workers];
+
+        if (!open_output_buffer(&worker->out))
+        {
+            break;
+        }
+
+        mutex_init_compat(&worker->lock);
+        cond_init_compat(&worker->batch_available);
+        cond_init_compat(&worker->batch_printed);
+        worker->ctx.profile = new_print_profile();
+
+        if (!thread_create_compat(&worker->thread, print_worker_thread, worker))
+        {
+            break;
+        }
+
+        printer.workers++;
+    }
+
+    if (printer.workers == 0)
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < 2u; i++)
+    {
+        print_batch_t *batch = &printer.batch[i];
+        batch->job = (print_job_t *)allocate_memory(PARALLEL_PRINT_BATCH * sizeof(print_job_t), "printJob");
+        batch->data = (uint32_t *)allocate_memory(PARALLEL_PRINT_DATA * sizeof(uint32_t), "printData");
+    }
+
+    printer.enabled = true;
+}
+
+
+/**
+ * @brief Checks if the printing of a message type depends only on the message itself.
+ *        MEMO values, OUT_FILE() outputs, value statistics and time differences to other
+ *        messages depend on the message order and must be processed sequentially.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message
+ *
+ * @return PARALLEL_PRINT_POSSIBLE or PARALLEL_PRINT_NOT_POSSIBLE
+ */
+
+static enum parallel_print_t check_parallel_printing(const msg_data_t *p_fmt)
+{
+    if (g_msg.param.column_export)
+    {
+        return PARALLEL_PRINT_NOT_POSSIBLE;     // The values are collected in the message order
+    }
+
+    for (const value_format_t *fmt = p_fmt->format; fmt != NULL; fmt = fmt->format)
+    {
+        if ((fmt->out_file != 0) || (fmt->get_memo != 0) || (fmt->put_memo != 0))
+        {
+            return PARALLEL_PRINT_NOT_POSSIBLE;
+        }
+
+        if ((fmt->value_stat != NULL) && (g_msg.param.value_statistics_enabled))
+        {
+            return PARALLEL_PRINT_NOT_POSSIBLE;
+        }
+
+        if ((fmt->data_type == VALUE_MEMO) || (fmt->data_type == VALUE_dTIMESTAMP)
+            || (fmt->data_type == VALUE_TIME_DIFF)
+            || (fmt->fmt_type == PRINT_dTIMESTAMP) || (fmt->fmt_type == PRINT_DATE))
+        {
+            return PARALLEL_PRINT_NOT_POSSIBLE;
+        }
+    }
+
+    return PARALLEL_PRINT_POSSIBLE;
+}
+
+
+/**
+ * @brief Merges the texts printed by the workers and the text printed sequentially
+ *        during the batch collection into Main.log in the message order.
+ *
+ * @param batch  Pointer to the printed batch
+ */
+
+static void merge_printed_texts(print_batch_t *batch)
+{
+    FILE *out = printer.main_log;
+    long seq_end = ftell(batch->seq.file);
+    fflush(batch->seq.file);
+    long seq_done = 0;
+
+    for (uint32_t i = 0; i < batch->jobs; i++)
+    {
+        print_job_t *job = &batch->job[i];
+        copy_output_buffer(out, &batch->seq, seq_done, job->seq_position);
+        seq_done = job->seq_position;
+
+        // Copy the texts of consecutive jobs printed by the same worker at once
+        print_worker_t *worker = &printer.worker[i / printer.jobs_per_worker];
+        long text_start = job->text_start;
+        long text_end = job->text_end;
+
+        while (((i + 1u) < worker->last_job) && (batch->job[i + 1u].seq_position == seq_done))
+        {
+            i++;
+            text_end = batch->job[i].text_end;
+        }
+
+        copy_output_buffer(out, &worker->out, text_start, text_end);
+    }
+
+    copy_output_buffer(out, &batch->seq, seq_done, seq_end);
+    rewind(batch->seq.file);
+    batch->jobs = 0;
+    batch->data_used = 0;
+}
+
+
+/**
+ * @brief Waits until the workers have printed the batch handed over by print_batch_in_background()
+ *        and writes its texts to Main.log.
+ */
+
+static void wait_for_printed_batch(void)
+{
+    if (!printer.batch_printing)
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < printer.workers; i++)
+    {
+        print_worker_t *worker = &printer.worker[i];
+        mutex_lock_compat(&worker->lock);
+
+        while (worker->printing)
+        {
+            cond_wait_compat(&worker->batch_printed, &worker->lock);
+        }
+
+        mutex_unlock_compat(&worker->lock);
+    }
+
+    merge_printed_texts(&printer.batch[printer.collected ^ 1u]);
+    printer.batch_printing = false;
+}
+
+
+/**
+ * @brief Hands the collected batch over to the printing workers. The decoding thread continues
+ *        with the collection of the other batch. The previously handed over batch is merged
+ *        to Main.log first, so that the texts are written in the message order.
+ */
+
+static void print_batch_in_background(void)
+{
+    uint64_t start = profile_start();
+    wait_for_printed_batch();
+
+    print_batch_t *batch = &printer.batch[printer.collected];
+    uint32_t jobs_per_worker = (batch->jobs + printer.workers - 1u) / printer.workers;
+    printer.jobs_per_worker = (jobs_per_worker == 0) ? 1u : jobs_per_worker;
+
+    for (unsigned i = 0; i < printer.workers; i++)
+    {
+        print_worker_t *worker = &printer.worker[i];
+        uint32_t first_job = i * jobs_per_worker;
+        uint32_t last_job = first_job + jobs_per_worker;
+
+        if (first_job > batch->jobs)
+        {
+            first_job = batch->jobs;
+        }
+
+        if (last_job > batch->jobs)
+        {
+            last_job = batch->jobs;
+        }
+
+        worker->batch = batch;
+        worker->first_job = first_job;
+        worker->last_job = last_job;
+
+        if (first_job < last_job)
+        {
+            mutex_lock_compat(&worker->lock);
+            worker->printing = true;
+            cond_signal_compat(&worker->batch_available);
+            mutex_unlock_compat(&worker->lock);
+        }
+    }
+
+    // The text printed by the decoding thread is collected for the next batch
+    printer.batch_printing = true;
+    printer.collected ^= 1u;
+    g_msg.file.main_log = printer.batch[printer.collected].seq.file;
+    profile_stop(PROFILE_PARALLEL_PRINTING, start);
+}
+
+
+/**
+ * @brief Adds the message from the printing context of the decoding thread to the current batch.
+ *        Messages are printed in parallel only if the message type does not depend on other
+ *        messages and a message with the same size has already been printed without decoding
+ *        errors, i.e. the printing of the message cannot report errors either.
+ *        Decoding errors restart the timestamp search and must be known before the next
+ *        message is decoded.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message
+ *
+ * @return true - the message will be printed by the printing workers,
+ *         false - the message has to be printed by the caller
+ */
+
+bool queue_message_for_parallel_printing(msg_data_t *p_fmt)
+{
+    if (!printer.enabled)
+    {
+        return false;
+    }
+
+    if (p_fmt->parallel_print == PARALLEL_PRINT_UNKNOWN)
+    {
+        p_fmt->parallel_print = check_parallel_printing(p_fmt);
+    }
+
+    if ((p_fmt->parallel_print != PARALLEL_PRINT_POSSIBLE) || (!p_fmt->size_verified)
+        || (p_fmt->verified_size != g_ctx->asm_size))
+    {
+        return false;
+    }
+
+    // Copy the message data with two zero words (the message can be printed as a zero terminated string)
+    uint32_t data_words = (g_ctx->asm_size + 3u) / 4u;
+
+    if ((data_words + 2u) > PARALLEL_PRINT_DATA)
+    {
+        return false;
+    }
+
+    if (!printer.collecting)
+    {
+        // Collect the text printed by the decoding thread until the batch is printed
+        printer.main_log = g_msg.file.main_log;
+        g_msg.file.main_log = printer.batch[printer.collected].seq.file;
+        printer.collecting = true;
+    }
+
+    print_batch_t *batch = &printer.batch[printer.collected];
+
+    if ((batch->jobs >= PARALLEL_PRINT_BATCH) || ((batch->data_used + data_words + 2u) > PARALLEL_PRINT_DATA))
+    {
+        print_batch_in_background();
+        batch = &printer.batch[printer.collected];
+    }
+
+    print_job_t *job = &batch->job[batch->jobs++];
+    job->p_fmt = p_fmt;
+    job->fmt_id = g_ctx->fmt_id;
+    job->message_cnt = g_ctx->message_cnt;
+    job->asm_size = g_ctx->asm_size;
+    job->timestamp = g_ctx->timestamp;
+    job->mark_problematic_tstamp = g_ctx->mark_problematic_tstamp;
+    job->seq_position = ftell(batch->seq.file);
+    job->data_index = batch->data_used;
+
+    uint32_t *data = &batch->data[batch->data_used];
+    memcpy(data, g_ctx->assembled_msg, data_words * sizeof(uint32_t));
+    data[data_words] = 0;
+    data[data_words + 1u] = 0;
+    batch->data_used += data_words + 2u;
+
+    return true;
+}
+
+
+/**
+ * @brief Hands the messages of the finished snapshot over to the printing workers
+ *        (multiple data capture files). The snapshot is printed while the next one
+ *        is decoded. Snapshots with only a few messages are collected together.
+ */
+
+void end_of_snapshot_for_parallel_printing(void)
+{
+    if (printer.collecting && (printer.batch[printer.collected].jobs >= PARALLEL_PRINT_MIN_BATCH))
+    {
+        print_batch_in_background();
+    }
+}
+
+
+/**
+ * @brief Prints the messages collected in the current batch and writes them to Main.log
+ *        together with the text printed by the decoding thread in the meantime.
+ *        Must be called before Main.log is used outside of the message decoding and
+ *        before waiting for new data.
+ */
+
+void flush_parallel_printing(void)
+{
+    if (!printer.collecting)
+    {
+        return;
+    }
+
+    print_batch_in_background();
+
+    uint64_t start = profile_start();
+    wait_for_printed_batch();
+    g_msg.file.main_log = printer.main_log;     // Restore Main.log for the decoding thread
+    printer.collecting = false;
+    profile_stop(PROFILE_PARALLEL_PRINTING, start);
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    parallel_decode.h
+ * @author  B. Premzel
+ * @brief   Header file for the parallel printing of decoded messages.
+ ******************************************************************************/
+
+#ifndef _PARALLEL_DECODE_H
+#define _PARALLEL_DECODE_H
+
+#include "main.h"
+#include "format.h"
+
+void start_parallel_printing(void);
+bool queue_message_for_parallel_printing(msg_data_t *p_fmt);
+void end_of_snapshot_for_parallel_printing(void);
+void flush_parallel_printing(void);
+
+#endif // _PARALLEL_DECODE_H
+
+/*==== End of file ====*/
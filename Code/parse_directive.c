@@ -27,6 +27,8 @@
 #include "files.h"
 #include "errors.h"
 #include "decoder.h"
+#include "fmt_cache.h"
+#include "parse_header_state.h"
 
 
 /**
@@ -512,7 +514,7 @@ static void parse_filter(parse_handle_t *parse_handle)
         }
 
         process_escape_sequences(filter_descr, MAX_NAME_LENGTH);
-        g_msg.enums[filter_no].u.filter_description = duplicate_string(filter_descr);
+        g_msg.enums[filter_no].u.filter_description = duplicate_parse_string(filter_descr);
     }
 
     check_closing_bracket(parse_handle, position);
@@ -610,7 +612,7 @@ static void parse_in_file(parse_handle_t *parse_handle)
 
     // Ensure the IN_FILE() with the same file path hasn't been defined before
     file_name_used_before(parse_handle, file_path, IN_FILE_TYPE);
-    g_msg.enums[g_msg.enums_found].file_name = duplicate_string(file_path);
+    g_msg.enums[g_msg.enums_found].file_name = duplicate_parse_string(file_path);
 
     // Skip reading the file if only syntax check/compile is initiated
     if (g_msg.param.check_syntax_and_compile == 0)
@@ -625,8 +627,64 @@ static void parse_in_file(parse_handle_t *parse_handle)
 
 
 /**
- * @brief Parses the OUT_FILE(NAME, "File path", "mode", "Optional initial text") directive.
- *        Defines an output file for message logging with optional initial content.
+ * @brief Parses the optional decimation argument of the OUT_FILE() directive:
+ *        DECIMATE=N - only every N-th message is written to the file,
+ *        MINMAX=T   - the messages with the min. and max. value in each time window T [s].
+ *
+ * @param parse_handle  Pointer to the format definitions parse handle.
+ * @param p_enum        Pointer to the OUT_FILE() definition.
+ */
+
+static void parse_out_file_decimation(parse_handle_t *parse_handle, enum_data_t *p_enum)
+{
+    char **position = parse_handle->p_file_line_curr_pos;
+    char *argument = *position;
+    char *end_position = NULL;
+
+    if (strncmp(*position, "DECIMATE", sizeof("DECIMATE") - 1) == 0)
+    {
+        *position += sizeof("DECIMATE") - 1;
+        skip_whitespace(position);
+
+        if (*(*position)++ == '=')
+        {
+            unsigned long value = strtoul(*position, &end_position, 10);
+
+            if ((end_position > *position) && (value >= 2u) && (value <= MAX_OUT_FILE_DECIMATION))
+            {
+                p_enum->decimation = (uint32_t)value;
+                *position = end_position;
+                return;
+            }
+        }
+    }
+    else if (strncmp(*position, "MINMAX", sizeof("MINMAX") - 1) == 0)
+    {
+        *position += sizeof("MINMAX") - 1;
+        skip_whitespace(position);
+
+        if (*(*position)++ == '=')
+        {
+            double value = strtod(*position, &end_position);
+
+            if ((end_position > *position)
+                && (value >= MIN_OUT_FILE_MINMAX_WINDOW) && (value <= MAX_OUT_FILE_MINMAX_WINDOW))
+            {
+                p_enum->minmax_window = value;
+                *position = end_position;
+                return;
+            }
+        }
+    }
+
+    catch_parsing_error(parse_handle, ERR_PARSE_OUT_FILE_DECIMATION, argument);
+}
+
+
+/**
+ * @brief Parses the OUT_FILE(NAME, "File path", "mode", "Optional initial text", decimation)
+ *        directive. Defines an output file for message logging with optional initial content.
+ *        The optional decimation (DECIMATE=N or MINMAX=T) may also follow the file mode directly.
  *
  * @param parse_handle  Pointer to the format definitions parse handle.
  */
@@ -634,6 +692,8 @@ static void parse_in_file(parse_handle_t *parse_handle)
 static void parse_out_file(parse_handle_t *parse_handle)
 {
     g_msg.enums[g_msg.enums_found].type = OUT_FILE_TYPE;
+    g_msg.enums[g_msg.enums_found].decimation = 0;
+    g_msg.enums[g_msg.enums_found].minmax_window = 0;
     char **position = parse_handle->p_file_line_curr_pos;
 
     static char file_path[MAX_FILEPATH_LENGTH];
@@ -661,7 +721,7 @@ static void parse_out_file(parse_handle_t *parse_handle)
 
     // Ensure the OUT_FILE() with the same file path hasn't been defined before
     file_name_used_before(parse_handle, file_path, OUT_FILE_TYPE);
-    g_msg.enums[g_msg.enums_found].file_name = duplicate_string(file_path);
+    g_msg.enums[g_msg.enums_found].file_name = duplicate_parse_string(file_path);
 
     // Parse file mode argument
     skip_whitespace(position);
@@ -680,17 +740,33 @@ static void parse_out_file(parse_handle_t *parse_handle)
 
     check_file_mode(parse_handle, file_mode);
 
-    // Parse optional initial text (e.g., for a CSV file)
+    // Parse optional initial text (e.g., for a CSV file) and decimation
     skip_whitespace(position);
 
     if (*(*position) == ',')
     {
         (*position)++;
+        skip_whitespace(position);
 
-        if (!parse_quoted_arg(position, parsedInitText, MAX_INPUT_LINE_LENGTH - 1))
+        if (*(*position) != '"')
+        {
+            parse_out_file_decimation(parse_handle, &g_msg.enums[g_msg.enums_found]);
+        }
+        else if (!parse_quoted_arg(position, parsedInitText, MAX_INPUT_LINE_LENGTH - 1))
         {
             catch_parsing_error(parse_handle, ERR_PARSE_OUT_FILE_INIT_TEXT, *position);
         }
+        else
+        {
+            skip_whitespace(position);
+
+            if (*(*position) == ',')
+            {
+                (*position)++;
+                skip_whitespace(position);
+                parse_out_file_decimation(parse_handle, &g_msg.enums[g_msg.enums_found]);
+            }
+        }
     }
 
     check_closing_bracket(parse_handle, position);
@@ -698,6 +774,7 @@ static void parse_out_file(parse_handle_t *parse_handle)
     // Skip file creation if only formatting definitions are checked and compiled
     if (g_msg.param.check_syntax_and_compile == 0)
     {
+        save_out_file_parameters(g_msg.enums_found, file_mode, parsedInitText);
         open_output_folder();
         FILE *new_file = create_file(file_path, parsedInitText, file_mode);
 
@@ -821,7 +898,7 @@ static void parse_input_line(parse_handle_t *parse_handle, char *file_line)
         catch_parsing_error(parse_handle, ERR_PARSE_C_DIRECTIVES_NOT_ALLOWED, pos);
     }
 
-    if (g_msg.param.check_syntax_and_compile)
+    if (g_msg.param.check_syntax_and_compile && (parse_handle->p_fmt_work_file != NULL))
     {
         fprintf(parse_handle->p_fmt_work_file, "%s", file_line);
     }
@@ -843,6 +920,49 @@ static void parse_input_line(parse_handle_t *parse_handle, char *file_line)
 }
 
 
+/**
+ * @brief Parses a line of the format definition file split into lines before the parsing
+ *        (see split_fmt_file_lines()). The empty lines and comments are not copied or examined.
+ *        The formatting definitions are copied to the line buffer, since the directive parsers
+ *        modify the line. Other lines are parsed by the parse_input_line().
+ *
+ * @param parse_handle  Pointer to the current file's parse handle.
+ * @param line          Line from the line table of the preloaded file.
+ * @param file_line     Buffer for the line (MAX_INPUT_LINE_LENGTH characters).
+ */
+
+static void parse_preloaded_line(parse_handle_t *parse_handle, const fmt_line_t *line, char *file_line)
+{
+    const char *text = &parse_handle->preloaded_file->data[line->start];
+
+    if ((line->type != FMT_LINE_OTHER) && (line->length < (MAX_INPUT_LINE_LENGTH - 4)))
+    {
+        if (g_msg.param.check_syntax_and_compile && (parse_handle->p_fmt_work_file != NULL))
+        {
+            fwrite(text, 1, line->length, parse_handle->p_fmt_work_file);
+        }
+
+        if (line->type != FMT_LINE_DIRECTIVE)
+        {
+            return;
+        }
+
+        memcpy(file_line, text, line->length);
+        file_line[line->length] = '\0';
+
+        char *pos = file_line + line->text_offset + 2u;     // Skip the '//'
+        parse_handle->p_file_line_curr_pos = &pos;
+        parse_directive(parse_handle);
+        parse_handle->p_file_line_curr_pos = NULL;
+        return;
+    }
+
+    memcpy(file_line, text, line->length);
+    file_line[line->length] = '\0';
+    parse_input_line(parse_handle, file_line);
+}
+
+
 /**
  * @brief Resets the format of the current message to default values if an error is reported.
  *        This helps prevent further errors for the same MSG directive.
@@ -912,7 +1032,33 @@ void parse_fmt_file(const char *filepath, parse_handle_t *parent_parse_handle)
 
         _set_errno(0);
 
-        if (fgets(file_line, MAX_INPUT_LINE_LENGTH, parse_handle.p_fmt_file) == NULL)
+        if ((parse_handle.preloaded_file != NULL) && (parse_handle.preloaded_file->line != NULL))
+        {
+            if (parse_handle.preloaded_line >= parse_handle.preloaded_file->lines)
+            {
+                file_line[0] = '\0';
+                break;
+            }
+
+            ++parse_handle.file_line_num;
+            parse_preloaded_line(&parse_handle,
+                &parse_handle.preloaded_file->line[parse_handle.preloaded_line++], file_line);
+            continue;
+        }
+
+        char *line_read;
+
+        if (parse_handle.preloaded_file != NULL)
+        {
+            line_read = read_preloaded_line(file_line, MAX_INPUT_LINE_LENGTH,
+                parse_handle.preloaded_file, &parse_handle.preloaded_position);
+        }
+        else
+        {
+            line_read = fgets(file_line, MAX_INPUT_LINE_LENGTH, parse_handle.p_fmt_file);
+        }
+
+        if (line_read == NULL)
         {
             file_line[0] = '\0';
 
@@ -941,6 +1087,11 @@ void parse_fmt_file(const char *filepath, parse_handle_t *parent_parse_handle)
     {
         fclose(parse_handle.p_fmt_file);
     }
+
+    if (g_msg.param.check_syntax_and_compile)
+    {
+        update_header_state(&parse_handle);
+    }
 }
 
 /*==== End of file ====*/
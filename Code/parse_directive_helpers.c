@@ -14,6 +14,37 @@
 #include "decoder.h"
 #include "errors.h"
 #include "parse_error_reporting.h"
+#include "name_index.h"
+
+
+static name_index_t enum_names;         // Index of the enum names (enums above the filter bits)
+static name_index_t in_file_names;      // Index of the IN_FILE file names
+static name_index_t out_file_names;     // Index of the OUT_FILE file names
+static rte_enum_t indexed_enums = NUMBER_OF_FILTER_BITS;    // Number of g_msg.enums[] checked for the index
+
+
+/**
+ * @brief Adds the enums defined after the previous call to the name indexes.
+ *        An enum is added only after it was completely defined (g_msg.enums_found incremented).
+ */
+
+static void update_enum_indexes(void)
+{
+    for (; indexed_enums < g_msg.enums_found; indexed_enums++)
+    {
+        const enum_data_t *p_enum = &g_msg.enums[indexed_enums];
+        add_name_to_index(&enum_names, p_enum->name, indexed_enums);
+
+        if (p_enum->type == IN_FILE_TYPE)
+        {
+            add_name_to_index(&in_file_names, p_enum->file_name, indexed_enums);
+        }
+        else if (p_enum->type == OUT_FILE_TYPE)
+        {
+            add_name_to_index(&out_file_names, p_enum->file_name, indexed_enums);
+        }
+    }
+}
 
 
 /**
@@ -26,13 +57,22 @@
 
 static void check_if_enums_name_exists(const char *newName, parse_handle_t *parse_handle)
 {
-    for (unsigned int i = 0; i < g_msg.enums_found; i++)
+    // The filter names are checked separately since a filter may be defined in any of the first 32 locations
+    for (unsigned int i = 0; (i < NUMBER_OF_FILTER_BITS) && (i < g_msg.enums_found); i++)
     {
         if ((g_msg.enums[i].name != NULL) && (strcmp(newName, g_msg.enums[i].name) == 0))
         {
             catch_parsing_error(parse_handle, ERR_PARSE_ENUMS_NAME_EXISTS, newName);
         }
     }
+
+    uint32_t enum_index;
+    update_enum_indexes();
+
+    if (find_name_in_index(&enum_names, newName, &enum_index))
+    {
+        catch_parsing_error(parse_handle, ERR_PARSE_ENUMS_NAME_EXISTS, newName);
+    }
 }
 
 
@@ -48,21 +88,17 @@ static void check_if_enums_name_exists(const char *newName, parse_handle_t *pars
 
 rte_enum_t find_enum_idx(char *enum_name, enum enums_type_t enum_type)
 {
-    rte_enum_t result = 0;
+    uint32_t enum_index;
+    update_enum_indexes();
 
-    for (rte_enum_t i = NUMBER_OF_FILTER_BITS; i < g_msg.enums_found; i++)
+    if (find_name_in_index(&enum_names, enum_name, &enum_index)
+        && (g_msg.enums[enum_index].type == enum_type)
+        )
     {
-        if ((g_msg.enums[i].name != NULL)
-            && (strcmp(g_msg.enums[i].name, enum_name) == 0)
-            && (g_msg.enums[i].type == enum_type)
-            )
-        {
-            result = i;
-            break;
-        }
+        return (rte_enum_t)enum_index;
     }
 
-    return result;
+    return 0;
 }
 
 
@@ -76,16 +112,14 @@ rte_enum_t find_enum_idx(char *enum_name, enum enums_type_t enum_type)
 
 void file_name_used_before(parse_handle_t *parse_handle, char *file_name, enum enums_type_t enum_type)
 {
-    for (rte_enum_t i = NUMBER_OF_FILTER_BITS; i < g_msg.enums_found; i++)
+    uint32_t enum_index;
+    update_enum_indexes();
+    const name_index_t *file_names = (enum_type == IN_FILE_TYPE) ? &in_file_names : &out_file_names;
+
+    if (find_name_in_index(file_names, file_name, &enum_index))
     {
-        if ((g_msg.enums[i].type == enum_type)
-            && (g_msg.enums[i].file_name != NULL)
-            && (strcmp(g_msg.enums[i].file_name, file_name) == 0)
-            )
-        {
-            catch_parsing_error(parse_handle,
-                ERR_PARSE_IN_OUT_FILE_NAME_USED_TWICE, g_msg.enums[i].name);
-        }
+        catch_parsing_error(parse_handle,
+            ERR_PARSE_IN_OUT_FILE_NAME_USED_TWICE, g_msg.enums[enum_index].name);
     }
 }
 
@@ -281,7 +315,7 @@ char *parse_directive_name(parse_handle_t *parse_handle, const char *name_prefix
         catch_parsing_error(parse_handle, ERR_PARSE_MAX_ENUMS, NULL);
     }
 
-    return duplicate_string(name);
+    return duplicate_parse_string(name);
 }
 
 
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "format.h"
+#include "parse_file_preload.h"
 
 
 struct parse_handle_str
@@ -37,6 +38,16 @@ struct parse_handle_str
     char work_file_name[MAX_FILENAME_LENGTH]; /*!< Name of the work file (output file) */
     const char *fmt_file_path;          /*!< File name of the currently parsed format definition file */
     char **p_file_line_curr_pos;        /*!< Position in the currently processed line */
+    const preloaded_file_t *preloaded_file; /*!< Format definition file loaded before the parsing (NULL - not loaded) */
+    size_t preloaded_position;          /*!< Position of the next line in the preloaded_file */
+    uint32_t preloaded_line;            /*!< Index of the next line in the preloaded_file line table */
+
+    // Incremental header regeneration (see parse_header_state.c)
+    bool output_up_to_date;             /*!< The work file is not created - the output has not changed */
+    unsigned fmt_file_number;           /*!< Number of format definition files started before this one */
+    uint32_t start_fmt_ids_defined;     /*!< Value of g_msg.fmt_ids_defined before the parsing of the file */
+    uint32_t start_fmt_align_value;     /*!< Value of g_msg.fmt_align_value before the parsing of the file */
+    uint32_t start_filter_enums;        /*!< Value of g_msg.filter_enums before the parsing of the file */
 
     // Pointers to currently used or processed data structures
     msg_data_t *p_current_message;      /*!< Message currently used for the format IDs */
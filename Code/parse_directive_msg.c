@@ -153,7 +153,7 @@ static void parse_msg_name(parse_handle_t *parse_handle)
         catch_parsing_error(parse_handle, ERR_PARSE_MSG_NAME_EXISTS, name);
     }
 
-    parse_handle->p_new_message->message_name = duplicate_string(name);
+    parse_handle->p_new_message->message_name = duplicate_parse_string(name);
 }
 
 
@@ -182,7 +182,7 @@ static void parse_msg_directive(parse_handle_t *parse_handle, size_t chars_to_sk
         catch_parsing_error(parse_handle, ERR_PARSE_MSG_IN_LINE_AFTER_IN_OUT_SELECT, NULL);
     }
 
-    parse_handle->p_new_message = (msg_data_t *)allocate_memory(sizeof(msg_data_t), "MsgParse");
+    parse_handle->p_new_message = (msg_data_t *)allocate_parse_memory(sizeof(msg_data_t), "MsgParse");
     parse_handle->p_new_message->msg_type = msg_type;
 
     char **position = parse_handle->p_file_line_curr_pos;
@@ -190,7 +190,7 @@ static void parse_msg_directive(parse_handle_t *parse_handle, size_t chars_to_sk
     *position = *position + chars_to_skip;      // Skip the message name prefix.
 
     value_format_t *new_format =
-        (value_format_t *)allocate_memory(sizeof(value_format_t), "ValFmt");
+        (value_format_t *)allocate_parse_memory(sizeof(value_format_t), "ValFmt");
     parse_handle->p_new_message->format = new_format;
 
     unsigned current_message_fmt_id = p_parse_msg_no(parse_handle);
@@ -209,6 +209,7 @@ static void parse_msg_directive(parse_handle_t *parse_handle, size_t chars_to_sk
 
     *position = p_start;    // Point to the start of "MSG.." or "EXT_MSG.." name.
     parse_msg_name(parse_handle);
+    add_message_name_to_index(parse_handle->p_new_message->message_name, current_message_fmt_id);
     parse_handle->p_current_message = parse_handle->p_new_message;
     write_define_to_work_file(parse_handle,
         parse_handle->p_current_message->message_name, current_message_fmt_id);
@@ -47,7 +47,7 @@ static void print_additional_info(const char *additional_info)
     size_t end = utf8_truncate(text, MAX_NO_OF_CHARS_PRINTED_FOR_ADDINFO_REPORTING);
     utf8_print_string(text, end);
     fprintf(g_msg.file.error_log, "%.*s", (int)end, text);
-    free(text);
+    release_memory(text, size + 1, "tmp");
 }
 
 
@@ -18,6 +18,9 @@
 #include "main.h"
 #include "parse_error_reporting.h"
 #include "decoder.h"
+#include "fmt_cache.h"
+#include "parse_header_state.h"
+#include "compress_output.h"
 
 
 /**
@@ -139,10 +142,12 @@ static bool open_file(const char *filename, FILE **file)
 
 FILE *create_file(char *filename, char *initial_text, const char *write_mode)
 {
-    FILE *new_file = utf8_fopen(filename, write_mode);
+    FILE *new_file = compressed_fopen(filename, write_mode);
 
     if (new_file != NULL)
     {
+        set_output_file_buffer(new_file);
+
         if (initial_text != NULL)
         {
             process_escape_sequences(initial_text, strlen(initial_text));
@@ -202,7 +207,7 @@ static bool create_work_file(parse_handle_t *parse_handle)
 
 
 /**
- * @brief Compares the contents of two files and closes them. Determines if the contents are identical.
+ * @brief Compares the contents of two files block by block.
  *
  * @param src  Pointer to the source format definition file.
  * @param dst  Pointer to the work file.
@@ -211,7 +216,7 @@ static bool create_work_file(parse_handle_t *parse_handle)
  * @return  true if contents are identical, false otherwise.
  */
 
-static bool compare_and_close_files(FILE *src, FILE *dst, parse_handle_t *parse_handle)
+static bool compare_file_streams(FILE *src, FILE *dst, parse_handle_t *parse_handle)
 {
     bool are_identical = false;
 
@@ -250,6 +255,69 @@ static bool compare_and_close_files(FILE *src, FILE *dst, parse_handle_t *parse_
     }
     while (comparison_result == 0);
 
+    return are_identical;
+}
+
+
+/**
+ * @brief Compares the contents of two files and closes them. Determines if the contents are identical.
+ *        Files of the same size are mapped into memory and compared with a single memcmp().
+ *        The block by block comparison is used if the files cannot be mapped. On Windows, it is
+ *        also used if the raw contents differ because a file may have different line endings.
+ *
+ * @param src  Pointer to the source format definition file.
+ * @param dst  Pointer to the work file.
+ * @param parse_handle   Pointer to the main parse handle structure.
+ *
+ * @return  true if contents are identical, false otherwise.
+ */
+
+static bool compare_and_close_files(FILE *src, FILE *dst, parse_handle_t *parse_handle)
+{
+    bool are_identical = false;
+    bool compare_streams = true;
+
+    if (fflush(dst) != 0)
+    {
+        catch_parsing_error(parse_handle, ERR_PARSE_FILE_WORK_CANNOT_COMPARE, "");
+    }
+
+    int64_t src_size = get_file_size(src);
+    int64_t dst_size = get_file_size(dst);
+
+    if ((src_size > 0) && (dst_size > 0))
+    {
+        void *src_view = NULL;
+        void *dst_view = NULL;
+
+        if (src_size == dst_size)
+        {
+            src_view = map_file_to_memory(src, src_size);
+            dst_view = map_file_to_memory(dst, dst_size);
+        }
+
+        if ((src_view != NULL) && (dst_view != NULL))
+        {
+            are_identical = (memcmp(src_view, dst_view, (size_t)src_size) == 0);
+            compare_streams = false;
+        }
+        else if (src_size != dst_size)
+        {
+            compare_streams = false;
+        }
+
+        unmap_file_from_memory(src_view, src_size);
+        unmap_file_from_memory(dst_view, dst_size);
+#ifdef _WIN32
+        compare_streams = compare_streams || !are_identical;    // Text mode line endings
+#endif
+    }
+
+    if (compare_streams)
+    {
+        are_identical = compare_file_streams(src, dst, parse_handle);
+    }
+
     fclose(src);
     fclose(dst);
 
@@ -294,7 +362,17 @@ bool setup_parse_files(parse_handle_t *parse_handle)
         return false;
     }
 
-    if (g_msg.param.check_syntax_and_compile && !create_work_file(parse_handle))
+    // Use the file contents loaded before the parsing (if available)
+    parse_handle->preloaded_file = find_preloaded_fmt_file(parse_handle->fmt_file_path);
+
+    if (parse_handle->preloaded_file == NULL)
+    {
+        skip_fmt_cache_saving();        // The file contents are not included in the cache key
+    }
+
+    // The work file is not needed if the output has not changed since the last regeneration
+    if (g_msg.param.check_syntax_and_compile
+        && !fmt_file_output_up_to_date(parse_handle) && !create_work_file(parse_handle))
     {
         report_parsing_error(parse_handle->p_parse_parent,
             ERR_PARSE_FILE_CANNOT_CREATE_FMT_WORK_FILE, parse_handle->work_file_name);
@@ -343,6 +421,7 @@ static void check_and_replace_header_file(parse_handle_t *parse_handle)
     {
         // Check if the header and work files are the same
         bool same_contents = false;
+        bool write_error = (ferror(parse_handle->p_fmt_work_file) != 0);   // Checked before the file is closed
 
         if (!parse_handle->parsing_errors_found)
         {
@@ -365,10 +444,12 @@ static void check_and_replace_header_file(parse_handle_t *parse_handle)
             return;
         }
 
-        if (ferror(parse_handle->p_fmt_work_file))
+        if (write_error)
         {
-            catch_parsing_error(parse_handle,
+            report_parsing_error(parse_handle->p_parse_parent,
                 ERR_PARSE_FILE_CANNOT_WRITE_TO_WORK_FILE, parse_handle->work_file_name);
+            (void)utf8_remove(parse_handle->work_file_name);
+            return;
         }
 
         // Remove the header file to replace it with the work file
@@ -516,7 +597,7 @@ void read_file_to_indexed_text(const char *filename, parse_handle_t *parse_handl
         catch_parsing_error(parse_handle, ERR_PARSE_IN_FILE_TOO_LONG, filename);
     }
 
-    unsigned char *str = allocate_memory((size_t)(file_size + 2), "Yfile");
+    unsigned char *str = allocate_parse_memory((size_t)(file_size + 2), "Yfile");
     size_t no_read = fread(str + 1, 1, (size_t)file_size, file);
         // The actual length is less for Windows OS because all "\r\n" are read as '\n'.
 
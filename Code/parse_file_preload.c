@@ -0,0 +1,535 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    parse_file_preload.c
+ * @author  B. Premzel
+ * @brief   Parallel loading of the format definition files before the parsing.
+ *          The main format file is scanned for the INCLUDE() directives. The
+ *          included files are loaded in parallel by several threads and scanned
+ *          for further INCLUDE() directives. The parsing itself (format ID
+ *          assignment, error reporting and work file output) remains sequential
+ *          and in the same order, so the results do not depend on the loading.
+ *          Files that were not found or not loaded are read line by line
+ *          during the parsing as before.
+ *          The loading threads also split the files into lines. The line ends
+ *          are found with memchr() and the lines are sorted into empty lines,
+ *          comments, formatting definitions ("//") and other lines, so that the
+ *          parser copies and examines only the formatting definitions.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <string.h>
+#include "platform_compat.h"
+#include "main.h"
+#include "files.h"
+#include "utf8_helpers.h"
+#include "parse_directive_helpers.h"
+#include "parse_file_preload.h"
+
+
+static struct
+{
+    preloaded_file_t file[MAX_PRELOADED_FMT_FILES];
+    unsigned files;             /*!< Number of files found in the INCLUDE() directives */
+    unsigned next_to_load;      /*!< Index of the next file to be loaded by the loading threads */
+    unsigned load_end;          /*!< Index after the last file loaded in the current pass */
+    bool lock_initialized;
+    mutex_compat_t lock;
+} preload;
+
+
+/**
+ * @brief Checks for the whitespace characters - the same as isspace() in the "C" locale
+ *        used during the parsing. The isspace() is not used by the loading threads since
+ *        the locale may be changed during the error reporting.
+ */
+
+static inline bool is_fmt_whitespace(char c)
+{
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+
+/**
+ * @brief Determines the type of a line the same way as the parse_input_line().
+ *
+ * @param text    Line without the leading whitespace characters (no zero characters).
+ * @param length  Length of the text including the trailing whitespace and '\n'.
+ *
+ * @return Line type (see fmt_line_type_t)
+ */
+
+static uint8_t fmt_line_type(const char *text, size_t length)
+{
+    if (length == 0)
+    {
+        return FMT_LINE_EMPTY;
+    }
+
+    if ((length >= 2u) && (text[0] == '/') && (text[1] == '/'))
+    {
+        return FMT_LINE_DIRECTIVE;
+    }
+
+    if ((length > 3u) && (text[0] == '/') && (text[1] == '*'))
+    {
+        size_t end = length - 1u;
+
+        while ((end > 0) && is_fmt_whitespace(text[end]))
+        {
+            end--;
+        }
+
+        // Unfinished comments are reported by the parse_input_line()
+        if ((end >= 1u) && (text[end] == '/') && (text[end - 1u] == '*'))
+        {
+            return FMT_LINE_COMMENT;
+        }
+    }
+
+    return FMT_LINE_OTHER;
+}
+
+
+/**
+ * @brief Splits the loaded file into lines. The lines are split the same way as with the
+ *        read_preloaded_line() - the lines longer than MAX_INPUT_LINE_LENGTH - 1 characters
+ *        are split into several lines. The file is read line by line with the
+ *        read_preloaded_line() if the memory for the line table cannot be allocated.
+ *
+ * @param file  Loaded file
+ */
+
+static void split_fmt_file_lines(preloaded_file_t *file)
+{
+    size_t max_lines = 1u + file->size / (MAX_INPUT_LINE_LENGTH - 1u);
+
+    const char *p = file->data;
+    const char *end_of_data = file->data + file->size;
+
+    while ((p = (const char *)memchr(p, '\n', (size_t)(end_of_data - p))) != NULL)
+    {
+        max_lines++;
+        p++;
+    }
+
+    fmt_line_t *line = (fmt_line_t *)malloc(max_lines * sizeof(fmt_line_t));
+
+    if (line == NULL)
+    {
+        return;
+    }
+
+    uint32_t lines = 0;
+    size_t position = 0;
+
+    while (position < file->size)
+    {
+        const char *start = &file->data[position];
+        size_t length = file->size - position;
+
+        if (length > (MAX_INPUT_LINE_LENGTH - 1u))
+        {
+            length = MAX_INPUT_LINE_LENGTH - 1u;
+        }
+
+        const char *end_of_line = (const char *)memchr(start, '\n', length);
+
+        if (end_of_line != NULL)
+        {
+            length = (size_t)(end_of_line - start) + 1u;
+        }
+
+        size_t offset = 0;
+
+        while ((offset < length) && is_fmt_whitespace(start[offset]))
+        {
+            offset++;
+        }
+
+        line[lines].start = (uint32_t)position;
+        line[lines].length = (uint32_t)length;
+        line[lines].text_offset = (uint16_t)offset;
+        line[lines].type = (memchr(start, '\0', length) != NULL)
+            ? (uint8_t)FMT_LINE_OTHER : fmt_line_type(start + offset, length - offset);
+        lines++;
+        position += length;
+    }
+
+    file->line = line;
+    file->lines = lines;
+}
+
+
+/**
+ * @brief Loads the complete format definition file into memory.
+ *        The file is read in the text mode (the same as with fgets() during the parsing).
+ *        Called by the loading threads - errors are not reported here, but during the parsing.
+ *
+ * @param file  File to load
+ */
+
+static void load_fmt_file(preloaded_file_t *file)
+{
+    FILE *fmt_file = utf8_fopen(file->path, "r");
+
+    if (fmt_file == NULL)
+    {
+        return;
+    }
+
+    int64_t file_size = get_file_size(fmt_file);
+
+    if ((file_size >= 0) && (file_size <= MAX_PRELOADED_FMT_FILE_SIZE))
+    {
+        char *data = (char *)malloc((size_t)file_size + 1u);
+
+        if (data != NULL)
+        {
+            size_t size = fread(data, 1, (size_t)file_size, fmt_file);
+
+            if (ferror(fmt_file))
+            {
+                free(data);
+            }
+            else
+            {
+                data[size] = '\0';
+                file->size = size;
+                file->data = data;
+                split_fmt_file_lines(file);
+            }
+        }
+    }
+
+    fclose(fmt_file);
+}
+
+
+/**
+ * @brief Loads the files from the current pass until all of them are taken.
+ */
+
+static thread_ret_compat_t THREAD_API_COMPAT preload_thread(void *arg)
+{
+    (void)arg;
+
+    for ( ;; )
+    {
+        unsigned index;
+
+        mutex_lock_compat(&preload.lock);
+        index = preload.next_to_load;
+
+        if (index < preload.load_end)
+        {
+            preload.next_to_load++;
+        }
+
+        mutex_unlock_compat(&preload.lock);
+
+        if (index >= preload.load_end)
+        {
+            break;
+        }
+
+        load_fmt_file(&preload.file[index]);
+    }
+
+    return (thread_ret_compat_t)0;
+}
+
+
+/**
+ * @brief Loads the files [first .. end) in parallel. The calling thread loads files also.
+ *
+ * @param first  Index of the first file to load
+ * @param end    Index after the last file to load
+ */
+
+static void load_fmt_files(unsigned first, unsigned end)
+{
+    thread_compat_t threads[FMT_PRELOAD_THREADS];
+    unsigned threads_started = 0;
+
+    preload.next_to_load = first;
+    preload.load_end = end;
+
+    for (unsigned i = first + 1u; (i < end) && (threads_started < FMT_PRELOAD_THREADS); i++)
+    {
+        if (!thread_create_compat(&threads[threads_started], preload_thread, NULL))
+        {
+            break;
+        }
+
+        threads_started++;
+    }
+
+    (void)preload_thread(NULL);
+
+    for (unsigned i = 0; i < threads_started; i++)
+    {
+        thread_join_compat(threads[i]);
+    }
+}
+
+
+/**
+ * @brief Adds a file to the list of files to be loaded (if not in the list already).
+ *
+ * @param path  File path
+ */
+
+static void add_fmt_file(const char *path)
+{
+    if (preload.files >= MAX_PRELOADED_FMT_FILES)
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < preload.files; i++)
+    {
+        if (strcmp(preload.file[i].path, path) == 0)
+        {
+            return;
+        }
+    }
+
+    preloaded_file_t *file = &preload.file[preload.files++];
+    file->path = duplicate_string(path);
+    file->data = NULL;
+    file->size = 0;
+    file->line = NULL;
+    file->lines = 0;
+}
+
+
+/**
+ * @brief Adds the file from an INCLUDE() directive at the start of a line to the list of
+ *        files to be loaded.
+ *
+ * @param line  Line of a loaded file (zero terminated)
+ */
+
+static void add_included_file(char *line)
+{
+    char path[MAX_FILEPATH_LENGTH];
+    char *pos = line;
+    skip_whitespace(&pos);
+
+    if ((pos[0] != '/') || (pos[1] != '/'))
+    {
+        return;
+    }
+
+    pos += 2;
+    skip_whitespace(&pos);
+
+    if (strncmp(pos, "INCLUDE", sizeof("INCLUDE") - 1) != 0)
+    {
+        return;
+    }
+
+    pos += sizeof("INCLUDE") - 1;
+    skip_whitespace(&pos);
+
+    if (*pos++ != '(')
+    {
+        return;
+    }
+
+    if (parse_quoted_arg(&pos, path, sizeof(path)) && (*path != '\0'))
+    {
+        add_fmt_file(path);
+    }
+}
+
+
+/**
+ * @brief Adds the files from the INCLUDE() directives of a loaded file to the list of files to be loaded.
+ *        Only the directives at the start of a line are checked. Included files that are not found
+ *        here are read during the parsing as before.
+ *
+ * @param file  Loaded format definition file
+ */
+
+static void add_included_files(const preloaded_file_t *file)
+{
+    char line[MAX_INPUT_LINE_LENGTH];
+
+    if (file->line == NULL)
+    {
+        size_t position = 0;
+
+        while (read_preloaded_line(line, sizeof(line), file, &position) != NULL)
+        {
+            add_included_file(line);
+        }
+
+        return;
+    }
+
+    for (uint32_t i = 0; i < file->lines; i++)
+    {
+        const fmt_line_t *fmt_line = &file->line[i];
+
+        // The empty lines and comments cannot contain directives
+        if ((fmt_line->type == FMT_LINE_DIRECTIVE) || (fmt_line->type == FMT_LINE_OTHER))
+        {
+            memcpy(line, &file->data[fmt_line->start], fmt_line->length);
+            line[fmt_line->length] = '\0';
+            add_included_file(line);
+        }
+    }
+}
+
+
+/**
+ * @brief Loads the main format file and all format definition files included in it
+ *        (also indirectly) before the parsing. Every pass loads the files included in the
+ *        files from the previous pass.
+ *
+ * @param main_file_path  Path of the main format definition file
+ */
+
+void preload_fmt_files(const char *main_file_path)
+{
+    if (!preload.lock_initialized)
+    {
+        mutex_init_compat(&preload.lock);
+        preload.lock_initialized = true;
+    }
+
+    open_format_folder();       // The file paths are relative to the format folder
+    add_fmt_file(main_file_path);
+    unsigned first = 0;
+
+    while (first < preload.files)
+    {
+        unsigned end = preload.files;
+        load_fmt_files(first, end);
+
+        for (unsigned i = first; i < end; i++)
+        {
+            if (preload.file[i].data != NULL)
+            {
+                add_included_files(&preload.file[i]);
+            }
+        }
+
+        first = end;
+    }
+}
+
+
+/**
+ * @brief Finds a loaded format definition file.
+ *
+ * @param path  File path as written in the INCLUDE() directive
+ *
+ * @return Pointer to the file contents or NULL if the file has not been loaded
+ */
+
+const preloaded_file_t *find_preloaded_fmt_file(const char *path)
+{
+    for (unsigned i = 0; i < preload.files; i++)
+    {
+        if (strcmp(preload.file[i].path, path) == 0)
+        {
+            return (preload.file[i].data != NULL) ? &preload.file[i] : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Returns the number of format definition files in the list of files to be loaded.
+ */
+
+unsigned number_of_preloaded_fmt_files(void)
+{
+    return preload.files;
+}
+
+
+/**
+ * @brief Returns a file from the list of files to be loaded (also if it could not be loaded).
+ *
+ * @param index  Index of the file in the list (0 = main format file)
+ */
+
+const preloaded_file_t *get_preloaded_fmt_file(unsigned index)
+{
+    return &preload.file[index];
+}
+
+
+/**
+ * @brief Copies the next line of the loaded file to the line buffer.
+ *        Works the same as the fgets() - the line is shortened to line_size - 1 characters
+ *        and the remainder is returned by the next call.
+ *
+ * @param line       Buffer for the line
+ * @param line_size  Size of the buffer
+ * @param file       Loaded file
+ * @param position   Input: position of the line in the file, output: position of the next line
+ *
+ * @return Pointer to the line or NULL if the end of file is reached
+ */
+
+char *read_preloaded_line(char *line, size_t line_size, const preloaded_file_t *file, size_t *position)
+{
+    if ((*position >= file->size) || (line_size < 2u))
+    {
+        return NULL;
+    }
+
+    const char *start = &file->data[*position];
+    size_t length = file->size - *position;
+
+    if (length > (line_size - 1u))
+    {
+        length = line_size - 1u;
+    }
+
+    const char *end_of_line = (const char *)memchr(start, '\n', length);
+
+    if (end_of_line != NULL)
+    {
+        length = (size_t)(end_of_line - start) + 1u;
+    }
+
+    memcpy(line, start, length);
+    line[length] = '\0';
+    *position += length;
+    return line;
+}
+
+
+/**
+ * @brief Releases the memory used for the loaded format definition files.
+ */
+
+void free_preloaded_fmt_files(void)
+{
+    for (unsigned i = 0; i < preload.files; i++)
+    {
+        free(preload.file[i].path);
+        free(preload.file[i].data);
+        free(preload.file[i].line);
+        preload.file[i].path = NULL;
+        preload.file[i].data = NULL;
+        preload.file[i].line = NULL;
+    }
+
+    preload.files = 0;
+}
+
+/*==== End of file ====*/
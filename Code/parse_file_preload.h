@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    parse_file_preload.h
+ * @author  B. Premzel
+ * @brief   Parallel loading of the format definition files before the parsing.
+ ******************************************************************************/
+
+#ifndef _PARSE_FILE_PRELOAD_H
+#define _PARSE_FILE_PRELOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/* @brief Types of the lines found by split_fmt_file_lines() */
+typedef enum
+{
+    FMT_LINE_EMPTY,             /*!< Only whitespace characters */
+    FMT_LINE_COMMENT,           /*!< C-style comment closed within the same line */
+    FMT_LINE_DIRECTIVE,         /*!< Formatting definition starting with the "//" */
+    FMT_LINE_OTHER              /*!< Other lines (C directives, errors, zero characters) - parsed as a copy */
+} fmt_line_type_t;
+
+
+/* @brief Line of a format definition file loaded before the parsing */
+typedef struct
+{
+    uint32_t start;             /*!< Position of the line in the file */
+    uint32_t length;            /*!< Length of the line including the '\n' */
+    uint16_t text_offset;       /*!< Position of the first non-whitespace character in the line */
+    uint8_t type;               /*!< Line type (see fmt_line_type_t) */
+} fmt_line_t;
+
+
+/* @brief Contents of a format definition file loaded before the parsing */
+typedef struct
+{
+    char *path;                 /*!< File path as written in the INCLUDE() directive */
+    char *data;                 /*!< File contents (zero terminated) or NULL if the file could not be loaded */
+    size_t size;                /*!< Number of bytes loaded */
+    fmt_line_t *line;           /*!< Lines of the file (NULL - the lines are read with read_preloaded_line()) */
+    uint32_t lines;             /*!< Number of lines in the line[] */
+} preloaded_file_t;
+
+
+void preload_fmt_files(const char *main_file_path);
+const preloaded_file_t *find_preloaded_fmt_file(const char *path);
+unsigned number_of_preloaded_fmt_files(void);
+const preloaded_file_t *get_preloaded_fmt_file(unsigned index);
+char *read_preloaded_line(char *line, size_t line_size, const preloaded_file_t *file, size_t *position);
+void free_preloaded_fmt_files(void);
+
+#endif  // _PARSE_FILE_PRELOAD_H
+
+/*==== End of file ====*/
@@ -22,12 +22,32 @@
 #include "parse_directive_helpers.h"
 #include "parse_directive.h"
 #include "parse_error_reporting.h"
+#include "fast_format.h"
 
 
 // Address of the first bit of the next value for the message being prepared for printing
 static unsigned parse_bit_address;
 
 
+/**
+ * @brief Returns the number of bits occupied by the value in the message.
+ *
+ * @param current_format  Pointer to the currently prepared formatting structure
+ *
+ * @return Size of a single value or of all elements of an array value [number of bits]
+ */
+
+static unsigned get_value_bits(const value_format_t *current_format)
+{
+    if (current_format->array_count > 0)
+    {
+        return current_format->data_size * current_format->array_count;
+    }
+
+    return current_format->data_size;
+}
+
+
 /**
  * @brief Validates the format definition and sets up the data structure for hex dump print type.
  *
@@ -129,7 +149,7 @@ static void check_fmt_type_data(parse_handle_t *parse_handle, char fmt_char)
     }
 
     // Validate if the value fits into the message (based on the defined message size)
-    unsigned last_bit_address = current_format->bit_address + current_format->data_size;
+    unsigned last_bit_address = current_format->bit_address + get_value_bits(current_format);
     if (((last_bit_address > (parse_handle->p_current_message->msg_len * 8u))
             && (parse_handle->p_current_message->msg_len != 0))
         || ((parse_handle->p_current_message->msg_len == 0)
@@ -206,6 +226,31 @@ static void check_s_and_W_type_data(parse_handle_t *parse_handle)
 }
 
 
+/**
+ * @brief Validates the format of an array value [nn:mmF*K]. The elements are printed without
+ *        the fprintf() (see print_array_value()), so the format must be supported by the
+ *        prepare_fast_format(). The MEMO is not possible for the array values.
+ *
+ * @param parse_handle    Pointer to the current file's parse handle.
+ * @param current_format  Pointer to the currently prepared formatting structure
+ */
+
+static void check_array_value(parse_handle_t *parse_handle, value_format_t *current_format)
+{
+    if (((current_format->fmt_type != PRINT_UINT64) && (current_format->fmt_type != PRINT_INT64)
+            && (current_format->fmt_type != PRINT_DOUBLE))
+        || (current_format->fast_fmt == NULL) || (current_format->data_type == VALUE_STRING))
+    {
+        catch_parsing_error(parse_handle, ERR_PARSE_ARRAY_FORMAT_TYPE, NULL);
+    }
+
+    if (current_format->put_memo != 0)
+    {
+        catch_parsing_error(parse_handle, ERR_PARSE_MEMO_NOT_ALLOWED, NULL);
+    }
+}
+
+
 /**
  * @brief Assigns the format type based on the character found in the format definition.
  *
@@ -313,6 +358,18 @@ static void fill_in_fmt_type(char *currentSubstring, parse_handle_t *parse_handl
             break;
     }
 
+    // Prepare the printing without the fprintf() for the common integer and double formats
+    if ((current_format->fmt_type == PRINT_UINT64) || (current_format->fmt_type == PRINT_INT64)
+        || (current_format->fmt_type == PRINT_DOUBLE))
+    {
+        current_format->fast_fmt = prepare_fast_format(currentSubstring);
+    }
+
+    if (current_format->array_count > 0)
+    {
+        check_array_value(parse_handle, current_format);
+    }
+
     check_fmt_type_data(parse_handle, fmt_char);
 }
 
@@ -454,8 +511,9 @@ static void parse_remember_spec(char **position, parse_handle_t *parse_handle)
 
 
 /**
- * @brief Parses the statistics definition: |statistics|
+ * @brief Parses the statistics definition: |statistics| or |statistics:q|
  *        Activates statistics and assigns a name to the value using the text between the |...|.
+ *        The ":q" suffix additionally enables the quantile and histogram estimation.
  *
  * @param position      Pointer to the current position in the string being parsed.
  * @param parse_handle  Pointer to the handle of the currently parsed file.
@@ -481,8 +539,19 @@ static void parse_statistics_spec(char **position, parse_handle_t *parse_handle)
         catch_parsing_error(parse_handle, ERR_PARSE_OVERDEFINITION_PIPEBRACKETS, *position);
     }
 
-    parse_handle->current_format->value_stat = allocate_memory(sizeof(value_stats_t), "stat_s");
-    parse_handle->current_format->value_stat->name = duplicate_string(selection);
+    value_stats_t *value_stat = allocate_parse_memory(sizeof(value_stats_t), "stat_s");
+    parse_handle->current_format->value_stat = value_stat;
+
+    // The suffix ":q" enables the quantile and histogram estimation - e.g. "|loop_time:q|"
+    size_t length = strlen(selection);
+
+    if ((length > 2u) && (strcmp(&selection[length - 2u], ":q") == 0))
+    {
+        selection[length - 2u] = '\0';
+        value_stat->quantiles = true;
+    }
+
+    value_stat->name = duplicate_parse_string(selection);
 
     *position = p + 1;          // Move past the closing '|'.
 }
@@ -513,7 +582,7 @@ static void save_the_indexed_text_line(char **position, parse_handle_t *parse_ha
 
     g_msg.enums[g_msg.enums_found].name = "#Y_TEXT";
     g_msg.enums[g_msg.enums_found].type = Y_TEXT_TYPE;
-    g_msg.enums[g_msg.enums_found].u.in_file_txt = duplicate_string(buff);
+    g_msg.enums[g_msg.enums_found].u.in_file_txt = duplicate_parse_string(buff);
     parse_handle->current_format->in_file = (rte_enum_t)g_msg.enums_found;
     g_msg.enums_found++;
     g_msg.fmt_ids_defined++;
@@ -779,6 +848,7 @@ static void check_and_set_data_type(parse_handle_t *parse_handle, char type)
  *        F - type of data (f=float, u=unsigned, i=signed int, s=string).
  *        nn - address of value to be printed (taken from the currently processed message).
  *        mm - size of value (number of bits).
+ *        An array of K values with the size mm is defined with [nn:mmF*K] or [mmF*K].
  *
  * @param position      Pointer to the currently parsed string.
  * @param parse_handle  Pointer to the handle of the currently parsed file.
@@ -828,6 +898,26 @@ static void parse_value_data(char **position, parse_handle_t *parse_handle)
         type = *p++;
     }
 
+    unsigned long count = 0;    // Number of array elements (0 - single value)
+
+    if (*p == '*')
+    {
+        p++;
+        count = strtoul(p, &end, 10);
+
+        if (end <= p)
+        {
+            catch_parsing_error(parse_handle, ERR_PARSE_VALUE_INVALID_CHAR, *position);
+        }
+
+        p = end;
+
+        if ((count < 2) || (count > MAX_ARRAY_ELEMENTS))
+        {
+            catch_parsing_error(parse_handle, ERR_PARSE_ARRAY_ELEMENTS, *position);
+        }
+    }
+
     if (*p++ != ']')
     {
         catch_parsing_error(parse_handle, ERR_PARSE_VALUE_UNFINISHED, *position);
@@ -837,6 +927,7 @@ static void parse_value_data(char **position, parse_handle_t *parse_handle)
 
     check_and_set_value_definition(parse_handle, size, address, sign, two_values_found);
     check_and_set_data_type(parse_handle, type);
+    parse_handle->current_format->array_count = (uint32_t)count;
 }
 
 
@@ -979,7 +1070,7 @@ static void prepare_or_continue_fmt(parse_handle_t *parse_handle)
     else
     {
         // Continue with the existing message
-        parse_handle->current_format->format = allocate_memory(sizeof(value_format_t), "valFormat");
+        parse_handle->current_format->format = allocate_parse_memory(sizeof(value_format_t), "valFormat");
         parse_handle->current_format = parse_handle->current_format->format;
     }
 
@@ -1062,12 +1153,12 @@ static void finalize_substring(char *fmt_substring, size_t index, char **p, pars
     } while (c != '\0');
 
     fmt_substring[index] = '\0';
-    char *format_string = duplicate_string(fmt_substring);
+    char *format_string = duplicate_parse_string(fmt_substring);
     fill_in_fmt_type(format_string, parse_handle, fmt_char);
     parse_handle->current_format->fmt_string = format_string;
 
     check_y_type_formatting(parse_handle, fmt_substring);
-    parse_bit_address += parse_handle->current_format->data_size; // Update bit address for next value
+    parse_bit_address += get_value_bits(parse_handle->current_format); // Update bit address for next value
 
     *p = fmt_string;
 }
@@ -1169,10 +1260,12 @@ void separate_fmt_strings(char *buffer, parse_handle_t *parse_handle)
     if (substr_index > 0)
     {
         fmt_substring[substr_index] = '\0';
-        parse_handle->current_format->fmt_string = duplicate_string(fmt_substring);
+        parse_handle->current_format->fmt_string = duplicate_parse_string(fmt_substring);
         parse_handle->current_format->data_size = 0;
         parse_handle->current_format->fmt_type = PRINT_PLAIN_TEXT;
         parse_handle->current_format->bit_address = parse_bit_address;
+        parse_handle->current_format->fast_fmt =
+            prepare_plain_text_format(parse_handle->current_format->fmt_string);
     }
 }
 
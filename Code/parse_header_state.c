@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    parse_header_state.c
+ * @author  B. Premzel
+ * @brief   Incremental regeneration of the format definition headers (-c).
+ *          The contents of the work file depend only on the format definition
+ *          file, the format ID and filter number assignment state before the
+ *          file is parsed and the files included by it. The work file is not
+ *          needed if the file has not been changed since the last regeneration,
+ *          the assignment state is the same, the file does not include other
+ *          files and the generated header has not been changed or removed.
+ *          The state file is written only after an error-free parsing. Problems
+ *          with the state file are not reported - all files are regenerated.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "files.h"
+#include "utf8_helpers.h"
+#include "fmt_cache.h"
+#include "parse_header_state.h"
+
+#define HEADER_STATE_SEED   0x6A09E667F3BCC909uLL
+
+
+/* @brief State of a format definition file after the last regeneration of its output */
+typedef struct
+{
+    char *path;                     /*!< File path as written in the INCLUDE() directive */
+    uint64_t source_hash;           /*!< Hash of the format definition file */
+    uint64_t header_hash;           /*!< Hash of the generated .fmt.h header (0 - output written to the file itself) */
+    uint32_t fmt_ids_defined;       /*!< Format ID assignment state before the file has been parsed */
+    uint32_t fmt_align_value;
+    uint32_t filter_enums;          /*!< Number of filters defined before the file has been parsed */
+    bool includes;                  /*!< The file includes other format definition files */
+    bool updated;                   /*!< The state has been checked or updated during this parsing */
+} fmt_file_state_t;
+
+static fmt_file_state_t *file_state;    // States of the format definition files
+static unsigned file_states;            // Number of entries in the file_state[]
+static unsigned file_states_allocated;  // Size of the file_state[]
+static unsigned fmt_files_started;      // Number of format definition files parsed so far
+static uint64_t state_key;              // Hash of the RTEmsg version and parameters which affect the output
+
+
+/**
+ * @brief Calculates the hash of the parameters which change the contents of all work files.
+ *
+ * @return Key of the state file
+ */
+
+static uint64_t calculate_state_key(void)
+{
+    uint32_t parameters[4] =
+        { RTEMSG_VERSION, RTEMSG_SUBVERSION, RTEMSG_REVISION, g_msg.param.purge_defines };
+    const char *caveat = get_message_text(MSG_HEADER_CAVEAT);
+
+    uint64_t key = hash_data(HEADER_STATE_SEED, parameters, sizeof(parameters));
+    return hash_data(key, caveat, strlen(caveat));
+}
+
+
+/**
+ * @brief Calculates the hash of a file. The file is read in the text mode the same as the
+ *        format definition files loaded before the parsing (see parse_file_preload.c).
+ *
+ * @param path  File name
+ * @param hash  Output: hash of the file contents
+ *
+ * @return false - the file could not be read
+ */
+
+static bool hash_file(const char *path, uint64_t *hash)
+{
+    FILE *file = utf8_fopen(path, "r");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    bool ok = false;
+    int64_t file_size = get_file_size(file);
+
+    if ((file_size >= 0) && (file_size <= MAX_PRELOADED_FMT_FILE_SIZE))
+    {
+        char *data = (char *)malloc((size_t)file_size + 1u);
+
+        if (data != NULL)
+        {
+            size_t size = fread(data, 1, (size_t)file_size, file);
+            ok = (ferror(file) == 0);
+            *hash = hash_data(HEADER_STATE_SEED, data, size);
+            free(data);
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+
+/**
+ * @brief Finds the state of a format definition file.
+ *
+ * @param path  File path as written in the INCLUDE() directive
+ *
+ * @return Pointer to the state or NULL if not found
+ */
+
+static fmt_file_state_t *find_file_state(const char *path)
+{
+    for (unsigned i = 0; i < file_states; i++)
+    {
+        if (strcmp(file_state[i].path, path) == 0)
+        {
+            return &file_state[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Adds the state of a format definition file to the file_state[].
+ *
+ * @param path  File path as written in the INCLUDE() directive
+ *
+ * @return Pointer to the new state or NULL if there is not enough memory
+ */
+
+static fmt_file_state_t *add_file_state(const char *path)
+{
+    if (file_states >= file_states_allocated)
+    {
+        unsigned new_size = (file_states_allocated == 0) ? 64u : (2u * file_states_allocated);
+        fmt_file_state_t *new_state =
+            (fmt_file_state_t *)realloc(file_state, new_size * sizeof(fmt_file_state_t));
+
+        if (new_state == NULL)
+        {
+            return NULL;
+        }
+
+        file_state = new_state;
+        file_states_allocated = new_size;
+    }
+
+    char *new_path = (char *)malloc(strlen(path) + 1u);
+
+    if (new_path == NULL)
+    {
+        return NULL;
+    }
+
+    strcpy(new_path, path);
+    fmt_file_state_t *state = &file_state[file_states++];
+    *state = (fmt_file_state_t){ .path = new_path };
+    return state;
+}
+
+
+/**
+ * @brief Loads the state file from the output folder (-c only). The format folder is not
+ *        changed by the RTEmsg except for the generated headers.
+ *        The states are not used if the file was written by another RTEmsg version or with
+ *        different parameters.
+ */
+
+void load_header_state(void)
+{
+    if (!g_msg.param.check_syntax_and_compile)
+    {
+        return;
+    }
+
+    state_key = calculate_state_key();
+    open_output_folder();
+    FILE *file = utf8_fopen(RTE_HEADER_STATE_FILE, "r");
+    open_format_folder();
+
+    if (file == NULL)
+    {
+        return;
+    }
+
+    char line[MAX_FILEPATH_LENGTH + 100u];
+    unsigned long long key = 0;
+
+    if ((fgets(line, sizeof(line), file) == NULL)
+        || (sscanf(line, RTE_HEADER_STATE_MAGIC " %llx", &key) != 1) || (key != state_key))
+    {
+        fclose(file);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long long source_hash;
+        unsigned long long header_hash;
+        unsigned fmt_ids_defined;
+        unsigned fmt_align_value;
+        unsigned filter_enums;
+        unsigned includes;
+        int path_start = 0;
+
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if ((sscanf(line, "%llx %llx %u %u %u %u %n", &source_hash, &header_hash,
+                &fmt_ids_defined, &fmt_align_value, &filter_enums, &includes, &path_start) != 6)
+            || (path_start == 0) || (line[path_start] == '\0'))
+        {
+            continue;       // Damaged entry - the file is regenerated
+        }
+
+        fmt_file_state_t *state = add_file_state(&line[path_start]);
+
+        if (state == NULL)
+        {
+            break;
+        }
+
+        state->source_hash = source_hash;
+        state->header_hash = header_hash;
+        state->fmt_ids_defined = fmt_ids_defined;
+        state->fmt_align_value = fmt_align_value;
+        state->filter_enums = filter_enums;
+        state->includes = (includes != 0);
+    }
+
+    fclose(file);
+}
+
+
+/**
+ * @brief Saves the format ID assignment state before the parsing of a format definition file and
+ *        checks if the output of the file is the same as after the last regeneration.
+ *        Called before the work file is created (-c only).
+ *
+ * @param parse_handle  Pointer to the parse handle of the file.
+ *
+ * @return true - the work file does not have to be created
+ */
+
+bool fmt_file_output_up_to_date(parse_handle_t *parse_handle)
+{
+    parse_handle->fmt_file_number = fmt_files_started++;
+    parse_handle->start_fmt_ids_defined = g_msg.fmt_ids_defined;
+    parse_handle->start_fmt_align_value = g_msg.fmt_align_value;
+    parse_handle->start_filter_enums = g_msg.filter_enums;
+
+    const fmt_file_state_t *state = find_file_state(parse_handle->fmt_file_path);
+    const preloaded_file_t *file = parse_handle->preloaded_file;
+
+    if ((state == NULL) || (file == NULL) || state->includes
+        || (state->fmt_ids_defined != g_msg.fmt_ids_defined)
+        || (state->fmt_align_value != g_msg.fmt_align_value)
+        || (state->filter_enums != g_msg.filter_enums)
+        || (state->source_hash != hash_data(HEADER_STATE_SEED, file->data, file->size)))
+    {
+        return false;
+    }
+
+    if (parse_handle->write_output_to_header)
+    {
+        // The header must not have been changed or removed after the last regeneration
+        char header_file_name[MAX_FILENAME_LENGTH];
+        snprintf(header_file_name, MAX_FILENAME_LENGTH, "%s.h", parse_handle->fmt_file_path);
+        uint64_t header_hash = 0;
+
+        if (!hash_file(header_file_name, &header_hash) || (header_hash != state->header_hash))
+        {
+            return false;
+        }
+    }
+
+    parse_handle->output_up_to_date = true;
+    return true;
+}
+
+
+/**
+ * @brief Updates the state of a format definition file after it has been parsed and its output
+ *        checked or regenerated (-c only). The state of a file with parsing errors is not saved.
+ *
+ * @param parse_handle  Pointer to the parse handle of the file.
+ */
+
+void update_header_state(const parse_handle_t *parse_handle)
+{
+    fmt_file_state_t *state = find_file_state(parse_handle->fmt_file_path);
+
+    if (parse_handle->parsing_errors_found || (parse_handle->preloaded_file == NULL))
+    {
+        if (state != NULL)
+        {
+            state->updated = false;     // The file is regenerated during the next parsing
+        }
+
+        return;
+    }
+
+    if (parse_handle->output_up_to_date)
+    {
+        state->updated = true;
+        return;
+    }
+
+    if (state == NULL)
+    {
+        state = add_file_state(parse_handle->fmt_file_path);
+
+        if (state == NULL)
+        {
+            return;
+        }
+    }
+
+    open_format_folder();
+    const preloaded_file_t *file = parse_handle->preloaded_file;
+    bool ok = true;
+    state->source_hash = hash_data(HEADER_STATE_SEED, file->data, file->size);
+    state->header_hash = 0;
+
+    if (parse_handle->write_output_to_header)
+    {
+        char header_file_name[MAX_FILENAME_LENGTH];
+        snprintf(header_file_name, MAX_FILENAME_LENGTH, "%s.h", parse_handle->fmt_file_path);
+        ok = hash_file(header_file_name, &state->header_hash);
+    }
+    else
+    {
+        // The format definition file itself may have been replaced with the work file
+        ok = hash_file(parse_handle->fmt_file_path, &state->source_hash);
+    }
+
+    state->fmt_ids_defined = parse_handle->start_fmt_ids_defined;
+    state->fmt_align_value = parse_handle->start_fmt_align_value;
+    state->filter_enums = parse_handle->start_filter_enums;
+    state->includes = (fmt_files_started > (parse_handle->fmt_file_number + 1u));
+    state->updated = ok;
+}
+
+
+/**
+ * @brief Writes the states of the format definition files parsed without errors to the state
+ *        file in the output folder (-c only). The state file is not changed if errors were found.
+ */
+
+void save_header_state(void)
+{
+    if (!g_msg.param.check_syntax_and_compile || (g_msg.total_errors > 0))
+    {
+        return;
+    }
+
+    open_output_folder();
+    FILE *file = utf8_fopen(RTE_HEADER_STATE_FILE, "w");
+
+    if (file != NULL)
+    {
+        fprintf(file, RTE_HEADER_STATE_MAGIC " %016llx\n", (unsigned long long)state_key);
+
+        for (unsigned i = 0; i < file_states; i++)
+        {
+            const fmt_file_state_t *state = &file_state[i];
+
+            if (state->updated)
+            {
+                fprintf(file, "%016llx %016llx %u %u %u %u %s\n",
+                    (unsigned long long)state->source_hash, (unsigned long long)state->header_hash,
+                    state->fmt_ids_defined, state->fmt_align_value, state->filter_enums,
+                    state->includes ? 1u : 0u, state->path);
+            }
+        }
+
+        if (fclose(file) != 0)
+        {
+            (void)utf8_remove(RTE_HEADER_STATE_FILE);   // All files are regenerated next time
+        }
+    }
+
+    open_format_folder();
+
+    for (unsigned i = 0; i < file_states; i++)
+    {
+        free(file_state[i].path);
+    }
+
+    free(file_state);
+    file_state = NULL;
+    file_states = 0;
+    file_states_allocated = 0;
+}
+
+/*==== End of file ====*/
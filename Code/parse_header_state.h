@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    parse_header_state.h
+ * @author  B. Premzel
+ * @brief   Incremental regeneration of the format definition headers (-c).
+ *
+ *          The state file RTE_HEADER_STATE_FILE in the output folder contains
+ *          for every format definition file the hash of its contents, the
+ *          hash of the generated header and the format ID and filter number
+ *          assignment state before the file was parsed. A file which did not
+ *          change and whose format IDs did not shift is parsed as before, but
+ *          the work file is not written and compared with the output file.
+ *
+ *          File structure (text):
+ *              RTE_HEADER_STATE_MAGIC key
+ *              source_hash header_hash fmt_ids_defined fmt_align_value filter_enums includes path
+ *              ...
+ ******************************************************************************/
+
+#ifndef _PARSE_HEADER_STATE_H
+#define _PARSE_HEADER_STATE_H
+
+#include <stdbool.h>
+#include "parse_directive_helpers.h"
+
+#define RTE_HEADER_STATE_MAGIC      "RTEhdr1"
+
+
+/***** Function declarations *****/
+void load_header_state(void);
+bool fmt_file_output_up_to_date(parse_handle_t *parse_handle);
+void update_header_state(const parse_handle_t *parse_handle);
+void save_header_state(void);
+
+#endif  // _PARSE_HEADER_STATE_H
+
+/*==== End of file ====*/
@@ -354,4 +354,37 @@ int _wrename(const wchar_t *oldname, const wchar_t *newname)
     return result;
 }
 
+/**
+ * @brief Create directory with wide character name (Linux implementation)
+ * @param dirname Wide character directory name
+ * @return 0 on success, -1 on error
+ */
+int _wmkdir(const wchar_t *dirname)
+{
+    if (dirname == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    
+    // Convert directory name
+    size_t len = wcstombs(NULL, dirname, 0);
+    if (len == (size_t)-1) {
+        return -1;
+    }
+    
+    char *mbdirname = malloc(len + 1);
+    if (mbdirname == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    
+    wcstombs(mbdirname, dirname, len + 1);
+    
+    int result = mkdir(mbdirname, 0777);
+    
+    free(mbdirname);
+    
+    return result;
+}
+
 #endif // !_WIN32
\ No newline at end of file
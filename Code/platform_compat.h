@@ -33,6 +33,34 @@
     #define wgetcwd_compat _wgetcwd
     #define fseeki64_compat _fseeki64
     #define ftelli64_compat _ftelli64
+
+    // Threads and synchronization
+    #include <process.h>
+    typedef HANDLE thread_compat_t;
+    typedef CRITICAL_SECTION mutex_compat_t;
+    typedef CONDITION_VARIABLE cond_compat_t;
+    typedef unsigned thread_ret_compat_t;
+    #define THREAD_API_COMPAT __stdcall
+    #define thread_create_compat(thread, function, arg) \
+        ((*(thread) = (HANDLE)_beginthreadex(NULL, 0, (function), (arg), 0, NULL)) != NULL)
+    #define thread_join_compat(thread) (WaitForSingleObject((thread), INFINITE), CloseHandle(thread))
+    #define mutex_init_compat(mutex) InitializeCriticalSection(mutex)
+    #define mutex_lock_compat(mutex) EnterCriticalSection(mutex)
+    #define mutex_unlock_compat(mutex) LeaveCriticalSection(mutex)
+    #define cond_init_compat(cond) InitializeConditionVariable(cond)
+    #define cond_wait_compat(cond, mutex) SleepConditionVariableCS((cond), (mutex), INFINITE)
+    #define cond_signal_compat(cond) WakeConditionVariable(cond)
+    #define THREAD_LOCAL_COMPAT __declspec(thread)
+    #define CACHE_LINE_ALIGNED_COMPAT __declspec(align(64))
+
+    // Pipes to the output file compression tools
+    typedef HANDLE process_compat_t;
+    #define ignore_broken_pipe_compat()
+    #define NULL_DEVICE_COMPAT "NUL"
+
+    // Binary data read from the standard input (no CR LF translation)
+    #include <fcntl.h>
+    #define set_stdin_binary_compat() (void)_setmode(_fileno(stdin), _O_BINARY)
     
 #else
     // Linux/Unix includes
@@ -72,6 +100,31 @@
     
     // Sleep function
     #define Sleep(x) usleep((x) * 1000)
+
+    // Threads and synchronization
+    #include <pthread.h>
+    typedef pthread_t thread_compat_t;
+    typedef pthread_mutex_t mutex_compat_t;
+    typedef pthread_cond_t cond_compat_t;
+    typedef void *thread_ret_compat_t;
+    #define THREAD_API_COMPAT
+    #define thread_create_compat(thread, function, arg) (pthread_create((thread), NULL, (function), (arg)) == 0)
+    #define thread_join_compat(thread) pthread_join((thread), NULL)
+    #define mutex_init_compat(mutex) pthread_mutex_init((mutex), NULL)
+    #define mutex_lock_compat(mutex) pthread_mutex_lock(mutex)
+    #define mutex_unlock_compat(mutex) pthread_mutex_unlock(mutex)
+    #define cond_init_compat(cond) pthread_cond_init((cond), NULL)
+    #define cond_wait_compat(cond, mutex) pthread_cond_wait((cond), (mutex))
+    #define cond_signal_compat(cond) pthread_cond_signal(cond)
+    #define THREAD_LOCAL_COMPAT _Thread_local
+    #define CACHE_LINE_ALIGNED_COMPAT __attribute__((aligned(64)))
+
+    // Pipes to the output file compression tools
+    #include <signal.h>
+    typedef pid_t process_compat_t;
+    #define ignore_broken_pipe_compat() signal(SIGPIPE, SIG_IGN)
+    #define NULL_DEVICE_COMPAT "/dev/null"
+    #define set_stdin_binary_compat()
     
     // Integer types
     #define __int64 int64_t
@@ -93,6 +146,7 @@
     FILE* _wfopen(const wchar_t *filename, const wchar_t *mode);
     int _wremove(const wchar_t *filename);
     int _wrename(const wchar_t *oldname, const wchar_t *newname);
+    int _wmkdir(const wchar_t *dirname);
     
     // Define MAX_PATH if not available
     #ifndef MAX_PATH
@@ -12,10 +12,25 @@
 
 #include "pch.h"
 #include <string.h>
+#include <stdarg.h>
 #include "print_helper.h"
 #include "statistics.h"
 #include "files.h"
 #include "errors.h"
+#include "fast_format.h"
+#include "hex_text.h"
+
+/* Text of the currently printed message - written to the Main.log with a single fwrite() */
+static THREAD_LOCAL_COMPAT char message_line[MESSAGE_LINE_SIZE];
+static THREAD_LOCAL_COMPAT size_t message_line_length;   // Number of characters in the message_line[]
+static THREAD_LOCAL_COMPAT FILE *message_line_out;       // File of the message line (NULL - not collected)
+
+/* Text written to a decimated OUT_FILE() file - collected or discarded (see capture_file_output()) */
+static THREAD_LOCAL_COMPAT FILE *captured_out;           // File of the captured text (NULL - not captured)
+static THREAD_LOCAL_COMPAT captured_text_t *captured;    // Buffer for the text (NULL - the text is discarded)
+
+static fast_format_t *msg_number_format;    // Message number printed without the fprintf() (NULL - fprintf())
+static fast_format_t *timestamp_format;     // Timestamp printed without the fprintf() (NULL - fprintf())
 
 
 /**
@@ -38,20 +53,28 @@ void save_decoding_error(uint32_t err_no, uint32_t data1, uint32_t data2, const
         err_no = ERR_DECODE_UNKNOWN_ERROR;
     }
 
+    // The errors over the -errors=K limit are only counted
+    bool not_shown = aggregate_error(err_no, g_ctx->message_cnt, g_ctx->fmt_id, data1, data2);
     g_msg.total_errors++;
     g_msg.error_counter[err_no]++;   // Increment the error count
 
-    if (g_msg.msg_error_counter >= MAX_ERRORS_IN_SINGLE_MESSAGE)
+    if (!not_shown)
+    {
+        g_ctx->msg_errors_shown++;
+    }
+
+    if (g_ctx->msg_error_counter >= MAX_ERRORS_IN_SINGLE_MESSAGE)
     {
         return;
     }
 
-    g_msg.error_log[g_msg.msg_error_counter].error_number = err_no;
-    g_msg.error_log[g_msg.msg_error_counter].value_number = g_msg.error_value_no;
-    g_msg.error_log[g_msg.msg_error_counter].data1 = data1;
-    g_msg.error_log[g_msg.msg_error_counter].data2 = data2;
-    g_msg.error_log[g_msg.msg_error_counter].fmt_text = fmt_text;
-    g_msg.msg_error_counter++;
+    g_ctx->error_log[g_ctx->msg_error_counter].error_number = err_no;
+    g_ctx->error_log[g_ctx->msg_error_counter].value_number = g_ctx->error_value_no;
+    g_ctx->error_log[g_ctx->msg_error_counter].data1 = data1;
+    g_ctx->error_log[g_ctx->msg_error_counter].data2 = data2;
+    g_ctx->error_log[g_ctx->msg_error_counter].fmt_text = fmt_text;
+    g_ctx->error_log[g_ctx->msg_error_counter].not_shown = not_shown;
+    g_ctx->msg_error_counter++;
 }
 
 
@@ -145,20 +168,25 @@ static void print_decoding_errors_to_file(FILE *out)
     }
 
     fprintf(out, "\n");
-    print_message_number(out, g_msg.message_cnt);
+    print_message_number(out, g_ctx->message_cnt);
     fprintf(out, get_message_text(MSG_DECODING_ERRORS_FOUND));
 
-    if (g_msg.msg_error_counter >= MAX_ERRORS_IN_SINGLE_MESSAGE)
+    if (g_ctx->msg_error_counter >= MAX_ERRORS_IN_SINGLE_MESSAGE)
     {
-        g_msg.msg_error_counter = MAX_ERRORS_IN_SINGLE_MESSAGE;
+        g_ctx->msg_error_counter = MAX_ERRORS_IN_SINGLE_MESSAGE;
         fprintf(out, get_message_text(MSG_TOO_MANY_ERRORS_FIRST_SHOWN), MAX_ERRORS_IN_SINGLE_MESSAGE);
     }
 
-    for (unsigned i = 0; i < g_msg.msg_error_counter; i++)
+    for (unsigned i = 0; i < g_ctx->msg_error_counter; i++)
     {
-        const char *text = strip_newlines_and_shorten_string(g_msg.error_log[i].fmt_text, 0);
+        if (g_ctx->error_log[i].not_shown)
+        {
+            continue;
+        }
+
+        const char *text = strip_newlines_and_shorten_string(g_ctx->error_log[i].fmt_text, 0);
 
-        unsigned err_no = g_msg.error_log[i].error_number;
+        unsigned err_no = g_ctx->error_log[i].error_number;
 
         if ((err_no < FIRST_ERROR) || (err_no >= ERR_PARSE_UNKNOWN))
         {
@@ -169,16 +197,16 @@ static void print_decoding_errors_to_file(FILE *out)
         {
             // Log the raw error data (data1 and data2) to report internal errors (ERR_INTERNAL_ERROR)
             fprintf(out, "\n-->#%u ERR_%03u: 0x%X 0x%X",
-                g_msg.error_log[i].value_number, err_no,
-                g_msg.error_log[i].data1, g_msg.error_log[i].data2);
+                g_ctx->error_log[i].value_number, err_no,
+                g_ctx->error_log[i].data1, g_ctx->error_log[i].data2);
             continue;
         }
 
-        fprintf(out, "\n-->#%u - \"%s\"\n ERR_%03u: ", g_msg.error_log[i].value_number, text, err_no);
+        fprintf(out, "\n-->#%u - \"%s\"\n ERR_%03u: ", g_ctx->error_log[i].value_number, text, err_no);
 
         // Format the error message using the error number
         text = get_message_text(err_no);
-        fprintf(out, text, g_msg.error_log[i].data1, g_msg.error_log[i].data2);
+        fprintf(out, text, g_ctx->error_log[i].data1, g_ctx->error_log[i].data2);
     }
 }
 
@@ -189,11 +217,11 @@ static void print_decoding_errors_to_file(FILE *out)
 
 void print_decoding_errors(void)
 {
-    if (g_msg.msg_error_counter != 0)
+    if (g_ctx->msg_errors_shown != 0)
     {
-        if (g_msg.file.main_log != NULL)
+        if (g_ctx->main_log != NULL)
         {
-            print_decoding_errors_to_file(g_msg.file.main_log);
+            print_decoding_errors_to_file(g_ctx->main_log);
         }
 
         if (g_msg.file.error_log != NULL)
@@ -204,6 +232,241 @@ void print_decoding_errors(void)
 }
 
 
+/**
+ * @brief Starts collecting the text written with msg_write() and msg_printf() to the specified
+ *        file in the message line buffer. The text of a message is written to the file with
+ *        a single fwrite() by flush_message_line() instead of a separate call for each part
+ *        of the message. The text written directly to the file must be flushed first.
+ *
+ * @param out  Pointer to the output file (Main.log or the output buffer of a printing worker).
+ */
+
+void start_message_line(FILE *out)
+{
+    message_line_length = 0;
+    message_line_out = out;
+}
+
+
+/**
+ * @brief Writes the collected message line to its file and stops the collecting.
+ */
+
+void flush_message_line(void)
+{
+    if ((message_line_out != NULL) && (message_line_length > 0))
+    {
+        fwrite(message_line, 1, message_line_length, message_line_out);
+    }
+
+    message_line_length = 0;
+    message_line_out = NULL;
+}
+
+
+/**
+ * @brief Redirects the text written with msg_write() and msg_printf() to the specified file
+ *        to a buffer or discards it. The discarded text is not formatted at all - the values
+ *        are still prepared, so that the MEMO values, statistics and copies to the Main.log
+ *        remain the same (see out_file_decimation.c).
+ *
+ * @param out      Pointer to the output file (NULL - stop the capturing).
+ * @param capture  Buffer for the text (NULL - the text is discarded).
+ */
+
+void capture_file_output(FILE *out, captured_text_t *capture)
+{
+    captured_out = out;
+    captured = capture;
+}
+
+
+/**
+ * @brief Makes room for additional characters in the buffer for the captured text.
+ *
+ * @param capture  Buffer for the text.
+ * @param length   Number of characters to be added (plus the terminating zero).
+ */
+
+static void reserve_captured_text(captured_text_t *capture, size_t length)
+{
+    if ((capture->length + length + 1u) <= capture->size)
+    {
+        return;
+    }
+
+    size_t size = (capture->size > 0) ? (2u * capture->size) : MESSAGE_LINE_SIZE;
+
+    while (size < (capture->length + length + 1u))
+    {
+        size *= 2u;
+    }
+
+    char *text = (char *)allocate_memory(size, "outDecim");
+
+    if (capture->length > 0)
+    {
+        memcpy(text, capture->text, capture->length);
+    }
+
+    release_memory(capture->text, capture->size, "outDecim");
+    capture->text = text;
+    capture->size = size;
+}
+
+
+/**
+ * @brief Writes the text to the file. The text for the file of the message line is added
+ *        to the message line buffer.
+ *
+ * @param out     Pointer to the output file.
+ * @param text    Text to be written (not necessarily zero terminated).
+ * @param length  Number of characters.
+ */
+
+void msg_write(FILE *out, const char *text, size_t length)
+{
+    if ((out == captured_out) && (out != NULL))
+    {
+        if (captured != NULL)
+        {
+            reserve_captured_text(captured, length);
+            memcpy(&captured->text[captured->length], text, length);
+            captured->length += length;
+        }
+
+        return;
+    }
+
+    if ((out != message_line_out) || (out == NULL))
+    {
+        fwrite(text, 1, length, out);
+        return;
+    }
+
+    if ((message_line_length + length) > MESSAGE_LINE_SIZE)
+    {
+        fwrite(message_line, 1, message_line_length, out);
+        message_line_length = 0;
+
+        if (length > MESSAGE_LINE_SIZE)
+        {
+            fwrite(text, 1, length, out);
+            return;
+        }
+    }
+
+    memcpy(&message_line[message_line_length], text, length);
+    message_line_length += length;
+}
+
+
+/**
+ * @brief Prints the formatted text to the file. The text for the file of the message line is
+ *        added to the message line buffer.
+ *
+ * @param out     Pointer to the output file.
+ * @param format  printf() formatting string.
+ */
+
+void msg_printf(FILE *out, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    if ((out == captured_out) && (out != NULL))
+    {
+        if (captured != NULL)
+        {
+            va_list args_copy;
+            va_copy(args_copy, args);
+            size_t space = captured->size - captured->length;
+            int length = vsnprintf((space > 0) ? &captured->text[captured->length] : NULL, space, format, args);
+
+            if ((length >= 0) && ((size_t)length >= space))
+            {
+                reserve_captured_text(captured, (size_t)length);
+                (void)vsnprintf(&captured->text[captured->length], captured->size - captured->length,
+                    format, args_copy);
+            }
+
+            if (length > 0)
+            {
+                captured->length += (size_t)length;
+            }
+
+            va_end(args_copy);
+        }
+
+        va_end(args);
+        return;
+    }
+
+    if ((out != message_line_out) || (out == NULL))
+    {
+        vfprintf(out, format, args);
+        va_end(args);
+        return;
+    }
+
+    va_list args_copy;
+    va_copy(args_copy, args);
+    size_t space = MESSAGE_LINE_SIZE - message_line_length;
+    int length = vsnprintf(&message_line[message_line_length], space, format, args);
+
+    if ((length >= 0) && ((size_t)length < space))
+    {
+        message_line_length += (size_t)length;  // The text fits into the buffer
+    }
+    else if (length >= 0)
+    {
+        fwrite(message_line, 1, message_line_length, out);
+        message_line_length = 0;
+
+        if ((size_t)length < MESSAGE_LINE_SIZE)
+        {
+            message_line_length = (size_t)vsnprintf(message_line, MESSAGE_LINE_SIZE, format, args_copy);
+        }
+        else
+        {
+            vfprintf(out, format, args_copy);
+        }
+    }
+
+    va_end(args_copy);
+    va_end(args);
+}
+
+
+/**
+ * @brief Prepares the printing of the message numbers and timestamps without the fprintf()
+ *        (see prepare_fast_format()). Must be called after the command line parameters have
+ *        been processed and the fast formatting initialized.
+ */
+
+void prepare_message_line_formats(void)
+{
+    msg_number_format = prepare_fast_format(
+        (g_msg.param.msg_number_print != NULL) ? g_msg.param.msg_number_print : "N%05u");
+    timestamp_format = NULL;
+
+    if (g_msg.param.timestamp_print != NULL)
+    {
+        timestamp_format = prepare_fast_format(g_msg.param.timestamp_print);
+    }
+
+    if ((timestamp_format != NULL) && (strchr("fFeEgG", timestamp_format->conversion) == NULL))
+    {
+        timestamp_format = NULL;    // Not a floating point value specification
+    }
+
+    if ((msg_number_format != NULL) && (strchr("diouxX", msg_number_format->conversion) == NULL))
+    {
+        msg_number_format = NULL;
+    }
+}
+
+
 /**
  * @brief Prints the message number to the specified output file using
  *        the format string defined by a command line parameter.
@@ -214,6 +477,14 @@ void print_decoding_errors(void)
  
 void print_message_number(FILE *out, uint32_t msg_no)
 {
+    if (msg_number_format != NULL)
+    {
+        char text[FAST_FORMAT_BUFFER_SIZE];
+        size_t len = fast_format_integer(text, msg_number_format, msg_no);
+        write_fast_formatted_value(out, msg_number_format, text, len);
+        return;
+    }
+
     const char *string_text = "N%05u";
 
     if (g_msg.param.msg_number_print != NULL)
@@ -221,7 +492,7 @@ void print_message_number(FILE *out, uint32_t msg_no)
         string_text = g_msg.param.msg_number_print;
     }
 
-    fprintf(out, string_text, msg_no);
+    msg_printf(out, string_text, msg_no);
 }
 
 
@@ -234,7 +505,21 @@ void print_message_number(FILE *out, uint32_t msg_no)
  
 void print_timestamp(FILE *out, double timestamp)
 {
-    fprintf(out, g_msg.param.timestamp_print, timestamp * g_msg.param.time_multiplier);
+    double value = timestamp * g_msg.param.time_multiplier;
+
+    if (timestamp_format != NULL)
+    {
+        char text[FAST_FORMAT_BUFFER_SIZE];
+        size_t len = fast_format_double(text, timestamp_format, value);
+
+        if (len > 0)
+        {
+            write_fast_formatted_value(out, timestamp_format, text, len);
+            return;
+        }
+    }
+
+    msg_printf(out, g_msg.param.timestamp_print, value);
 }
 
 
@@ -275,21 +560,32 @@ void hex_dump_current_message(bool print_words)
 
     fprintf(g_msg.file.main_log, get_message_text(MSG_HEX_DUMP));
 
-    if (print_words)
-    {
-        for (unsigned i = 0; i < g_msg.asm_words; i++)
-        {
-            fprintf(g_msg.file.main_log, " %08X", g_msg.assembled_msg[i]);
-        }
-    }
-    else
+    // The values are written as " %08X" or " %02X" in blocks of up to 64 words
+    char text[64u * 4u * 3u];
+    const unsigned char *data = (const unsigned char *)&g_msg.assembled_msg[0];
+
+    for (unsigned i = 0; i < g_msg.asm_words; )
     {
-        unsigned char *data = (unsigned char *)&g_msg.assembled_msg[0];
+        char *p = text;
 
-        for (unsigned i = 0; i < (g_msg.asm_words * 4U); i++)
+        for (unsigned n = 0; (n < 64u) && (i < g_msg.asm_words); n++, i++)
         {
-            fprintf(g_msg.file.main_log, " %02X", data[i]);
+            if (print_words)
+            {
+                *p++ = ' ';
+                p = put_hex32(p, g_msg.assembled_msg[i]);
+            }
+            else
+            {
+                for (unsigned j = 0; j < 4u; j++)
+                {
+                    *p++ = ' ';
+                    p = put_hex8(p, data[4u * i + j]);
+                }
+            }
         }
+
+        fwrite(text, 1, (size_t)(p - text), g_msg.file.main_log);
     }
 }
 
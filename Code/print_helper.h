@@ -16,6 +16,18 @@
 #include "main.h"
 #include "format.h"
 
+#define MESSAGE_LINE_SIZE   8192u   // Size of the buffer for the text of a single message
+
+
+/* @brief Text written to a file collected in a buffer (see capture_file_output()) */
+typedef struct
+{
+    char *text;                 /*!< Collected text (not zero terminated) */
+    size_t length;              /*!< Number of characters in the text */
+    size_t size;                /*!< Size of the buffer */
+} captured_text_t;
+
+
 void print_message_number(FILE *out, uint32_t msg_no);
 void print_timestamp(FILE *out, double timestamp);
 void dump_filter_names_to_file(void);
@@ -24,6 +36,12 @@ const char *strip_newlines_and_shorten_string(const char *text, char spec_char);
 void save_internal_decoding_error(uint32_t sys_error, uint32_t data2);
 void save_decoding_error(uint32_t err_no, uint32_t data1, uint32_t data2, const char *fmt_text);
 void print_decoding_errors(void);
+void prepare_message_line_formats(void);
+void start_message_line(FILE *out);
+void flush_message_line(void);
+void msg_write(FILE *out, const char *text, size_t length);
+void msg_printf(FILE *out, const char *format, ...);
+void capture_file_output(FILE *out, captured_text_t *capture);
 
 #endif  // _PRINT_HELPER_H
 
@@ -20,6 +20,18 @@
 #include "statistics.h"
 #include "files.h"
 #include "errors.h"
+#include "parallel_decode.h"
+#include "bit_field.h"
+#include "array_decode.h"
+#include "hex_text.h"
+#include "fast_format.h"
+#include "profile.h"
+#include "column_export.h"
+#include "side_channel.h"
+#include "rate_stats.h"
+#include "loss_report.h"
+#include "query.h"
+#include "out_file_decimation.h"
 
 
 #ifdef _WIN32
@@ -33,6 +45,9 @@
     #endif
 #endif
 
+#define ARRAY_TEXT_BUFFER_SIZE      4096u   // Buffer for the formatted elements of an array value
+#define ARRAY_ELEMENT_MAX_LENGTH    512u    // Max. length of a single formatted array element
+
 // Union for conversion between uint32_t and float
 typedef union convert_f32
 {
@@ -60,7 +75,7 @@ static void print_binary64(FILE *out, uint64_t value, uint32_t size)
 {
     if (size == 0)
     {
-        fprintf(out, "?");
+        msg_write(out, "?", 1);
         return;
     }
 
@@ -69,23 +84,91 @@ static void print_binary64(FILE *out, uint64_t value, uint32_t size)
         size = 64U;
     }
 
-    uint64_t mask = 1uLL << (size - 1uLL);
+    char text[64u + 7u];            // 64 digits and 7 separators
+    char *end = put_binary_digits(text, value, size);
+    msg_write(out, text, (size_t)(end - text));
+}
+
+
+/**
+ * @brief Writes the data of a hex dump line as bytes, 16-bit or 32-bit words (little endian)
+ *        followed by a space.
+ *
+ * @param p         Pointer to the text buffer.
+ * @param message   Pointer to the data.
+ * @param size      Number of bytes.
+ * @param print_as  Print data as bytes (1), 16-bit (2), or 32-bit (4) words.
+ *
+ * @return Pointer to the end of the written text.
+ */
 
-    for (uint32_t i = 0; i < size; i++)
+static char *put_hex_dump_data(char *p, const unsigned char *message, unsigned size, unsigned print_as)
+{
+    for (unsigned i = 0; i < size; i += print_as)
     {
-        if ((((size - i) % 8ul) == 0) && (i != 0))
+        if (print_as == 4u)
+        {
+            uint32_t value = ((uint32_t)message[i + 3u] << 24u) | ((uint32_t)message[i + 2u] << 16u)
+                | ((uint32_t)message[i + 1u] << 8u) | message[i];
+            p = put_hex32(p, value);
+        }
+        else if (print_as == 2u)
+        {
+            p = put_hex16(p, ((uint32_t)message[i + 1u] << 8u) | message[i]);
+        }
+        else
         {
-            fprintf(out, "%c", '\'');
+            p = put_hex8(p, message[i]);
         }
 
-        fprintf(out, "%c", (value & mask) ? '1' : '0');
-        mask >>= 1uLL;
+        *p++ = ' ';
+    }
+
+    return p;
+}
+
+
+/**
+ * @brief Writes the start of a hex dump line: new line and the index of the first byte ("\n%3X: ").
+ *
+ * @param p      Pointer to the text buffer (at least 12 characters).
+ * @param index  Index of the first byte in the line.
+ *
+ * @return Pointer to the end of the written text.
+ */
+
+static char *put_hex_dump_index(char *p, unsigned index)
+{
+    char digits[8];
+    unsigned n = 0;
+
+    do
+    {
+        digits[n++] = "0123456789ABCDEF"[index & 0x0Fu];
+        index >>= 4u;
+    } while (index != 0);
+
+    *p++ = '\n';
+
+    for (unsigned i = n; i < 3u; i++)
+    {
+        *p++ = ' ';
+    }
+
+    while (n > 0)
+    {
+        *p++ = digits[--n];
     }
+
+    *p++ = ':';
+    *p++ = ' ';
+    return p;
 }
 
 
 /**
  * @brief Helper function to print the contents of a message as hexadecimal data.
+ *        Every line of the dump is written to the output at once.
  *
  * @param out      File to which the data will be printed.
  * @param message  Pointer to the message that will be printed.
@@ -93,40 +176,25 @@ static void print_binary64(FILE *out, uint64_t value, uint32_t size)
  * @param print_as Print data as bytes (1), 16-bit (2), or 32-bit (4) words.
  */
  
-static void hex_print(FILE *out, unsigned char **message, unsigned int *size, int print_as)
+static void hex_print(FILE *out, unsigned char **message, unsigned int *size, unsigned print_as)
 {
-    unsigned int i = 0;
     unsigned int current_index = 0;
     unsigned char *p_msg = *message;
+    char line[12u + 3u * 16u];      // Index and 16 bytes printed as "XX "
 
     do
     {
-        fprintf(out, "\n%3X: ", current_index);
-
-        for (i = 0; i < 16u; i += print_as)
-        {
-            if (print_as == 4u)
-            {
-                uint32_t value = (p_msg[i + 3u] << 24u) | (p_msg[i + 2u] << 16u)
-                    | (p_msg[i + 1] << 8u) | p_msg[i];
-                fprintf(out, "%08X ", value);
-            }
-            else if (print_as == 2u)
-            {
-                fprintf(out, "%04X ", (p_msg[i + 1] << 8u) | p_msg[i]);
-            }
-            else
-            {
-                fprintf(out, "%02X ", p_msg[i]);
-            }
-        }
+        char *end = put_hex_dump_index(line, current_index);
+        end = put_hex_dump_data(end, p_msg, 16u, print_as);
+        msg_write(out, line, (size_t)(end - line));
 
         *size -= 16u;
         p_msg += 16u;
         current_index += 16u;
     } while (*size > 16u);
 
-    fprintf(out, "\n%3X: ", current_index);
+    char *end = put_hex_dump_index(line, current_index);
+    msg_write(out, line, (size_t)(end - line));
     *message = p_msg;
 }
 
@@ -143,8 +211,6 @@ static void hex_print(FILE *out, unsigned char **message, unsigned int *size, in
  
 static void hex_print_complete_message(FILE *out, unsigned char *message, unsigned size, unsigned print_as)
 {
-    unsigned int i = 0;
-
     if (size > 16u)
     {
         // Print the initial part of the message in 16-byte chunks.
@@ -152,35 +218,13 @@ static void hex_print_complete_message(FILE *out, unsigned char *message, unsign
     }
 
     // Print the remaining part of the message.
-    switch (print_as)
-    {
-        case 4u:
-            for (i = 0; i < size; i += 4u)
-            {
-                uint32_t value = (message[i + 3u] << 24u) | (message[i + 2u] << 16u)
-                    | (message[i + 1u] << 8u) | message[i];
-                fprintf(out, "%08X ", value);
-            }
-            break;
-
-        case 2u:
-            for (i = 0; i < size; i += 2u)
-            {
-                fprintf(out, "%04X ", (message[i + 1u] << 8u) | message[i]);
-            }
-            break;
-
-        default:
-            for (i = 0; i < size; i++)
-            {
-                fprintf(out, "%02X ", message[i]);
-            }
-            break;
-    }
+    char line[3u * 16u + 3u];       // Up to 16 bytes printed as "XX " (and a partial word)
+    char *end = put_hex_dump_data(line, message, size, print_as);
+    msg_write(out, line, (size_t)(end - line));
 
     if (size > 16u)
     {
-        fprintf(out, "\n");
+        msg_write(out, "\n", 1);
     }
 }
 
@@ -196,58 +240,27 @@ static void hex_print_complete_message(FILE *out, unsigned char *message, unsign
 static void value_scaling(value_format_t *fmt, double data)
 {
     // Store the original data in case the multiplier is zero.
-    g_msg.value.data_double = data;
+    g_ctx->value.data_double = data;
 
     if (fmt->mult != 0)
     {
-        g_msg.value.data_double = (data + fmt->offset) * fmt->mult;
+        g_ctx->value.data_double = (data + fmt->offset) * fmt->mult;
 
         /* Convert the scaled double value to integer and unsigned integer also to 
          * enable printing with %d, %u, etc. */
-        g_msg.value.data_i64 = (int64_t)(g_msg.value.data_double + 0.5);
-        g_msg.value.data_u64 = (uint64_t)(g_msg.value.data_double + 0.5);
-    }
-}
-
-
-/**
- * @brief Assembles a value from a specified bit address and size in bits.
- *
- * @param size      Size of the value in bits.
- * @param address   Bit address of the value (number of bits to the first bit of the value).
- * @param message   Pointer to the buffer containing the message to be processed.
- *
- * @return Assembled value as a 64-bit unsigned integer.
- */
-
-static uint64_t extract_bit_sized_value(uint32_t size, uint32_t address, uint8_t *message)
-{
-    uint64_t value = 0;
-
-    while (size > 0)
-    {
-        unsigned bit_address = address & 7u;
-        unsigned byte_address = address >> 3u;
-        value >>= 1;
-
-        if (*(message + byte_address) & (1u << bit_address))
-        {
-            value |= (1uLL << 63u);
-        }
-
-        address++;
-        size--;
+        g_ctx->value.data_i64 = (int64_t)(g_ctx->value.data_double + 0.5);
+        g_ctx->value.data_u64 = (uint64_t)(g_ctx->value.data_double + 0.5);
     }
-
-    return value;
 }
 
 
 /**
  * @brief Extract the value with specified length starting with the specified
  *        bit address of the lowest value bit.
- *        Value is extracted to the 64-bit unsigned variable g_msg.value.data_u64
- *        and its signed value to the g_msg.value.data_i64.
+ *        Value is extracted to the 64-bit unsigned variable g_ctx->value.data_u64
+ *        and its signed value to the g_ctx->value.data_i64.
+ *        The size and address are checked only for the values for which this was
+ *        not already done by the compile_decode_plans().
  *
  * @param fmt    Pointer to the value descriptor for the current printed value.
  */
@@ -257,61 +270,43 @@ static void extract_value_from_message(value_format_t *fmt)
     uint32_t size = fmt->data_size;             // Number of bits to extract
     uint32_t address = fmt->bit_address;        // Bit address of the value in the message
 
-    if (size == 0)         // If size is 0, use the entire message
-    {
-        return;
-    }
-
-    if (size > 64u)
-    {
-        save_decoding_error(ERR_DECODE_VALUE_SIZE_TOO_LARGE, size, 64, fmt->fmt_string);
-        return;
-    }
-
-    // Ensure the value fits within the received message length
-    unsigned end_address = size + address;
-
-    if (end_address > (g_msg.asm_size * 8u))
+    if (fmt->extraction == EXTRACT_CHECKED)
     {
-        save_decoding_error(ERR_DECODE_VALUE_NOT_IN_MESSAGE, end_address,
-            g_msg.asm_size * 8u, fmt->fmt_string);
-        return;
-    }
+        if (size == 0)         // If size is 0, use the entire message
+        {
+            return;
+        }
 
-    uint8_t *message = (uint8_t *)g_msg.assembled_msg;
-    uint64_t value = 0;
+        if (size > 64u)
+        {
+            save_decoding_error(ERR_DECODE_VALUE_SIZE_TOO_LARGE, size, 64, fmt->fmt_string);
+            return;
+        }
 
-    if (((size | address) & 7) == 0)
-    {
-        // Extract the value as bytes since both size and address are byte-aligned
-        address >>= 3;      // Convert bit address to byte address
-        size >>= 3;         // Convert size from bits to bytes
-        message += address;
+        // Ensure the value fits within the received message length
+        unsigned end_address = size + address;
 
-        do
+        if (end_address > (g_ctx->asm_size * 8u))
         {
-            value >>= 8u;
-            value |= ((uint64_t)*message) << (64u - 8u);
-            message++;
-        } while (--size != 0);
-    }
-    else
-    {
-        // Extract the value bit by bit
-        value = extract_bit_sized_value(size, address, (uint8_t *)message);
+            save_decoding_error(ERR_DECODE_VALUE_NOT_IN_MESSAGE, end_address,
+                g_ctx->asm_size * 8u, fmt->fmt_string);
+            return;
+        }
     }
 
+    uint64_t value = extract_bit_field((const uint8_t *)g_ctx->assembled_msg, address, size);
+
     unsigned shift = 64u - fmt->data_size;
-    g_msg.value.data_u64 = value >> shift;
-    g_msg.value.data_i64 = (int64_t)value;
-    g_msg.value.data_i64 >>= shift;
+    g_ctx->value.data_u64 = value >> shift;
+    g_ctx->value.data_i64 = (int64_t)value;
+    g_ctx->value.data_i64 >>= shift;
 }
 
 
 /**
  * @brief Saves the current value to memory at the specified index.
- * @note  g_msg.value is initialized to zero at the start of value processing. If the value
- *        cannot be set correctly, g_msg.value remains zero for printing purposes.
+ * @note  g_ctx->value is initialized to zero at the start of value processing. If the value
+ *        cannot be set correctly, g_ctx->value remains zero for printing purposes.
  *
  * @param memo       Index in the g_msg.enums[] array.
  */
@@ -322,7 +317,7 @@ static void save_to_memo(rte_enum_t memo)
     {
         if (g_msg.enums[memo].type == MEMO_TYPE)
         {
-            g_msg.enums[memo].u.memo_value = g_msg.value.data_double;
+            g_msg.enums[memo].u.memo_value = g_ctx->value.data_double;
         }
         else
         {
@@ -339,7 +334,7 @@ static void save_to_memo(rte_enum_t memo)
 /**
  * @brief Prepares a 32-bit variable for printing.
  *        This is used only for values where the number of bits and type are unspecified.
- *        The values are stored in the 'g_msg.value' structure.
+ *        The values are stored in the 'g_ctx->value' structure.
  *
  * @param fmt    Pointer to the structure containing value preparation/conversion and print information.
  *
@@ -377,19 +372,19 @@ static bool process_value_auto(value_format_t *fmt)
     switch (fmt->fmt_type)
     {
         case PRINT_DOUBLE:
-            convert_value32.data_u = (uint32_t)g_msg.value.data_u64;
-            g_msg.value.data_double = (double)convert_value32.data_f;
-            value_scaling(fmt, g_msg.value.data_double);
+            convert_value32.data_u = (uint32_t)g_ctx->value.data_u64;
+            g_ctx->value.data_double = (double)convert_value32.data_f;
+            value_scaling(fmt, g_ctx->value.data_double);
             break;
 
         case PRINT_INT64:
-            g_msg.value.data_double = (double)g_msg.value.data_i64;
-            value_scaling(fmt, (double)g_msg.value.data_i64);
+            g_ctx->value.data_double = (double)g_ctx->value.data_i64;
+            value_scaling(fmt, (double)g_ctx->value.data_i64);
             break;
 
         case PRINT_UINT64:
-            g_msg.value.data_double = (double)g_msg.value.data_u64;
-            value_scaling(fmt, (double)g_msg.value.data_u64);
+            g_ctx->value.data_double = (double)g_ctx->value.data_u64;
+            value_scaling(fmt, (double)g_ctx->value.data_u64);
             break;
 
         case PRINT_STRING:
@@ -475,20 +470,20 @@ static void process_double_value(value_format_t *fmt)
     {
         case 16:
             extract_value_from_message(fmt);
-            g_msg.value.data_double =
-                (double)convert_half_float_to_float((uint16_t)g_msg.value.data_u64);
+            g_ctx->value.data_double =
+                (double)convert_half_float_to_float((uint16_t)g_ctx->value.data_u64);
             break;
 
         case 32:
             extract_value_from_message(fmt);
-            convert_value32.data_u = (uint32_t)g_msg.value.data_u64;
-            g_msg.value.data_double = (double)convert_value32.data_f;
+            convert_value32.data_u = (uint32_t)g_ctx->value.data_u64;
+            g_ctx->value.data_double = (double)convert_value32.data_f;
             break;
 
         case 64:
             extract_value_from_message(fmt);
-            convert_value64.data_u = g_msg.value.data_u64;
-            g_msg.value.data_double = convert_value64.data_f;
+            convert_value64.data_u = g_ctx->value.data_u64;
+            g_ctx->value.data_double = convert_value64.data_f;
             break;
 
         default:
@@ -497,7 +492,7 @@ static void process_double_value(value_format_t *fmt)
             return;
     }
 
-    value_scaling(fmt, g_msg.value.data_double);
+    value_scaling(fmt, g_ctx->value.data_double);
 }
 
 
@@ -513,9 +508,9 @@ static void process_memo(value_format_t *fmt)
     {
         if ((g_msg.enums[fmt->get_memo].name != NULL) && (g_msg.enums[fmt->get_memo].type == MEMO_TYPE))
         {
-            g_msg.value.data_double = g_msg.enums[fmt->get_memo].u.memo_value;
-            g_msg.value.data_i64 = (int64_t)g_msg.value.data_double;
-            g_msg.value.data_u64 = (uint64_t)g_msg.value.data_double;
+            g_ctx->value.data_double = g_msg.enums[fmt->get_memo].u.memo_value;
+            g_ctx->value.data_i64 = (int64_t)g_ctx->value.data_double;
+            g_ctx->value.data_u64 = (uint64_t)g_ctx->value.data_double;
         }
         else
         {
@@ -523,7 +518,7 @@ static void process_memo(value_format_t *fmt)
             return;
         }
 
-        value_scaling(fmt, g_msg.value.data_double);
+        value_scaling(fmt, g_ctx->value.data_double);
     }
     else
     {
@@ -569,12 +564,12 @@ static void check_value_bit_address(value_format_t *fmt, bool divisible_by_8)
 
 static void prepare_message_time_period(value_format_t *fmt)
 {
-    if (g_msg.fmt_id >= MAX_FMT_IDS)
+    if (g_ctx->fmt_id >= MAX_FMT_IDS)
     {
         return;
     }
 
-    msg_data_t *p_msg = g_fmt[g_msg.fmt_id];
+    msg_data_t *p_msg = g_fmt[g_ctx->fmt_id];
 
     if (p_msg == NULL)
     {
@@ -584,8 +579,8 @@ static void prepare_message_time_period(value_format_t *fmt)
     // Calculate the time difference only if the message has been decoded at least once before
     if (p_msg->counter > 0)
     {
-        g_msg.value.data_double = g_msg.timestamp.f - p_msg->time_last_message;
-        value_scaling(fmt, g_msg.value.data_double);
+        g_ctx->value.data_double = g_ctx->timestamp - p_msg->time_last_message;
+        value_scaling(fmt, g_ctx->value.data_double);
     }
 }
 
@@ -614,40 +609,27 @@ static void prepare_time_difference(value_format_t *fmt)
 
     if (p_fmt->counter > 0)
     {
-        double time_diff = g_msg.timestamp.f - p_fmt->time_last_message;
-        g_msg.value.data_u64 = (uint64_t)time_diff;
-        g_msg.value.data_i64 = (int64_t)time_diff;
-        g_msg.value.data_double = time_diff;
-        value_scaling(fmt, g_msg.value.data_double);
+        double time_diff = g_ctx->timestamp - p_fmt->time_last_message;
+        g_ctx->value.data_u64 = (uint64_t)time_diff;
+        g_ctx->value.data_i64 = (int64_t)time_diff;
+        g_ctx->value.data_double = time_diff;
+        value_scaling(fmt, g_ctx->value.data_double);
     }
 }
 
 
 /**
- * @brief Prepares a value for printing by setting up the necessary information
- *        for the 'print_message()' function. The values are stored in the
- *        'g_msg.value' structure. Each data type is prepared, if possible, as a
- *        64-bit integer, 64-bit unsigned integer, double, and (if possible) as
- *        string also.
- * @note  The 'g_msg.value' is initialized to zero at the start of processing.
- *        If the value cannot be set correctly, it remains zero for printing.
+ * @brief Prepares the value data according to the data type in the 'g_ctx->value'
+ *        structure (see prepare_value()).
  *
- * @param fmt            Pointer to the structure containing value preparation,
- *                       conversion, and print information.
- * @param divisible_by_8 Indicates whether the value must be divisible by 8
- *                       (true) or must not be divisible by 8 (false).
+ * @param fmt    Pointer to the structure containing value preparation,
+ *               conversion, and print information.
+ *
+ * @return  false - error detected, the value processing must be stopped
  */
 
-static void prepare_value(value_format_t *fmt, bool divisible_by_8)
+static bool prepare_value_data(value_format_t *fmt)
 {
-    if (fmt->fmt_string == NULL)
-    {
-        save_internal_decoding_error(INT_FMT_STRING_NULL, 0);
-        return;
-    }
-
-    check_value_bit_address(fmt, divisible_by_8);
-
     // Validate data length based on the data type and prepare the data,
     // or report an error if the data or address is invalid.
     switch (fmt->data_type)
@@ -658,7 +640,7 @@ static void prepare_value(value_format_t *fmt, bool divisible_by_8)
 
             if (rez != 0)
             {
-                return;     // Error detected - stop the value processing
+                return false;   // Error detected - stop the value processing
             }
 
             break;
@@ -668,24 +650,24 @@ static void prepare_value(value_format_t *fmt, bool divisible_by_8)
             if (fmt->data_size < 2)
             {
                 save_decoding_error(ERR_DECODE_TOO_SMALL_INT_DATA_SIZE, fmt->data_size, 1u, fmt->fmt_string);
-                return;
+                return false;
             }
 
             extract_value_from_message(fmt);
-            g_msg.value.data_double = (double)g_msg.value.data_i64;
-            value_scaling(fmt, (double)g_msg.value.data_i64);
+            g_ctx->value.data_double = (double)g_ctx->value.data_i64;
+            value_scaling(fmt, (double)g_ctx->value.data_i64);
             break;
 
         case VALUE_UINT64:          // Unsigned integers (1 to 64 bits long)
             if (fmt->data_size < 1)
             {
                 save_decoding_error(ERR_DECODE_TOO_SMALL_UINT_DATA_SIZE, fmt->data_size, 0, fmt->fmt_string);
-                return;
+                return false;
             }
 
             extract_value_from_message(fmt);
-            g_msg.value.data_double = (double)g_msg.value.data_u64;
-            value_scaling(fmt, (double)g_msg.value.data_u64);
+            g_ctx->value.data_double = (double)g_ctx->value.data_u64;
+            value_scaling(fmt, (double)g_ctx->value.data_u64);
             break;
 
         case VALUE_DOUBLE:          // Float (32b) or double (64b) values
@@ -702,8 +684,8 @@ static void prepare_value(value_format_t *fmt, bool divisible_by_8)
             break;
 
         case VALUE_TIMESTAMP:       // Value of current timestamp
-            g_msg.value.data_double = g_msg.timestamp.f;
-            value_scaling(fmt, g_msg.value.data_double);
+            g_ctx->value.data_double = g_ctx->timestamp;
+            value_scaling(fmt, g_ctx->value.data_double);
             break;
 
         case VALUE_MEMO:            // Use the memorized value
@@ -711,9 +693,9 @@ static void prepare_value(value_format_t *fmt, bool divisible_by_8)
             break;
 
         case VALUE_MESSAGE_NO:      // Number of current message
-            g_msg.value.data_u64 = g_msg.message_cnt;
-            g_msg.value.data_i64 = (int64_t)g_msg.message_cnt;
-            g_msg.value.data_double = (double)g_msg.message_cnt;
+            g_ctx->value.data_u64 = g_ctx->message_cnt;
+            g_ctx->value.data_i64 = (int64_t)g_ctx->message_cnt;
+            g_ctx->value.data_double = (double)g_ctx->message_cnt;
             break;
 
         case VALUE_TIME_DIFF:       // Time difference between current time and specified message
@@ -722,80 +704,57 @@ static void prepare_value(value_format_t *fmt, bool divisible_by_8)
 
         default:
             save_internal_decoding_error(INT_BAD_DATA_TYPE, fmt->data_type);
-            return;
+            return false;
     }
 
-    // Write the value to the memory (if memory is defined for this value)
-    rte_enum_t memo = fmt->put_memo;
-
-    if (memo != 0)
-    {
-        save_to_memo(memo);
-    }
+    return true;
 }
 
 
 /**
- * @brief Choose the text from the indexed text buffer to the output buffer.
- *        Copy the last one if the index is over the maximal number of text messages.
- *        The first byte of each message contains length of message (1 .. 255 bytes).
- *        Length of message == 0 => end of indexed text.
- *
- * @param y_text      Pointer to the buffer containing indexed text.
- * @param txt_buffer  Buffer where the selected text will be copied.
- * @param buf_size    Size of txt_buffer including space for null terminator.
- * @param index       Index of the desired text in 'y_text'.
+ * @brief Prepares a value for printing by setting up the necessary information
+ *        for the 'print_message()' function. The values are stored in the
+ *        'g_ctx->value' structure. Each data type is prepared, if possible, as a
+ *        64-bit integer, 64-bit unsigned integer, double, and (if possible) as
+ *        string also.
+ * @note  The 'g_ctx->value' is initialized to zero at the start of processing.
+ *        If the value cannot be set correctly, it remains zero for printing.
  *
- * @return            Pointer to the copied text in the buffer, or TXT_UNDEFINED_TEXT if error.
+ * @param fmt            Pointer to the structure containing value preparation,
+ *                       conversion, and print information.
+ * @param divisible_by_8 Indicates whether the value must be divisible by 8
+ *                       (true) or must not be divisible by 8 (false).
  */
 
-static const char* copy_selected_text(const char* y_text, char* txt_buffer, size_t buf_size, unsigned index)
+static void prepare_value(value_format_t *fmt, bool divisible_by_8)
 {
-    txt_buffer[0] = '\0';
-    const char* text = TXT_UNDEFINED_TEXT;
-
-    if ((y_text == NULL) || (txt_buffer == NULL) || (buf_size == 0))
+    if (fmt->fmt_string == NULL)
     {
-        return text;
+        save_internal_decoding_error(INT_FMT_STRING_NULL, 0);
+        return;
     }
 
-    // Size of the first text
-    size_t text_length = (unsigned char)*y_text;
-    if (text_length == 0)
-    {
-        return text;
-    }
+    check_value_bit_address(fmt, divisible_by_8);
 
-    // Navigate to desired index
-    const char* current = y_text;
-    for (size_t i = 0; i < index; i++)
+    if (!prepare_value_data(fmt))
     {
-        if (current[1u + text_length] == 0)   // Last message in the list?
-        {
-            break;
-        }
-
-        // Move to next message
-        current += text_length + 1u;
-        text_length = (unsigned char)*current;
+        return;
     }
 
-    // Copy selected text if it fits in the buffer
-    if ((text_length > 0) && (text_length < buf_size))
+    // Write the value to the memory (if memory is defined for this value)
+    rte_enum_t memo = fmt->put_memo;
+
+    if (memo != 0)
     {
-        memcpy(txt_buffer, current + 1u, text_length);
-        txt_buffer[text_length] = '\0';
-        text = txt_buffer;
+        save_to_memo(memo);
     }
-
-    return text;
 }
 
 
 /**
  * @brief Return pointer to the indexed text (or last text message of the list if out of bounds).
- *        Select the text from a list of text messages. The first byte of every message contains
- *        number of characters in the message - see below:
+ *        The texts are selected with the offset table prepared by prepare_selected_texts().
+ *        The texts are not zero terminated - see below:
  *          no_characters1, "non zero terminated string with 'no_characters1' length"
  *              ...
  *          no_charactersN, "non zero terminated string with 'no_charactersN' length"
@@ -803,42 +762,96 @@ static const char* copy_selected_text(const char* y_text, char* txt_buffer, size
  *
  * @param in_file  Index of the structure containing indexed text messages.
  * @param index    Index to select the desired text message.
+ * @param length   Output: length of the selected text.
  *
- * @return         Pointer to the selected text or NULL if no valid text is found.
+ * @return         Pointer to the selected text (empty text if no valid text is found).
  */
 
-static const char *get_selected_text(rte_enum_t in_file, unsigned index)
+static const char *get_selected_text(rte_enum_t in_file, unsigned index, size_t *length)
 {
-    static char txt_buffer[256];
+    *length = 0;
 
     if (in_file < MAX_ENUMS)
     {
-        if ((g_msg.enums[in_file].type == Y_TEXT_TYPE) || (g_msg.enums[in_file].type == IN_FILE_TYPE))
+        const enum_data_t *p_enum = &g_msg.enums[in_file];
+
+        if ((p_enum->type == Y_TEXT_TYPE) || (p_enum->type == IN_FILE_TYPE))
         {
-            char *y_text = g_msg.enums[in_file].u.in_file_txt;
+            const char *y_text = p_enum->u.in_file_txt;
 
             if (y_text == NULL)
             {
                 save_internal_decoding_error(INT_DECODE_Y_TYPE_STRING_NULL, 0);
             }
-            else
+            else if (p_enum->no_texts > 0)
             {
-                copy_selected_text(y_text, txt_buffer, sizeof(txt_buffer), index);
+                if (index >= p_enum->no_texts)
+                {
+                    index = p_enum->no_texts - 1u;      // Last text of the list
+                }
+
+                const char *text = y_text + p_enum->text_offset[index];
+                *length = (unsigned char)text[0];
+                return text + 1u;
             }
         }
         else
         {
-            save_internal_decoding_error(INT_DECODE_Y_TYPE_STRING, g_msg.enums[in_file].type);
+            save_internal_decoding_error(INT_DECODE_Y_TYPE_STRING, p_enum->type);
         }
     }
 
-    return txt_buffer;
+    return "";
+}
+
+
+/**
+ * @brief Prepares the table of text offsets for every indexed text (IN_FILE() and
+ *        {text1|text2|...} definitions), so that the %Y values do not have to
+ *        search through the list of texts.
+ */
+
+static void prepare_selected_texts(void)
+{
+    for (rte_enum_t i = NUMBER_OF_FILTER_BITS; i < g_msg.enums_found; i++)
+    {
+        enum_data_t *p_enum = &g_msg.enums[i];
+
+        if (((p_enum->type != Y_TEXT_TYPE) && (p_enum->type != IN_FILE_TYPE))
+            || (p_enum->u.in_file_txt == NULL) || (p_enum->text_offset != NULL))
+        {
+            continue;
+        }
+
+        const unsigned char *y_text = (const unsigned char *)p_enum->u.in_file_txt;
+        uint32_t no_texts = 0;
+
+        for (size_t pos = 0; y_text[pos] != 0; pos += 1u + y_text[pos])
+        {
+            no_texts++;
+        }
+
+        if (no_texts == 0)
+        {
+            continue;
+        }
+
+        p_enum->text_offset = (uint32_t *)allocate_parse_memory(no_texts * sizeof(uint32_t), "textIdx");
+        p_enum->no_texts = no_texts;
+        uint32_t pos = 0;
+
+        for (uint32_t n = 0; n < no_texts; n++)
+        {
+            p_enum->text_offset[n] = pos;
+            pos += 1u + y_text[pos];
+        }
+    }
 }
 
 
 /**
  * @brief Logs timestamps to the 'Timestamps.csv' file.
- *        Each timestamp is logged with its corresponding message number.
+ *        Each timestamp is logged with its corresponding message number by the side channel.
  */
 
 static void timestamp_logging(void)
@@ -851,15 +864,14 @@ static void timestamp_logging(void)
     }
 
     // Do not print timestamp for the first message or if a decoding error was reported
-    if ((g_msg.messages_processed_after_restart > 0) && (g_msg.msg_error_counter == 0))
+    if ((g_msg.messages_processed_after_restart > 0) && (g_ctx->msg_error_counter == 0))
     {
-        double timestamp_diff = (g_msg.timestamp.f - previous_time) * g_msg.param.time_multiplier;
-        print_message_number(g_msg.file.timestamps, g_msg.message_cnt);
-        fprintf(g_msg.file.timestamps, ";%8.6f;%g\n",
-            g_msg.timestamp.f * g_msg.param.time_multiplier, timestamp_diff);
+        double timestamp_diff = (g_ctx->timestamp - previous_time) * g_msg.param.time_multiplier;
+        side_channel_timestamp(g_ctx->message_cnt,
+            g_ctx->timestamp * g_msg.param.time_multiplier, timestamp_diff);
     }
 
-    previous_time = g_msg.timestamp.f;
+    previous_time = g_ctx->timestamp;
 }
 
 
@@ -892,8 +904,8 @@ static void hex_dump_complete_message_to_file(FILE *out, value_format_t *fmt)
             break;
     }
 
-    unsigned size = g_msg.asm_size;
-    unsigned char *address = (unsigned char *)g_msg.assembled_msg;
+    unsigned size = g_ctx->asm_size;
+    unsigned char *address = (unsigned char *)g_ctx->assembled_msg;
     unsigned bytes_to_skip = (fmt->bit_address + 7U) / 8U;
 
     if (size < bytes_to_skip)
@@ -904,13 +916,13 @@ static void hex_dump_complete_message_to_file(FILE *out, value_format_t *fmt)
     size -= bytes_to_skip;
     address += bytes_to_skip;
 
-    fprintf(out, fmt->fmt_string);
+    msg_printf(out, fmt->fmt_string);
     hex_print_complete_message(out, address, size, print_as);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string);
-        hex_print_complete_message(g_msg.file.main_log, address, size, print_as);
+        msg_printf(g_ctx->main_log, fmt->fmt_string);
+        hex_print_complete_message(g_ctx->main_log, address, size, print_as);
     }
 }
 
@@ -924,11 +936,11 @@ static void hex_dump_complete_message_to_file(FILE *out, value_format_t *fmt)
 
 static void print_date_to_file(FILE *out, value_format_t *fmt)
 {
-    fprintf(out, "%s%s", fmt->fmt_string, g_msg.date_string);
+    msg_printf(out, "%s%s", fmt->fmt_string, g_msg.date_string);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, "%s%s", fmt->fmt_string, g_msg.date_string);
+        msg_printf(g_ctx->main_log, "%s%s", fmt->fmt_string, g_msg.date_string);
     }
 }
 
@@ -944,13 +956,13 @@ static void write_binary_message_data_to_file(FILE *out, value_format_t *fmt)
 {
     if (fmt->data_size == 0)    // Write the complete message
     {
-        fprintf(out, fmt->fmt_string);
-        fwrite((unsigned char *)g_msg.assembled_msg, 1, g_msg.asm_size, out);
+        msg_printf(out, fmt->fmt_string);
+        msg_write(out, (const char *)g_ctx->assembled_msg, g_ctx->asm_size);
 
         if (fmt->print_copy_to_main_log)
         {
-            fprintf(g_msg.file.main_log, fmt->fmt_string);
-            fwrite((unsigned char *)g_msg.assembled_msg, 1, g_msg.asm_size, g_msg.file.main_log);
+            msg_printf(g_ctx->main_log, fmt->fmt_string);
+            msg_write(g_ctx->main_log, (const char *)g_ctx->assembled_msg, g_ctx->asm_size);
         }
     }
     else
@@ -964,13 +976,13 @@ static void write_binary_message_data_to_file(FILE *out, value_format_t *fmt)
         }
 
         prepare_value(fmt, true);
-        fprintf(out, fmt->fmt_string);
-        fwrite((const char *)&g_msg.value.data_u64, 1, fmt->data_size / 8u, out);
+        msg_printf(out, fmt->fmt_string);
+        msg_write(out, (const char *)&g_ctx->value.data_u64, fmt->data_size / 8u);
 
         if (fmt->print_copy_to_main_log)
         {
-            fprintf(g_msg.file.main_log, fmt->fmt_string);
-            fwrite((const char *)&g_msg.value.data_u64, 1, fmt->data_size / 8u, g_msg.file.main_log);
+            msg_printf(g_ctx->main_log, fmt->fmt_string);
+            msg_write(g_ctx->main_log, (const char *)&g_ctx->value.data_u64, fmt->data_size / 8u);
         }
     }
 }
@@ -980,9 +992,11 @@ static void write_binary_message_data_to_file(FILE *out, value_format_t *fmt)
  * @brief Calculate total data size for a particular message (including the FMT words).
  *
  * @param p_fmt   Pointer to the current message parameters.
+ *
+ * @return Number of words of the message
  */
 
-static void calculate_total_message_size(msg_data_t *p_fmt)
+static uint32_t calculate_total_message_size(msg_data_t *p_fmt)
 {
     uint32_t total_words = g_msg.asm_words;      // Number of data words found for this message
     uint32_t remainder = total_words & 3uL;
@@ -999,6 +1013,7 @@ static void calculate_total_message_size(msg_data_t *p_fmt)
     }
 
     p_fmt->total_data_received += total_words;
+    return total_words;
 }
 
 
@@ -1006,29 +1021,29 @@ static void calculate_total_message_size(msg_data_t *p_fmt)
  * @brief Prints the time difference between the current and previous message timestamps for the same message.
  *
  * @param out    Pointer to the output file.
- * @param p_fmt  Pointer to the current message parameters.
  * @param fmt    Pointer to the current value parameters.
  */
 
-static void print_dTimeStamp_to_file(FILE *out, msg_data_t *p_fmt, value_format_t *fmt)
+static void print_dTimeStamp_to_file(FILE *out, value_format_t *fmt)
 {
+    msg_data_t *p_fmt = g_fmt[g_ctx->fmt_id];   // The format ID was checked by check_and_get_print_info()
     double value = 0;
 
     if (p_fmt->counter > 0)
     {
-        value = g_msg.timestamp.f - p_fmt->time_last_message;
+        value = g_ctx->timestamp - p_fmt->time_last_message;
     }
 
-    fprintf(out, fmt->fmt_string);
+    msg_printf(out, fmt->fmt_string);
     print_timestamp(out, value);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string);
-        print_timestamp(g_msg.file.main_log, value);
+        msg_printf(g_ctx->main_log, fmt->fmt_string);
+        print_timestamp(g_ctx->main_log, value);
     }
 
-    g_msg.value.data_double = value;
+    g_ctx->value.data_double = value;
 
     // Save the value to memory if a memo is defined for this value.
     rte_enum_t memo = fmt->put_memo;
@@ -1049,12 +1064,12 @@ static void print_dTimeStamp_to_file(FILE *out, msg_data_t *p_fmt, value_format_
 
 static void print_current_message_name(FILE *out, value_format_t *fmt)
 {
-    fprintf(out, fmt->fmt_string);
-    fprintf(out, get_format_id_name(g_msg.fmt_id));
+    msg_printf(out, fmt->fmt_string);
+    msg_printf(out, get_format_id_name(g_ctx->fmt_id));
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string);
+        msg_printf(g_ctx->main_log, fmt->fmt_string);
         // The message name is not printed to Main.log again as it was already printed.
     }
 }
@@ -1069,12 +1084,12 @@ static void print_current_message_name(FILE *out, value_format_t *fmt)
 
 static void print_current_message_number(FILE *out, value_format_t *fmt)
 {
-    fprintf(out, fmt->fmt_string);
-    print_message_number(out, g_msg.message_cnt);
+    msg_printf(out, fmt->fmt_string);
+    print_message_number(out, g_ctx->message_cnt);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string);
+        msg_printf(g_ctx->main_log, fmt->fmt_string);
         // The message number is not printed to Main.log again as it was already printed.
     }
 
@@ -1097,13 +1112,13 @@ static void print_current_message_number(FILE *out, value_format_t *fmt)
 
 static void print_timestamp_to_file(FILE *out, value_format_t *fmt)
 {
-    fprintf(out, fmt->fmt_string);
-    print_timestamp(out, g_msg.timestamp.f);
-    g_msg.value.data_double = g_msg.timestamp.f;
+    msg_printf(out, fmt->fmt_string);
+    print_timestamp(out, g_ctx->timestamp);
+    g_ctx->value.data_double = g_ctx->timestamp;
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string);
+        msg_printf(g_ctx->main_log, fmt->fmt_string);
         // The timestamp is not printed to Main.log again as it was already printed.
     }
 
@@ -1127,25 +1142,17 @@ static void print_timestamp_to_file(FILE *out, value_format_t *fmt)
 static void print_selected_text(FILE *out, value_format_t *fmt)
 {
     prepare_value(fmt, 0);
-    fprintf(out, "%s", fmt->fmt_string);
+    msg_printf(out, "%s", fmt->fmt_string);
 
     // Retrieve the text from a list of text messages
-    const char *text = get_selected_text(fmt->in_file, (unsigned)(g_msg.value.data_u64));
-    // The first byte contains the string length information
-
-    if (text != NULL)
-    {
-        fprintf(out, "%s", text);
-    }
+    size_t length;
+    const char *text = get_selected_text(fmt->in_file, (unsigned)(g_ctx->value.data_u64), &length);
+    msg_printf(out, "%.*s", (int)length, text);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, "%s", fmt->fmt_string);
-
-        if (text != NULL)
-        {
-            fprintf(g_msg.file.main_log, "%s", text);
-        }
+        msg_printf(g_ctx->main_log, "%s", fmt->fmt_string);
+        msg_printf(g_ctx->main_log, "%.*s", (int)length, text);
     }
 }
 
@@ -1161,23 +1168,23 @@ static void print_message_as_string_to_file(FILE *out, value_format_t *fmt)
 {
     if (fmt->data_size == 0)    // Print the entire message?
     {
-        fprintf(out, fmt->fmt_string, g_msg.assembled_msg);
+        msg_printf(out, fmt->fmt_string, g_ctx->assembled_msg);
     }
     else
     {
         prepare_value(fmt, true);
-        fprintf(out, fmt->fmt_string, (const char *)&g_msg.value.data_u64);
+        msg_printf(out, fmt->fmt_string, (const char *)&g_ctx->value.data_u64);
     }
 
     if (fmt->print_copy_to_main_log)
     {
         if (fmt->data_size == 0)    // Print the entire message?
         {
-            fprintf(g_msg.file.main_log, fmt->fmt_string, g_msg.assembled_msg);
+            msg_printf(g_ctx->main_log, fmt->fmt_string, g_ctx->assembled_msg);
         }
         else
         {
-            fprintf(g_msg.file.main_log, fmt->fmt_string, (const char *)&g_msg.value.data_u64);
+            msg_printf(g_ctx->main_log, fmt->fmt_string, (const char *)&g_ctx->value.data_u64);
         }
     }
 }
@@ -1193,17 +1200,17 @@ static void print_message_as_string_to_file(FILE *out, value_format_t *fmt)
 static void print_binary_value_to_file(FILE *out, value_format_t *fmt)
 {
     prepare_value(fmt, false);
-    fprintf(out, fmt->fmt_string);
-    g_msg.value.data_double = (double)g_msg.value.data_u64;
+    msg_printf(out, fmt->fmt_string);
+    g_ctx->value.data_double = (double)g_ctx->value.data_u64;
 
     if (fmt->data_type == VALUE_UINT64)
     {
-        print_binary64(out, g_msg.value.data_u64, fmt->data_size);
+        print_binary64(out, g_ctx->value.data_u64, fmt->data_size);
 
         if (fmt->print_copy_to_main_log)
         {
-            fprintf(g_msg.file.main_log, fmt->fmt_string);
-            print_binary64(g_msg.file.main_log, g_msg.value.data_u64, fmt->data_size);
+            msg_printf(g_ctx->main_log, fmt->fmt_string);
+            print_binary64(g_ctx->main_log, g_ctx->value.data_u64, fmt->data_size);
         }
     }
     else
@@ -1249,7 +1256,8 @@ static bool statistics_possible_for_the_value(enum fmt_type_t value_type)
 static void process_statistics_for_the_current_value(msg_data_t *p_fmt, value_format_t *fmt)
 {
     // Verify if statistics are enabled and applicable for the current value.
-    if ((fmt->value_stat != NULL) && (g_msg.param.value_statistics_enabled))
+    // The elements of array values are added to the statistics by print_array_value().
+    if ((fmt->value_stat != NULL) && (g_msg.param.value_statistics_enabled) && (fmt->array_count == 0))
     {
         // For timers, check if previous data is available (previous message exists)
         if (fmt->data_type == VALUE_dTIMESTAMP)
@@ -1273,9 +1281,13 @@ static void process_statistics_for_the_current_value(msg_data_t *p_fmt, value_fo
         }
 
         // Execute statistics if the value type supports it.
+        // Messages with value statistics are printed by the decoding thread (see parallel_decode.c).
+        // The value is added to the statistics by the side channel thread (see side_channel.c).
         if (statistics_possible_for_the_value(fmt->fmt_type))
         {
-            value_statistic(p_fmt, fmt);
+            uint64_t start = profile_start();
+            side_channel_value(fmt->value_stat, g_ctx->value.data_double, g_msg.message_cnt);
+            profile_stop(PROFILE_VALUE_STATISTICS, start);
         }
     }
 }
@@ -1301,7 +1313,7 @@ static msg_data_t *check_and_get_print_info(uint32_t current_fmt_id)
     // Validate format ID range.
     if (current_fmt_id >= MAX_FMT_IDS)
     {
-        fprintf(g_msg.file.main_log, "???");
+        msg_printf(g_ctx->main_log, "???");
         save_internal_decoding_error(INT_FMT_ID_OUT_OF_RANGE, current_fmt_id);
         return NULL;
     }
@@ -1331,7 +1343,7 @@ static msg_data_t *check_and_get_print_info(uint32_t current_fmt_id)
 static FILE *get_out_file(value_format_t *fmt)
 {
     unsigned out_file = fmt->out_file;
-    FILE *out = g_msg.file.main_log;    // Default output file = Main.log
+    FILE *out = g_ctx->main_log;    // Default output file = Main.log
 
     // Validate output file index.
     if ((out_file >= NUMBER_OF_FILTER_BITS) && (out_file < MAX_ENUMS))
@@ -1391,11 +1403,11 @@ static void check_extended_data(enum msg_type_t msg_type)
 static void print_uint(FILE *out, value_format_t *fmt)
 {
     prepare_value(fmt, false);
-    fprintf(out, fmt->fmt_string, g_msg.value.data_u64);
+    msg_printf(out, fmt->fmt_string, g_ctx->value.data_u64);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string, g_msg.value.data_u64);
+        msg_printf(g_ctx->main_log, fmt->fmt_string, g_ctx->value.data_u64);
     }
 }
 
@@ -1410,11 +1422,11 @@ static void print_uint(FILE *out, value_format_t *fmt)
 static void print_int(FILE *out, value_format_t *fmt)
 {
     prepare_value(fmt, false);
-    fprintf(out, fmt->fmt_string, g_msg.value.data_i64);
+    msg_printf(out, fmt->fmt_string, g_ctx->value.data_i64);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string, g_msg.value.data_i64);
+        msg_printf(g_ctx->main_log, fmt->fmt_string, g_ctx->value.data_i64);
     }
 }
 
@@ -1429,122 +1441,1040 @@ static void print_int(FILE *out, value_format_t *fmt)
 static void print_double(FILE *out, value_format_t *fmt)
 {
     prepare_value(fmt, false);
-    fprintf(out, fmt->fmt_string, g_msg.value.data_double);
+    msg_printf(out, fmt->fmt_string, g_ctx->value.data_double);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string, g_msg.value.data_double);
+        msg_printf(g_ctx->main_log, fmt->fmt_string, g_ctx->value.data_double);
     }
 }
 
 
 /**
- * @brief Prints plain text to the specified file.
+ * @brief Writes the value formatted without the fprintf() to the specified file
+ *        (and to the Main.log file if required).
  *
  * @param out   Pointer to the output file.
  * @param fmt   Pointer to the current value parameters.
+ * @param text  Formatted value.
+ * @param len   Length of the formatted value.
  */
 
-static void print_plain_text(FILE *out, value_format_t *fmt)
+static void write_fast_value(FILE *out, value_format_t *fmt, const char *text, size_t len)
 {
-    fprintf(out, fmt->fmt_string);
+    write_fast_formatted_value(out, fmt->fast_fmt, text, len);
 
     if (fmt->print_copy_to_main_log)
     {
-        fprintf(g_msg.file.main_log, fmt->fmt_string);
+        write_fast_formatted_value(g_ctx->main_log, fmt->fast_fmt, text, len);
     }
 }
 
 
 /**
- * @brief Processes a single format structure and prints the corresponding value.
+ * @brief Prints an unsigned integer value to the specified file without the fprintf().
  *
- * @param out    Pointer to the output file.
- * @param p_fmt  Pointer to the current message parameters.
- * @param fmt    Pointer to the current value parameters.
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
  */
 
-static void print_single_value(FILE *out, msg_data_t *p_fmt, value_format_t *fmt)
+static void print_uint_fast(FILE *out, value_format_t *fmt)
 {
-    // Determine the appropriate print function based on the format type
-    switch (fmt->fmt_type)
-    {
-        case PRINT_PLAIN_TEXT:      // No format specifier in the string
-            print_plain_text(out, fmt);
-            break;
+    char text[FAST_FORMAT_BUFFER_SIZE];
+    prepare_value(fmt, false);
+    size_t len = fast_format_integer(text, fmt->fast_fmt, g_ctx->value.data_u64);
+    write_fast_value(out, fmt, text, len);
+}
 
-        case PRINT_STRING:          // "%s"
-            print_message_as_string_to_file(out, fmt);
-            break;
 
-        case PRINT_SELECTED_TEXT:   // "%Y"
-            print_selected_text(out, fmt);
-            break;
+/**
+ * @brief Prints a signed integer value to the specified file without the fprintf().
+ *
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
+ */
 
-        case PRINT_UINT64:          // "%c", "%u", "%x", "%o", "%X", "%lu", "%lx", "%lX", "%lo", etc.
-            print_uint(out, fmt);
-            break;
+static void print_int_fast(FILE *out, value_format_t *fmt)
+{
+    char text[FAST_FORMAT_BUFFER_SIZE];
+    prepare_value(fmt, false);
+    size_t len = fast_format_integer(text, fmt->fast_fmt, (uint64_t)g_ctx->value.data_i64);
+    write_fast_value(out, fmt, text, len);
+}
 
-        case PRINT_INT64:           // "%d", "%i", "%ld", "%li", etc.
-            print_int(out, fmt);
-            break;
 
-        case PRINT_DOUBLE:          // "%f", "%F", "%e", "%E", "%g", "%G", "%a", "%A"
-            print_double(out, fmt);
-            break;
+/**
+ * @brief Prints a double value to the specified file without the fprintf().
+ *        The fprintf() is used for the values which cannot be formatted by the
+ *        fast_format_double() (inf, nan, very large or very small values).
+ *
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
+ */
 
-        case PRINT_BINARY:          // "%b", "%B"
-            print_binary_value_to_file(out, fmt);
-            break;
+static void print_double_fast(FILE *out, value_format_t *fmt)
+{
+    char text[FAST_FORMAT_BUFFER_SIZE];
+    prepare_value(fmt, false);
+    size_t len = fast_format_double(text, fmt->fast_fmt, g_ctx->value.data_double);
 
-        case PRINT_TIMESTAMP:       // "%t"
-            print_timestamp_to_file(out, fmt);
-            break;
+    if (len == 0)
+    {
+        msg_printf(out, fmt->fmt_string, g_ctx->value.data_double);
 
-        case PRINT_dTIMESTAMP:      // "%T"
-            print_dTimeStamp_to_file(out, p_fmt, fmt);
-            break;
+        if (fmt->print_copy_to_main_log)
+        {
+            msg_printf(g_ctx->main_log, fmt->fmt_string, g_ctx->value.data_double);
+        }
 
-        case PRINT_MSG_NO:          // "%N"
-            print_current_message_number(out, fmt);
-            break;
+        return;
+    }
 
-        case PRINT_MSG_FMT_ID_NAME: // "%M"
-            print_current_message_name(out, fmt);
-            break;
+    write_fast_value(out, fmt, text, len);
+}
 
-        case PRINT_HEX1U:           // "%1H"
-        case PRINT_HEX2U:           // "%2H"
-        case PRINT_HEX4U:           // "%4H"
-            hex_dump_complete_message_to_file(out, fmt);
+
+/**
+ * @brief Converts a block of array value [nn:mmF*K] elements to double values.
+ *        The byte aligned elements are converted with the vector instructions (if
+ *        available) and the remaining ones one by one.
+ *
+ * @param fmt      Pointer to the current value parameters.
+ * @param address  Bit address of the first element of the block.
+ * @param count    Number of elements in the block.
+ * @param values   Output: converted values.
+ */
+
+static void convert_array_block(const value_format_t *fmt, uint32_t address, uint32_t count,
+    double *values)
+{
+    const uint8_t *message = (const uint8_t *)g_ctx->assembled_msg;
+    uint32_t size = fmt->data_size;
+    unsigned shift = 64u - size;
+    char type = (fmt->data_type == VALUE_DOUBLE) ? 'f' : ((fmt->data_type == VALUE_INT64) ? 'i' : 'u');
+    uint32_t i = 0;
+
+    if ((address & 7u) == 0)
+    {
+        i = convert_array_elements(&message[address >> 3u], size, type, count, values);
+    }
+
+    for ( ; i < count; i++)
+    {
+        uint64_t value = extract_bit_field(message, address + (i * size), size);
+
+        if (type == 'i')
+        {
+            values[i] = (double)((int64_t)value >> shift);
+        }
+        else if (type == 'u')
+        {
+            values[i] = (double)(value >> shift);
+        }
+        else if (size == 16u)
+        {
+            values[i] = (double)convert_half_float_to_float((uint16_t)(value >> shift));
+        }
+        else if (size == 32u)
+        {
+            val_convert32_t convert_value32;
+            convert_value32.data_u = (uint32_t)(value >> shift);
+            values[i] = (double)convert_value32.data_f;
+        }
+        else
+        {
+            val_convert64_t convert_value64;
+            convert_value64.data_u = value;
+            values[i] = convert_value64.data_f;
+        }
+    }
+}
+
+
+/**
+ * @brief Formats a double array element with the fprintf() format specification of the
+ *        value. Used for the values which cannot be formatted by the fast_format_double()
+ *        (inf, nan, very large or very small values).
+ *
+ * @param buffer  Buffer for the formatted element (ARRAY_ELEMENT_MAX_LENGTH bytes).
+ * @param fmt     Pointer to the current value parameters.
+ * @param value   Value to be formatted.
+ *
+ * @return Length of the formatted element.
+ */
+
+static size_t format_array_element_with_snprintf(char *buffer, const value_format_t *fmt, double value)
+{
+    const char *spec = fmt->fmt_string;
+
+    // Skip the text before the value specification (the format was checked by prepare_fast_format())
+    for ( ; (*spec != '%') || (spec[1] == '%'); spec++)
+    {
+        if (*spec == '%')
+        {
+            spec++;
+        }
+    }
+
+    char spec_only[64];
+    size_t spec_length = strlen(spec) - fmt->fast_fmt->suffix_len;
+    snprintf(spec_only, sizeof(spec_only), "%.*s", (int)spec_length, spec);
+    int length = snprintf(buffer, ARRAY_ELEMENT_MAX_LENGTH, spec_only, value);
+
+    if (length < 0)
+    {
+        return 0;
+    }
+
+    return ((size_t)length < ARRAY_ELEMENT_MAX_LENGTH) ? (size_t)length : (ARRAY_ELEMENT_MAX_LENGTH - 1u);
+}
+
+
+/**
+ * @brief Formats a single element of an array value. The integer values are prepared
+ *        the same way as for a single value (see prepare_value() and value_scaling()).
+ *
+ * @param buffer     Buffer for the formatted element (ARRAY_ELEMENT_MAX_LENGTH bytes).
+ * @param fmt        Pointer to the current value parameters.
+ * @param value      Converted (and scaled) value of the element.
+ * @param address    Bit address of the element.
+ * @param raw_value  true - the integer must be extracted again (not exact as a double value)
+ *
+ * @return Length of the formatted element.
+ */
+
+static size_t format_array_element(char *buffer, const value_format_t *fmt, double value,
+    uint32_t address, bool raw_value)
+{
+    if (fmt->fmt_type == PRINT_DOUBLE)
+    {
+        size_t length = fast_format_double(buffer, fmt->fast_fmt, value);
+
+        if (length == 0)
+        {
+            length = format_array_element_with_snprintf(buffer, fmt, value);
+        }
+
+        return length;
+    }
+
+    bool is_signed = (fmt->fmt_type == PRINT_INT64);
+    uint64_t integer = 0;           // Unscaled float values are printed as 0 (as the single values)
+
+    if (fmt->mult != 0)
+    {
+        integer = is_signed ? (uint64_t)(int64_t)(value + 0.5) : (uint64_t)(value + 0.5);
+    }
+    else if (raw_value)
+    {
+        uint64_t data = extract_bit_field((const uint8_t *)g_ctx->assembled_msg, address, fmt->data_size);
+        unsigned shift = 64u - fmt->data_size;
+        integer = is_signed ? (uint64_t)((int64_t)data >> shift) : (data >> shift);
+    }
+    else if (fmt->data_type != VALUE_DOUBLE)
+    {
+        integer = is_signed ? (uint64_t)(int64_t)value : (uint64_t)value;
+    }
+
+    return fast_format_integer(buffer, fmt->fast_fmt, integer);
+}
+
+
+/**
+ * @brief Writes the formatted array elements to the specified file (and to the Main.log
+ *        file if required).
+ *
+ * @param out     Pointer to the output file.
+ * @param fmt     Pointer to the current value parameters.
+ * @param text    Formatted elements.
+ * @param length  Length of the text.
+ */
+
+static void write_array_text(FILE *out, value_format_t *fmt, const char *text, size_t length)
+{
+    msg_write(out, text, length);
+
+    if (fmt->print_copy_to_main_log)
+    {
+        msg_write(g_ctx->main_log, text, length);
+    }
+}
+
+
+/**
+ * @brief Prints an array value [nn:mmF*K] to the specified file. The elements are converted
+ *        and scaled in blocks of ARRAY_DECODE_BLOCK values (see array_decode.h), formatted
+ *        without the fprintf() and printed separated by a space. The text of the format
+ *        before and after the value is printed once. The elements are added to the value
+ *        statistics (if defined) one block at a time.
+ *
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
+ */
+
+static void print_array_value(FILE *out, value_format_t *fmt)
+{
+    uint32_t size = fmt->data_size;
+    uint32_t count = fmt->array_count;
+    unsigned end_address = fmt->bit_address + (size * count);
+
+    if ((fmt->extraction == EXTRACT_CHECKED) && (end_address > (g_ctx->asm_size * 8u)))
+    {
+        save_decoding_error(ERR_DECODE_VALUE_NOT_IN_MESSAGE, end_address,
+            g_ctx->asm_size * 8u, fmt->fmt_string);
+        return;
+    }
+
+    if ((fmt->data_type == VALUE_INT64) && (size < 2))
+    {
+        save_decoding_error(ERR_DECODE_TOO_SMALL_INT_DATA_SIZE, size, 1u, fmt->fmt_string);
+        return;
+    }
+
+    // The integers are exact as double values if the type matches the printing and size <= 53 bits
+    bool raw_value = (size > 53u)
+        || ((fmt->fmt_type == PRINT_INT64) && (fmt->data_type != VALUE_INT64))
+        || ((fmt->fmt_type == PRINT_UINT64) && (fmt->data_type != VALUE_UINT64));
+    bool statistics = (fmt->value_stat != NULL) && g_msg.param.value_statistics_enabled;
+    double values[ARRAY_DECODE_BLOCK];
+    char text[ARRAY_TEXT_BUFFER_SIZE];
+    size_t length = 0;
+
+    write_array_text(out, fmt, fmt->fast_fmt->prefix, fmt->fast_fmt->prefix_len);
+
+    for (uint32_t first = 0; first < count; first += ARRAY_DECODE_BLOCK)
+    {
+        uint32_t block = ((count - first) < ARRAY_DECODE_BLOCK) ? (count - first) : ARRAY_DECODE_BLOCK;
+        uint32_t address = fmt->bit_address + (first * size);
+        convert_array_block(fmt, address, block, values);
+
+        if (fmt->mult != 0)
+        {
+            scale_array_elements(values, block, fmt->offset, fmt->mult);
+        }
+
+        for (uint32_t i = 0; i < block; i++)
+        {
+            if ((length + 1u + ARRAY_ELEMENT_MAX_LENGTH) > sizeof(text))
+            {
+                write_array_text(out, fmt, text, length);
+                length = 0;
+            }
+
+            if ((first + i) > 0)
+            {
+                text[length++] = ' ';
+            }
+
+            length += format_array_element(&text[length], fmt, values[i], address + (i * size), raw_value);
+        }
+
+        if (statistics)
+        {
+            uint64_t start = profile_start();
+            side_channel_values(fmt->value_stat, values, block, g_msg.message_cnt);
+            profile_stop(PROFILE_VALUE_STATISTICS, start);
+        }
+
+        g_ctx->value.data_double = values[block - 1u];
+    }
+
+    write_array_text(out, fmt, text, length);
+    write_array_text(out, fmt, fmt->fast_fmt->suffix, fmt->fast_fmt->suffix_len);
+}
+
+
+/**
+ * @brief Prints plain text to the specified file.
+ *
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
+ */
+
+static void print_plain_text(FILE *out, value_format_t *fmt)
+{
+    msg_printf(out, fmt->fmt_string);
+
+    if (fmt->print_copy_to_main_log)
+    {
+        msg_printf(g_ctx->main_log, fmt->fmt_string);
+    }
+}
+
+
+/**
+ * @brief Prints plain text prepared by prepare_plain_text_format() to the specified file.
+ *
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
+ */
+
+static void print_plain_text_fast(FILE *out, value_format_t *fmt)
+{
+    msg_write(out, fmt->fast_fmt->prefix, fmt->fast_fmt->prefix_len);
+
+    if (fmt->print_copy_to_main_log)
+    {
+        msg_write(g_ctx->main_log, fmt->fast_fmt->prefix, fmt->fast_fmt->prefix_len);
+    }
+}
+
+
+/**
+ * @brief Reports an unknown format type (internal error).
+ *
+ * @param out   Pointer to the output file.
+ * @param fmt   Pointer to the current value parameters.
+ */
+
+static void print_unknown_type(FILE *out, value_format_t *fmt)
+{
+    (void)out;
+    save_internal_decoding_error(INT_DECODE_INTERNAL_UNKNOWN_TYPE, fmt->fmt_type);
+}
+
+
+/**
+ * @brief Selects the print function for a single format structure.
+ *        The values with the format prepared by prepare_fast_format() and the plain
+ *        text prepared by prepare_plain_text_format() are printed without the fprintf().
+ *
+ * @param fmt   Pointer to the value formatting definition.
+ *
+ * @return Pointer to the function which prints the value.
+ */
+
+static print_value_t select_print_function(const value_format_t *fmt)
+{
+    if (fmt->array_count > 0)       // "[nn:mmF*K]" (the format was checked by check_array_value())
+    {
+        return print_array_value;
+    }
+
+    // Determine the appropriate print function based on the format type
+    switch (fmt->fmt_type)
+    {
+        case PRINT_PLAIN_TEXT:      // No format specifier in the string
+            return (fmt->fast_fmt != NULL) ? print_plain_text_fast : print_plain_text;
+
+        case PRINT_STRING:          // "%s"
+            return print_message_as_string_to_file;
+
+        case PRINT_SELECTED_TEXT:   // "%Y"
+            return print_selected_text;
+
+        case PRINT_UINT64:          // "%c", "%u", "%x", "%o", "%X", "%lu", "%lx", "%lX", "%lo", etc.
+            return (fmt->fast_fmt != NULL) ? print_uint_fast : print_uint;
+
+        case PRINT_INT64:           // "%d", "%i", "%ld", "%li", etc.
+            return (fmt->fast_fmt != NULL) ? print_int_fast : print_int;
+
+        case PRINT_DOUBLE:          // "%f", "%F", "%e", "%E", "%g", "%G", "%a", "%A"
+            return (fmt->fast_fmt != NULL) ? print_double_fast : print_double;
+
+        case PRINT_BINARY:          // "%b", "%B"
+            return print_binary_value_to_file;
+
+        case PRINT_TIMESTAMP:       // "%t"
+            return print_timestamp_to_file;
+
+        case PRINT_dTIMESTAMP:      // "%T"
+            return print_dTimeStamp_to_file;
+
+        case PRINT_MSG_NO:          // "%N"
+            return print_current_message_number;
+
+        case PRINT_MSG_FMT_ID_NAME: // "%M"
+            return print_current_message_name;
+
+        case PRINT_HEX1U:           // "%1H"
+        case PRINT_HEX2U:           // "%2H"
+        case PRINT_HEX4U:           // "%4H"
+            return hex_dump_complete_message_to_file;
+
+        case PRINT_BIN_TO_FILE:     // "%W"
+            return write_binary_message_data_to_file;
+
+        case PRINT_DATE:            // "%D"
+            return print_date_to_file;
+
+        default:
+            return print_unknown_type;
+    }
+}
+
+
+/**
+ * @brief Pre-resolves the output file of a value.
+ *        Main.log is selected during the printing since the parallel printing
+ *        workers print it to their own buffers.
+ *
+ * @param op    Pointer to the decode operation.
+ */
+
+static void resolve_out_file(decode_op_t *op)
+{
+    unsigned out_file = op->fmt.out_file;
+    op->out = NULL;
+    op->check_out_file = false;
+    op->decimated = false;
+
+    if (out_file == 0)
+    {
+        return;                 // Print to Main.log
+    }
+
+    if ((out_file >= NUMBER_OF_FILTER_BITS) && (out_file < MAX_ENUMS)
+        && (g_msg.enums[out_file].type == OUT_FILE_TYPE) && (g_msg.enums[out_file].u.p_file != NULL))
+    {
+        op->out = g_msg.enums[out_file].u.p_file;
+        op->decimated = out_file_is_decimated(out_file);
+    }
+    else
+    {
+        op->check_out_file = true;  // The problem is reported by get_out_file() for every message
+    }
+}
+
+
+/**
+ * @brief Selects the value extraction method. The checks of the value size and address
+ *        are done here if the message length is known at compile time. The message size
+ *        is checked against msg_len by process_message() before the message is printed.
+ *
+ * @param fmt      Pointer to the value parameters.
+ * @param msg_len  Message length [bytes] (0 - unknown at compile time).
+ */
+
+static void select_value_extraction(value_format_t *fmt, uint32_t msg_len)
+{
+    uint32_t size = fmt->data_size;
+    uint32_t address = fmt->bit_address;
+    fmt->extraction = EXTRACT_CHECKED;
+
+    if ((msg_len == 0) || (size == 0) || (size > 64u)
+        || (((fmt->array_count > 0) ? (size * fmt->array_count) : size) + address) > (msg_len * 8u))
+    {
+        return;
+    }
+
+    fmt->extraction = EXTRACT_IN_MESSAGE;
+}
+
+
+/**
+ * @brief Marks the messages matching one name from the -select=... list as selected.
+ *        A name ending with the '*' character selects all messages beginning with the name.
+ *
+ * @param name    Name from the list (not zero terminated).
+ * @param length  Length of the name.
+ *
+ * @return  true if at least one message matches the name.
+ */
+
+static bool select_messages_by_name(const char *name, size_t length)
+{
+    bool prefix = (length > 0) && (name[length - 1u] == '*');
+    size_t compare_length = prefix ? (length - 1u) : length;
+    bool found = false;
+
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        msg_data_t *p_fmt = g_fmt[fmt_id];
+
+        if ((p_fmt == NULL) || (p_fmt->message_name == NULL))
+        {
+            continue;
+        }
+
+        if ((strncmp(p_fmt->message_name, name, compare_length) == 0)
+            && (prefix || (p_fmt->message_name[compare_length] == '\0')))
+        {
+            p_fmt->not_selected = false;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+
+/**
+ * @brief Prepares the message selection defined with the -select=NAME1,NAME2,... argument.
+ *        The messages not selected are only framed and counted, but not decoded.
+ *        A fatal error is reported if a name does not match any message.
+ */
+
+static void prepare_message_selection(void)
+{
+    const char *names = g_msg.param.select_names;
+
+    if (names == NULL)
+    {
+        return;
+    }
+
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        if (g_fmt[fmt_id] != NULL)
+        {
+            g_fmt[fmt_id]->not_selected = true;
+        }
+    }
+
+    for (;;)
+    {
+        const char *separator = strchr(names, ',');
+        size_t length = (separator != NULL) ? (size_t)(separator - names) : strlen(names);
+
+        if (!select_messages_by_name(names, length))
+        {
+            char name[MAX_NAME_LENGTH];
+            snprintf(name, sizeof(name), "%.*s", (int)length, names);
+            report_fatal_error_and_exit(FATAL_BAD_SELECT_PARAMETER_VALUE, name, 0);
+        }
+
+        if (separator == NULL)
+        {
             break;
+        }
 
-        case PRINT_BIN_TO_FILE:     // "%W"
-            write_binary_message_data_to_file(out, fmt);
+        names = separator + 1;
+    }
+}
+
+
+/**
+ * @brief Prepares the decode plan for every message type after the format definition
+ *        files have been parsed and the OUT_FILE() files opened. The linked list of
+ *        value definitions is converted to a contiguous array of decode operations
+ *        with pre-selected print functions, output files and value extraction methods.
+ */
+
+void compile_decode_plans(void)
+{
+    init_fast_formatting();         // The message printing locale is already selected
+    prepare_message_line_formats();
+    prepare_selected_texts();
+    prepare_message_selection();
+
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        msg_data_t *p_fmt = g_fmt[fmt_id];
+
+        if ((p_fmt == NULL) || (p_fmt->format == NULL))
+        {
+            continue;
+        }
+
+        // Several format IDs share the same definitions (i.e. MSG1 .. MSGn, EXT_MSG).
+        // The plans compiled for the previous binary data file (-batch) get the newly created OUT_FILE() files.
+        if (p_fmt->plan != NULL)
+        {
+            for (uint32_t i = 0; i < p_fmt->plan_size; i++)
+            {
+                resolve_out_file(&p_fmt->plan[i]);
+            }
+
+            continue;
+        }
+
+        uint32_t plan_size = 0;
+
+        for (value_format_t *fmt = p_fmt->format; fmt != NULL; fmt = fmt->format)
+        {
+            plan_size++;
+        }
+
+        decode_op_t *op = (decode_op_t *)allocate_parse_memory(plan_size * sizeof(decode_op_t), "decPlan");
+        p_fmt->plan = op;
+        p_fmt->plan_size = plan_size;
+
+        for (value_format_t *fmt = p_fmt->format; fmt != NULL; fmt = fmt->format)
+        {
+            op->fmt = *fmt;
+            op->fmt.format = NULL;      // The plan is used instead of the linked list
+            select_value_extraction(&op->fmt, p_fmt->msg_len);
+            op->print = select_print_function(fmt);
+            resolve_out_file(op);
+            op++;
+        }
+    }
+
+    prepare_message_query();        // The conditions refer to the values in the decode plans
+}
+
+
+/**
+ * @brief Copies the data of the message prepared by the sequential decoding to the
+ *        printing context of the main thread.
+ */
+
+static void prepare_message_context(void)
+{
+    g_ctx->main_log = g_msg.file.main_log;
+    g_ctx->assembled_msg = g_msg.assembled_msg;
+    g_ctx->asm_size = g_msg.asm_size;
+    g_ctx->fmt_id = g_msg.fmt_id;
+    g_ctx->message_cnt = g_msg.message_cnt;
+    g_ctx->timestamp = g_msg.timestamp.f;
+    g_ctx->mark_problematic_tstamp = false;
+    g_ctx->error_value_no = 0;              // Counter of processed values for the same message
+    g_ctx->msg_error_counter = 0;
+    g_ctx->msg_errors_shown = 0;
+}
+
+
+/**
+ * @brief Prints the message from the current printing context (g_ctx) to its Main.log output.
+ *        The function modifies only the printing context and can therefore be executed by the
+ *        parallel printing workers for the messages that do not use MEMO values, OUT_FILE()
+ *        files, statistics and timing values depending on other messages.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ */
+
+void print_message_text(msg_data_t *p_fmt)
+{
+    uint64_t message_start = print_profile_start();
+
+    // The message text is collected and written to the Main.log with a single fwrite()
+    start_message_line(g_ctx->main_log);
+
+    // Print the message information for the Main.log file (mandatory data)
+    // Flag the message number with a '#' symbol if the timestamp is flagged as suspicious
+    msg_write(g_ctx->main_log, "\n#", g_ctx->mark_problematic_tstamp ? 2u : 1u);
+    print_message_number(g_ctx->main_log, g_ctx->message_cnt);
+    msg_write(g_ctx->main_log, " ", 1);
+    print_timestamp(g_ctx->main_log, g_ctx->timestamp);
+    msg_write(g_ctx->main_log, " ", 1);
+    const char *name = get_format_id_name(g_ctx->fmt_id);
+    msg_write(g_ctx->main_log, name, strlen(name));
+    msg_write(g_ctx->main_log, ": ", 2);
+
+    decode_op_t *op = p_fmt->plan;
+    decode_op_t *plan_end = op + p_fmt->plan_size;
+
+    if (g_msg.param.column_export)
+    {
+        start_column_row(p_fmt);
+    }
+
+    for ( ; op < plan_end; op++)
+    {
+        // Reset the value structure to ensure no residual data is present
+        memset(&g_ctx->value, 0, sizeof(g_ctx->value));
+        FILE *out = op->out;            // The file to which the data will be printed
+
+        if (out == NULL)
+        {
+            out = op->check_out_file ? get_out_file(&op->fmt) : g_ctx->main_log;
+        }
+
+        if (op->fmt.fmt_type != PRINT_PLAIN_TEXT)
+        {
+            g_ctx->error_value_no++;
+        }
+
+        uint64_t value_start = print_profile_start();
+
+        if (op->decimated)
+        {
+            // The text is written, collected as a min/max candidate or not formatted at all
+            select_decimated_output(op, plan_end);
+            op->print(out, &op->fmt);
+            capture_file_output(NULL, NULL);
+        }
+        else
+        {
+            op->print(out, &op->fmt);
+        }
+
+        process_statistics_for_the_current_value(p_fmt, &op->fmt);
+
+        if (p_fmt->columns != NULL)
+        {
+            save_column_value(p_fmt, op);
+        }
+        profile_value_printed(op->fmt.fmt_type, value_start);
+    }
+
+    if (p_fmt->columns != NULL)
+    {
+        finish_column_row(p_fmt);
+    }
+
+    flush_message_line();
+    print_decoding_errors();    // Print error information detected during decoding (if any)
+    profile_message_printed(g_ctx->fmt_id, message_start);
+}
+
+
+/**
+ * @brief Exports the values of the current message to its column file without printing the
+ *        message text (-columns=only). The values are prepared the same way as for a message
+ *        callback - the printf formatting of the Main.log and OUT_FILE() texts is skipped.
+ *        The MEMO values, value statistics and decoding errors are processed as during the printing.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ */
+
+static void export_message_columns(msg_data_t *p_fmt)
+{
+    uint64_t message_start = print_profile_start();
+    decode_op_t *op = p_fmt->plan;
+    decode_op_t *plan_end = op + p_fmt->plan_size;
+    start_column_row(p_fmt);
+
+    for ( ; op < plan_end; op++)
+    {
+        const char *text;
+        size_t length;
+
+        // Reset the value structure to ensure no residual data is present
+        memset(&g_ctx->value, 0, sizeof(g_ctx->value));
+
+        if (op->fmt.fmt_type != PRINT_PLAIN_TEXT)
+        {
+            g_ctx->error_value_no++;
+        }
+
+        if (prepare_value_for_callback(&op->fmt, &text, &length))
+        {
+            process_statistics_for_the_current_value(p_fmt, &op->fmt);
+            save_column_value(p_fmt, op);
+        }
+    }
+
+    finish_column_row(p_fmt);
+    print_decoding_errors();    // Print error information detected during decoding (if any)
+    profile_message_printed(g_ctx->fmt_id, message_start);
+}
+
+
+/**
+ * @brief Prepares the value of a decode plan operation in g_ctx->value without printing it.
+ *        Used instead of the printing if the decoded messages are passed to a message
+ *        callback (see rtemsg_api.c). The MEMO values are saved as during the printing.
+ *
+ * @param fmt     Pointer to the current value parameters.
+ * @param text    Output: text of the %s and %Y values (NULL - numeric value).
+ * @param length  Output: length of the text (the text is not necessarily zero terminated).
+ *
+ * @return  false - the operation does not contain a value (plain text, hex dump, date, ...).
+ */
+
+bool prepare_value_for_callback(value_format_t *fmt, const char **text, size_t *length)
+{
+    msg_data_t *p_fmt = g_fmt[g_ctx->fmt_id];   // The format ID was checked by check_and_get_print_info()
+    *text = NULL;
+    *length = 0;
+
+    if (fmt->array_count > 0)
+    {
+        return false;               // The array values are not passed to the callback
+    }
+
+    switch (fmt->fmt_type)
+    {
+        case PRINT_UINT64:
+        case PRINT_INT64:
+        case PRINT_DOUBLE:
+            prepare_value(fmt, false);
+            return true;
+
+        case PRINT_BINARY:
+            prepare_value(fmt, false);
+            g_ctx->value.data_double = (double)g_ctx->value.data_u64;
+            return true;
+
+        case PRINT_STRING:
+            if (fmt->data_size == 0)    // The entire message?
+            {
+                *text = (const char *)g_ctx->assembled_msg;
+                *length = strnlen(*text, g_ctx->asm_size);
+            }
+            else
+            {
+                prepare_value(fmt, true);
+                *text = (const char *)&g_ctx->value.data_u64;
+                *length = strnlen(*text, sizeof(g_ctx->value.data_u64));
+            }
+            return true;
+
+        case PRINT_SELECTED_TEXT:
+            prepare_value(fmt, false);
+            *text = get_selected_text(fmt->in_file, (unsigned)(g_ctx->value.data_u64), length);
+            return true;
+
+        case PRINT_TIMESTAMP:
+            g_ctx->value.data_double = g_ctx->timestamp;
             break;
 
-        case PRINT_DATE:            // "%D"
-            print_date_to_file(out, fmt);
+        case PRINT_dTIMESTAMP:
+            if (p_fmt->counter > 0)
+            {
+                g_ctx->value.data_double = g_ctx->timestamp - p_fmt->time_last_message;
+            }
+            break;
+
+        case PRINT_MSG_NO:
+            g_ctx->value.data_u64 = g_ctx->message_cnt;
+            g_ctx->value.data_i64 = (int64_t)g_ctx->message_cnt;
+            g_ctx->value.data_double = (double)g_ctx->message_cnt;
             break;
 
         default:
-            // Unknown format type
-            save_internal_decoding_error(INT_DECODE_INTERNAL_UNKNOWN_TYPE, fmt->fmt_type);
+            return false;
+    }
+
+    // Save the value to memory if a memo is defined for this value.
+    rte_enum_t memo = fmt->put_memo;
+
+    if (memo != 0)
+    {
+        save_to_memo(memo);
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Prepares a numeric value of the current message in g_ctx->value.data_double without
+ *        printing it (see query.c). Unlike the prepare_value(), no decoding errors are reported
+ *        and no MEMO values are saved - the value is prepared again if the message is printed.
+ *
+ * @param fmt  Pointer to the value parameters of an operation in the decode plan.
+ *
+ * @return  false - the value cannot be prepared without a decoding error or is not available
+ */
+
+bool prepare_query_value(value_format_t *fmt)
+{
+    if (!statistics_possible_for_the_value(fmt->fmt_type) || (fmt->array_count > 0))
+    {
+        return false;
+    }
+
+    switch (fmt->data_type)
+    {
+        case VALUE_AUTO:
+            if (((fmt->bit_address % 32u) != 0) || (fmt->data_size != 32u) || (fmt->mult != 0)
+                || ((fmt->fmt_type != PRINT_DOUBLE) && (fmt->fmt_type != PRINT_INT64)
+                    && (fmt->fmt_type != PRINT_UINT64)))
+            {
+                return false;
+            }
+            break;
+
+        case VALUE_INT64:
+        case VALUE_UINT64:
+            if (fmt->data_size < ((fmt->data_type == VALUE_INT64) ? 2u : 1u))
+            {
+                return false;
+            }
+            break;
+
+        case VALUE_DOUBLE:
+            if ((fmt->data_size != 16u) && (fmt->data_size != 32u) && (fmt->data_size != 64u))
+            {
+                return false;
+            }
+            break;
+
+        case VALUE_dTIMESTAMP:
+            if (g_fmt[g_ctx->fmt_id]->counter == 0)
+            {
+                return false;       // No previous message for this message type
+            }
+            break;
+
+        case VALUE_TIME_DIFF:
+            if ((fmt->fmt_id_timer >= MAX_FMT_IDS) || (g_fmt[fmt->fmt_id_timer] == NULL)
+                || (g_fmt[fmt->fmt_id_timer]->counter == 0))
+            {
+                return false;
+            }
+            break;
+
+        case VALUE_TIMESTAMP:
+        case VALUE_MESSAGE_NO:
             break;
+
+        default:
+            return false;           // The MEMO values depend on the values printed before
+    }
+
+    if ((fmt->data_type == VALUE_AUTO) || (fmt->data_type == VALUE_INT64)
+        || (fmt->data_type == VALUE_UINT64) || (fmt->data_type == VALUE_DOUBLE))
+    {
+        if ((fmt->data_size > 64u) || ((fmt->bit_address + fmt->data_size) > (g_ctx->asm_size * 8u)))
+        {
+            return false;           // The value is not in the message
+        }
+    }
+
+    memset(&g_ctx->value, 0, sizeof(g_ctx->value));
+    (void)prepare_value_data(fmt);
+
+    if (fmt->fmt_type == PRINT_BINARY)
+    {
+        g_ctx->value.data_double = (double)g_ctx->value.data_u64;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief Checks if the current message has to be decoded and printed.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ *
+ * @return  false - the message is not selected (-select=...) or is outside of the time window
+ *                  (-window=t1;t2) or message range (-range=N1;N2) or does not match the
+ *                  value conditions (-query=...)
+ */
+
+static bool is_message_decoded(const msg_data_t *p_fmt)
+{
+    if (p_fmt->not_selected)
+    {
+        return false;
+    }
+
+    if (g_msg.param.message_range
+        && ((g_ctx->message_cnt < g_msg.param.first_message) || (g_ctx->message_cnt > g_msg.param.last_message)))
+    {
+        return false;
+    }
+
+    if (g_msg.param.time_window
+        && !((g_ctx->timestamp >= g_msg.param.window_start) && (g_ctx->timestamp <= g_msg.param.window_end)))
+    {
+        return false;
+    }
+
+    if (g_msg.param.query != NULL)
+    {
+        return message_matches_query(p_fmt);
     }
+
+    return true;
 }
 
 
 /**
  * @brief Prints a message based on the format definition file(s).
  *        Ensure the message length matches the definition before invoking this function.
+ *        The message text is printed by a parallel printing worker if possible (see parallel_decode.c).
  */
 
 void print_message(void)
 {
-    g_msg.error_value_no = 0;               // Counter of processed values for the same message
-    g_msg.msg_error_counter = 0;
-    msg_data_t *p_fmt = check_and_get_print_info(g_msg.fmt_id);
+    prepare_message_context();
+    msg_data_t *p_fmt = check_and_get_print_info(g_ctx->fmt_id);
 
     if (p_fmt == NULL)
     {
@@ -1553,53 +2483,59 @@ void print_message(void)
 
     check_extended_data(p_fmt->msg_type);
 
-    // Print the message information for the Main.log file (mandatory data)
-    fprintf(g_msg.file.main_log, "\n");
-
-    // Flag the message number with a '#' symbol if the timestamp is flagged as suspicious
     if (g_msg.timestamp.mark_problematic_tstamps)
     {
-        fprintf(g_msg.file.main_log, "#");
+        g_ctx->mark_problematic_tstamp = true;
         g_msg.timestamp.mark_problematic_tstamps = false;
         g_msg.timestamp.suspicious_timestamp++;
     }
 
-    print_message_number(g_msg.file.main_log, g_msg.message_cnt);
-    fprintf(g_msg.file.main_log, " ");
-    print_timestamp(g_msg.file.main_log, g_msg.timestamp.f);
-    fprintf(g_msg.file.main_log, " %s: ", get_format_id_name(g_msg.fmt_id));
-
     timestamp_logging();
     g_msg.messages_processed_after_restart++;
-    value_format_t *fmt = p_fmt->format;
 
-    while (fmt != NULL)
+    // The messages not selected with -select=..., -window=t1;t2, -range=N1;N2 or -query=... are only counted.
+    // Their decoding errors cannot be detected and do not restart the timestamp search.
+    if (is_message_decoded(p_fmt) && !queue_message_for_parallel_printing(p_fmt))
     {
-        // Reset the value structure to ensure no residual data is present
-        memset(&g_msg.value, 0, sizeof(g_msg.value));
-        FILE *out = get_out_file(fmt);       // The file to which the data will be printed
-
-        if (fmt->fmt_type != PRINT_PLAIN_TEXT)
+        if (g_msg.message_callback != NULL)
+        {
+            g_msg.message_callback(p_fmt);  // Decoded values without the text formatting (see rtemsg_api.c)
+        }
+        else if (g_msg.param.columns_only)
+        {
+            export_message_columns(p_fmt);
+        }
+        else
         {
-            g_msg.error_value_no++;
+            print_message_text(p_fmt);
         }
 
-        print_single_value(out, p_fmt, fmt);
-        process_statistics_for_the_current_value(p_fmt, fmt);
-        fmt = fmt->format;      // Continue processing the next formatting definition
+        if (g_ctx->msg_error_counter > 0)
+        {
+            g_msg.timestamp.no_previous_tstamp = true;  // Restart log-timestamp search after an error is detected
+        }
+        else
+        {
+            // Messages with this size can be printed by the parallel printing workers (no decoding errors possible)
+            p_fmt->verified_size = g_ctx->asm_size;
+            p_fmt->size_verified = true;
+        }
     }
 
-    print_decoding_errors();    // Print error information detected during decoding (if any)
+    p_fmt->counter++;        // Increment message counter
+    uint32_t total_words = calculate_total_message_size(p_fmt);
 
-    if (g_msg.msg_error_counter > 0)
+    if (g_msg.param.rate_window != 0)
     {
-        g_msg.timestamp.no_previous_tstamp = true;      // Restart log-timestamp search after an error is detected
+        count_message_rate(p_fmt, g_ctx->fmt_id, total_words, g_ctx->timestamp);
     }
 
-    p_fmt->counter++;        // Increment message counter
-    calculate_total_message_size(p_fmt);
+    if (g_msg.param.loss_statistics_enabled)
+    {
+        count_message_for_loss_report(g_ctx->fmt_id, g_ctx->message_cnt, total_words, g_ctx->timestamp);
+    }
 
-    p_fmt->time_last_message = g_msg.timestamp.f;       // Store the timestamp of the current message
+    p_fmt->time_last_message = g_ctx->timestamp;        // Store the timestamp of the current message
 }
 
 /*==== End of file ====*/
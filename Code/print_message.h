@@ -19,6 +19,10 @@
 #include "format.h"
 
 void print_message(void);
+void print_message_text(msg_data_t *p_fmt);
+bool prepare_value_for_callback(value_format_t *fmt, const char **text, size_t *length);
+bool prepare_query_value(value_format_t *fmt);
+void compile_decode_plans(void);
 
 #endif // _PRINT_MESSAGE_H
 
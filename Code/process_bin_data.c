@@ -23,6 +23,12 @@
 #include "print_message.h"
 #include "print_helper.h"
 #include "read_bin_data.h"
+#include "parallel_decode.h"
+#include "profile.h"
+#include "decode_index.h"
+#include "msg_framing.h"
+#include "side_channel.h"
+#include "hex_text.h"
 
 
 /**
@@ -44,105 +50,7 @@ bool message_complete(unsigned no_words)
         return true;
     }
 
-    // Check if a format definition exists for the current format ID.
-    if (g_msg.fmt_id < MAX_FMT_IDS)
-    {
-        msg_data_t *p_fmt = g_fmt[g_msg.fmt_id];
-
-        if (p_fmt != NULL)
-        {
-            // Do not search for other parts of the message if the message has the correct length already
-            unsigned length = p_fmt->msg_len;       // Length [bytes]
-
-            if (length == 0)
-            {
-                return false;       // Message length zero (MSG0) or unknown
-            }
-
-            if ((p_fmt->msg_type == TYPE_EXT_MSG) && (length >= 4uL))
-            {
-                // Exclude the extended data since the message has not been identified as EXT_MSG yet
-                length -= 4uL;
-            }
-
-            if (length <= (g_msg.asm_words * 4uL)) // Is the message the correct length or too long?
-            {
-                return true; // Message size matches the format definition or is too long.
-            }
-        }
-    }
-
-    return false;
-}
-
-
-/**
- * @brief Retrieves the expected length of the sub-packet for a given format ID.
- *        Returns the length of the first packet (1 to 5 words including FMT).
- *
- * @param fmt_id  Format ID of the current message.
- *
- * @return Length of the message (number of DATA words including one FMT word).
- *         Returns 0xFFFFFFFF if the format ID is invalid or no definition exists.
- */
-
-static uint32_t get_packet_length(uint32_t fmt_id)
-{
-    if (fmt_id >= MAX_FMT_IDS)
-    {
-        return 0xFFFFFFFFu;     // Return actual packet length if format ID is invalid.
-    }
-
-    msg_data_t *p_fmt = g_fmt[fmt_id];
-
-    while ((fmt_id & 0xF) != 0)
-    {
-        p_fmt = g_fmt[fmt_id];  // The format definition exists?
-
-        if (p_fmt != NULL)
-        {
-            break;
-        }
-
-        fmt_id--;
-    }
-
-    if (p_fmt == NULL)
-    {
-        return 0xFFFFFFFFu;     // Use the actual packet length since the length is unknown
-    }
-
-    uint32_t len = p_fmt->msg_len / 4u; // Calculate number of DATA words.
-
-    switch (g_fmt[fmt_id]->msg_type)
-    {
-        case TYPE_MSG0_4:
-            break;
-
-        case TYPE_EXT_MSG:
-            if (len > 0)
-            {
-                len--;  // One data element (up to 8 bits) is part of the FMT word.
-            }
-            break;
-
-        case TYPE_MSGN:
-            if ((len == 0) || (len > 4))
-            {
-                // Assume a length of 4 DATA words or more if unknown at compile time.
-                len = 4u;
-            }
-            break;
-            // The code above assumes that there is an invalid message that should be skipped
-            // before the start of the MSGN message and not in the middle of the message.
-
-        case TYPE_MSGX:
-            len = 4u;           // Sub packet can could hold up to 4 DATA words
-            break;
-    }
-
-    len++;                      // Add one for the FMT word
-    return len;
+    return message_length_reached(g_msg.fmt_id, g_msg.asm_words);
 }
 
 
@@ -182,7 +90,7 @@ asm_msg_t process_the_message_packet(unsigned no_words, uint32_t data)
         return BAD_BLOCK;
     }
 
-    if ((g_fmt[g_msg.fmt_id] == NULL) || (g_fmt[g_msg.fmt_id]->msg_type != TYPE_EXT_MSG))
+    if (g_fmt_info[g_msg.fmt_id].msg_type != TYPE_EXT_MSG)    // TYPE_MSG0_4 if not defined
     {
         additional_data &= 0x0Fu;
     }
@@ -230,18 +138,8 @@ asm_msg_t process_the_message_packet(unsigned no_words, uint32_t data)
 
 unsigned skip_unfinished_words(void)
 {
-    unsigned no_unfinished = 0;
-    
-    for (uint32_t idx = g_msg.index; idx < g_msg.in_size; idx++)
-    {
-        if (g_msg.rte_buffer[idx] != 0xFFFFFFFFuL)
-        {
-            break;
-        }
-
-        no_unfinished++;
-        g_msg.index++;
-    }
+    unsigned no_unfinished = count_erased_bin_words(g_msg.index, g_msg.in_size);
+    g_msg.index += no_unfinished;
 
     return no_unfinished;
 }
@@ -271,7 +169,7 @@ __inline static asm_msg_t find_fmt_word(unsigned *packet_words, uint32_t *p_data
             return BAD_BLOCK;       // Too many DATA words without a FMT word
         }
 
-        data = g_msg.rte_buffer[g_msg.index];
+        data = get_bin_word(g_msg.index);
 
         if (data == 0xFFFFFFFFuL)
         {
@@ -358,7 +256,7 @@ static bool next_packet_is_the_continuation_of_the_message(uint32_t timestamp_an
             return false;
         }
 
-        uint32_t data = g_msg.rte_buffer[idx];
+        uint32_t data = get_bin_word(idx);
 
         if (data == 0xFFFFFFFFuL)   // Unfinished message?
         {
@@ -397,6 +295,11 @@ static asm_msg_t assemble_message(void)
     g_msg.asm_words = 0;
     unsigned packet_words = 0;
 
+    if (assemble_framed_message())      // Single-packet message found by the framing
+    {
+        return DATA_FOUND;
+    }
+
     // Assemble the message into g_msg.assembled_msg
     while (g_msg.index < g_msg.in_size)
     {
@@ -471,6 +374,71 @@ static void debug_print_format_id_name_info(FILE *out)
 }
 
 
+/**
+ * @brief Prints the 32-bit words as hex numbers "0x%08X ". The text is prepared with
+ *        the hex_text.h functions and written in blocks.
+ *
+ * @param out    Pointer to the output file
+ * @param words  Pointer to the words
+ * @param count  Number of words
+ */
+
+static void debug_print_hex_words(FILE *out, const uint32_t *words, uint32_t count)
+{
+    char text[64u * 11u];
+
+    for (uint32_t i = 0; i < count; )
+    {
+        char *p = text;
+
+        for (uint32_t n = 0; (n < 64u) && (i < count); n++, i++)
+        {
+            *p++ = '0';
+            *p++ = 'x';
+            p = put_hex32(p, words[i]);
+            *p++ = ' ';
+        }
+
+        fwrite(text, 1, (size_t)(p - text), out);
+    }
+}
+
+
+/**
+ * @brief Prints the bytes of the 32-bit words as hex numbers " 0x%02X 0x%02X 0x%02X 0x%02X ".
+ *
+ * @param out    Pointer to the output file
+ * @param words  Pointer to the words
+ * @param count  Number of words
+ */
+
+static void debug_print_hex_bytes(FILE *out, const uint32_t *words, uint32_t count)
+{
+    char text[64u * 21u];
+    const uint8_t *message = (const uint8_t *)words;
+
+    for (uint32_t i = 0; i < count; )
+    {
+        char *p = text;
+
+        for (uint32_t n = 0; (n < 64u) && (i < count); n++, i++)
+        {
+            *p++ = ' ';
+
+            for (unsigned j = 0; j < 4u; j++)
+            {
+                *p++ = '0';
+                *p++ = 'x';
+                p = put_hex8(p, *message++);
+                *p++ = ' ';
+            }
+        }
+
+        fwrite(text, 1, (size_t)(p - text), out);
+    }
+}
+
+
 /**
  * @brief Prints message as hex data if errors in the message have been detected
  *
@@ -494,10 +462,7 @@ static void debug_print_bad_packet_words(FILE *out)
             no_words = MAX_RAW_DATA_SIZE;
         }
 
-        for (uint32_t i = 0; i < no_words; i++)
-        {
-            fprintf(out, "0x%08X ", g_msg.raw_data[i]);
-        }
+        debug_print_hex_words(out, g_msg.raw_data, no_words);
     }
 }
 
@@ -540,25 +505,12 @@ void debug_print_message_hex(uint32_t start_index)
             fprintf(out, "hex: ");
         }
 
-        for (uint32_t i = 0; i < g_msg.asm_words; i++)
-        {
-            fprintf(out, "0x%08X ", g_msg.assembled_msg[i]);
-        }
+        debug_print_hex_words(out, g_msg.assembled_msg, g_msg.asm_words);
 
         if (g_msg.bad_packet_words == 0)
         {
             fprintf(out, "---");
-            uint8_t *message = (uint8_t *)&g_msg.assembled_msg[0];
-
-            for (uint32_t i = 0; i < g_msg.asm_words * 4; i++)
-            {
-                if ((i % 4) == 0)
-                {
-                    fprintf(out, " ");
-                }
-
-                fprintf(out, "0x%02X ", *message++);
-            }
+            debug_print_hex_bytes(out, g_msg.assembled_msg, g_msg.asm_words);
         }
     }
 
@@ -597,7 +549,10 @@ __inline static void load_additional_data(void)
 
         if (remaining_words <= (2ull * g_msg.hdr_data.max_msg_blocks * 5ull * sizeof(uint32_t)))
         {
+            uint64_t start = profile_start();
             load_data_block();   // Add new data to the data that has not been decoded yet
+            discard_message_descriptors();
+            profile_stop(PROFILE_LOAD_DATA, start);
         }
     }
 }
@@ -637,8 +592,13 @@ static void report_a_too_long_message(unsigned last_fmt_id)
 {
     g_msg.message_cnt++;
     debug_print_message_info(last_fmt_id);
+    bool not_shown = error_report_limit_reached(ERR_MESSAGE_TOO_LONG);
     report_problem(ERR_MESSAGE_TOO_LONG, 0);
-    fprintf(g_msg.file.main_log, get_message_text(MSG_FMT_ID), g_msg.fmt_id);
+
+    if (!not_shown)
+    {
+        fprintf(g_msg.file.main_log, get_message_text(MSG_FMT_ID), g_msg.fmt_id);
+    }
     debug_print_message_hex(last_fmt_id);
 }
 
@@ -680,6 +640,74 @@ static void report_warning_if_error_found_in_first_message(uint32_t last_error_c
 }
 
 
+/**
+ * @brief Prepare the data structure for the topmost format definition used
+ *        for MSG1_SYS_STREAMING_MODE_LOGGING (internal system messages).
+ *        This is the only system message format structure not initialized
+ *        during 'rte_system.h' format file parsing.
+ */
+
+static void prepare_sys_msg_fmt_structure(void)
+{
+    if (g_fmt[MSG1_SYS_STREAMING_MODE_LOGGING] != NULL)
+    {
+        return;     // Already prepared for a previous decoding library context
+    }
+
+    msg_data_t *p_fmt = allocate_memory(sizeof(msg_data_t), "sysFmt");
+    g_fmt[MSG1_SYS_STREAMING_MODE_LOGGING] = p_fmt;
+    p_fmt->msg_len = 4u;
+    p_fmt->msg_type = TYPE_MSG0_4;
+    p_fmt->message_name = "sys";
+}
+
+
+/**
+ * @brief Returns the size of the buffer for the assembled messages.
+ *
+ * @param state  Decoding state with the checked header of the binary data
+ *
+ * @return Size of the buffer [bytes]
+ */
+
+static size_t get_assembly_buffer_size(const rte_msg_t *state)
+{
+    size_t buffer_size = sizeof(uint32_t) * 4u * (1u + (size_t)state->hdr_data.max_msg_blocks) + 20u;
+
+    if (buffer_size < (256U + 16U))
+    {
+        buffer_size = 256U + 16U;        // The buffer should accommodate at least the MSGX-style message
+    }
+
+    return buffer_size;
+}
+
+
+/**
+ * @brief Allocates the buffer for the assembled messages and prepares the format structure
+ *        of the internal system messages. The header of the binary data must be checked already.
+ */
+
+void prepare_message_assembly(void)
+{
+    g_msg.assembled_msg = (uint32_t *)allocate_memory(get_assembly_buffer_size(&g_msg), "Asm_msg");
+    prepare_sys_msg_fmt_structure();
+}
+
+
+/**
+ * @brief Releases the buffer for the assembled messages of a decoding state.
+ *
+ * @param state  Decoding state (g_msg or the state of a decoding library context)
+ */
+
+void release_message_assembly(rte_msg_t *state)
+{
+    release_memory(state->assembled_msg, get_assembly_buffer_size(state), "Asm_msg");
+    state->assembled_msg = NULL;
+}
+
+
 /**
  * @brief Decodes the data loaded from the binary data file.
  *        The binary data is stored in g_msg.rte_buffer.
@@ -689,14 +717,38 @@ void process_bin_data_worker(void)
 {
     for ( ;; )
     {
+        if (decode_index_checkpoint())
+        {
+            // All the messages selected with -range=N1;N2 or -window=t1;t2 have been decoded
+            flush_parallel_printing();
+            g_msg.binary_file_decoding_finished = true;
+            return;
+        }
+
         uint32_t last_index = g_msg.index;
+        uint64_t start = profile_start();
         asm_msg_t code = assemble_message();
+        profile_stop(PROFILE_ASSEMBLE_MESSAGE, start);
         uint32_t last_error_counter = g_msg.total_errors;
 
         switch (code)
         {
             case END_OF_BUFFER:
-                return;
+                flush_parallel_printing();
+                flush_side_channel();
+
+                if (g_msg.complete_file_loaded)
+                {
+                    return;
+                }
+
+                // -follow mode: wait for the data appended to the binary file
+                g_msg.binary_file_decoding_finished = false;
+                start = profile_start();
+                load_data_block();
+                discard_message_descriptors();
+                profile_stop(PROFILE_LOAD_DATA, start);
+                continue;
 
             case DATA_FOUND:
                 // Decode and print the message content
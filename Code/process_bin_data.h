@@ -16,6 +16,8 @@
 
 #include "main.h"
 
+void prepare_message_assembly(void);
+void release_message_assembly(rte_msg_t *state);
 void process_bin_data_worker(void);
 void debug_print_message_info(uint32_t last_index);
 void debug_print_message_hex(uint32_t start_index);
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    profile.c
+ * @author  B. Premzel
+ * @brief   Execution time profile of the binary file decoding (-profile).
+ *          The decoding thread measures the time of the decoding stages. Every
+ *          printing context measures the printing time of the messages and values
+ *          it prints. The summary is written to the Stat_main.log file together
+ *          with the memory usage by the allocation names.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "main.h"
+#include "format.h"
+#include "profile.h"
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+/***** Global variables *****/
+profile_counter_t g_profile[PROFILE_STAGES];
+
+
+/* Printing time of the messages with the same formatting definitions */
+typedef struct
+{
+    msg_data_t *p_fmt;
+    profile_counter_t time;
+} msg_profile_t;
+
+
+static struct
+{
+    struct timespec start_time;     /*!< Start of the binary file processing */
+    uint64_t start_cycles;          /*!< Cycle counter at the start of the binary file processing */
+    print_profile_t *contexts[MAX_PRINT_THREADS + 1u]; /*!< Profiles of the main thread and printing workers */
+    unsigned contexts_used;
+} profile;
+
+
+/* Names of the decoding stages - message numbers in the same order as profile_stage_t */
+static const uint32_t stage_name[PROFILE_STAGES] =
+{
+    MSG_PROFILE_LOAD_DATA,
+    MSG_PROFILE_ASSEMBLE_MESSAGE,
+    MSG_PROFILE_TIMESTAMP,
+    MSG_PROFILE_LONG_TIMESTAMP,
+    MSG_PROFILE_PRINT_MESSAGE,
+    MSG_PROFILE_PARALLEL_PRINTING,
+    MSG_PROFILE_VALUE_STATISTICS,
+    MSG_PROFILE_WRITE_STATISTICS
+};
+
+
+/* Format types in the same order as enum fmt_type_t */
+static const char *fmt_type_name[] =
+{
+    "plain text", "%s", "%Y", "%u %x %o %c", "%d %i", "%f %e %g %a", "%b", "%t", "%T", "%N",
+    "%1H", "%2H", "%4H", "%W", "%D", "%M"
+};
+
+static_assert(sizeof(fmt_type_name) / sizeof(fmt_type_name[0]) == (PRINT_MSG_FMT_ID_NAME + 1u),
+    "The fmt_type_name[] must contain names of all format types");
+
+
+/**
+ * @brief Starts the profiling of the binary file processing (if enabled with -profile).
+ */
+
+void start_profiling(void)
+{
+    if (!g_msg.param.profile)
+    {
+        return;
+    }
+
+    (void)timespec_get(&profile.start_time, TIME_UTC);
+    profile.start_cycles = read_cycle_counter();
+    memset(g_profile, 0, sizeof(g_profile));
+
+    // Every binary data file is profiled separately (-batch)
+    for (unsigned n = 0; n < profile.contexts_used; n++)
+    {
+        memset(profile.contexts[n]->fmt_id, 0, MAX_FMT_IDS * sizeof(profile_counter_t));
+        memset(profile.contexts[n]->fmt_type, 0, sizeof(profile.contexts[n]->fmt_type));
+    }
+
+    g_msg.ctx.profile = (profile.contexts_used > 0) ? profile.contexts[0] : new_print_profile();
+}
+
+
+/**
+ * @brief Prepares the execution time counters for a printing context.
+ *
+ * @return Pointer to the counters or NULL if the profiling is not enabled
+ */
+
+print_profile_t *new_print_profile(void)
+{
+    if ((!g_msg.param.profile) || (profile.contexts_used >= (MAX_PRINT_THREADS + 1u)))
+    {
+        return NULL;
+    }
+
+    print_profile_t *print_profile = (print_profile_t *)allocate_memory(sizeof(print_profile_t), "profile");
+    print_profile->fmt_id = (profile_counter_t *)allocate_memory(MAX_FMT_IDS * sizeof(profile_counter_t), "profFmt");
+    profile.contexts[profile.contexts_used++] = print_profile;
+    return print_profile;
+}
+
+
+/**
+ * @brief Prints a single line of the execution profile.
+ *
+ * @param out           Output file
+ * @param name          Name of the stage, message or format type
+ * @param counter       Measured execution time
+ * @param cycles_per_s  Number of counter cycles per second
+ * @param total_cycles  Binary file processing time [cycles]
+ */
+
+static void print_profile_line(FILE *out, const char *name, const profile_counter_t *counter,
+    double cycles_per_s, double total_cycles)
+{
+    double cycles_per_call = 0;
+
+    if (counter->calls > 0)
+    {
+        cycles_per_call = (double)counter->cycles / (double)counter->calls;
+    }
+
+    fprintf(out, get_message_text(MSG_PROFILE_LINE), name,
+        (double)counter->cycles / cycles_per_s,
+        100.0 * (double)counter->cycles / total_cycles,
+        (unsigned long long)counter->calls, cycles_per_call);
+}
+
+
+/**
+ * @brief Compares the printing times of two messages for the qsort() - the longest first.
+ */
+
+static int compare_msg_profiles(const void *a, const void *b)
+{
+    uint64_t cycles_a = ((const msg_profile_t *)a)->time.cycles;
+    uint64_t cycles_b = ((const msg_profile_t *)b)->time.cycles;
+
+    return (cycles_a < cycles_b) - (cycles_a > cycles_b);
+}
+
+
+/**
+ * @brief Prints the list of messages with the longest printing time.
+ *        The times of all format IDs sharing the same formatting definitions are added together.
+ *
+ * @param out           Output file
+ * @param cycles_per_s  Number of counter cycles per second
+ * @param total_cycles  Binary file processing time [cycles]
+ */
+
+static void print_messages_with_top_printing_time(FILE *out, double cycles_per_s, double total_cycles)
+{
+    msg_profile_t *messages = (msg_profile_t *)allocate_memory(MAX_FMT_IDS * sizeof(msg_profile_t), "profMsg");
+    unsigned msgs_found = 0;
+
+    for (unsigned i = 0; i < MAX_FMT_IDS; i++)
+    {
+        profile_counter_t time = { 0 };
+
+        for (unsigned n = 0; n < profile.contexts_used; n++)
+        {
+            time.cycles += profile.contexts[n]->fmt_id[i].cycles;
+            time.calls += profile.contexts[n]->fmt_id[i].calls;
+        }
+
+        if (time.calls == 0)
+        {
+            continue;
+        }
+
+        if ((msgs_found == 0) || (messages[msgs_found - 1u].p_fmt != g_fmt[i]))
+        {
+            messages[msgs_found].p_fmt = g_fmt[i];
+            msgs_found++;
+        }
+
+        messages[msgs_found - 1u].time.cycles += time.cycles;
+        messages[msgs_found - 1u].time.calls += time.calls;
+    }
+
+    if (msgs_found > 0)
+    {
+        qsort(messages, msgs_found, sizeof(msg_profile_t), compare_msg_profiles);
+        fprintf(out, get_message_text(MSG_PROFILE_MESSAGES));
+
+        for (unsigned i = 0; (i < msgs_found) && (i < TOP_MESSAGES); i++)
+        {
+            const char *name = NULL;
+
+            if (messages[i].p_fmt != NULL)
+            {
+                name = messages[i].p_fmt->message_name;
+            }
+
+            if (name == NULL)
+            {
+                name = get_message_text(MSG_UNDEFINED_NAME);
+            }
+
+            print_profile_line(out, name, &messages[i].time, cycles_per_s, total_cycles);
+        }
+    }
+
+    release_memory(messages, MAX_FMT_IDS * sizeof(msg_profile_t), "profMsg");
+}
+
+
+/**
+ * @brief Prints the value printing time for every format type used.
+ *
+ * @param out           Output file
+ * @param cycles_per_s  Number of counter cycles per second
+ * @param total_cycles  Binary file processing time [cycles]
+ */
+
+static void print_format_type_printing_time(FILE *out, double cycles_per_s, double total_cycles)
+{
+    fprintf(out, get_message_text(MSG_PROFILE_VALUE_TYPES));
+
+    for (unsigned type = 0; type <= PRINT_MSG_FMT_ID_NAME; type++)
+    {
+        profile_counter_t time = { 0 };
+
+        for (unsigned n = 0; n < profile.contexts_used; n++)
+        {
+            time.cycles += profile.contexts[n]->fmt_type[type].cycles;
+            time.calls += profile.contexts[n]->fmt_type[type].calls;
+        }
+
+        if (time.calls > 0)
+        {
+            print_profile_line(out, fmt_type_name[type], &time, cycles_per_s, total_cycles);
+        }
+    }
+}
+
+
+/**
+ * @brief Returns the peak physical memory used by the process (resident set / working set).
+ *
+ * @return Peak memory [bytes], 0 - not available
+ */
+
+static size_t get_peak_process_memory(void)
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        return (size_t)usage.ru_maxrss * 1024u;     // Linux reports the size in kilobytes
+    }
+#endif
+
+    return 0;
+}
+
+
+/**
+ * @brief Compares the peak memory usage of two allocation names for the qsort() - the largest first.
+ */
+
+static int compare_memory_usage(const void *a, const void *b)
+{
+    size_t peak_a = ((const memory_usage_t *)a)->peak;
+    size_t peak_b = ((const memory_usage_t *)b)->peak;
+
+    return (peak_a < peak_b) - (peak_a > peak_b);
+}
+
+
+/**
+ * @brief Prints the current and peak memory usage for every allocation name and the
+ *        peak memory used by the process. The peak values of different names may be
+ *        reached at different times, so their sum may exceed the total peak.
+ *
+ * @param out  Output file
+ */
+
+static void print_memory_usage(FILE *out)
+{
+    unsigned names;
+    size_t peak;
+    const memory_usage_t *usage = get_memory_usage(&names, &peak);
+    memory_usage_t sorted[MAX_MEMORY_NAMES + 1u];
+
+    memcpy(sorted, usage, names * sizeof(memory_usage_t));
+    qsort(sorted, names, sizeof(memory_usage_t), compare_memory_usage);
+    fprintf(out, get_message_text(MSG_MEMORY_USAGE_TITLE),
+        (double)peak / 1024.0, (double)get_peak_process_memory() / 1024.0);
+
+    for (unsigned i = 0; i < names; i++)
+    {
+        fprintf(out, get_message_text(MSG_MEMORY_USAGE_LINE), sorted[i].name,
+            (double)sorted[i].peak / 1024.0, (double)sorted[i].current / 1024.0,
+            (unsigned long long)sorted[i].allocations);
+    }
+}
+
+
+/**
+ * @brief Writes the execution profile of the binary file processing to the Stat_main.log.
+ *        The percentages are relative to the binary file processing time. The message and
+ *        format type printing times are sums of the times for all printing threads.
+ */
+
+void write_profile_report(void)
+{
+    FILE *out = g_msg.file.statistics_log;
+
+    if ((!g_msg.param.profile) || (out == NULL))
+    {
+        return;
+    }
+
+    struct timespec end_time;
+    (void)timespec_get(&end_time, TIME_UTC);
+    double total_cycles = (double)(read_cycle_counter() - profile.start_cycles);
+    double elapsed = (double)(end_time.tv_sec - profile.start_time.tv_sec)
+        + (double)(end_time.tv_nsec - profile.start_time.tv_nsec) * 1e-9;
+
+    if ((total_cycles <= 0) || (elapsed <= 0))
+    {
+        return;
+    }
+
+    double cycles_per_s = total_cycles / elapsed;
+    fprintf(out, get_message_text(MSG_PROFILE_TITLE), elapsed, cycles_per_s * 1e-6);
+    fprintf(out, get_message_text(MSG_PROFILE_STAGES));
+
+    for (unsigned stage = 0; stage < PROFILE_STAGES; stage++)
+    {
+        print_profile_line(out, get_message_text(stage_name[stage]), &g_profile[stage],
+            cycles_per_s, total_cycles);
+    }
+
+    print_messages_with_top_printing_time(out, cycles_per_s, total_cycles);
+    print_format_type_printing_time(out, cycles_per_s, total_cycles);
+    print_memory_usage(out);
+    fprintf(out, "\n");
+}
+
+/*==== End of file ====*/
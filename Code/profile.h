@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    profile.h
+ * @author  B. Premzel
+ * @brief   Measurement of the execution time of the binary file decoding stages,
+ *          messages and value types (-profile command line argument).
+ ******************************************************************************/
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "main.h"
+#include "format.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_USE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_USE_TSC
+#endif
+
+
+/* @brief Binary file decoding stages measured with the -profile command line argument.
+ *        The stages marked as nested are executed inside of the previous stage. */
+typedef enum
+{
+    PROFILE_LOAD_DATA,              /*!< Binary data loading - load_data_from_binary_file(), load_data_block() */
+    PROFILE_ASSEMBLE_MESSAGE,       /*!< Message assembly - assemble_message() */
+    PROFILE_TIMESTAMP,              /*!< Timestamp reconstruction - prepare_timestamp_value() */
+    PROFILE_LONG_TIMESTAMP,         /*!< Nested: long timestamp search - long_timestamp_found() */
+    PROFILE_PRINT_MESSAGE,          /*!< Message printing - print_message() */
+    PROFILE_PARALLEL_PRINTING,      /*!< Nested: handover, wait and merge of the batches (parallel_decode.c) */
+    PROFILE_VALUE_STATISTICS,       /*!< Nested: value statistics - value_statistic() */
+    PROFILE_WRITE_STATISTICS,       /*!< Statistics file writing - write_statistics_to_file() */
+    PROFILE_STAGES                  /*!< Number of the decoding stages */
+} profile_stage_t;
+
+
+/* @brief Execution time counter */
+typedef struct
+{
+    uint64_t cycles;                /*!< Total execution time [CPU cycles] */
+    uint64_t calls;                 /*!< Number of measurements */
+} profile_counter_t;
+
+
+/* @brief Execution times measured in a printing context (see msg_context_t) */
+typedef struct _print_profile_t
+{
+    profile_counter_t *fmt_id;      /*!< Message printing time for every format ID */
+    profile_counter_t fmt_type[PRINT_MSG_FMT_ID_NAME + 1u]; /*!< Value printing time for every format type */
+} print_profile_t;
+
+
+/***** Global variables *****/
+extern profile_counter_t g_profile[PROFILE_STAGES];  /*!< Decoding stages - measured by the decoding thread only */
+
+
+/**
+ * @brief Reads the CPU time stamp counter (or the time in ns if the counter is not available).
+ *
+ * @return Current value of the counter
+ */
+
+static inline uint64_t read_cycle_counter(void)
+{
+#ifdef PROFILE_USE_TSC
+    return __rdtsc();
+#else
+    struct timespec ts;
+    (void)timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000uLL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+/**
+ * @brief Starts the measurement of a decoding stage.
+ *
+ * @return Start time or 0 if the profiling is not enabled
+ */
+
+static inline uint64_t profile_start(void)
+{
+    return g_msg.param.profile ? read_cycle_counter() : 0;
+}
+
+
+/**
+ * @brief Adds the execution time of a decoding stage to its counter.
+ *        Must be called by the decoding thread only.
+ *
+ * @param stage  Decoding stage
+ * @param start  Start time returned by the profile_start()
+ */
+
+static inline void profile_stop(profile_stage_t stage, uint64_t start)
+{
+    if (g_msg.param.profile)
+    {
+        g_profile[stage].cycles += read_cycle_counter() - start;
+        g_profile[stage].calls++;
+    }
+}
+
+
+/**
+ * @brief Starts the measurement of a message or value printing in the current printing context.
+ *
+ * @return Start time or 0 if the profiling is not enabled
+ */
+
+static inline uint64_t print_profile_start(void)
+{
+    return (g_ctx->profile != NULL) ? read_cycle_counter() : 0;
+}
+
+
+/**
+ * @brief Adds the printing time of a value to the counter of its format type.
+ *
+ * @param fmt_type  Format type of the printed value
+ * @param start     Start time returned by the print_profile_start()
+ */
+
+static inline void profile_value_printed(enum fmt_type_t fmt_type, uint64_t start)
+{
+    if (g_ctx->profile != NULL)
+    {
+        profile_counter_t *counter = &g_ctx->profile->fmt_type[fmt_type];
+        counter->cycles += read_cycle_counter() - start;
+        counter->calls++;
+    }
+}
+
+
+/**
+ * @brief Adds the printing time of a message to the counter of its format ID.
+ *
+ * @param fmt_id  Format ID of the printed message
+ * @param start   Start time returned by the print_profile_start()
+ */
+
+static inline void profile_message_printed(uint32_t fmt_id, uint64_t start)
+{
+    if (g_ctx->profile != NULL)
+    {
+        profile_counter_t *counter = &g_ctx->profile->fmt_id[fmt_id];
+        counter->cycles += read_cycle_counter() - start;
+        counter->calls++;
+    }
+}
+
+
+void start_profiling(void);
+print_profile_t *new_print_profile(void);
+void write_profile_report(void);
+
+#endif  // _PROFILE_H
+
+/*==== End of file ====*/
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    quantile_sketch.c
+ * @author  B. Premzel
+ * @brief   Streaming quantile estimation for the value statistics ("|name:q|").
+ *          The values are counted in logarithmically spaced buckets, so the memory
+ *          needed does not depend on the number of values. The quantiles are estimated
+ *          with the QUANTILE_SKETCH_ACCURACY relative accuracy (DDSketch algorithm).
+ ******************************************************************************/
+
+#include "pch.h"
+#include <math.h>
+#include "main.h"
+#include "quantile_sketch.h"
+
+static double sketch_gamma;         // Ratio between the upper limits of two neighboring buckets
+static double sketch_log_gamma;     // Natural logarithm of the sketch_gamma
+
+
+/**
+ * @brief Allocates memory for a new quantile sketch.
+ *
+ * @return  Pointer to the zero-initialized sketch.
+ */
+
+quantile_sketch_t *create_quantile_sketch(void)
+{
+    if (sketch_gamma == 0)
+    {
+        sketch_gamma = (1.0 + QUANTILE_SKETCH_ACCURACY) / (1.0 - QUANTILE_SKETCH_ACCURACY);
+        sketch_log_gamma = log(sketch_gamma);
+    }
+
+    return (quantile_sketch_t *)allocate_memory(sizeof(quantile_sketch_t), "qSketch");
+}
+
+
+/**
+ * @brief Releases the memory of a quantile sketch.
+ *
+ * @param sketch  Pointer to the sketch (NULL - nothing to release).
+ */
+
+void release_quantile_sketch(quantile_sketch_t *sketch)
+{
+    release_memory(sketch, sizeof(quantile_sketch_t), "qSketch");
+}
+
+
+/**
+ * @brief Returns the index of the bucket for a value.
+ *        Bucket k contains values between MIN * gamma^(k-1) and MIN * gamma^k.
+ *        Values outside of the range are counted in the first or last bucket.
+ *
+ * @param abs_value  Absolute value (>= QUANTILE_SKETCH_MIN_VALUE).
+ *
+ * @return  Index of the bucket.
+ */
+
+static unsigned bucket_index(double abs_value)
+{
+    double key = ceil(log(abs_value / QUANTILE_SKETCH_MIN_VALUE) / sketch_log_gamma);
+
+    if (!(key > 0))
+    {
+        return 0;
+    }
+
+    if (key >= (double)(QUANTILE_SKETCH_BUCKETS - 1u))
+    {
+        return QUANTILE_SKETCH_BUCKETS - 1u;
+    }
+
+    return (unsigned)key;
+}
+
+
+/**
+ * @brief Returns the value representing the values counted in a bucket.
+ *        Its relative difference to all the bucket values is smaller than the accuracy.
+ *
+ * @param index  Index of the bucket.
+ *
+ * @return  Absolute value for the bucket.
+ */
+
+static double bucket_value(unsigned index)
+{
+    return QUANTILE_SKETCH_MIN_VALUE * pow(sketch_gamma, (double)index) * 2.0 / (1.0 + sketch_gamma);
+}
+
+
+/**
+ * @brief Adds a value to the quantile sketch.
+ *
+ * @param sketch  Pointer to the sketch.
+ * @param value   Value to add (NaN values are ignored).
+ */
+
+void add_to_quantile_sketch(quantile_sketch_t *sketch, double value)
+{
+    if (isnan(value))
+    {
+        return;
+    }
+
+    if ((sketch->counter == 0) || (value < sketch->min))
+    {
+        sketch->min = value;
+    }
+
+    if ((sketch->counter == 0) || (value > sketch->max))
+    {
+        sketch->max = value;
+    }
+
+    sketch->counter++;
+
+    if (value >= QUANTILE_SKETCH_MIN_VALUE)
+    {
+        sketch->positive[bucket_index(value)]++;
+    }
+    else if (value <= -QUANTILE_SKETCH_MIN_VALUE)
+    {
+        sketch->negative[bucket_index(-value)]++;
+    }
+    else
+    {
+        sketch->zero_count++;
+    }
+}
+
+
+/**
+ * @brief Walks through the buckets from the smallest to the largest value.
+ *
+ * @param sketch    Pointer to the sketch.
+ * @param position  Position of the bucket (0 .. 2 * QUANTILE_SKETCH_BUCKETS).
+ * @param value     Output: value representing the bucket limited to the min. and max. value.
+ *
+ * @return  Number of values in the bucket.
+ */
+
+static uint32_t sketch_bucket(const quantile_sketch_t *sketch, unsigned position, double *value)
+{
+    uint32_t count;
+
+    if (position < QUANTILE_SKETCH_BUCKETS)
+    {
+        unsigned index = QUANTILE_SKETCH_BUCKETS - 1u - position;
+        count = sketch->negative[index];
+        *value = (count == 0) ? 0 : -bucket_value(index);
+    }
+    else if (position == QUANTILE_SKETCH_BUCKETS)
+    {
+        count = sketch->zero_count;
+        *value = 0;
+    }
+    else
+    {
+        unsigned index = position - QUANTILE_SKETCH_BUCKETS - 1u;
+        count = sketch->positive[index];
+        *value = (count == 0) ? 0 : bucket_value(index);
+    }
+
+    if (*value < sketch->min)
+    {
+        *value = sketch->min;
+    }
+
+    if (*value > sketch->max)
+    {
+        *value = sketch->max;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Estimates the value of a quantile.
+ *
+ * @param sketch    Pointer to the sketch.
+ * @param quantile  Quantile (0.0 .. 1.0) - e.g. 0.99 for the 99th percentile.
+ *
+ * @return  Estimated value of the quantile (0 if the sketch is empty).
+ */
+
+double get_sketch_quantile(const quantile_sketch_t *sketch, double quantile)
+{
+    if (sketch->counter == 0)
+    {
+        return 0;
+    }
+
+    double rank = quantile * (double)(sketch->counter - 1u);
+    double value = sketch->max;
+    uint64_t count = 0;
+
+    for (unsigned position = 0; position <= (2u * QUANTILE_SKETCH_BUCKETS); position++)
+    {
+        double bucket_val;
+        count += sketch_bucket(sketch, position, &bucket_val);
+
+        if ((double)count > rank)
+        {
+            value = bucket_val;
+            break;
+        }
+    }
+
+    return value;
+}
+
+
+/**
+ * @brief Prepares the histogram with equally wide bins between the min. and max. value.
+ *        The bin limits are min + i * (max - min) / bins.
+ *
+ * @param sketch     Pointer to the sketch.
+ * @param bin_count  Output: number of values in the bins.
+ * @param bins       Number of bins.
+ */
+
+void get_sketch_histogram(const quantile_sketch_t *sketch, uint32_t *bin_count, unsigned bins)
+{
+    for (unsigned i = 0; i < bins; i++)
+    {
+        bin_count[i] = 0;
+    }
+
+    double bin_width = (sketch->max - sketch->min) / (double)bins;
+
+    for (unsigned position = 0; position <= (2u * QUANTILE_SKETCH_BUCKETS); position++)
+    {
+        double value;
+        uint32_t count = sketch_bucket(sketch, position, &value);
+
+        if (count == 0)
+        {
+            continue;
+        }
+
+        unsigned bin = 0;
+
+        if (bin_width > 0)
+        {
+            double bin_position = (value - sketch->min) / bin_width;
+            bin = (bin_position < (double)bins) ? (unsigned)bin_position : (bins - 1u);
+        }
+
+        bin_count[bin] += count;
+    }
+}
+
+/*==== End of file ====*/
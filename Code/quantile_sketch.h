@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    quantile_sketch.h
+ * @author  B. Premzel
+ * @brief   Streaming quantile estimation for the value statistics ("|name:q|").
+ ******************************************************************************/
+
+#ifndef _QUANTILE_SKETCH_H
+#define _QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include "rtemsg_config.h"
+
+
+/**
+ * @brief Quantile sketch with logarithmically spaced buckets (DDSketch).
+ *        Each bucket covers values between gamma^(k-1) and gamma^k, where
+ *        gamma = (1 + accuracy) / (1 - accuracy). The quantiles are therefore estimated
+ *        with the QUANTILE_SKETCH_ACCURACY relative accuracy regardless of the number of values.
+ */
+typedef struct
+{
+    uint32_t counter;                               //!< Number of values added to the sketch
+    uint32_t zero_count;                            //!< Number of values smaller than QUANTILE_SKETCH_MIN_VALUE
+    double min;                                     //!< Minimal value
+    double max;                                     //!< Maximal value
+    uint32_t positive[QUANTILE_SKETCH_BUCKETS];     //!< Buckets for the positive values
+    uint32_t negative[QUANTILE_SKETCH_BUCKETS];     //!< Buckets for the negative values (absolute value)
+} quantile_sketch_t;
+
+
+/***** Function declarations *****/
+quantile_sketch_t *create_quantile_sketch(void);
+void release_quantile_sketch(quantile_sketch_t *sketch);
+void add_to_quantile_sketch(quantile_sketch_t *sketch, double value);
+double get_sketch_quantile(const quantile_sketch_t *sketch, double quantile);
+void get_sketch_histogram(const quantile_sketch_t *sketch, uint32_t *bin_count, unsigned bins);
+
+#endif  // _QUANTILE_SKETCH_H
+
+/*==== End of file ====*/
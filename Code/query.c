@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    query.c
+ * @author  B. Premzel
+ * @brief   Selection of the decoded messages with the value conditions
+ *          (-query=...), e.g. -query="MOTOR.current>12.5|ERROR.code==7".
+ *          The values are referenced with the names of the value statistics
+ *          (|name| in the format definitions). The message name may be omitted -
+ *          the value is then searched in all messages. All conditions joined with
+ *          '&' must be true for the same message, the groups of conditions joined
+ *          with '|' are alternatives. The condition values are prepared before the
+ *          message is printed and only the matching messages are decoded, plus
+ *          -context=N messages after each of them. The other messages are only
+ *          counted as the messages not selected with -select=...
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "main.h"
+#include "errors.h"
+#include "print_message.h"
+#include "query.h"
+
+
+/* @brief Comparison operators of the query conditions */
+enum query_op_t
+{
+    QUERY_LESS,
+    QUERY_LESS_OR_EQUAL,
+    QUERY_GREATER,
+    QUERY_GREATER_OR_EQUAL,
+    QUERY_EQUAL,
+    QUERY_NOT_EQUAL
+};
+
+
+/* @brief Condition of the -query=... argument */
+typedef struct
+{
+    char message_name[MAX_NAME_LENGTH]; /*!< Name of the message ("" - any message) */
+    char value_name[MAX_NAME_LENGTH];   /*!< Name of the value (value statistics name) */
+    enum query_op_t op;                 /*!< Comparison operator */
+    double value;                       /*!< Value compared with the message value */
+    bool end_of_group;                  /*!< true - the next condition is an alternative ('|') */
+} query_condition_t;
+
+
+/* @brief Values of the query conditions in the decode plan of a message type (see msg_data_t) */
+typedef struct message_query
+{
+    value_format_t *value[MAX_QUERY_CONDITIONS]; /*!< NULL - the value is not in this message */
+} message_query_t;
+
+
+static struct
+{
+    query_condition_t condition[MAX_QUERY_CONDITIONS];
+    unsigned conditions;            /*!< Number of conditions in the condition[] */
+    uint32_t context_left;          /*!< Number of messages still to be decoded after the last match */
+} query;
+
+
+/* @brief Texts of the comparison operators - the two character operators are checked first */
+static const struct
+{
+    const char *text;
+    enum query_op_t op;
+} query_operator[] =
+{
+    { "<=", QUERY_LESS_OR_EQUAL },
+    { ">=", QUERY_GREATER_OR_EQUAL },
+    { "==", QUERY_EQUAL },
+    { "!=", QUERY_NOT_EQUAL },
+    { "<",  QUERY_LESS },
+    { ">",  QUERY_GREATER },
+    { "=",  QUERY_EQUAL }
+};
+
+#define NUMBER_OF_QUERY_OPERATORS   (sizeof(query_operator) / sizeof(query_operator[0]))
+
+
+/**
+ * @brief Copies a name without the leading and trailing spaces.
+ *
+ * @param name    Output: zero terminated name (MAX_NAME_LENGTH characters).
+ * @param text    Start of the name.
+ * @param length  Length of the text.
+ *
+ * @return false - empty or too long name
+ */
+
+static bool copy_query_name(char *name, const char *text, size_t length)
+{
+    while ((length > 0) && isspace((unsigned char)*text))
+    {
+        text++;
+        length--;
+    }
+
+    while ((length > 0) && isspace((unsigned char)text[length - 1u]))
+    {
+        length--;
+    }
+
+    if ((length == 0) || (length >= MAX_NAME_LENGTH))
+    {
+        return false;
+    }
+
+    memcpy(name, text, length);
+    name[length] = '\0';
+    return true;
+}
+
+
+/**
+ * @brief Parses a single condition [MSG_NAME.]value_name<op>number. The message name
+ *        is checked later - a name with a '.' may also be a value name.
+ *
+ * @param text       Start of the condition.
+ * @param length     Length of the condition text.
+ * @param condition  Output: parsed condition.
+ *
+ * @return false - syntax error
+ */
+
+static bool parse_query_condition(const char *text, size_t length, query_condition_t *condition)
+{
+    char buffer[2u * MAX_NAME_LENGTH];
+
+    if (length >= sizeof(buffer))
+    {
+        return false;
+    }
+
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    size_t name_length = strcspn(buffer, "<>=!");
+    const char *op_text = &buffer[name_length];
+    size_t op_length = 0;
+
+    for (unsigned i = 0; i < NUMBER_OF_QUERY_OPERATORS; i++)
+    {
+        size_t len = strlen(query_operator[i].text);
+
+        if (strncmp(op_text, query_operator[i].text, len) == 0)
+        {
+            condition->op = query_operator[i].op;
+            op_length = len;
+            break;
+        }
+    }
+
+    if ((op_length == 0) || !copy_query_name(condition->value_name, buffer, name_length))
+    {
+        return false;
+    }
+
+    // The number is converted before the locale for the message printing is selected
+    const char *number = op_text + op_length;
+    char *end;
+    condition->value = strtod(number, &end);
+
+    while (isspace((unsigned char)*end))
+    {
+        end++;
+    }
+
+    condition->message_name[0] = '\0';
+    return (end != number) && (*end == '\0');
+}
+
+
+/**
+ * @brief Parses the -query=... command line argument. The names are checked after the
+ *        format definitions have been loaded (see prepare_message_query()).
+ *
+ * @param text  Conditions joined with the '&' and '|' characters.
+ *
+ * @return false - syntax error or too many conditions
+ */
+
+bool parse_query_argument(const char *text)
+{
+    query.conditions = 0;
+
+    for ( ;; )
+    {
+        size_t length = strcspn(text, "&|");
+
+        if (query.conditions >= MAX_QUERY_CONDITIONS)
+        {
+            return false;
+        }
+
+        query_condition_t *condition = &query.condition[query.conditions++];
+
+        if (!parse_query_condition(text, length, condition))
+        {
+            return false;
+        }
+
+        condition->end_of_group = (text[length] != '&');
+
+        if (text[length] == '\0')
+        {
+            return true;
+        }
+
+        text += length + 1u;
+    }
+}
+
+
+/**
+ * @brief Finds the value of a condition in the decode plan of a message.
+ *
+ * @param p_fmt      Pointer to the formatting definitions of the message.
+ * @param condition  Query condition.
+ *
+ * @return Pointer to the value parameters in the decode plan, NULL - not found
+ */
+
+static value_format_t *find_query_value(msg_data_t *p_fmt, const query_condition_t *condition)
+{
+    const char *value_name = condition->value_name;
+
+    if (condition->message_name[0] != '\0')
+    {
+        if (strcmp(p_fmt->message_name, condition->message_name) != 0)
+        {
+            return NULL;
+        }
+
+        value_name = &condition->value_name[strlen(condition->message_name) + 1u];
+    }
+
+    for (uint32_t i = 0; i < p_fmt->plan_size; i++)
+    {
+        value_format_t *fmt = &p_fmt->plan[i].fmt;
+
+        if ((fmt->value_stat != NULL) && (fmt->array_count == 0)
+            && (strcmp(fmt->value_stat->name, value_name) == 0))
+        {
+            return fmt;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Checks if the part of the condition value name in front of the first '.' is
+ *        a message name. The value is searched in all messages otherwise.
+ *
+ * @param condition  Query condition.
+ */
+
+static void find_query_message_name(query_condition_t *condition)
+{
+    const char *separator = strchr(condition->value_name, '.');
+
+    if ((separator == NULL) || (separator[1] == '\0'))
+    {
+        return;
+    }
+
+    size_t length = (size_t)(separator - condition->value_name);
+
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        const msg_data_t *p_fmt = g_fmt[fmt_id];
+
+        if ((p_fmt != NULL) && (p_fmt->message_name != NULL)
+            && (strncmp(p_fmt->message_name, condition->value_name, length) == 0)
+            && (p_fmt->message_name[length] == '\0'))
+        {
+            memcpy(condition->message_name, condition->value_name, length);
+            condition->message_name[length] = '\0';
+            return;
+        }
+    }
+}
+
+
+/**
+ * @brief Finds the values of the -query=... conditions in the decode plans of the messages.
+ *        Must be called after the decode plans have been compiled. A fatal error is reported
+ *        if a condition value is not found in any message.
+ */
+
+void prepare_message_query(void)
+{
+    if (g_msg.param.query == NULL)
+    {
+        return;
+    }
+
+    query.context_left = 0;
+    bool found[MAX_QUERY_CONDITIONS] = { false };
+
+    for (unsigned i = 0; i < query.conditions; i++)
+    {
+        find_query_message_name(&query.condition[i]);
+    }
+
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        msg_data_t *p_fmt = g_fmt[fmt_id];
+
+        // Several format IDs share the same definitions and decode plan
+        if ((p_fmt == NULL) || (p_fmt->plan == NULL) || (p_fmt->message_name == NULL))
+        {
+            continue;
+        }
+
+        for (unsigned i = 0; i < query.conditions; i++)
+        {
+            value_format_t *fmt = find_query_value(p_fmt, &query.condition[i]);
+
+            if (fmt == NULL)
+            {
+                continue;
+            }
+
+            // The plans and values are prepared once also for several binary data files (-batch)
+            if (p_fmt->query == NULL)
+            {
+                p_fmt->query = (message_query_t *)allocate_memory(sizeof(message_query_t), "query");
+                memset(p_fmt->query, 0, sizeof(message_query_t));
+            }
+
+            p_fmt->query->value[i] = fmt;
+            found[i] = true;
+        }
+    }
+
+    for (unsigned i = 0; i < query.conditions; i++)
+    {
+        if (!found[i])
+        {
+            report_fatal_error_and_exit(FATAL_QUERY_VALUE_NOT_FOUND, query.condition[i].value_name, 0);
+        }
+    }
+}
+
+
+/**
+ * @brief Checks a condition for a value of the current message.
+ *
+ * @param fmt        Pointer to the value parameters (NULL - the value is not in the message).
+ * @param condition  Query condition.
+ *
+ * @return true - the condition is true
+ */
+
+static bool query_condition_is_true(value_format_t *fmt, const query_condition_t *condition)
+{
+    if ((fmt == NULL) || !prepare_query_value(fmt))
+    {
+        return false;
+    }
+
+    double value = g_ctx->value.data_double;
+
+    switch (condition->op)
+    {
+        case QUERY_LESS:
+            return value < condition->value;
+
+        case QUERY_LESS_OR_EQUAL:
+            return value <= condition->value;
+
+        case QUERY_GREATER:
+            return value > condition->value;
+
+        case QUERY_GREATER_OR_EQUAL:
+            return value >= condition->value;
+
+        case QUERY_EQUAL:
+            return value == condition->value;
+
+        case QUERY_NOT_EQUAL:
+            return value != condition->value;
+
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * @brief Checks if the current message matches the -query=... conditions or follows
+ *        a matching message closely enough (-context=N).
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ *
+ * @return true - the message has to be decoded
+ */
+
+bool message_matches_query(const msg_data_t *p_fmt)
+{
+    const message_query_t *values = p_fmt->query;
+
+    if (values != NULL)
+    {
+        bool group_true = true;
+
+        for (unsigned i = 0; i < query.conditions; i++)
+        {
+            const query_condition_t *condition = &query.condition[i];
+
+            if (group_true)
+            {
+                group_true = query_condition_is_true(values->value[i], condition);
+            }
+
+            if (condition->end_of_group)
+            {
+                if (group_true)
+                {
+                    query.context_left = g_msg.param.query_context;
+                    return true;
+                }
+
+                group_true = true;
+            }
+        }
+    }
+
+    if (query.context_left > 0)
+    {
+        query.context_left--;
+        return true;
+    }
+
+    return false;
+}
+
+/*==== End of file ====*/
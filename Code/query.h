@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    query.h
+ * @author  B. Premzel
+ * @brief   Header file for the selection of the decoded messages with the value
+ *          conditions (-query=...).
+ ******************************************************************************/
+
+#ifndef _QUERY_H
+#define _QUERY_H
+
+#include <stdbool.h>
+#include "format.h"
+
+
+/***** Function declarations *****/
+bool parse_query_argument(const char *text);
+void prepare_message_query(void);
+bool message_matches_query(const msg_data_t *p_fmt);
+
+#endif  // _QUERY_H
+
+/*==== End of file ====*/
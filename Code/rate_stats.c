@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rate_stats.c
+ * @author  B. Premzel
+ * @brief   Logging rate statistics (-rate=N). The decoded messages are counted
+ *          in consecutive time windows of N milliseconds. The number of messages
+ *          and words (circular buffer usage) of every window with messages is
+ *          written to Stat_rates.csv. The windows with the most words and the
+ *          message types with the highest rate in a single window are reported
+ *          in Stat_main.log. The counters of a message type are reset only when
+ *          the next message of this type is found in a later window, so the
+ *          work per message does not depend on the number of message types.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "format.h"
+#include "rate_stats.h"
+
+#define MAX_WINDOW_INDEX    9.0e18      // Larger window indexes do not fit into int64_t
+
+
+/**
+ * @brief Creates the Stat_rates.csv file in the current (output) folder
+ *        if the logging rate statistics are enabled.
+ */
+
+void create_rate_file(void)
+{
+    if (g_msg.param.rate_window == 0)
+    {
+        return;
+    }
+
+    g_msg.file.rates = fopen(RTE_STAT_RATES_FILE, "w");
+
+    if (g_msg.file.rates == NULL)
+    {
+        report_problem_with_string(FATAL_CANT_CREATE_FILE, RTE_STAT_RATES_FILE);
+        return;
+    }
+
+    set_output_file_buffer(g_msg.file.rates);
+    fprintf(g_msg.file.rates, get_message_text(MSG_RATE_FILE_HEADER));
+}
+
+
+/**
+ * @brief Returns the name of the message type for the rate statistics reports.
+ *
+ * @param fmt_id  Format ID of the message
+ *
+ * @return Message name
+ */
+
+static const char *rate_message_name(uint32_t fmt_id)
+{
+    const char *name = NULL;
+
+    if ((fmt_id < MAX_FMT_IDS) && (g_fmt[fmt_id] != NULL))
+    {
+        name = g_fmt[fmt_id]->message_name;
+    }
+
+    if (name == NULL)
+    {
+        name = get_message_text(MSG_UNDEFINED_NAME);
+    }
+
+    return name;
+}
+
+
+/**
+ * @brief Inserts a finished window into the table of windows with the most words.
+ *        The window with the most words is the first one in the table.
+ *
+ * @param window  Pointer to the finished window
+ */
+
+static void insert_peak_window(const rate_window_t *window)
+{
+    rate_stats_t *rate = &g_msg.rate;
+    unsigned count = rate->peak_windows;
+
+    if ((count >= TOP_MESSAGES) && (window->words <= rate->peak[TOP_MESSAGES - 1].words))
+    {
+        return;
+    }
+
+    unsigned position;
+
+    for (position = 0; position < count; position++)
+    {
+        if (window->words > rate->peak[position].words)
+        {
+            break;
+        }
+    }
+
+    if (count < TOP_MESSAGES)
+    {
+        count++;
+    }
+
+    for (unsigned i = count - 1u; i > position; i--)
+    {
+        rate->peak[i] = rate->peak[i - 1u];
+    }
+
+    rate->peak[position] = *window;
+    rate->peak_windows = count;
+}
+
+
+/**
+ * @brief Writes the counters of the current window to Stat_rates.csv and checks if it
+ *        belongs to the windows with the most words.
+ */
+
+static void finish_rate_window(void)
+{
+    const rate_window_t *window = &g_msg.rate.current;
+
+    if (window->messages == 0)
+    {
+        return;
+    }
+
+    if (g_msg.file.rates != NULL)
+    {
+        double words_per_second = (double)window->words * 1000.0 / (double)g_msg.param.rate_window;
+        fprintf(g_msg.file.rates, "%.6f;%u;%u;%.0f;%s;%u\n",
+            window->start, window->messages, window->words, words_per_second,
+            rate_message_name(window->top_fmt_id), window->top_words);
+    }
+
+    insert_peak_window(window);
+    g_msg.rate.current.messages = 0;
+}
+
+
+/**
+ * @brief Adds a decoded message to the counters of the time window that contains its timestamp.
+ *        The previous window is finished if the message belongs to another window.
+ *
+ * @param p_fmt      Pointer to the formatting definitions of the message
+ * @param fmt_id     Format ID of the message
+ * @param words      Number of words of the message (including the FMT words)
+ * @param timestamp  Timestamp of the message [s]
+ */
+
+void count_message_rate(msg_data_t *p_fmt, uint32_t fmt_id, uint32_t words, double timestamp)
+{
+    rate_stats_t *rate = &g_msg.rate;
+    double window_length = (double)g_msg.param.rate_window / 1000.0;
+    double position = floor(timestamp / window_length);
+    int64_t index = rate->window_index;
+
+    if ((position > -MAX_WINDOW_INDEX) && (position < MAX_WINDOW_INDEX))
+    {
+        index = (int64_t)position;      // Invalid timestamps are added to the current window
+    }
+
+    if ((rate->window_no == 0) || (index != rate->window_index))
+    {
+        finish_rate_window();
+        rate->window_no++;
+        rate->window_index = index;
+        rate->current = (rate_window_t){ .start = (double)index * window_length };
+    }
+
+    rate->current.messages++;
+    rate->current.words += words;
+
+    // Counters of the message type from an earlier window
+    if (p_fmt->rate_window_no != rate->window_no)
+    {
+        p_fmt->rate_window_no = rate->window_no;
+        p_fmt->rate_window_messages = 0;
+        p_fmt->rate_window_words = 0;
+    }
+
+    p_fmt->rate_window_messages++;
+    p_fmt->rate_window_words += words;
+
+    if (p_fmt->rate_window_words > rate->current.top_words)
+    {
+        rate->current.top_words = p_fmt->rate_window_words;
+        rate->current.top_fmt_id = fmt_id;
+    }
+
+    if (p_fmt->rate_window_words > p_fmt->peak_window_words)
+    {
+        p_fmt->peak_window_words = p_fmt->rate_window_words;
+        p_fmt->peak_window_messages = p_fmt->rate_window_messages;
+        p_fmt->peak_window_start = rate->current.start;
+    }
+}
+
+
+/**
+ * @brief Finishes the last window of the logging rate statistics.
+ *        Must be called after the binary data file has been decoded.
+ */
+
+void finish_rate_statistics(void)
+{
+    if (g_msg.param.rate_window != 0)
+    {
+        finish_rate_window();
+    }
+}
+
+
+/**
+ * @brief Prints the message types with the highest logging rate in a single window.
+ *
+ * @param out  Pointer to the output file
+ */
+
+static void print_message_types_with_peak_rate(FILE *out)
+{
+    const msg_data_t *top_fmt[TOP_MESSAGES] = { 0 };
+    uint32_t top_fmt_id[TOP_MESSAGES] = { 0 };
+    unsigned msgs_found = 0;
+    const msg_data_t *p_already_processed = NULL;
+
+    for (unsigned i = 0; i < g_msg.fmt_ids_defined; i++)
+    {
+        const msg_data_t *p_fmt = g_fmt[i];
+
+        if ((p_fmt == NULL) || (p_fmt == p_already_processed) || (p_fmt->peak_window_words == 0))
+        {
+            continue;
+        }
+
+        p_already_processed = p_fmt;
+
+        if ((msgs_found >= TOP_MESSAGES)
+            && (p_fmt->peak_window_words <= top_fmt[TOP_MESSAGES - 1]->peak_window_words))
+        {
+            continue;
+        }
+
+        unsigned position;
+
+        for (position = 0; position < msgs_found; position++)
+        {
+            if (p_fmt->peak_window_words > top_fmt[position]->peak_window_words)
+            {
+                break;
+            }
+        }
+
+        if (msgs_found < TOP_MESSAGES)
+        {
+            msgs_found++;
+        }
+
+        for (unsigned nn = msgs_found - 1u; nn > position; nn--)
+        {
+            top_fmt[nn] = top_fmt[nn - 1u];
+            top_fmt_id[nn] = top_fmt_id[nn - 1u];
+        }
+
+        top_fmt[position] = p_fmt;
+        top_fmt_id[position] = i;
+    }
+
+    fprintf(out, get_message_text(MSG_RATE_PEAK_MESSAGES), g_msg.param.rate_window);
+
+    for (unsigned i = 0; i < msgs_found; i++)
+    {
+        const msg_data_t *p_fmt = top_fmt[i];
+        double words_per_second =
+            (double)p_fmt->peak_window_words * 1000.0 / (double)g_msg.param.rate_window;
+
+        fprintf(out, "\n%2u %12.0f %9u %16.6f  %s", i + 1u, words_per_second,
+            p_fmt->peak_window_messages, p_fmt->peak_window_start, rate_message_name(top_fmt_id[i]));
+    }
+}
+
+
+/**
+ * @brief Prints the windows with the highest logging rate and the message types with the
+ *        highest rate in a single window to the Stat_main.log file (-rate=N).
+ *
+ * @param out  Pointer to the output file
+ */
+
+void print_rate_statistics(FILE *out)
+{
+    const rate_stats_t *rate = &g_msg.rate;
+
+    if ((out == NULL) || (g_msg.param.rate_window == 0) || (rate->peak_windows == 0))
+    {
+        return;
+    }
+
+    fprintf(out, get_message_text(MSG_RATE_PEAK_WINDOWS), g_msg.param.rate_window, rate->window_no);
+
+    for (unsigned i = 0; i < rate->peak_windows; i++)
+    {
+        const rate_window_t *window = &rate->peak[i];
+        double words_per_second = (double)window->words * 1000.0 / (double)g_msg.param.rate_window;
+
+        fprintf(out, "\n%2u %12.6f %9u %9u %12.0f  %s (%u words)", i + 1u, window->start,
+            window->messages, window->words, words_per_second,
+            rate_message_name(window->top_fmt_id), window->top_words);
+    }
+
+    print_message_types_with_peak_rate(out);
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rate_stats.h
+ * @author  B. Premzel
+ * @brief   Header file for the logging rate statistics (-rate=N).
+ ******************************************************************************/
+
+#ifndef _RATE_STATS_H
+#define _RATE_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "main.h"
+#include "format.h"
+
+
+/***** Function declarations *****/
+void create_rate_file(void);
+void count_message_rate(msg_data_t *p_fmt, uint32_t fmt_id, uint32_t words, double timestamp);
+void finish_rate_statistics(void);
+void print_rate_statistics(FILE *out);
+
+#endif  // _RATE_STATS_H
+
+/*==== End of file ====*/
@@ -15,10 +15,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <memory.h>
+#include <signal.h>
+#include <errno.h>
 #include "read_bin_data.h"
 #include "errors.h"
 #include "files.h"
 #include "utf8_helpers.h"
+#include "decode_index.h"
+#include "compress_output.h"
 
 
 /**
@@ -43,20 +47,11 @@ int data_in_the_buffer(void)
     }
 
     // Search for the first word not equal to 0xFFFFFFFF
-    while (g_msg.index < g_msg.in_size)
-    {
-        uint32_t data = g_msg.rte_buffer[g_msg.index];
+    uint32_t erased = count_erased_bin_words(g_msg.index, g_msg.in_size);
+    g_msg.unfinished_words += erased;
+    g_msg.index += erased;
 
-        if (data != 0xFFFFFFFFuL)
-        {
-            return DATA_FOUND;
-        }
-
-        g_msg.unfinished_words++;
-        g_msg.index++;
-    }
-
-    return NO_DATA_FOUND;
+    return (g_msg.index < g_msg.in_size) ? DATA_FOUND : NO_DATA_FOUND;
 }
 
 
@@ -91,10 +86,447 @@ static uint32_t load_bin_words(uint32_t *buffer, uint32_t no_words)
 }
 
 
+#define STREAM_TAIL_RESERVE (RTEDBG_BUFFER_SIZE / 8u)
+    // Space in front of each streaming data block for the undecoded data moved from the previous blocks
+
+/* Streaming mode data blocks. The blocks are filled in order by the reader thread while
+ * the decoder processes the previously loaded ones. The decoder holds up to two blocks -
+ * the block with the undecoded remainder of the older data and the most recent block.
+ * The post-mortem and single-shot data decoded in blocks (see decode_circular_buffer_in_blocks())
+ * is read the same way - the parts of the circular buffer are read one after another.
+ */
+typedef struct _stream_reader_t
+{
+    uint32_t *block[STREAM_READ_BLOCKS];      /*!< Data blocks (STREAM_TAIL_RESERVE + RTEDBG_BUFFER_SIZE words) */
+    uint32_t  block_words[STREAM_READ_BLOCKS];/*!< Number of words loaded into the block */
+    bool      last_block[STREAM_READ_BLOCKS]; /*!< true - end of file reached or read error */
+    int       read_error[STREAM_READ_BLOCKS]; /*!< errno value if the block could not be read */
+    unsigned  blocks_loaded;        /*!< Total number of blocks filled by the reader */
+    unsigned  blocks_taken;         /*!< Total number of blocks taken by the decoder */
+    unsigned  blocks_released;      /*!< Total number of blocks released by the decoder */
+    uint32_t  words_held_back;      /*!< Incomplete message words following g_msg.in_size (-follow mode) */
+    unsigned  parts;                /*!< Number of circular buffer parts to read (0 - streaming data file) */
+    unsigned  part;                 /*!< Index of the part being read */
+    int64_t   part_offset[2];       /*!< File offsets of the parts [bytes] */
+    uint32_t  part_words[2];        /*!< Number of words of the parts not read yet */
+    bool      file_idle;            /*!< The binary file has not grown during the last poll interval */
+    bool      thread_running;       /*!< false - blocks are loaded synchronously by the decoder */
+    thread_compat_t thread;         /*!< Reader thread */
+    mutex_compat_t  lock;           /*!< Protects the block counters */
+    cond_compat_t   block_loaded;   /*!< Signaled by the reader after a block has been loaded */
+    cond_compat_t   block_released; /*!< Signaled by the decoder after a block has been released */
+} stream_reader_t;
+
+static stream_reader_t reader;
+static void *loaded_data;                       // Allocated buffer or mapped binary file with the post-mortem/single shot data
+static int64_t mapped_size;                     // Size of the mapped binary file (0 - the data has been loaded to a buffer)
+static size_t loaded_size;                      // Size of the allocated buffer with the binary data
+static const char *loaded_name;                 // Allocation name of the buffer (memory usage counters)
+static bool input_compressed;                   // The binary data file is read from a pipe of the decompression tool
+static bool input_sequential;                   // The data is read from a pipe (decompression tool or standard input)
+static volatile sig_atomic_t stop_following;   // Set by Ctrl+C in the -follow mode
+
+
+/**
+ * @brief Signal handler for Ctrl+C in the -follow mode. The reader thread finishes after
+ *        the data already written to the binary file has been loaded.
+ *
+ * @param signal_number  Not used.
+ */
+
+static void follow_mode_break_handler(int signal_number)
+{
+    (void)signal_number;
+    stop_following = 1;
+}
+
+
+/**
+ * @brief Loads the next block of streaming data from the binary data file.
+ *        Called by the reader thread (or the decoder if the thread could not be started).
+ *        Errors are not reported here, but by the decoder when it takes the block.
+ *        In the -follow mode the end of file is not the end of data. The file is checked
+ *        periodically for new data and the block is returned as soon as any data is found.
+ *
+ * @param slot  Index of the block in the reader.block[] table.
+ *
+ * @return true - last block (end of file reached or read error), false - more data to follow
+ */
+
+static bool read_circular_buffer_block(unsigned slot);
+
+static bool read_stream_block(unsigned slot)
+{
+    if (reader.parts != 0)
+    {
+        return read_circular_buffer_block(slot);
+    }
+
+    uint8_t *block = (uint8_t *)&reader.block[slot][STREAM_TAIL_RESERVE];
+    size_t bytes_read = 0;
+    unsigned idle_time = 0;
+    bool last_block = false;
+
+    for ( ;; )
+    {
+        // Read bytes - the logging tool may have written just a part of the last word
+        size_t new_bytes = fread(&block[bytes_read], 1, RTEDBG_BUFFER_SIZE * sizeof(uint32_t) - bytes_read,
+            g_msg.file.rte_data);
+        bytes_read += new_bytes;
+
+        if (new_bytes > 0)
+        {
+            idle_time = 0;
+        }
+
+        if ((bytes_read >= RTEDBG_BUFFER_SIZE * sizeof(uint32_t)) || ferror(g_msg.file.rte_data))
+        {
+            break;
+        }
+
+        last_block = !g_msg.param.follow_mode || stop_following
+            || ((g_msg.param.follow_timeout != 0) && (idle_time >= 1000u * g_msg.param.follow_timeout));
+
+        if (((bytes_read > 0) && ((bytes_read % sizeof(uint32_t)) == 0)) || last_block)
+        {
+            break;
+        }
+
+        // Return an empty block (the last message can be decoded) when the file stops growing
+        if ((bytes_read == 0) && (idle_time >= FOLLOW_IDLE_TIME) && !reader.file_idle)
+        {
+            break;
+        }
+
+        // Wait for the logging tool to append new data
+        clearerr(g_msg.file.rte_data);
+        Sleep(FOLLOW_POLL_INTERVAL);
+        idle_time += FOLLOW_POLL_INTERVAL;
+    }
+
+    reader.block_words[slot] = (uint32_t)(bytes_read / sizeof(uint32_t));
+    reader.file_idle = (bytes_read == 0);
+    reader.read_error[slot] = ferror(g_msg.file.rte_data) ? errno : 0;
+    reader.last_block[slot] = last_block || (reader.read_error[slot] != 0)
+        || (!g_msg.param.follow_mode && (reader.block_words[slot] < RTEDBG_BUFFER_SIZE));
+    return reader.last_block[slot];
+}
+
+
+/**
+ * @brief Loads the next block of the post-mortem or single-shot data decoded in blocks.
+ *        The oldest part of the circular buffer is read first. A block may contain the end
+ *        of the first part and the start of the second one - the data is passed to the decoder
+ *        in the order of logging, as if the circular buffer had been reordered.
+ *
+ * @param slot  Index of the block in the reader.block[] table.
+ *
+ * @return true - last block (all parts read or read error), false - more data to follow
+ */
+
+static bool read_circular_buffer_block(unsigned slot)
+{
+    uint32_t *block = &reader.block[slot][STREAM_TAIL_RESERVE];
+    uint32_t words_read = 0;
+    int read_error = 0;
+
+    while ((words_read < RTEDBG_BUFFER_SIZE) && (reader.part < reader.parts))
+    {
+        uint32_t words = RTEDBG_BUFFER_SIZE - words_read;
+
+        if (words > reader.part_words[reader.part])
+        {
+            words = reader.part_words[reader.part];
+        }
+
+        size_t new_words = fread(&block[words_read], sizeof(uint32_t), words, g_msg.file.rte_data);
+        words_read += (uint32_t)new_words;
+        reader.part_words[reader.part] -= (uint32_t)new_words;
+
+        if (new_words != words)
+        {
+            // A truncated file is also reported as a read error
+            read_error = (ferror(g_msg.file.rte_data) && (errno != 0)) ? errno : EIO;
+            break;
+        }
+
+        if (reader.part_words[reader.part] == 0)
+        {
+            reader.part++;
+
+            if ((reader.part < reader.parts)
+                && (fseeki64_compat(g_msg.file.rte_data, reader.part_offset[reader.part], SEEK_SET) != 0))
+            {
+                read_error = (errno != 0) ? errno : EIO;
+                break;
+            }
+        }
+    }
+
+    reader.block_words[slot] = words_read;
+    reader.read_error[slot] = read_error;
+    reader.last_block[slot] = (read_error != 0) || (reader.part >= reader.parts);
+    return reader.last_block[slot];
+}
+
+
+/**
+ * @brief Reader thread - prefetches the streaming data blocks until the end of file.
+ *        Waits for the decoder to release a block if all of them are loaded.
+ *
+ * @param arg  Not used.
+ *
+ * @return Always 0
+ */
+
+static thread_ret_compat_t THREAD_API_COMPAT stream_reader_thread(void *arg)
+{
+    (void)arg;
+    bool last_block;
+
+    do
+    {
+        mutex_lock_compat(&reader.lock);
+
+        while ((reader.blocks_loaded - reader.blocks_released) >= STREAM_READ_BLOCKS)
+        {
+            cond_wait_compat(&reader.block_released, &reader.lock);
+        }
+
+        unsigned slot = reader.blocks_loaded % STREAM_READ_BLOCKS;
+        mutex_unlock_compat(&reader.lock);
+
+        last_block = read_stream_block(slot);   // The file is read without holding the lock
+
+        mutex_lock_compat(&reader.lock);
+        reader.blocks_loaded++;
+        cond_signal_compat(&reader.block_loaded);
+        mutex_unlock_compat(&reader.lock);
+    }
+    while (!last_block);
+
+    return 0;
+}
+
+
+/**
+ * @brief Allocates the streaming data blocks and starts the reader thread.
+ *        The blocks are loaded by the decoder if the thread cannot be started.
+ */
+
+static void start_stream_reader(void)
+{
+    // The blocks are allocated once and reused for the next binary data files (-batch)
+    if (reader.block[0] == NULL)
+    {
+        for (unsigned i = 0; i < STREAM_READ_BLOCKS; i++)
+        {
+            reader.block[i] = (uint32_t *)allocate_memory(
+                (STREAM_TAIL_RESERVE + RTEDBG_BUFFER_SIZE) * sizeof(uint32_t), "binFile");
+        }
+
+        mutex_init_compat(&reader.lock);
+        cond_init_compat(&reader.block_loaded);
+        cond_init_compat(&reader.block_released);
+    }
+
+    reader.blocks_loaded = 0;
+    reader.blocks_taken = 0;
+    reader.blocks_released = 0;
+    reader.words_held_back = 0;
+    reader.file_idle = false;
+
+    if (g_msg.param.follow_mode)
+    {
+        (void)signal(SIGINT, follow_mode_break_handler);
+        printf("%s\n", get_message_text(MSG_FOLLOW_MODE_ACTIVE));
+    }
+
+    reader.thread_running = thread_create_compat(&reader.thread, stream_reader_thread, NULL);
+}
+
+
+/**
+ * @brief Checks if the reader has loaded a block that has not been taken by the decoder yet.
+ *
+ * @return true - a block can be taken without waiting
+ */
+
+static bool stream_block_ready(void)
+{
+    if (!reader.thread_running)
+    {
+        return false;
+    }
+
+    mutex_lock_compat(&reader.lock);
+    bool ready = (reader.blocks_loaded != reader.blocks_taken);
+    mutex_unlock_compat(&reader.lock);
+    return ready;
+}
+
+
+/**
+ * @brief Takes the next loaded block from the reader. Waits until the reader has loaded it.
+ *
+ * @return Index of the block in the reader.block[] table
+ */
+
+static unsigned take_stream_block(void)
+{
+    unsigned slot = reader.blocks_taken % STREAM_READ_BLOCKS;
+
+    if (g_msg.param.follow_mode)
+    {
+        fflush(NULL);   // Make the decoded data visible while waiting for new data
+    }
+
+    if (!reader.thread_running)
+    {
+        (void)read_stream_block(slot);
+        reader.blocks_loaded++;
+        reader.blocks_taken++;
+        return slot;
+    }
+
+    mutex_lock_compat(&reader.lock);
+
+    while (reader.blocks_loaded == reader.blocks_taken)
+    {
+        cond_wait_compat(&reader.block_loaded, &reader.lock);
+    }
+
+    reader.blocks_taken++;
+    mutex_unlock_compat(&reader.lock);
+
+    if (reader.last_block[slot])
+    {
+        thread_join_compat(reader.thread);  // The reader finished after loading the last block
+        reader.thread_running = false;
+    }
+
+    return slot;
+}
+
+
 /**
- * @brief Loads additional data into the buffer for binary data processing.
- *        Copies remaining data to the start of the buffer and resets the index.
- *        Loads new data into the rest of the buffer.
+ * @brief Releases the oldest block taken by the decoder so that the reader can reuse it.
+ */
+
+static void release_stream_block(void)
+{
+    mutex_lock_compat(&reader.lock);
+    reader.blocks_released++;
+    cond_signal_compat(&reader.block_released);
+    mutex_unlock_compat(&reader.lock);
+}
+
+
+/**
+ * @brief Finds the end of the complete messages in the loaded data. The last message may not
+ *        have been written completely yet (-follow mode, data passed to the rtemsg_push_words()) -
+ *        the words after the last FMT word or the following packets of a multi-packet message
+ *        may still be missing.
+ *
+ * @param file_idle  true - no more data has been written during the last poll interval. Only the
+ *                   words after the last FMT word are excluded (the packets are complete).
+ *
+ * @return Index of the first word of the last (possibly incomplete) message.
+ *         The g_msg.in_size is returned if the message start cannot be determined (bad data).
+ */
+
+uint32_t find_end_of_complete_messages(bool file_idle)
+{
+    uint32_t end = g_msg.in_size;
+    uint32_t data_words = 0;
+
+    // Find the last FMT word
+    while ((end > 0) && ((get_bin_word(end - 1u) & 1u) == 0))
+    {
+        if (++data_words >= MAX_RAW_DATA_SIZE)
+        {
+            return g_msg.in_size;   // Bad data - not a message that has not been completely written yet
+        }
+
+        end--;
+    }
+
+    if ((end == 0) || file_idle)
+    {
+        return end;
+    }
+
+    // Find the first packet of the last message (packets of a message share the timestamp and format ID)
+    uint32_t tag = get_bin_word(end - 1u) & g_msg.hdr_data.timestamp_and_index_mask;
+    uint32_t msg_start = end - 1u;     // Index of the FMT word of the first packet found so far
+
+    for (unsigned packets = 0; ; packets++)
+    {
+        if (msg_start == 0)
+        {
+            break;                  // The message starts at the beginning of the data
+        }
+
+        if (packets >= g_msg.hdr_data.max_msg_blocks)
+        {
+            return g_msg.in_size;   // Message too long
+        }
+
+        // Search for the FMT word of the previous packet (up to four DATA words in front of it)
+        uint32_t idx = msg_start;
+        uint32_t words = 0;
+
+        do
+        {
+            idx--;
+        }
+        while ((idx > 0) && (++words < 5u) && ((get_bin_word(idx) & 1u) == 0));
+
+        uint32_t data = get_bin_word(idx);
+
+        if ((data & 1u) == 0)
+        {
+            msg_start = idx;        // Start of data or DATA words without the FMT word
+            break;
+        }
+
+        if ((data & g_msg.hdr_data.timestamp_and_index_mask) != tag)
+        {
+            msg_start = idx + 1u;   // The previous packet belongs to another message
+            break;
+        }
+
+        msg_start = idx;
+    }
+
+    return msg_start;
+}
+
+
+/**
+ * @brief Excludes the last message from decoding (-follow mode). It is decoded after the next
+ *        data block has been appended or after the binary file has stopped growing.
+ *
+ * @param file_idle  true - the file has not grown during the last poll interval. Only the
+ *                   words after the last FMT word are excluded (the packets are complete).
+ */
+
+static void hold_back_incomplete_message(bool file_idle)
+{
+    uint32_t end = find_end_of_complete_messages(file_idle);
+
+    reader.words_held_back = g_msg.in_size - end;
+    g_msg.in_size = end;
+}
+
+
+/**
+ * @brief Appends the next block of streaming data to the data that has not been decoded yet.
+ *        The undecoded remainder stays in its block and the new block is accessed through
+ *        g_msg.rte_buffer_wrap (see get_bin_word()), so no data has to be moved. The remainder is
+ *        copied in front of the new block only if it extends over both blocks held by the decoder.
+ *        This happens in the -follow mode only, where partially filled blocks are decoded. Then the
+ *        function does not wait for new data while there is still undecoded data in the buffer.
  */
 
 void load_data_block(void)
@@ -104,37 +536,94 @@ void load_data_block(void)
         return;
     }
 
-    uint32_t space_in_buffer = RTEDBG_BUFFER_SIZE;
-    uint32_t remaining_words = g_msg.in_size - g_msg.index;
+    if (g_msg.index > g_msg.in_size)
+    {
+        g_msg.index = g_msg.in_size;
+    }
 
-    if (g_msg.index < g_msg.in_size)
+    if (g_msg.param.follow_mode && (g_msg.index < g_msg.in_size) && !stream_block_ready())
     {
-        if (remaining_words >= RTEDBG_BUFFER_SIZE)
+        return;
+    }
+
+    unsigned slot = take_stream_block();
+    uint32_t *new_data = &reader.block[slot][STREAM_TAIL_RESERVE];
+    uint32_t words_read = reader.block_words[slot];
+    uint32_t remaining_words = g_msg.in_size - g_msg.index + reader.words_held_back;
+    unsigned blocks_held = reader.blocks_taken - 1u - reader.blocks_released;
+    unsigned blocks_to_release = blocks_held;
+    uint32_t *remaining_data = NULL;
+
+    if (reader.last_block[slot])
+    {
+        g_msg.complete_file_loaded = true;
+
+        if (reader.read_error[slot] != 0)
+        {
+            report_problem(ERR_READ_BIN_FILE_PROBLEM, (int)words_read);
+        }
+    }
+
+    if (remaining_words > 0)
+    {
+        if (remaining_words > STREAM_TAIL_RESERVE)
         {
             report_fatal_error_and_exit(FATAL_INTERNAL_ERROR, TXT_REMAINING_WORDS, remaining_words);
         }
 
-        // Move remaining data to the start of the buffer
-        memmove(&g_msg.rte_buffer[0], &g_msg.rte_buffer[g_msg.index], sizeof(uint32_t) * remaining_words);
-        g_msg.already_processed_data += g_msg.index;
+        if (g_msg.index >= g_msg.wrap_index)
+        {
+            remaining_data = &g_msg.rte_buffer_wrap[g_msg.index - g_msg.wrap_index];
+            blocks_to_release = blocks_held - 1u;   // Keep the most recent block
+        }
+        else if (blocks_held == 1u)
+        {
+            remaining_data = &g_msg.rte_buffer[g_msg.index];
+            blocks_to_release = 0;
+        }
+        else
+        {
+            // The remainder extends over both blocks - copy it in front of the new data
+            remaining_data = new_data - remaining_words;
 
-        // Calculate available space in the buffer
-        space_in_buffer = RTEDBG_BUFFER_SIZE - remaining_words;
+            for (uint32_t i = 0; i < remaining_words; i++)
+            {
+                remaining_data[i] = get_bin_word(g_msg.index + i);
+            }
+
+            new_data = remaining_data;
+            words_read += remaining_words;
+            remaining_words = 0;
+        }
+    }
+
+    while (blocks_to_release-- > 0)
+    {
+        release_stream_block();
     }
 
+    g_msg.already_processed_data += g_msg.index;
     g_msg.index = 0;
-    g_msg.in_size -= remaining_words;
+    reader.words_held_back = 0;
 
-    if (space_in_buffer > 0)
+    if (remaining_words == 0)
     {
-        uint32_t words_read = load_bin_words(&g_msg.rte_buffer[g_msg.in_size], space_in_buffer);
+        g_msg.rte_buffer = new_data;
+        g_msg.wrap_index = NO_BUFFER_WRAP;
+    }
+    else
+    {
+        g_msg.rte_buffer = remaining_data;
+        g_msg.rte_buffer_wrap = new_data;
+        g_msg.wrap_index = remaining_words;
+    }
 
-        if ((words_read == 0) || feof(g_msg.file.rte_data))
-        {
-            g_msg.complete_file_loaded = true;
-        }
+    g_msg.in_size = remaining_words + words_read;
 
-        g_msg.in_size += words_read;     // Update the buffer size with the number of words read
+    // No new data has been written to the file during the last poll interval if the block is empty
+    if (!g_msg.complete_file_loaded)
+    {
+        hold_back_incomplete_message(reader.block_words[slot] == 0);
     }
 }
 
@@ -145,6 +634,7 @@ void load_data_block(void)
  *        The buffer index must be initialized to zero.
  *
  * @param file_size  Size of the binary file in bytes, excluding the rtedbg_header.
+ *                   The file may grow during decoding in the -follow mode.
  * 
  * NOTE: This function is untested as the tools for streaming data collection
  *       are still under development. The file format specification may change.
@@ -152,7 +642,7 @@ void load_data_block(void)
 
 static void load_streaming_log_data(__int64 file_size)
 {
-    if (file_size < 4)
+    if ((file_size < 4) && !g_msg.param.follow_mode)  // The data may not have been written yet in the -follow mode
     {
         report_fatal_error_and_exit(FATAL_NO_BIN_DATA, NULL, 0);
     }
@@ -162,87 +652,134 @@ static void load_streaming_log_data(__int64 file_size)
         report_problem(ERR_INDEX_SHOULD_BE_ZERO, g_msg.rte_header.last_index);
     }
 
-    // Allocate memory for the binary data buffer
-    g_msg.rte_buffer = (uint32_t *)allocate_memory(RTEDBG_BUFFER_SIZE * sizeof(uint32_t), "binFile");
+    // Skip the binary file header (the file has been rewound by get_file_size()) and
+    // the data before the position found in the index file (-index=file)
+    size_t start_position = get_decode_index_start();
+
+    if (!input_sequential)      // The header has already been read from the pipe
+    {
+        fseeki64_compat(g_msg.file.rte_data, (int64_t)sizeof(rtedbg_header_t) + (int64_t)start_position * 4, SEEK_SET);
+
+        if (ferror(g_msg.file.rte_data))
+        {
+            report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
+        }
+    }
+
+    // Start prefetching the data blocks from the binary data file
+    reader.parts = 0;
+    start_stream_reader();
     g_msg.rte_buffer_size = RTEDBG_BUFFER_SIZE;
 
-    // Load the initial data block from the binary data file
+    // Take the initial data block from the reader
     g_msg.in_size = 0;
     g_msg.index = 0;
+    g_msg.already_processed_data = start_position;
     g_msg.complete_file_loaded = false;
     load_data_block();
 }
 
 
 /**
- * @brief Loads post-mortem (or snapshot) data starting from the index
- *        pointing to the 'oldest' data, which was logged first.
- *        This data contains 0xFFFFFFFF if the circular buffer was not filled
- *        completely at least once. This is part 1/2 or a complete load if last_index is zero.
+ * @brief Loads the complete circular buffer contents (data following the rtedbg_header).
+ *        The binary data file is mapped into memory if possible. The data is then decoded
+ *        directly from the mapped file. Otherwise, the data is read into an allocated buffer.
+ *        Neither has spare words after the data. All reads of the decoding are limited to
+ *        g_msg.in_size (see get_bin_word(), count_erased_bin_words() and frame_next_block()).
+ *
+ * @param no_words     Number of 32-bit words to load from the binary file.
+ * @param data_size    Size of the binary file (in bytes) excluding the rtedbg_header.
+ * @param memory_name  Name of the memory block allocated if the file cannot be mapped.
  *
- * @param data_size   Number of words to load from the binary file.
- * @param index       Index from which the data should be loaded.
+ * @return Number of words loaded into the g_msg.rte_buffer.
  */
 
-static void load_post_mortem_data_part1(uint32_t data_size, uint32_t index)
+static uint32_t load_circular_buffer(uint32_t no_words, int64_t data_size, const char *memory_name)
 {
-    if (data_size > g_msg.rte_buffer_size)
+    if (input_sequential)
     {
-        report_fatal_error_and_exit(FATAL_INTERNAL_ERROR_VALUE_TOO_LARGE, "bin load 1 of 2", data_size);
-    }
+        // The data has already been read from the pipe to the buffer by the load_piped_data()
+        uint32_t words_loaded = (uint32_t)((uint64_t)data_size / sizeof(uint32_t));
+        g_msg.rte_buffer = (uint32_t *)loaded_data;
+        g_msg.rte_buffer_size = no_words;
 
-    fseek(g_msg.file.rte_data, sizeof(rtedbg_header_t) + sizeof(uint32_t) * index, SEEK_SET);
+        if (words_loaded < no_words)
+        {
+            report_problem(ERR_READ_BIN_FILE_PROBLEM, (int)words_loaded);
+            fprintf(g_msg.file.main_log, get_message_text(MSG_SIZE_SHOULD_BE), no_words);
+            memset(&g_msg.rte_buffer[words_loaded], 0xFF, (no_words - words_loaded) * sizeof(uint32_t));
+            return words_loaded;
+        }
 
-    if (ferror(g_msg.file.rte_data))
+        return no_words;
+    }
+
+    if ((data_size >= 0) && (((uint64_t)no_words * sizeof(uint32_t)) <= (uint64_t)data_size))
     {
-        report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
+        uint8_t *mapped_file = (uint8_t *)map_file_to_memory(g_msg.file.rte_data,
+            data_size + (int64_t)sizeof(rtedbg_header_t));
+
+        if (mapped_file != NULL)
+        {
+            // The mapping is read-only - the buffer contents must not be modified during decoding
+            loaded_data = mapped_file;
+            mapped_size = data_size + (int64_t)sizeof(rtedbg_header_t);
+            count_allocated_memory((size_t)mapped_size, "binMap");
+            g_msg.rte_buffer = (uint32_t *)(mapped_file + sizeof(rtedbg_header_t));
+            g_msg.rte_buffer_size = no_words;
+            return no_words;
+        }
     }
 
-    (void)load_bin_words(g_msg.rte_buffer, data_size);
+    g_msg.rte_buffer = (uint32_t *)allocate_memory((size_t)no_words * sizeof(uint32_t), memory_name);
+    loaded_data = g_msg.rte_buffer;
+    mapped_size = 0;
+    loaded_size = (size_t)no_words * sizeof(uint32_t);
+    loaded_name = memory_name;
+    g_msg.rte_buffer_size = no_words;
 
-    // Skip initial words with the value 0xFFFFFFFF (if any)
-    uint32_t i;
+    // Skip the binary file header
+    fseek(g_msg.file.rte_data, sizeof(rtedbg_header_t), SEEK_SET);
 
-    for (i = 0; i < data_size; i++)
+    if (ferror(g_msg.file.rte_data))
     {
-        if (g_msg.rte_buffer[i] != 0xFFFFFFFFuL)
-        {
-            break;
-        }
+        report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
     }
 
-    g_msg.index = i;
-    g_msg.in_size = data_size;
+    return load_bin_words(g_msg.rte_buffer, no_words);
 }
 
 
 /**
- * @brief Loads post-mortem (or snapshot) data preceding the index.
- *        Part 2/2 - data found in the buffer before last_index.
+ * @brief Prepares the post-mortem (or snapshot) data for decoding without reordering it.
+ *        Part 1 is the data after last_index (oldest data). It contains 0xFFFFFFFF if the
+ *        circular buffer was not filled completely at least once. Part 2 is the data before
+ *        last_index. The decoding continues with part 2 after the end of part 1 is reached.
  *
- * @param data_size   Size of the buffer reserved for the binary data.
- * @param start_index Index from which the data will be loaded.
+ * @param part1_index  Index of the first word of part 1 in the circular buffer.
+ * @param part1_size   Number of words in part 1.
+ * @param part2_index  Index of the first word of part 2 in the circular buffer.
+ * @param part2_size   Number of words in part 2.
  */
 
-static void load_post_mortem_data_part2(uint32_t data_size, uint32_t start_index)
+static void use_circular_buffer_in_place(uint32_t part1_index, uint32_t part1_size,
+    uint32_t part2_index, uint32_t part2_size)
 {
-    if ((data_size + g_msg.in_size) > g_msg.rte_buffer_size)
+    if (((uint64_t)part1_index + part1_size > g_msg.rte_buffer_size)
+        || ((uint64_t)part2_index + part2_size > g_msg.rte_buffer_size))
     {
-        report_fatal_error_and_exit(FATAL_INTERNAL_ERROR_VALUE_TOO_LARGE, "bin load 2 of 2", data_size);
+        report_fatal_error_and_exit(FATAL_INTERNAL_ERROR_VALUE_TOO_LARGE, "bin load",
+            (size_t)part1_size + part2_size);
     }
 
-    if (data_size > 0)
-    {
-        fseek(g_msg.file.rte_data, sizeof(rtedbg_header_t) + sizeof(uint32_t) * start_index, SEEK_SET);
+    uint32_t *buffer = g_msg.rte_buffer;
+    g_msg.rte_buffer = &buffer[part1_index];
+    g_msg.rte_buffer_wrap = &buffer[part2_index];
+    g_msg.wrap_index = part1_size;
+    g_msg.in_size = part1_size + part2_size;
 
-        if (ferror(g_msg.file.rte_data))
-        {
-            report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
-        }
-
-        uint32_t words_read = load_bin_words(&g_msg.rte_buffer[g_msg.in_size], data_size);
-        g_msg.in_size += words_read;
-    }
+    // Skip initial words with the value 0xFFFFFFFF (if any)
+    g_msg.index = count_erased_words(g_msg.rte_buffer, part1_size);
 }
 
 
@@ -251,35 +788,20 @@ static void load_post_mortem_data_part2(uint32_t data_size, uint32_t start_index
  *        The end of the circular buffer includes four additional words to speed up data logging.
  *        The FMT word (with bit 0 = 1) is the last message word.
  *
- * @param buffer_size Size of the buffer.
+ * @param last_words  Pointer to the last five words of the buffer.
  *
  * @return Number of words to skip at the end of the buffer.
  */
 
-static uint32_t check_data_at_end_of_circular_buffer(uint32_t buffer_size)
+static uint32_t check_data_at_end_of_circular_buffer(const uint32_t *last_words)
 {
-    if (buffer_size < 5UL)
-    {
-        return 0;
-    }
-
     // Have the last words in the buffer not been overwritten yet?
-    if (g_msg.rte_buffer[buffer_size - 5UL] == 0xFFFFFFFFUL)
+    if (last_words[0] == 0xFFFFFFFFUL)
     {
         return 4;   // Do not skip any data at the start of the buffer
     }
 
-    uint32_t i;
-
-    for (i = buffer_size - 5UL; i < buffer_size; i++)
-    {
-        if ((g_msg.rte_buffer[i] & 1UL) != 0)
-        {
-            break;
-        }
-    }
-
-    return buffer_size - i - 1UL;
+    return 4UL - find_word_with_bit0(last_words, 5UL);
 }
 
 
@@ -295,20 +817,7 @@ static uint32_t check_data_at_end_of_circular_buffer(uint32_t buffer_size)
 
 static uint32_t check_empty_data(uint32_t *buffer, uint32_t size)
 {
-    uint32_t counter = 0;
-
-    do
-    {
-        if (*buffer++ != 0xFFFFFFFFuL)
-        {
-            break;
-        }
-
-        counter++;
-    }
-    while (--size != 0);
-
-    return counter;
+    return count_erased_words(buffer, size);
 }
 
 /**
@@ -322,18 +831,14 @@ static uint32_t check_empty_data(uint32_t *buffer, uint32_t size)
 
 static bool empty_data_at_end_of_buffer(uint32_t last_index, uint32_t words_read)
 {
-    bool empty_data_at_end = true;
-
-    for (uint32_t i = last_index; i < words_read; i++)
+    if (last_index >= words_read)
     {
-        if (g_msg.rte_buffer[i] != 0xFFFFFFFFuL)
-        {
-            empty_data_at_end = false;
-            break;
-        }
+        return true;
     }
 
-    return empty_data_at_end;
+    uint32_t size = words_read - last_index;
+
+    return count_erased_words(&g_msg.rte_buffer[last_index], size) == size;
 }
 
 
@@ -341,11 +846,12 @@ static bool empty_data_at_end_of_buffer(uint32_t last_index, uint32_t words_read
  * @brief Validates the binary data file size against the expected buffer size from the header.
  *        Adjusts the buffer size if the file contains more or less data than expected.
  *
- * @param  data_size  Size of the binary file (in bytes) excluding the rtedbg_header.
+ * @param  data_size        Size of the binary file (in bytes) excluding the rtedbg_header.
+ * @param  max_buffer_size  Max. number of words decoded (the data size is truncated to this size).
  * @return true if the buffer size was changed, false otherwise.
  */
 
-static bool check_data_size(int64_t data_size)
+static bool check_data_size(int64_t data_size, uint32_t max_buffer_size)
 {
     bool buffer_size_changed = false;
 
@@ -363,7 +869,8 @@ static bool check_data_size(int64_t data_size)
          * less data. Buffer size is increased to the size of file although the remainder of file
          * could contain erroneous data. */
         report_problem(ERR_BIN_FILE_CONTAINS_TOO_MUCH_DATA, (int)buffer_size);
-        buffer_size = (uint32_t)((uint64_t)data_size / sizeof(uint32_t));
+        uint64_t file_words = (uint64_t)data_size / sizeof(uint32_t);
+        buffer_size = (file_words > max_buffer_size) ? (max_buffer_size + 1u) : (uint32_t)file_words;
         buffer_size_changed = true;
     }
     else if (data_size < (int64_t)(buffer_size * sizeof(uint32_t)))
@@ -374,11 +881,11 @@ static bool check_data_size(int64_t data_size)
         buffer_size_changed = true;
     }
 
-    if (buffer_size > MAX_RTEDBG_BUFFER_SIZE)
+    if (buffer_size > max_buffer_size)
     {
-        buffer_size = MAX_RTEDBG_BUFFER_SIZE;
+        buffer_size = max_buffer_size;
         buffer_size_changed = true;
-        report_problem(ERR_MESSAGE_FILE_SIZE_TRUNCATED, MAX_RTEDBG_BUFFER_SIZE * sizeof(uint32_t));
+        report_problem(ERR_MESSAGE_FILE_SIZE_TRUNCATED, max_buffer_size * sizeof(uint32_t));
     }
 
     // Ensure the last circular buffer index is within bounds.
@@ -393,6 +900,212 @@ static bool check_data_size(int64_t data_size)
 }
 
 
+/**
+ * @brief Checks if the post-mortem or single-shot data should be decoded in blocks instead of
+ *        loading (or mapping) the complete data - the -lowmem option or more data than the
+ *        MAX_RTEDBG_BUFFER_SIZE. The compressed data and the standard input are read from a pipe
+ *        and cannot be read in the order of logging.
+ *
+ * @param data_size  Size of the binary file (in bytes) excluding the rtedbg_header.
+ *
+ * @return true - decode the data in blocks
+ */
+
+static bool decode_in_blocks(int64_t data_size)
+{
+    if (input_sequential)
+    {
+        return false;
+    }
+
+    return g_msg.param.low_memory || (g_msg.rte_header.buffer_size > MAX_RTEDBG_BUFFER_SIZE)
+        || (data_size > (int64_t)MAX_RTEDBG_BUFFER_SIZE * (int64_t)sizeof(uint32_t));
+}
+
+
+/**
+ * @brief Reads words of the circular buffer from the binary data file.
+ *
+ * @param index  Index of the first word in the circular buffer.
+ * @param words  Output: words read from the file.
+ * @param count  Number of words to read.
+ *
+ * @return true - all words read
+ */
+
+static bool read_file_words(uint32_t index, uint32_t *words, uint32_t count)
+{
+    int64_t offset = (int64_t)sizeof(rtedbg_header_t) + (int64_t)index * (int64_t)sizeof(uint32_t);
+
+    return (fseeki64_compat(g_msg.file.rte_data, offset, SEEK_SET) == 0)
+        && (fread(words, sizeof(uint32_t), count, g_msg.file.rte_data) == count);
+}
+
+
+#define ERASED_WORDS_SCAN_SIZE 1024u    // Number of words checked at once by the count_erased_file_words()
+
+/**
+ * @brief Counts the words with the value 0xFFFFFFFF (not written) in the binary data file.
+ *        The search stops at the first non-empty word or on a read error.
+ *
+ * @param index  Index of the first word in the circular buffer.
+ * @param size   Number of words to check.
+ *
+ * @return The number of words that contain 0xFFFFFFFF.
+ */
+
+static uint32_t count_erased_file_words(uint32_t index, uint32_t size)
+{
+    uint32_t words[ERASED_WORDS_SCAN_SIZE];
+    uint32_t erased = 0;
+
+    while (erased < size)
+    {
+        uint32_t count = size - erased;
+
+        if (count > ERASED_WORDS_SCAN_SIZE)
+        {
+            count = ERASED_WORDS_SCAN_SIZE;
+        }
+
+        if (!read_file_words(index + erased, words, count))
+        {
+            break;      // The read error is reported when the data is decoded
+        }
+
+        uint32_t erased_words = count_erased_words(words, count);
+        erased += erased_words;
+
+        if (erased_words < count)
+        {
+            break;
+        }
+    }
+
+    return erased;
+}
+
+
+/**
+ * @brief Starts the decoding of the post-mortem or single-shot data in blocks. The streaming data
+ *        reader blocks are used instead of a buffer with the complete data, so the memory used
+ *        does not depend on the size of the circular buffer. Part 1 (the oldest data) is read
+ *        first and part 2 after it. The messages written over the end of the circular buffer are
+ *        joined by load_data_block() like the messages at the boundaries of the data blocks.
+ *        The message positions (-index=file) are the same as for the data decoded in place.
+ *
+ * @param part1_index    Index of the first word of part 1 in the circular buffer.
+ * @param part1_size     Number of words in part 1.
+ * @param part2_index    Index of the first word of part 2 in the circular buffer.
+ * @param part2_size     Number of words in part 2.
+ * @param skipped_words  Number of the erased words (0xFFFFFFFF) skipped in front of part 1.
+ */
+
+static void decode_circular_buffer_in_blocks(uint32_t part1_index, uint32_t part1_size,
+    uint32_t part2_index, uint32_t part2_size, uint32_t skipped_words)
+{
+    // Skip the data before the position found in the index file (-index=file)
+    size_t start_position = get_decode_index_start();
+    size_t skip = (start_position > skipped_words) ? (start_position - skipped_words) : 0;
+    uint32_t skip1 = (skip < part1_size) ? (uint32_t)skip : part1_size;
+    uint32_t skip2 = ((skip - skip1) < part2_size) ? (uint32_t)(skip - skip1) : part2_size;
+
+    reader.parts = 2u;
+    reader.part = 0;
+    reader.part_offset[0] = (int64_t)sizeof(rtedbg_header_t) + (int64_t)(part1_index + skip1) * 4;
+    reader.part_words[0] = part1_size - skip1;
+    reader.part_offset[1] = (int64_t)sizeof(rtedbg_header_t) + (int64_t)(part2_index + skip2) * 4;
+    reader.part_words[1] = part2_size - skip2;
+
+    if (fseeki64_compat(g_msg.file.rte_data, reader.part_offset[0], SEEK_SET) != 0)
+    {
+        report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
+    }
+
+    // Start prefetching the data blocks from the binary data file
+    start_stream_reader();
+    g_msg.rte_buffer_size = RTEDBG_BUFFER_SIZE;
+
+    // Take the initial data block from the reader
+    g_msg.in_size = 0;
+    g_msg.index = 0;
+    g_msg.already_processed_data = (size_t)skipped_words + skip1 + skip2;
+    g_msg.complete_file_loaded = false;
+    load_data_block();
+}
+
+
+/**
+ * @brief Prepares the post-mortem data for decoding in blocks (see decode_in_blocks()).
+ *        The oldest data is found the same way as by the load_post_mortem_data(), but only
+ *        the words needed to find it are read from the binary data file.
+ *
+ * @param data_size  Size of the binary file (in bytes) excluding the rtedbg_header.
+ */
+
+static void load_post_mortem_data_in_blocks(int64_t data_size)
+{
+    bool buffer_size_changed = check_data_size(data_size, MAX_RTEDBG_BUFFER_SIZE_IN_BLOCKS);
+    uint32_t last_index = g_msg.rte_header.last_index;
+    uint32_t buffer_size = g_msg.rte_header.buffer_size;
+
+    if (buffer_size > g_msg.rte_buffer_size)
+    {
+        buffer_size = g_msg.rte_buffer_size;    // Truncated by the check_data_size()
+    }
+
+    // Part 1 (data after the last_index) is empty if the circular buffer has not been filled completely
+    uint32_t part1_size = buffer_size - last_index;
+    uint32_t empty_data_at_start = count_erased_file_words(last_index, part1_size);
+
+    if (empty_data_at_start == part1_size)
+    {
+        empty_data_at_start = count_erased_file_words(0, last_index);
+        decode_circular_buffer_in_blocks(empty_data_at_start, last_index - empty_data_at_start,
+            0, 0, empty_data_at_start);
+        return;
+    }
+
+    uint32_t skip_at_start = 0;
+    uint32_t skip_at_end = 0;
+
+    if (!buffer_size_changed)
+    {
+        uint32_t last_words[5];
+
+        if ((buffer_size >= 5UL) && read_file_words(buffer_size - 5UL, last_words, 5UL))
+        {
+            skip_at_end = check_data_at_end_of_circular_buffer(last_words);
+        }
+
+        if (g_msg.hdr_data.buffer_size_is_power_of_2 && (buffer_size > (2u * 4u)))
+        {
+            skip_at_start = 4 - skip_at_end;    // See load_post_mortem_data()
+        }
+    }
+
+    if (skip_at_end > part1_size)
+    {
+        skip_at_end = part1_size;
+    }
+
+    if (skip_at_start > last_index)
+    {
+        skip_at_start = last_index;
+    }
+
+    part1_size -= skip_at_end;
+
+    if (empty_data_at_start > part1_size)
+    {
+        empty_data_at_start = part1_size;
+    }
+
+    decode_circular_buffer_in_blocks(last_index + empty_data_at_start, part1_size - empty_data_at_start,
+        skip_at_start, last_index - skip_at_start, empty_data_at_start);
+}
+
+
 /**
  * @brief Reads raw binary data from a file containing the g_rte_dbg structure from the embedded system.
  *        This function prepares data collected during post-mortem data logging mode.
@@ -401,31 +1114,26 @@ static bool check_data_size(int64_t data_size)
  *        For post-mortem logging, last_index can be anywhere in the circular buffer.
  *        Data must be reorganized so that the most recently written data in the circular buffer is decoded first.
  *        The value of last_index points to the location past the last FMT word written.
- *        Data loading is divided into two parts for better readability.
- *        Part 1 loads data after last_index (oldest data), and Part 2 loads data before last_index.
+ *        The data is not copied - it is decoded in place in two parts.
+ *        Part 1 is the data after last_index (oldest data), and Part 2 is the data before last_index.
  *
  * @param data_size  Size of the binary file (in bytes) excluding the rtedbg_header.
  */
 
 static void load_post_mortem_data(int64_t data_size)
 {
-    bool buffer_size_changed = check_data_size(data_size);
-    uint32_t last_index = g_msg.rte_header.last_index;
-
-    // Allocate the necessary buffer space
-    uint32_t buffer_size = g_msg.rte_header.buffer_size;
-    g_msg.rte_buffer_size = 16u + buffer_size;
-    g_msg.rte_buffer = (uint32_t *)allocate_memory(g_msg.rte_buffer_size * sizeof(uint32_t), "binFil2");
-
-    // Read the complete circular buffer contents
-    fseek(g_msg.file.rte_data, sizeof(rtedbg_header_t), SEEK_SET);
-
-    if (ferror(g_msg.file.rte_data))
+    if (decode_in_blocks(data_size))
     {
-        report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
+        load_post_mortem_data_in_blocks(data_size);
+        return;
     }
 
-    uint32_t words_read = load_bin_words(g_msg.rte_buffer, buffer_size);
+    bool buffer_size_changed = check_data_size(data_size, MAX_RTEDBG_BUFFER_SIZE);
+    uint32_t last_index = g_msg.rte_header.last_index;
+
+    // Load (or map) the complete circular buffer contents
+    uint32_t buffer_size = g_msg.rte_header.buffer_size;
+    uint32_t words_read = load_circular_buffer(buffer_size, data_size, "binFil2");
 
     if (words_read != buffer_size)
     {
@@ -449,14 +1157,13 @@ static void load_post_mortem_data(int64_t data_size)
     }
 
     uint32_t skip_at_start = 0;
-    uint32_t skip_at_end = check_data_at_end_of_circular_buffer(buffer_size);
+    uint32_t skip_at_end = 0;
 
-    if (buffer_size_changed)
-    {
-        skip_at_end = 0;
-    }
-    else
+    if (!buffer_size_changed)
     {
+        skip_at_end = (buffer_size < 5UL) ? 0
+            : check_data_at_end_of_circular_buffer(&g_msg.rte_buffer[buffer_size - 5UL]);
+
         if (g_msg.hdr_data.buffer_size_is_power_of_2 && (buffer_size > (2u * 4u)))
         {
             /* If the embedded system circular buffer size (RTE_BUFFER_SIZE) is a power of 2
@@ -467,8 +1174,8 @@ static void load_post_mortem_data(int64_t data_size)
         }
     }
     
-    load_post_mortem_data_part1(buffer_size - last_index - skip_at_end, last_index);
-    load_post_mortem_data_part2(last_index - skip_at_start, skip_at_start);
+    use_circular_buffer_in_place(last_index, buffer_size - last_index - skip_at_end,
+        skip_at_start, last_index - skip_at_start);
 }
 
 
@@ -489,37 +1196,117 @@ static void load_single_shot_data(int64_t data_size)
         report_fatal_error_and_exit(FATAL_SINGLE_SHOT_AND_INDEX_IS_ZERO, NULL, 0);
     }
 
-    (void)check_data_size(data_size);
+    bool in_blocks = decode_in_blocks(data_size);
+    (void)check_data_size(data_size, in_blocks ? MAX_RTEDBG_BUFFER_SIZE_IN_BLOCKS : MAX_RTEDBG_BUFFER_SIZE);
 
     uint32_t buffer_size = g_msg.rte_buffer_size;
         // Size of the data logging buffer (number of 32-bit words) including the extra 4 words (buffer trailer)
 
-    g_msg.rte_buffer = (uint32_t *)allocate_memory(buffer_size * sizeof(uint32_t), "binFil1");
-
-    // Skip the binary file header
-    fseek(g_msg.file.rte_data, sizeof(rtedbg_header_t), SEEK_SET);
-
-    if (ferror(g_msg.file.rte_data))
+    if (in_blocks)
     {
-        report_fatal_error_and_exit(ERR_BIN_DATA_FILE_FSEEK, NULL, errno);
+        if ((g_msg.hdr_data.logging_mode == MODE_SINGLE_SHOT) && (buffer_size > g_msg.rte_header.last_index))
+        {
+            buffer_size = g_msg.rte_header.last_index;
+        }
+
+        // Skip the initial words with a value of 0xFFFFFFFF (data not written)
+        uint32_t empty_data_at_start = count_erased_file_words(0, buffer_size);
+        decode_circular_buffer_in_blocks(empty_data_at_start, buffer_size - empty_data_at_start,
+            0, 0, empty_data_at_start);
+        return;
     }
 
-    // Load the captured data
-    uint32_t words_read = load_bin_words(g_msg.rte_buffer, buffer_size);
+    // Load (or map) the captured data
+    uint32_t words_read = load_circular_buffer(buffer_size, data_size, "binFil1");
     g_msg.in_size = words_read;
 
     // Skip the initial words with a value of 0xFFFFFFFF (data not written)
-    uint32_t i;
+    g_msg.index = count_erased_words(g_msg.rte_buffer, g_msg.in_size);
+}
+
+
+/**
+ * @brief Reads the post-mortem or single-shot data from the pipe of the decompression tool or from
+ *        the standard input into a single buffer, which is then decoded in place like the mapped
+ *        binary data file.
+ *        The buffer is allocated for the size defined in the header and enlarged if the file
+ *        contains more data (up to the MAX_RTEDBG_BUFFER_SIZE limit checked by check_data_size()).
+ *
+ * @return Size of the binary data (in bytes) including the rtedbg_header
+ */
+
+static int64_t load_piped_data(void)
+{
+    size_t max_words = (size_t)MAX_RTEDBG_BUFFER_SIZE + 1u;     // One word more to detect too much data
+    size_t buffer_words = g_msg.rte_header.buffer_size;
+
+    if (buffer_words > max_words)
+    {
+        buffer_words = max_words;
+    }
 
-    for (i = 0; i < g_msg.in_size; i++)
+    if (buffer_words == 0)
     {
-        if (g_msg.rte_buffer[i] != 0xFFFFFFFFuL)
+        buffer_words = 1u;
+    }
+
+    uint8_t *buffer = (uint8_t *)allocate_memory(buffer_words * sizeof(uint32_t), "binFilZ");
+    size_t bytes_read = 0;
+
+    for ( ;; )
+    {
+        bytes_read += fread(&buffer[bytes_read], 1, buffer_words * sizeof(uint32_t) - bytes_read,
+            g_msg.file.rte_data);
+
+        if ((bytes_read < buffer_words * sizeof(uint32_t)) || ferror(g_msg.file.rte_data)
+            || (buffer_words >= max_words))
         {
             break;
         }
+
+        size_t new_words = (2u * buffer_words < max_words) ? (2u * buffer_words) : max_words;
+        uint8_t *new_buffer = (uint8_t *)realloc(buffer, new_words * sizeof(uint32_t));
+
+        if (new_buffer == NULL)
+        {
+            report_fatal_error_and_exit(FATAL_MALLOC_FAILED, "binFilZ", new_words * sizeof(uint32_t));
+        }
+
+        count_allocated_memory((new_words - buffer_words) * sizeof(uint32_t), "binFilZ");
+        buffer = new_buffer;
+        buffer_words = new_words;
+    }
+
+    if (ferror(g_msg.file.rte_data))
+    {
+        report_fatal_error_and_exit(FATAL_READ_BIN_DATA_FILE, g_msg.param.data_file_name, ~1uLL);
+    }
+
+    loaded_data = buffer;
+    mapped_size = 0;
+    loaded_size = buffer_words * sizeof(uint32_t);
+    loaded_name = "binFilZ";
+    return (int64_t)bytes_read + (int64_t)sizeof(rtedbg_header_t);
+}
+
+
+/**
+ * @brief Closes the binary data file. A compressed file is reported as corrupted
+ *        if the decompression tool has not finished successfully. The standard input
+ *        remains open.
+ */
+
+static void close_binary_data_file(void)
+{
+    if (g_msg.file.rte_data == stdin)
+    {
+        return;
     }
 
-    g_msg.index = i;
+    if ((compressed_fclose(g_msg.file.rte_data) != 0) && input_compressed)
+    {
+        report_problem_with_string(ERR_DECOMPRESSION_FAILED, g_msg.param.data_file_name);
+    }
 }
 
 
@@ -531,19 +1318,39 @@ static void load_single_shot_data(int64_t data_size)
 
 void load_data_from_binary_file(void)
 {
-    int64_t size = get_file_size(g_msg.file.rte_data);
+    int64_t size;
+
+    if (!input_sequential)
+    {
+        size = get_file_size(g_msg.file.rte_data);
+    }
+    else if ((g_msg.hdr_data.logging_mode == MODE_STREAMING)
+        || (g_msg.hdr_data.logging_mode == MULTIPLE_DATA_CAPTURE))
+    {
+        size = INT64_MAX & ~3LL;    // The streaming data is read from the pipe block by block - the size is not known
+    }
+    else
+    {
+        size = load_piped_data();
+    }
 
     /* Ensure file size is a multiple of 4, as 32-bit values are recorded.
      * The check for size >= sizeof(rtedbg_header_t) is performed in load_and_check_rtedbg_header(). */
     if ((size & 3) != 0)
     {
-        report_problem(ERR_BIN_FILE_SIZE_NOT_DIVISIBLE_BY_4, 0);
+        if (!g_msg.param.follow_mode)   // The last word may be partially written in the -follow mode
+        {
+            report_problem(ERR_BIN_FILE_SIZE_NOT_DIVISIBLE_BY_4, 0);
+        }
+
         size &= ~3uLL;       // Remove any extra bytes
     }
 
     size -= sizeof(rtedbg_header_t);
         // Adjust size to exclude the header, which has already been loaded
 
+    g_msg.wrap_index = NO_BUFFER_WRAP;      // Loaded data is contiguous unless decoded in place
+
     switch (g_msg.hdr_data.logging_mode)
     {
         case MODE_POST_MORTEM:
@@ -566,22 +1373,28 @@ void load_data_from_binary_file(void)
                 }
             }
 
-            g_msg.complete_file_loaded = true;
-                // Entire data file has been loaded (unless shortened by check_data_size function)
-            fclose(g_msg.file.rte_data);
+            if (reader.parts == 0)      // Not decoded in blocks
+            {
+                g_msg.complete_file_loaded = true;
+                    // Entire data file has been loaded (unless shortened by check_data_size function)
+                close_binary_data_file();
+            }
             break;
 
         case MODE_SINGLE_SHOT:
             load_single_shot_data(size);
 
-            if (g_msg.in_size > g_msg.rte_header.last_index)
+            if (reader.parts == 0)      // Not decoded in blocks
             {
-                g_msg.in_size = g_msg.rte_header.last_index;
-            }
+                if (g_msg.in_size > g_msg.rte_header.last_index)
+                {
+                    g_msg.in_size = g_msg.rte_header.last_index;
+                }
 
-            g_msg.complete_file_loaded = true;
-                // Entire data file has been loaded (unless shortened by check_data_size function)
-            fclose(g_msg.file.rte_data);
+                g_msg.complete_file_loaded = true;
+                    // Entire data file has been loaded (unless shortened by check_data_size function)
+                close_binary_data_file();
+            }
             break;
 
         case MODE_STREAMING:
@@ -595,6 +1408,45 @@ void load_data_from_binary_file(void)
 }
 
 
+/**
+ * @brief Releases the loaded data and closes the binary data file after the decoding,
+ *        so that the next binary data file can be decoded (-batch).
+ */
+
+void release_binary_data(void)
+{
+    if ((g_msg.hdr_data.logging_mode == MODE_STREAMING) || (g_msg.hdr_data.logging_mode == MULTIPLE_DATA_CAPTURE)
+        || (reader.parts != 0))
+    {
+        // Wait for the reader thread if the decoding has been finished before the end of file
+        while (reader.thread_running)
+        {
+            (void)take_stream_block();
+            release_stream_block();
+        }
+
+        close_binary_data_file();
+    }
+    else if (mapped_size > 0)
+    {
+        unmap_file_from_memory(loaded_data, mapped_size);
+        count_released_memory((size_t)mapped_size, "binMap");
+    }
+    else
+    {
+        release_memory(loaded_data, loaded_size, loaded_name);
+    }
+
+    loaded_data = NULL;
+    mapped_size = 0;
+    loaded_size = 0;
+    reader.parts = 0;
+    g_msg.file.rte_data = NULL;
+    g_msg.rte_buffer = NULL;
+    g_msg.rte_buffer_wrap = NULL;
+}
+
+
 /**
  * @brief  Determines the data logging mode and initializes related variables.
  */
@@ -644,7 +1496,24 @@ void load_and_check_rtedbg_header(void)
         report_fatal_error_and_exit(FATAL_NO_BIN_FILE, NULL, 0);
     }
 
-    FILE *bin_data_file = utf8_fopen(g_msg.param.data_file_name, "rb");
+    // The .zst, .lz4 and .gz files are decompressed by the external zstd, lz4 or gzip tool (PATH)
+    // while they are read - see compressed_fopen()
+    input_compressed = is_compressed_file_name(g_msg.param.data_file_name);
+    input_sequential = input_compressed || (strcmp(g_msg.param.data_file_name, RTE_STDIN_DATA_FILE) == 0);
+    FILE *bin_data_file = stdin;        // Data piped directly from the capture tool ("-")
+
+    if (input_compressed)
+    {
+        bin_data_file = compressed_fopen(g_msg.param.data_file_name, "rb");
+    }
+    else if (!input_sequential)
+    {
+        bin_data_file = utf8_fopen(g_msg.param.data_file_name, "rb");
+    }
+    else
+    {
+        set_stdin_binary_compat();
+    }
 
     if (bin_data_file == NULL)
     {
@@ -654,22 +1523,41 @@ void load_and_check_rtedbg_header(void)
     g_msg.file.rte_data = bin_data_file;
 
     // Ensure the file size is at least as large as the RTEdbg structure header
-    int64_t file_size = get_file_size(bin_data_file);
-
-    if (sizeof(rtedbg_header_t) >= (uint64_t)file_size)
+    if (!input_sequential)
     {
-        report_fatal_error_and_exit(FATAL_FILE_MUST_CONTAIN_MIN_DATA_SIZE,
-            g_msg.param.data_file_name, file_size);
+        int64_t file_size = get_file_size(bin_data_file);
+
+        if (sizeof(rtedbg_header_t) >= (uint64_t)file_size)
+        {
+            report_fatal_error_and_exit(FATAL_FILE_MUST_CONTAIN_MIN_DATA_SIZE,
+                g_msg.param.data_file_name, file_size);
+        }
     }
 
     size_t data_read = fread(&g_msg.rte_header, 1, sizeof(g_msg.rte_header), bin_data_file);
 
+    if (input_sequential && !ferror(bin_data_file) && (data_read < sizeof(g_msg.rte_header)))
+    {
+        report_fatal_error_and_exit(FATAL_FILE_MUST_CONTAIN_MIN_DATA_SIZE,
+            g_msg.param.data_file_name, data_read);
+    }
+
     if ((data_read != sizeof(g_msg.rte_header)) || ferror(bin_data_file))
     {
         report_fatal_error_and_exit(FATAL_READ_BIN_DATA_FILE, g_msg.param.data_file_name, ~1uLL);
     }
 
-    // Validate the header values
+    check_rtedbg_header();
+}
+
+
+/**
+ * @brief  Validates the RTEdbg data structure header in g_msg.rte_header and prepares
+ *         the values used during the decoding.
+ */
+
+void check_rtedbg_header(void)
+{
     if (sizeof(rtedbg_header_t) != RTE_HEADER_SIZE)
     {
         report_fatal_error_and_exit(FATAL_BAD_HEADER_SIZE, NULL, 0);
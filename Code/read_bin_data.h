@@ -15,13 +15,80 @@
 #define _READ_BIN_DATA_H
 
 #include "main.h"
+#include "word_scan.h"
+
+#define NO_BUFFER_WRAP  0xFFFFFFFFuL    // Value of g_msg.wrap_index if the data is contiguous
+
+
+/**
+ * @brief Get a word from the loaded binary data. The post-mortem data is decoded in place
+ *        (without reordering the circular buffer). The oldest part of the data is at the
+ *        g_msg.rte_buffer and the remainder continues at the g_msg.rte_buffer_wrap.
+ *
+ * @param index  Index of the word in the data buffer
+ *
+ * @return Data word
+ */
+
+static inline uint32_t get_bin_word(uint32_t index)
+{
+    if (index < g_msg.wrap_index)
+    {
+        return g_msg.rte_buffer[index];
+    }
+
+    return g_msg.rte_buffer_wrap[index - g_msg.wrap_index];
+}
+
+
+/**
+ * @brief Counts the erased words (0xFFFFFFFF) in the loaded binary data starting at the index.
+ *        Both parts of the data are checked if the data is decoded in place (see get_bin_word()).
+ *
+ * @param index  Index of the first word to check
+ * @param end    Index after the last word to check
+ *
+ * @return Number of consecutive erased words
+ */
+
+static inline uint32_t count_erased_bin_words(uint32_t index, uint32_t end)
+{
+    uint32_t erased = 0;
+
+    if (index >= end)
+    {
+        return 0;
+    }
+
+    if (index < g_msg.wrap_index)
+    {
+        uint32_t part_end = (end < g_msg.wrap_index) ? end : g_msg.wrap_index;
+        erased = count_erased_words(&g_msg.rte_buffer[index], part_end - index);
+        index += erased;
+
+        if (index < part_end)
+        {
+            return erased;      // Non-erased word found before the wrap index
+        }
+    }
+
+    if (index < end)
+    {
+        erased += count_erased_words(&g_msg.rte_buffer_wrap[index - g_msg.wrap_index], end - index);
+    }
+
+    return erased;
+}
 
 int  data_in_the_buffer(void);
 void load_data_from_binary_file(void);
+void release_binary_data(void);
 void print_bin_file_header_info(void);
 void print_msg_intro(void);
 void load_and_check_rtedbg_header(void);
+void check_rtedbg_header(void);
 void load_data_block(void);
+uint32_t find_end_of_complete_messages(bool file_idle);
 
 #endif  // _READ_BIN_DATA_H
 
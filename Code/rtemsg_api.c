@@ -0,0 +1,563 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rtemsg_api.c
+ * @author  B. Premzel
+ * @brief   Programming interface of the RTEmsg decoding library (see rtemsg_api.h).
+ *          The decoding functions work with the global g_msg structure. Every
+ *          context therefore keeps its own copy of it, which is exchanged with
+ *          the g_msg when another context is used (the same way as the -batch
+ *          decoding restores it for every binary data file). The format
+ *          definitions (g_fmt[]), the value statistics, the OUT_FILE() files
+ *          and the Main.log and Errors.log files are shared by all contexts.
+ *          The API is therefore neither reentrant nor thread-safe - the calls
+ *          made while another API function is executed (i.e. from the callback
+ *          function) are rejected. The pushed words
+ *          are decoded up to the last message, which may not be complete yet.
+ *          The fatal errors return to the API function with longjmp() (see
+ *          set_fatal_error_return()) instead of terminating the application.
+ *          The context in which the error occurred can only be deleted.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <setjmp.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "format.h"
+#include "messages.h"
+#include "cmd_line.h"
+#include "fmt_cache.h"
+#include "statistics.h"
+#include "msg_framing.h"
+#include "print_message.h"
+#include "out_file_decimation.h"
+#include "print_helper.h"
+#include "process_bin_data.h"
+#include "read_bin_data.h"
+#include "rtemsg_api.h"
+
+
+/* @brief Decoding context of a single data source */
+struct rtemsg_context
+{
+    rte_msg_t state;                /*!< Decoding state while another context is in the g_msg */
+    uint32_t *buffer;               /*!< Pushed words that have not been decoded yet */
+    uint32_t buffer_size;           /*!< Size of the buffer [32b words] */
+    uint32_t words;                 /*!< Number of words in the buffer */
+    rtemsg_value_t *values;         /*!< Values of the currently decoded message */
+    rtemsg_callback_t callback;     /*!< Function receiving the decoded messages */
+    void *user_data;                /*!< User data passed to the callback function */
+    bool failed;                    /*!< A fatal error occurred - the context can only be deleted */
+};
+
+static rte_msg_t *formats_loaded_state;     // Main data structure after the format definitions have been prepared
+static rtemsg_context_t *active_context;    // Context whose state is in the g_msg (NULL - none)
+static uint32_t max_values;                 // Max. number of operations in a decode plan
+static bool formats_failed;                 // The format definitions could not be loaded
+static int last_error;                      // Number of the last fatal error (0 - none)
+static bool api_call_active;                // An API function is being executed (i.e. the callback is running)
+
+
+/**
+ * @brief Returns the value type for the callback according to the format type of the value.
+ *
+ * @param fmt_type  Format type of the value
+ *
+ * @return Value type
+ */
+
+static rtemsg_value_type_t get_value_type(enum fmt_type_t fmt_type)
+{
+    switch (fmt_type)
+    {
+        case PRINT_INT64:
+            return RTEMSG_VALUE_INT;
+
+        case PRINT_DOUBLE:
+        case PRINT_TIMESTAMP:
+        case PRINT_dTIMESTAMP:
+            return RTEMSG_VALUE_DOUBLE;
+
+        case PRINT_STRING:
+        case PRINT_SELECTED_TEXT:
+            return RTEMSG_VALUE_TEXT;
+
+        default:
+            return RTEMSG_VALUE_UINT;
+    }
+}
+
+
+/**
+ * @brief Passes the decoded message and its values to the callback function of the active
+ *        context. Called by print_message() instead of the message printing.
+ *
+ * @param p_fmt  Pointer to the formatting definitions of the message.
+ */
+
+static void deliver_decoded_message(msg_data_t *p_fmt)
+{
+    rtemsg_context_t *ctx = active_context;
+    unsigned value_count = 0;
+
+    for (uint32_t i = 0; i < p_fmt->plan_size; i++)
+    {
+        value_format_t *fmt = &p_fmt->plan[i].fmt;
+        const char *text;
+        size_t length;
+
+        // Reset the value structure to ensure no residual data is present
+        memset(&g_ctx->value, 0, sizeof(g_ctx->value));
+
+        if (fmt->fmt_type != PRINT_PLAIN_TEXT)
+        {
+            g_ctx->error_value_no++;
+        }
+
+        if (!prepare_value_for_callback(fmt, &text, &length))
+        {
+            continue;
+        }
+
+        ctx->values[value_count++] = (rtemsg_value_t)
+        {
+            .name = (fmt->value_stat != NULL) ? fmt->value_stat->name : NULL,
+            .type = get_value_type(fmt->fmt_type),
+            .u64 = g_ctx->value.data_u64,
+            .i64 = g_ctx->value.data_i64,
+            .f64 = g_ctx->value.data_double,
+            .text = text,
+            .length = length
+        };
+    }
+
+    print_decoding_errors();    // Report the errors detected during the decoding (if any)
+
+    rtemsg_message_t message =
+    {
+        .fmt_id = g_ctx->fmt_id,
+        .name = get_format_id_name(g_ctx->fmt_id),
+        .message_no = g_ctx->message_cnt,
+        .timestamp = g_ctx->timestamp,
+        .data = g_ctx->assembled_msg,
+        .size = g_ctx->asm_size,
+        .values = ctx->values,
+        .value_count = value_count,
+        .errors = g_ctx->msg_error_counter
+    };
+
+    ctx->callback(&message, ctx->user_data);
+}
+
+
+/**
+ * @brief Starts the execution of an API function. The fatal errors return to the function.
+ *
+ * @param fatal_error  Buffer prepared with the setjmp() in the API function
+ */
+
+static void begin_api_call(jmp_buf *fatal_error)
+{
+    set_fatal_error_return(fatal_error);
+    api_call_active = true;
+}
+
+
+/**
+ * @brief Finishes the execution of an API function.
+ */
+
+static void end_api_call(void)
+{
+    set_fatal_error_return(NULL);
+    api_call_active = false;
+}
+
+
+/**
+ * @brief Finishes an API call interrupted by a fatal error (see set_fatal_error_return()).
+ *        The error has been reported to Errors.log.
+ *
+ * @param ctx        Pointer to the context (NULL - no context)
+ * @param exit_code  Number of the fatal error or the exit code of the RTEmsg utility
+ */
+
+static void api_call_failed(rtemsg_context_t *ctx, int exit_code)
+{
+    end_api_call();
+    last_error = exit_code;
+    capture_file_output(NULL, NULL);    // Output of the interrupted message (decimated OUT_FILE())
+
+    if (ctx != NULL)
+    {
+        ctx->failed = true;             // The decoding state of the context is not consistent
+    }
+
+    if (g_msg.file.main_log != NULL)
+    {
+        fflush(g_msg.file.main_log);
+    }
+}
+
+
+/**
+ * @brief Returns the number of the last fatal error of the API functions. The fatal errors
+ *        are also reported to Errors.log in the output folder.
+ *
+ * @return Fatal error number (ERR_nnn) or exit code of the RTEmsg utility, 0 - no fatal error
+ */
+
+int rtemsg_last_error(void)
+{
+    return last_error;
+}
+
+
+/**
+ * @brief Loads the format definitions for all decoding contexts. The parameters are the same
+ *        as for the RTEmsg utility (argv[0] is not used): output folder, format folder and
+ *        options. The -N=value is mandatory and the compiled format definitions are used
+ *        if the -fmtcache=file is defined. The binary data file name is not needed.
+ *        The Messages.txt file must be in the folder of the application executable.
+ *
+ * @param argc  Number of parameters
+ * @param argv  Array of parameter strings
+ *
+ * @return false - errors found in the format definitions (see Errors.log), fatal error
+ *                 (see rtemsg_last_error()) or already loaded
+ */
+
+bool rtemsg_load_formats(int argc, char *argv[])
+{
+    if ((formats_loaded_state != NULL) || formats_failed || api_call_active)
+    {
+        return false;
+    }
+
+    formats_failed = true;              // The global data cannot be prepared again
+    char *volatile locale = NULL;
+    jmp_buf fatal_error;
+    int exit_code = setjmp(fatal_error);
+
+    if (exit_code != 0)
+    {
+        api_call_failed(NULL, exit_code);
+
+        if (locale != NULL)
+        {
+            setlocale(LC_ALL, locale);
+        }
+
+        if (g_msg.file.start_folder != NULL)
+        {
+            (void)_wchdir(g_msg.file.start_folder);
+        }
+
+        return false;
+    }
+
+    begin_api_call(&fatal_error);
+    setup_working_folder_info();
+    load_text_messages();               // Load text strings for errors and other messages.
+    process_command_line_parameters(argc, argv);
+    create_error_file();
+
+    // The format definitions are parsed with dots as decimal separators.
+    locale = duplicate_string(setlocale(LC_ALL, NULL));
+    setlocale(LC_ALL, "C");
+    load_format_definitions();
+    setlocale(LC_ALL, locale);
+    release_memory(locale, strlen(locale) + 1u, "StringDup");
+    locale = NULL;
+
+    if (g_msg.total_errors > 0)
+    {
+        end_api_call();
+        (void)_wchdir(g_msg.file.start_folder);     // Return to the initial working directory.
+        return false;
+    }
+
+    compile_decode_plans();
+    create_main_log_file();             // Decoding errors are reported to Main.log
+    (void)_wchdir(g_msg.file.start_folder);
+
+    max_values = 1u;
+
+    for (unsigned fmt_id = 0; fmt_id < MAX_FMT_IDS; fmt_id++)
+    {
+        if ((g_fmt[fmt_id] != NULL) && (g_fmt[fmt_id]->plan_size > max_values))
+        {
+            max_values = g_fmt[fmt_id]->plan_size;
+        }
+    }
+
+    g_msg.message_callback = deliver_decoded_message;
+    formats_loaded_state = (rte_msg_t *)allocate_memory(sizeof(rte_msg_t), "apiState");
+    *formats_loaded_state = g_msg;
+    formats_failed = false;
+    end_api_call();
+    return true;
+}
+
+
+/**
+ * @brief Saves the decoding state of the active context and loads the state of this one.
+ *
+ * @param ctx  Pointer to the context
+ */
+
+static void activate_context(rtemsg_context_t *ctx)
+{
+    if (active_context == ctx)
+    {
+        return;
+    }
+
+    if (active_context != NULL)
+    {
+        active_context->state = g_msg;
+    }
+
+    g_msg = ctx->state;
+    active_context = ctx;
+    prepare_message_framing();      // The packet lengths depend on the header of the data
+}
+
+
+/**
+ * @brief Creates a decoding context for the data logged with the RTEdbg library.
+ *
+ * @param header       Pointer to the RTEdbg data structure header (the start of a binary data file)
+ * @param header_size  Size of the header [bytes]
+ * @param callback     Function receiving the decoded messages
+ * @param user_data    User data passed to the callback function
+ *
+ * @return Pointer to the context, NULL - bad parameters, format definitions not loaded,
+ *         called from the callback function or fatal error (i.e. bad header - see rtemsg_last_error())
+ */
+
+rtemsg_context_t *rtemsg_create_context(const void *header, size_t header_size,
+    rtemsg_callback_t callback, void *user_data)
+{
+    if ((formats_loaded_state == NULL) || api_call_active || (header == NULL)
+        || (header_size != sizeof(rtedbg_header_t)) || (callback == NULL))
+    {
+        return NULL;
+    }
+
+    rtemsg_context_t *volatile new_ctx = NULL;
+    jmp_buf fatal_error;
+    int exit_code = setjmp(fatal_error);
+
+    if (exit_code != 0)
+    {
+        api_call_failed(new_ctx, exit_code);
+
+        if (new_ctx != NULL)
+        {
+            new_ctx->state = g_msg;     // The incomplete state of the new context
+            active_context = NULL;
+            rtemsg_delete_context(new_ctx);
+        }
+
+        return NULL;
+    }
+
+    begin_api_call(&fatal_error);
+    rtemsg_context_t *ctx = (rtemsg_context_t *)allocate_memory(sizeof(rtemsg_context_t), "apiCtx");
+    new_ctx = ctx;
+
+    if (active_context != NULL)
+    {
+        active_context->state = g_msg;
+    }
+
+    g_msg = *formats_loaded_state;
+    active_context = ctx;
+    memcpy(&g_msg.rte_header, header, sizeof(g_msg.rte_header));
+    check_rtedbg_header();
+    check_timestamp_diff_values();      // The timestamp period is known here
+    g_msg.complete_file_loaded = true;  // The decoding stops at the end of the pushed words
+    g_msg.wrap_index = NO_BUFFER_WRAP;
+    prepare_message_assembly();
+    prepare_message_framing();
+    reset_statistics();
+
+    ctx->buffer_size = API_PUSH_BUFFER_WORDS;
+    ctx->buffer = (uint32_t *)allocate_memory(ctx->buffer_size * sizeof(uint32_t), "apiBuf");
+    ctx->values = (rtemsg_value_t *)allocate_memory(max_values * sizeof(rtemsg_value_t), "apiValues");
+    ctx->callback = callback;
+    ctx->user_data = user_data;
+    end_api_call();
+    return ctx;
+}
+
+
+/**
+ * @brief Decodes the words in the buffer of the active context and removes the decoded ones.
+ *
+ * @param ctx     Pointer to the context
+ * @param finish  true - decode all words, false - keep the last message (it may not be complete)
+ */
+
+static void decode_pushed_words(rtemsg_context_t *ctx, bool finish)
+{
+    g_msg.rte_buffer = ctx->buffer;
+    g_msg.index = 0;
+    g_msg.in_size = ctx->words;
+
+    if (!finish)
+    {
+        g_msg.in_size = find_end_of_complete_messages(false);
+    }
+
+    if (g_msg.in_size > 0)
+    {
+        process_bin_data_worker();
+    }
+
+    uint32_t decoded = (g_msg.index < g_msg.in_size) ? g_msg.index : g_msg.in_size;
+    ctx->words -= decoded;
+    memmove(ctx->buffer, &ctx->buffer[decoded], ctx->words * sizeof(uint32_t));
+    g_msg.already_processed_data += decoded;
+    g_msg.index = 0;
+    g_msg.in_size = 0;
+    discard_message_descriptors();
+    fflush(g_msg.file.main_log);
+}
+
+
+/**
+ * @brief Adds the words to the data of the context and decodes all complete messages.
+ *        The callback function is called for every decoded message.
+ *
+ * @param ctx    Pointer to the context
+ * @param words  Pointer to the data words received from the embedded system
+ * @param count  Number of words
+ *
+ * @return false - bad parameters, the context failed before, called from the callback function
+ *                 or fatal error (see rtemsg_last_error())
+ */
+
+bool rtemsg_push_words(rtemsg_context_t *ctx, const uint32_t *words, size_t count)
+{
+    if ((ctx == NULL) || ctx->failed || api_call_active || ((words == NULL) && (count > 0))
+        || (count >= (UINT32_MAX - ctx->words)))
+    {
+        return false;
+    }
+
+    jmp_buf fatal_error;
+    int exit_code = setjmp(fatal_error);
+
+    if (exit_code != 0)
+    {
+        api_call_failed(ctx, exit_code);
+        return false;
+    }
+
+    begin_api_call(&fatal_error);
+    activate_context(ctx);
+
+    if ((ctx->words + count) > ctx->buffer_size)
+    {
+        size_t new_size = 2u * (size_t)ctx->buffer_size;
+
+        if (new_size < (ctx->words + count))
+        {
+            new_size = ctx->words + count;
+        }
+
+        if (new_size > UINT32_MAX)
+        {
+            new_size = UINT32_MAX;
+        }
+
+        uint32_t *new_buffer = (uint32_t *)allocate_memory(new_size * sizeof(uint32_t), "apiBuf");
+        memcpy(new_buffer, ctx->buffer, ctx->words * sizeof(uint32_t));
+        release_memory(ctx->buffer, ctx->buffer_size * sizeof(uint32_t), "apiBuf");
+        ctx->buffer = new_buffer;
+        ctx->buffer_size = (uint32_t)new_size;
+    }
+
+    if (count > 0)
+    {
+        memcpy(&ctx->buffer[ctx->words], words, count * sizeof(uint32_t));
+        ctx->words += (uint32_t)count;
+    }
+
+    decode_pushed_words(ctx, false);
+    end_api_call();
+    return true;
+}
+
+
+/**
+ * @brief Decodes the remaining words of the context (end of data).
+ *
+ * @param ctx  Pointer to the context
+ *
+ * @return false - bad parameter, the context failed before, called from the callback function
+ *                 or fatal error (see rtemsg_last_error())
+ */
+
+bool rtemsg_finish(rtemsg_context_t *ctx)
+{
+    if ((ctx == NULL) || ctx->failed || api_call_active)
+    {
+        return false;
+    }
+
+    jmp_buf fatal_error;
+    int exit_code = setjmp(fatal_error);
+
+    if (exit_code != 0)
+    {
+        api_call_failed(ctx, exit_code);
+        return false;
+    }
+
+    begin_api_call(&fatal_error);
+    activate_context(ctx);
+    decode_pushed_words(ctx, true);
+    flush_decimated_out_files();        // Write the last min/max values (OUT_FILE() with MINMAX=T)
+    end_api_call();
+    return true;
+}
+
+
+/**
+ * @brief Releases the context and its buffers. Not possible from the callback function.
+ *
+ * @param ctx  Pointer to the context
+ */
+
+void rtemsg_delete_context(rtemsg_context_t *ctx)
+{
+    if ((ctx == NULL) || api_call_active)
+    {
+        return;
+    }
+
+    if (active_context == ctx)
+    {
+        ctx->state = g_msg;
+        active_context = NULL;
+    }
+
+    release_message_assembly(&ctx->state);
+    discard_decimated_out_files(&ctx->state);
+    release_memory(ctx->buffer, ctx->buffer_size * sizeof(uint32_t), "apiBuf");
+    release_memory(ctx->values, max_values * sizeof(rtemsg_value_t), "apiValues");
+    release_memory(ctx, sizeof(rtemsg_context_t), "apiCtx");
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    rtemsg_api.h
+ * @author  B. Premzel
+ * @brief   Programming interface of the RTEmsg decoding library (librtemsg).
+ *          The format definitions are loaded once with rtemsg_load_formats().
+ *          A decoding context is then created for every data source with the
+ *          RTEdbg data structure header of the logged data. The data words are
+ *          passed to the context in blocks of any size with rtemsg_push_words().
+ *          Every decoded message is passed to the callback function of the
+ *          context with its values - the messages are not formatted as text.
+ *          The decoding errors are reported to the Main.log and Errors.log files
+ *          in the output folder. A fatal error (i.e. a bad header or a failed
+ *          memory allocation) is reported to Errors.log and the function returns
+ *          false or NULL - rtemsg_last_error() returns the error number. A context
+ *          with a fatal error can only be deleted.
+ *          The contexts share the global decoding state of the RTEmsg utility
+ *          (it is exchanged when another context is used). The API is therefore
+ *          strictly single-threaded and not reentrant: all functions must be
+ *          called from the same thread, and the calls made from the callback
+ *          function are rejected. The value statistics, OUT_FILE() files and
+ *          the Main.log and Errors.log files are shared by all contexts.
+ ******************************************************************************/
+
+#ifndef _RTEMSG_API_H
+#define _RTEMSG_API_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*@brief Type of a decoded value */
+typedef enum
+{
+    RTEMSG_VALUE_UINT,              /*!< Unsigned integer ("%u", "%x", "%b", message number, ...) */
+    RTEMSG_VALUE_INT,               /*!< Signed integer ("%d", "%i") */
+    RTEMSG_VALUE_DOUBLE,            /*!< Floating point value ("%f", "%g", ...) and timestamps ("%t", "%T") */
+    RTEMSG_VALUE_TEXT               /*!< String ("%s") or selected text ("%Y") */
+} rtemsg_value_type_t;
+
+/*@brief Value decoded from a message */
+typedef struct
+{
+    const char *name;               /*!< Name of the value from the statistics definition (NULL - not defined) */
+    rtemsg_value_type_t type;       /*!< Type of the value according to its format definition */
+    uint64_t u64;                   /*!< Value as an unsigned integer */
+    int64_t i64;                    /*!< Value as a signed integer */
+    double f64;                     /*!< Value as a floating point number (scaled if scaling is defined) */
+    const char *text;               /*!< Text of the RTEMSG_VALUE_TEXT values (not zero terminated) */
+    size_t length;                  /*!< Length of the text */
+} rtemsg_value_t;
+
+/*@brief Decoded message passed to the callback function */
+typedef struct
+{
+    uint32_t fmt_id;                /*!< Format ID of the message */
+    const char *name;               /*!< Name of the message type (i.e. MSG2_NAME) */
+    uint32_t message_no;            /*!< Number of the message in the data of the context */
+    double timestamp;               /*!< Timestamp of the message [s] */
+    const uint32_t *data;           /*!< Assembled message data */
+    uint32_t size;                  /*!< Size of the message data [bytes] */
+    const rtemsg_value_t *values;   /*!< Values of the message in the order of the format definition */
+    unsigned value_count;           /*!< Number of values */
+    unsigned errors;                /*!< Number of decoding errors found in the message (see Main.log) */
+} rtemsg_message_t;
+
+/* Function receiving the decoded messages. The data is valid during the call only. */
+typedef void (*rtemsg_callback_t)(const rtemsg_message_t *message, void *user_data);
+
+/* Decoding context of a single data source */
+typedef struct rtemsg_context rtemsg_context_t;
+
+
+/***** Function declarations *****/
+bool rtemsg_load_formats(int argc, char *argv[]);
+rtemsg_context_t *rtemsg_create_context(const void *header, size_t header_size,
+    rtemsg_callback_t callback, void *user_data);
+bool rtemsg_push_words(rtemsg_context_t *ctx, const uint32_t *words, size_t count);
+bool rtemsg_finish(rtemsg_context_t *ctx);
+void rtemsg_delete_context(rtemsg_context_t *ctx);
+int rtemsg_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // _RTEMSG_API_H
+
+/*==== End of file ====*/
@@ -24,18 +24,58 @@
     /* Should be at least twice the size of maximal logged message. */
     /* Larger binary files are loaded in chunks of maximally this size. */
 
+#define STREAM_READ_BLOCKS 4u             // Number of RTEDBG_BUFFER_SIZE blocks used by the streaming data reader thread
+    /* Two blocks are used by the decoder, the others are loaded in advance by the reader thread. */
+#define FOLLOW_POLL_INTERVAL        100   // Time [ms] between checks for new data in the binary file (-follow mode)
+#define FOLLOW_IDLE_TIME            500   // Time [ms] without new data after which the last message is decoded (-follow mode)
+#define MAX_PRINT_THREADS           16u   // Max. number of threads for printing of the decoded messages (-threads=N)
+    /* After changing this value, the text FATAL_BAD_THREADS_PARAMETER_VALUE has to be changed also. */
+#define PARALLEL_PRINT_BATCH      8192u   // Max. number of messages handed over to the printing threads at once
+#define PARALLEL_PRINT_DATA    0x40000u   // Size of the buffer with data of these messages [32b words]
+#define PARALLEL_PRINT_MIN_BATCH   256u   // Min. number of messages handed over at the end of a snapshot
+#define SIDE_CHANNEL_BLOCKS          4u   // Number of record blocks of the Timestamps.csv and value statistics thread
+#define SIDE_CHANNEL_BLOCK_RECORDS 8192u   // Number of records handed over to this thread at once
+#define COLUMN_BATCH_ROWS         4096u   // Number of rows written at once to the column files (-columns)
+#define DECODE_INDEX_INTERVAL    16384u   // Number of messages between the entries of the index file (-index=file)
+#define MERGE_LINE_BUFFER_SIZE    4096u   // Initial size of the line and record buffers for the merging of Main.log files (-merge)
+#define MERGE_INPUT_BUFFER_SIZE 0x40000u  // Size of the input file buffers for the merging of Main.log files [bytes]
+#define API_PUSH_BUFFER_WORDS   0x10000u  // Initial size of the buffer for the words passed to rtemsg_push_words() [32b words]
+
 #define MAX_RTEDBG_BUFFER_SIZE (uint32_t)(0x8000000 + 5)
     /* Max. number of 32b words (max. file size for post mortem or single-shot data decoding is 0.5 GiB)
      * Defines max. memory size used for the buffer with logged data */
+#define MAX_RTEDBG_BUFFER_SIZE_IN_BLOCKS (uint32_t)0x3FFFFFFFu
+    /* Max. number of 32b words of the post mortem or single-shot data decoded in blocks of
+     * RTEDBG_BUFFER_SIZE words (-lowmem or data larger than MAX_RTEDBG_BUFFER_SIZE) - 4 GiB */
 
 #define MAX_ERRORS_REPORTED          20   // Maximal number of errors reported during the format file parsing
 #define MIN_MAX_VALUES               10   // Number of min./max. values saved for each variable and timing statistics
+#define QUANTILE_SKETCH_ACCURACY   0.01   // Relative accuracy of the quantiles for the "|name:q|" value statistics
+#define QUANTILE_SKETCH_BUCKETS    2800u  // Number of sketch buckets for positive and negative values (range 1e-9 .. 2e15)
+#define QUANTILE_SKETCH_MIN_VALUE  1e-9   // Smaller absolute values are counted as zero
+#define QUANTILE_HISTOGRAM_BINS      10u  // Number of histogram bins between the min. and max. value
 #define TOP_MESSAGES                 10   // Number of top messages for which the statistics will be printed
+#define LOSS_HISTORY_MESSAGES         8u  // Number of messages before a data loss for which the format IDs are reported
+#define LOSS_DURATION_BINS            7u  // Loss duration distribution: <1 ms, <10 ms, <100 ms, <1 s, <10 s, >=10 s, unknown
+#define MAX_LOSS_EVENTS          100000u  // Max. number of data losses reported in detail (-stat=loss)
 #define MAX_FMT_ID_BITS             16u   // Max. number of index bits (2^N = max. number of different message types)
                                           // 16 = max. value to reserve 32 - 16 - 1 = minimally 15 bits for timestamps
 #define NUMBER_OF_FILTER_BITS       32u   // This value is fixed (should not be modified)
 #define MAX_ERRORS_IN_SINGLE_MESSAGE 10   // Maximal number of errors shown during single message decoding
+#define MAX_ARRAY_ELEMENTS         8192u  // Max. number of elements of an array value [nn:mmF*K]
+    /* After changing this value, the text ERR_PARSE_ARRAY_ELEMENTS has to be changed also. */
+#define ARRAY_DECODE_BLOCK          256u  // Number of array value elements converted at once
+#define LONG_TSTAMP_CHECKPOINTS    4096u  // Max. number of saved states of the last long timestamp search
+#define LONG_TSTAMP_CHECKPOINT_INTERVAL 16u // Initial number of messages between the saved search states
 #define MAX_FILE_OPEN_TIME         1500   // Max. time [ms] to wait if the fopen fails due to EACCES error
+#define FMT_PRELOAD_THREADS           8u  // Max. number of additional threads loading the format definition files
+#define MAX_PRELOADED_FMT_FILES    1024u  // Max. number of format definition files loaded before the parsing
+#define MAX_PRELOADED_FMT_FILE_SIZE 0x4000000LL // Larger format definition files are read line by line
+#define PARSE_ARENA_BLOCK_SIZE  0x10000u  // Size of memory blocks for the structures prepared during the parsing
+#define PARSE_ARENA_MAX_OBJECT_SIZE 0x1000u // Larger structures and texts are allocated separately
+#define PARSE_ARENA_ALIGNMENT        16u  // Alignment of the structures allocated from the parse arena
+#define MAX_MEMORY_NAMES             64u  // Max. number of allocation names in the memory usage report (-profile)
+#define MEMORY_NAME_CACHE_SIZE       61u  // Number of allocation name pointers cached for the memory usage counters
 
 #define MAX_TXT_MESSAGE_LENGTH      500   // Max. line length for text in Messages.txt file
 #define MAX_INPUT_LINE_LENGTH      2004   // Max. line length for the format definition files (2000 effective length)
@@ -63,7 +103,23 @@
 
 #define MAX_RAW_DATA_SIZE 256u
   // Max. number of consecutive words in circular buffer with bit 0 = 0 (when no FMT word is found)
-//#define STREAM_BUFF_SIZE (32u * 1024u)      // Experimental
+#define MAX_ERROR_REPORT_LIMIT  1000000u  // Max. number of errors of each type printed in detail (-errors=K)
+    /* After changing this value, the text FATAL_BAD_ERRORS_PARAMETER_VALUE has to be changed also. */
+#define MAX_RATE_WINDOW         3600000u  // Max. length of the logging rate statistics window [ms] (-rate=N)
+    /* After changing this value, the text FATAL_BAD_RATE_PARAMETER_VALUE has to be changed also. */
+#define MAX_QUERY_CONDITIONS        32u   // Max. number of conditions in the -query=... argument
+#define MAX_OUT_FILE_DECIMATION 1000000u  // Max. value N of the OUT_FILE() decimation DECIMATE=N
+    /* After changing this value, the text ERR_PARSE_OUT_FILE_DECIMATION has to be changed also. */
+#define MIN_OUT_FILE_MINMAX_WINDOW  1e-9  // Min. time window T of the OUT_FILE() decimation MINMAX=T [s]
+#define MAX_OUT_FILE_MINMAX_WINDOW  1e9   // Max. time window T of the OUT_FILE() decimation MINMAX=T [s]
+    /* After changing these values, the text ERR_PARSE_OUT_FILE_DECIMATION has to be changed also. */
+#define MAX_QUERY_CONTEXT      1000000u   // Max. number of messages printed after a message matching the query (-context=N)
+    /* After changing this value, the text FATAL_BAD_CONTEXT_PARAMETER_VALUE has to be changed also. */
+#define FRAME_BLOCK_WORDS    1024u
+  // Max. number of words framed in one block (see msg_framing.c)
+#define DEFAULT_OUTPUT_BUFFER_SIZE  64u   // Default size of the output file buffers [kB] (-outbuf=N)
+#define MAX_OUTPUT_BUFFER_SIZE   65536u   // Max. size of the output file buffers [kB]
+    /* After changing this value, the text FATAL_BAD_OUTBUF_PARAMETER_VALUE has to be changed also. */
 
 
 #define MAX_ENUMS 2000u // Maximal number of enumerated filters, input / output files and memories
@@ -78,6 +134,7 @@
 // The default input files
 #define RTE_MESSAGES_FILE          "Messages.txt"           // Error and other messages and printf strings
 #define RTE_MAIN_FMT_FILE          "rte_main_fmt.h"         // Main format definition file
+#define RTE_STDIN_DATA_FILE        "-"                      // Binary data file name of the standard input
 
 // Names of RTEmsg utility output files
 #define RTE_MAIN_LOG_FILE          "Main.log"               // Main log file
@@ -88,7 +145,10 @@
 #define RTE_STAT_MSG_COUNTERS_FILE "Stat_msgs_found.txt"    // Messages found during decoding
 #define RTE_STAT_MISSING_MSGS_FILE "Stat_msgs_missing.txt"  // Messages that were not detected during decoding
 #define RTE_MSG_TIMESTAMPS_FILE    "Timestamps.csv"         // Relative timestamp values
+#define RTE_STAT_RATES_FILE        "Stat_rates.csv"         // Logging rate in consecutive time windows (-rate=N)
+#define RTE_STAT_LOSSES_FILE       "Stat_losses.csv"        // Data overruns and timestamp gaps (-stat=loss)
 #define RTE_FORMAT_DBG_FILE        "Format.csv"             // Information about formatting data structures
+#define RTE_HEADER_STATE_FILE      "RTEmsg_headers.state"   // State of the generated headers (-c, in the output folder)
 
 #define DEFAULT_ERROR_REPORT       "%F:%L: error: ERR_%E %D => \"%A\"\n"
 #define TXT_MSG_RTEMSG_VERSION     "RTEmsg v%u.%02u.%02u (Build date: %s)\n"
@@ -0,0 +1,674 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    server_mode.c
+ * @author  B. Premzel
+ * @brief   Resident decode server (-server=name). The format definitions are
+ *          parsed (or loaded from the cache) only once. The server then decodes
+ *          the jobs of its clients one after another the same way as the binary
+ *          data files of the -batch mode (see batch_mode.c). The clients connect
+ *          to the Unix domain socket "name" (Linux) or to the named pipe
+ *          \\.\pipe\name (Windows) and send a single line per connection:
+ *              <binary data file><TAB><output folder><LF>
+ *          The paths are relative to the folder from which the server has been
+ *          started and must stay inside of it - absolute paths, drive names, ".."
+ *          components, control characters and shell metacharacters are rejected.
+ *          The socket (Linux) and the named pipe (Windows) can only be used by the
+ *          user who has started the server. The server replies with the exit code of the job ("%d\n")
+ *          after all output files of the job have been written and closed.
+ *          The request "-stop" stops the server. All jobs are decoded with the
+ *          command line arguments of the server. The errors of a job are reported
+ *          to Errors.log in its output folder.
+ *          The format definition files are checked before every job. If they have
+ *          been changed, the server starts itself again and hands the socket and
+ *          the connection of the waiting client over to the new process. A fatal
+ *          error during a job is replied to the client and the server is then
+ *          started again the same way. A server with errors in the format
+ *          definitions replies EXIT_FATAL_FMT_PARSING_ERRORS to all jobs until
+ *          the format definition files are changed.
+ ******************************************************************************/
+
+#include "pch.h"
+#include "platform_compat.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "errors.h"
+#include "files.h"
+#include "fmt_cache.h"
+#include "utf8_helpers.h"
+#include "batch_mode.h"
+#include "compress_output.h"
+#include "server_mode.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#define SERVER_HANDLES_VARIABLE     "RTEMSG_SERVER_HANDLES" // Handles passed over to the restarted server
+#define SERVER_STOP_REQUEST         "-stop"                 // Request which stops the server
+#define SERVER_REQUEST_LENGTH       (2u * MAX_FILEPATH_LENGTH + 16u)
+#define SERVER_LISTEN_BACKLOG       16      // Number of the client connections waiting to be accepted
+#define SERVER_MAX_INHERITED_FD     65536   // Highest file descriptor closed before the restart
+#define SERVER_PATH_FORBIDDEN_CHARS "\"'`$&|;<>*?!%:"   // Not accepted in the paths of the jobs
+#define SERVER_PIPE_SECURITY        "D:P(A;;GA;;;OW)"   // Named pipe: access for the owner only
+
+#ifdef _WIN32
+#include <sddl.h>
+typedef HANDLE server_handle_t;
+#define NO_SERVER_HANDLE            INVALID_HANDLE_VALUE
+#else
+typedef int server_handle_t;
+#define NO_SERVER_HANDLE            (-1)
+#endif
+
+
+static struct
+{
+    char **argv;                    /*!< Command line arguments for the restart of the server */
+    server_handle_t listener;       /*!< Listening socket (not used with the named pipes) */
+    server_handle_t connection;     /*!< Connection of the current client */
+    bool started;                   /*!< The handles have been prepared by the start_decode_server() */
+    bool job_active;                /*!< A job is being decoded */
+    bool restarting;                /*!< The server is being restarted - no restart after a fatal error */
+    FILE *log;                      /*!< Errors.log of the server, NULL - format definition errors */
+    char *output_folder;            /*!< Output folder of the server */
+    char request[SERVER_REQUEST_LENGTH];    /*!< Request line of the current client */
+} server;
+
+
+/**
+ * @brief Creates the Unix domain socket of the server. A socket left by a previous server
+ *        is removed. Not needed for the named pipes - a pipe instance is created for every
+ *        connection (see accept_server_connection()).
+ */
+
+static void open_server_endpoint(void)
+{
+#ifndef _WIN32
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+
+    if (strlen(g_msg.param.server_name) >= sizeof(address.sun_path))
+    {
+        report_fatal_error_and_exit(FATAL_CANT_START_SERVER, g_msg.param.server_name, 0);
+    }
+
+    strcpy(address.sun_path, g_msg.param.server_name);
+    jump_to_start_folder();
+
+    struct stat file_info;
+
+    if ((stat(address.sun_path, &file_info) == 0) && S_ISSOCK(file_info.st_mode))
+    {
+        (void)unlink(address.sun_path);
+    }
+
+    server.listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool bound = false;
+
+    if (server.listener >= 0)
+    {
+        // The socket is created with the owner-only permissions - other users cannot connect
+        mode_t old_mask = umask(S_IRWXG | S_IRWXO);
+        bound = (bind(server.listener, (struct sockaddr *)&address, sizeof(address)) == 0);
+        (void)umask(old_mask);
+    }
+
+    if (!bound || (listen(server.listener, SERVER_LISTEN_BACKLOG) != 0))
+    {
+        report_fatal_error_and_exit(FATAL_CANT_START_SERVER, g_msg.param.server_name, ~1uLL);
+    }
+#endif
+}
+
+
+/**
+ * @brief Prepares the decode server. The socket and the connection of the waiting client
+ *        are taken over if the server has been restarted. Must be called before the format
+ *        definitions are loaded - the client which has been handed over gets the result
+ *        of the format definition parsing.
+ *
+ * @param argv  Array of command line argument strings (used for the restart)
+ */
+
+void start_decode_server(char *argv[])
+{
+    if (g_msg.param.server_name == NULL)
+    {
+        return;
+    }
+
+    server.argv = argv;
+    server.listener = NO_SERVER_HANDLE;
+    server.connection = NO_SERVER_HANDLE;
+    server.started = true;
+
+    const char *handles = getenv(SERVER_HANDLES_VARIABLE);
+    long long listener = -1;
+    long long connection = -1;
+
+    if ((handles != NULL) && (sscanf(handles, "%lld,%lld", &listener, &connection) == 2))
+    {
+        server.listener = (server_handle_t)(intptr_t)listener;
+        server.connection = (server_handle_t)(intptr_t)connection;
+    }
+
+#ifdef _WIN32
+    (void)_putenv_s(SERVER_HANDLES_VARIABLE, "");
+#else
+    (void)unsetenv(SERVER_HANDLES_VARIABLE);
+
+    if (server.connection != NO_SERVER_HANDLE)
+    {
+        (void)fcntl(server.connection, F_SETFD, FD_CLOEXEC);
+    }
+
+    if (server.listener != NO_SERVER_HANDLE)
+    {
+        (void)fcntl(server.listener, F_SETFD, FD_CLOEXEC);
+        return;
+    }
+#endif
+
+    open_server_endpoint();
+}
+
+
+/**
+ * @brief Waits for the next client of the server.
+ *
+ * @return false - the connection has not been established
+ */
+
+static bool accept_server_connection(void)
+{
+#ifdef _WIN32
+    char name[MAX_FILEPATH_LENGTH];
+    snprintf(name, sizeof(name), "\\\\.\\pipe\\%s", g_msg.param.server_name);
+    SECURITY_ATTRIBUTES security = { sizeof(SECURITY_ATTRIBUTES), NULL, FALSE };
+
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorA(SERVER_PIPE_SECURITY, SDDL_REVISION_1,
+        &security.lpSecurityDescriptor, NULL))
+    {
+        report_fatal_error_and_exit(FATAL_CANT_START_SERVER, g_msg.param.server_name, 0);
+    }
+
+    HANDLE pipe = CreateNamedPipeA(name, PIPE_ACCESS_DUPLEX,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        PIPE_UNLIMITED_INSTANCES, SERVER_REQUEST_LENGTH, SERVER_REQUEST_LENGTH, 0, &security);
+    (void)LocalFree(security.lpSecurityDescriptor);
+
+    if (pipe == INVALID_HANDLE_VALUE)
+    {
+        report_fatal_error_and_exit(FATAL_CANT_START_SERVER, g_msg.param.server_name, 0);
+    }
+
+    if (!ConnectNamedPipe(pipe, NULL) && (GetLastError() != ERROR_PIPE_CONNECTED))
+    {
+        CloseHandle(pipe);
+        return false;
+    }
+
+    server.connection = pipe;
+#else
+    int connection = accept(server.listener, NULL, NULL);
+
+    if (connection < 0)
+    {
+        if ((errno == EINTR) || (errno == ECONNABORTED))
+        {
+            return false;
+        }
+
+        report_fatal_error_and_exit(FATAL_CANT_START_SERVER, g_msg.param.server_name, ~1uLL);
+    }
+
+    (void)fcntl(connection, F_SETFD, FD_CLOEXEC);   // Not inherited by the compression tools
+    server.connection = connection;
+#endif
+    return true;
+}
+
+
+/**
+ * @brief Reads the request line of the client. The line end (LF or CR LF) is removed.
+ *
+ * @return false - the connection has been closed before the complete line was received
+ */
+
+static bool read_server_request(void)
+{
+    size_t length = 0;
+
+    while (length < (sizeof(server.request) - 1u))
+    {
+        size_t space = sizeof(server.request) - 1u - length;
+#ifdef _WIN32
+        DWORD bytes_read = 0;
+
+        if (!ReadFile(server.connection, &server.request[length], (DWORD)space, &bytes_read, NULL))
+        {
+            return false;
+        }
+
+        long long received = (long long)bytes_read;
+#else
+        long long received = (long long)recv(server.connection, &server.request[length], space, 0);
+
+        if ((received < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+#endif
+
+        if (received <= 0)
+        {
+            return false;
+        }
+
+        length += (size_t)received;
+        server.request[length] = '\0';
+        char *line_end = strchr(server.request, '\n');
+
+        if (line_end != NULL)
+        {
+            if ((line_end > server.request) && (line_end[-1] == '\r'))
+            {
+                line_end--;
+            }
+
+            *line_end = '\0';
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief Closes the connection of the current client.
+ */
+
+static void close_server_connection(void)
+{
+#ifdef _WIN32
+    (void)DisconnectNamedPipe(server.connection);
+    CloseHandle(server.connection);
+#else
+    (void)close(server.connection);
+#endif
+    server.connection = NO_SERVER_HANDLE;
+}
+
+
+/**
+ * @brief Sends the exit code of the job to the client and closes the connection.
+ *
+ * @param exit_code  Exit code of the job (the same as of a single RTEmsg run)
+ */
+
+static void finish_server_connection(int exit_code)
+{
+    char reply[16];
+    int length = snprintf(reply, sizeof(reply), "%d\n", exit_code);
+
+#ifdef _WIN32
+    DWORD bytes_written;
+    (void)WriteFile(server.connection, reply, (DWORD)length, &bytes_written, NULL);
+    (void)FlushFileBuffers(server.connection);
+#else
+    (void)send(server.connection, reply, (size_t)length, MSG_NOSIGNAL);
+#endif
+    close_server_connection();
+}
+
+
+#ifndef _WIN32
+/**
+ * @brief Closes the files before the restart - only the socket and the connection of the
+ *        client are inherited by the new process.
+ */
+
+static void close_inherited_files(void)
+{
+    long max_fd = sysconf(_SC_OPEN_MAX);
+
+    if ((max_fd < 0) || (max_fd > SERVER_MAX_INHERITED_FD))
+    {
+        max_fd = SERVER_MAX_INHERITED_FD;
+    }
+
+    for (int fd = STDERR_FILENO + 1; fd < (int)max_fd; fd++)
+    {
+        if ((fd != server.listener) && (fd != server.connection))
+        {
+            (void)close(fd);
+        }
+    }
+
+    (void)fcntl(server.listener, F_SETFD, 0);
+
+    if (server.connection != NO_SERVER_HANDLE)
+    {
+        (void)fcntl(server.connection, F_SETFD, 0);
+    }
+}
+#endif
+
+
+/**
+ * @brief Starts the server again with the same command line arguments. The socket and the
+ *        connection of the current client are handed over to the new process.
+ */
+
+static __declspec(noreturn) void restart_server(void)
+{
+    char handles[64];
+    char *program_path = NULL;
+
+    server.restarting = true;
+    snprintf(handles, sizeof(handles), "%lld,%lld",
+        (long long)(intptr_t)server.listener, (long long)(intptr_t)server.connection);
+    close_compressed_files();
+    _fcloseall();
+    (void)_wchdir(g_msg.file.start_folder);     // The folder names are relative to the start folder
+
+#ifdef _WIN32
+    (void)_putenv_s(SERVER_HANDLES_VARIABLE, handles);
+
+    if (server.connection != NO_SERVER_HANDLE)
+    {
+        (void)SetHandleInformation(server.connection, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+    }
+
+    if (_get_pgmptr(&program_path) == 0)
+    {
+        (void)_execv(program_path, (const char * const *)server.argv);
+    }
+#else
+    (void)setenv(SERVER_HANDLES_VARIABLE, handles, 1);
+    close_inherited_files();
+
+    if (_get_pgmptr(&program_path) == 0)
+    {
+        (void)execv(program_path, server.argv);
+    }
+#endif
+
+    char text[MAX_UTF8_TEXT_LENGTH];
+    snprintf(text, sizeof(text), get_message_text(FATAL_CANT_START_SERVER), g_msg.param.server_name);
+    report_error_and_exit(text, EXIT_FATAL_ERR_PGMPTR);
+}
+
+
+/**
+ * @brief Waits for the next request of a client. The format definition files are checked
+ *        after a client has connected - the server is restarted if they have been changed
+ *        and the new process reads the request.
+ *
+ * @return false - the server has been stopped by a client
+ */
+
+static bool wait_for_server_request(void)
+{
+    for ( ;; )
+    {
+        // The connection handed over by the restarted server is used first
+        if (server.connection == NO_SERVER_HANDLE)
+        {
+            if (!accept_server_connection())
+            {
+                continue;
+            }
+
+            if (format_definitions_changed())
+            {
+                if (server.log != NULL)
+                {
+                    fprintf(server.log, get_message_text(MSG_SERVER_FORMATS_CHANGED));
+                }
+
+                restart_server();
+            }
+        }
+
+        if (!read_server_request())
+        {
+            close_server_connection();
+            continue;
+        }
+
+        if (strcmp(server.request, SERVER_STOP_REQUEST) == 0)
+        {
+            finish_server_connection(0);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+
+/**
+ * @brief Checks a path of the job request. The clients may only use the files and folders
+ *        inside of the folder from which the server has been started.
+ *
+ * @param path  Binary data file name or output folder name
+ *
+ * @return false - absolute path, drive name, ".." component, control character or
+ *                 shell metacharacter found
+ */
+
+static bool server_path_is_safe(const char *path)
+{
+    if ((path[0] == '\0') || (path[0] == '/') || (path[0] == '\\'))
+    {
+        return false;
+    }
+
+    for (const char *c = path; *c != '\0'; c++)
+    {
+        if (((unsigned char)*c < ' ') || (strchr(SERVER_PATH_FORBIDDEN_CHARS, *c) != NULL))
+        {
+            return false;
+        }
+    }
+
+    for (const char *component = path; ; )
+    {
+        size_t length = strcspn(component, "/\\");
+
+        if ((length == 2u) && (component[0] == '.') && (component[1] == '.'))
+        {
+            return false;
+        }
+
+        if (component[length] == '\0')
+        {
+            return true;
+        }
+
+        component += length + 1u;
+    }
+}
+
+
+/**
+ * @brief Prepares the binary data file name and the output folder of the job from the
+ *        request. The output folder is created if it does not exist yet.
+ *
+ * @return false - incorrect request or a path outside of the folder of the server
+ */
+
+static bool prepare_server_job(void)
+{
+    char *separator = strchr(server.request, '\t');
+
+    if ((separator == NULL) || (separator == server.request) || (separator[1] == '\0')
+        || (strchr(&separator[1], '\t') != NULL))
+    {
+        return false;
+    }
+
+    *separator = '\0';
+    g_msg.param.data_file_name = prepare_folder_name(server.request, 0);
+    g_msg.param.working_folder = prepare_folder_name(&separator[1], 0);
+
+    if (strcmp(g_msg.param.data_file_name, RTE_STDIN_DATA_FILE) == 0)
+    {
+        return false;       // The standard input of the server is not the data of the client
+    }
+
+    if (!server_path_is_safe(g_msg.param.data_file_name) || !server_path_is_safe(g_msg.param.working_folder))
+    {
+        return false;
+    }
+
+    // A problem with the folder creation is reported by the open_output_folder()
+    jump_to_start_folder();
+    _set_errno(0);
+    (void)utf8_mkdir(g_msg.param.working_folder);
+    return true;
+}
+
+
+/**
+ * @brief Saves the state prepared by the format definition parsing for the decoding of the jobs.
+ */
+
+void prepare_server_jobs(void)
+{
+    prepare_batch_decoding();
+    server.log = g_msg.file.error_log;
+    server.output_folder = g_msg.param.working_folder;
+}
+
+
+/**
+ * @brief Waits for the next job and prepares its decoding. Incorrect requests are replied
+ *        with EXIT_FATAL_ERR_BAD_PARAMETERS.
+ *
+ * @return false - the server has been stopped by a client
+ */
+
+bool start_next_server_job(void)
+{
+    for ( ;; )
+    {
+        if (!wait_for_server_request())
+        {
+            return false;
+        }
+
+        restore_decoding_start_state();
+
+        if (prepare_server_job())
+        {
+            break;
+        }
+
+        finish_server_connection(EXIT_FATAL_ERR_BAD_PARAMETERS);
+    }
+
+    fprintf(server.log, get_message_text(MSG_BATCH_DATA_FILE),
+        g_msg.param.data_file_name, g_msg.param.working_folder);
+    fflush(server.log);
+    server.job_active = true;
+    create_error_file();                // Errors.log of the job
+    prepare_data_file_outputs();
+    return true;
+}
+
+
+/**
+ * @brief Closes Errors.log of the job and sends the exit code to the client. Must be called
+ *        after the finish_batch_file().
+ */
+
+void finish_server_job(void)
+{
+    int exit_code = 0;
+
+    if (g_msg.total_errors > 0)
+    {
+        exit_code = g_msg.binary_file_decoding_finished ?
+            EXIT_NON_FATAL_DECODING_ERRORS_DETECTED : EXIT_FATAL_DECODING_ERRORS_DETECTED;
+    }
+
+    close_output_file(g_msg.file.error_log);
+    g_msg.file.error_log = server.log;
+    g_msg.file.main_log = server.log;
+    g_msg.param.working_folder = server.output_folder;
+    server.job_active = false;
+    finish_server_connection(exit_code);
+}
+
+
+/**
+ * @brief Replies the exit code to all jobs until the format definition files are changed
+ *        or the server is stopped. Used if the format definitions could not be prepared.
+ *
+ * @param exit_code  Exit code for all jobs
+ */
+
+void reject_server_jobs(int exit_code)
+{
+    while (wait_for_server_request())
+    {
+        finish_server_connection(exit_code);
+    }
+
+    finish_decode_server();
+}
+
+
+/**
+ * @brief Removes the socket of the stopped server. The errors of the jobs have been reported
+ *        to the clients - they are not included in the exit code of the server.
+ */
+
+void finish_decode_server(void)
+{
+#ifndef _WIN32
+    (void)close(server.listener);
+    jump_to_start_folder();
+    (void)unlink(g_msg.param.server_name);
+#endif
+    server.listener = NO_SERVER_HANDLE;
+    g_msg.total_errors = 0;
+}
+
+
+/**
+ * @brief Called before the application exits because of a fatal error. The exit code is sent
+ *        to the client. The server is started again if the error occurred during a job.
+ *
+ * @param exit_code  Exit code of the application
+ */
+
+void finish_server_job_after_fatal_error(int exit_code)
+{
+    if (!server.started || server.restarting)
+    {
+        return;
+    }
+
+    if (server.connection != NO_SERVER_HANDLE)
+    {
+        finish_server_connection(exit_code);
+    }
+
+    if (server.job_active)
+    {
+        restart_server();
+    }
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    server_mode.h
+ * @author  B. Premzel
+ * @brief   Resident decode server (-server=name).
+ *
+ *          The server keeps the prepared format definitions and decodes the
+ *          jobs (binary data file and output folder) received over a local
+ *          socket or named pipe. The exit code of every job is sent back to
+ *          the client after the output files have been closed.
+ ******************************************************************************/
+
+#ifndef _SERVER_MODE_H
+#define _SERVER_MODE_H
+
+#include <stdbool.h>
+
+
+/***** Function declarations *****/
+void start_decode_server(char *argv[]);
+void prepare_server_jobs(void);
+bool start_next_server_job(void);
+void finish_server_job(void);
+void reject_server_jobs(int exit_code);
+void finish_decode_server(void);
+void finish_server_job_after_fatal_error(int exit_code);
+
+#endif  // _SERVER_MODE_H
+
+/*==== End of file ====*/
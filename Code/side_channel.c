@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    side_channel.c
+ * @author  B. Premzel
+ * @brief   Writing of Timestamps.csv and processing of the value statistics in
+ *          a separate thread. The decoding thread stores compact records with
+ *          the message number, timestamp or value in a block without any locking.
+ *          Full blocks are handed over to the side channel thread, which writes
+ *          the timestamps and adds the values to the statistics in the message
+ *          order. The decoding thread waits only if all blocks are in use.
+ *          The records are processed by the decoding thread if the side channel
+ *          thread cannot be started.
+ ******************************************************************************/
+
+#include "pch.h"
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "format.h"
+#include "print_helper.h"
+#include "statistics.h"
+#include "side_channel.h"
+
+
+/* Record handed over to the side channel thread */
+typedef struct
+{
+    value_stats_t *stat;            /*!< Value statistics or NULL for a Timestamps.csv line */
+    double value;                   /*!< Value for the statistics or timestamp [time units] */
+    double time_difference;         /*!< Time since the previous message [time units] */
+    uint32_t message_no;            /*!< Number of the message */
+} side_record_t;
+
+
+static struct
+{
+    bool running;                   /*!< false - the records are processed by the decoding thread */
+    thread_compat_t thread;
+    mutex_compat_t lock;            /*!< Protects the block counters */
+    cond_compat_t block_filled;     /*!< Signalled by the decoding thread after a block has been handed over */
+    cond_compat_t block_processed;  /*!< Signalled by the side channel thread after a block has been processed */
+    side_record_t *block[SIDE_CHANNEL_BLOCKS];
+    uint32_t block_records[SIDE_CHANNEL_BLOCKS];   /*!< Number of records in the handed over blocks */
+    uint32_t blocks_filled;         /*!< Number of blocks handed over to the side channel thread */
+    uint32_t blocks_processed;      /*!< Number of blocks processed by the side channel thread */
+    side_record_t *current;         /*!< Block filled by the decoding thread */
+    uint32_t records;               /*!< Number of records in the current block */
+} side;
+
+
+/**
+ * @brief Writes a timestamp to Timestamps.csv or adds a value to its statistics.
+ *
+ * @param record  Pointer to the record
+ */
+
+static void process_side_record(const side_record_t *record)
+{
+    if (record->stat != NULL)
+    {
+        value_statistic(record->stat, record->value, record->message_no);
+    }
+    else if (g_msg.file.timestamps != NULL)
+    {
+        print_message_number(g_msg.file.timestamps, record->message_no);
+        fprintf(g_msg.file.timestamps, ";%8.6f;%g\n", record->value, record->time_difference);
+    }
+}
+
+
+/**
+ * @brief Side channel thread. Processes the blocks handed over by the decoding thread.
+ *
+ * @param arg  Not used
+ *
+ * @return Always 0 (the thread runs until the application exits)
+ */
+
+static thread_ret_compat_t THREAD_API_COMPAT side_channel_thread(void *arg)
+{
+    (void)arg;
+
+    for ( ;; )
+    {
+        mutex_lock_compat(&side.lock);
+
+        while (side.blocks_processed == side.blocks_filled)
+        {
+            cond_wait_compat(&side.block_filled, &side.lock);
+        }
+
+        unsigned index = side.blocks_processed % SIDE_CHANNEL_BLOCKS;
+        uint32_t records = side.block_records[index];
+        mutex_unlock_compat(&side.lock);
+
+        const side_record_t *record = side.block[index];
+
+        for (uint32_t i = 0; i < records; i++)
+        {
+            process_side_record(&record[i]);
+        }
+
+        mutex_lock_compat(&side.lock);
+        side.blocks_processed++;
+        cond_signal_compat(&side.block_processed);
+        mutex_unlock_compat(&side.lock);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief Hands over the current block to the side channel thread and waits until the
+ *        next block is free.
+ */
+
+static void hand_over_side_block(void)
+{
+    if (side.records == 0)
+    {
+        return;
+    }
+
+    mutex_lock_compat(&side.lock);
+    side.block_records[side.blocks_filled % SIDE_CHANNEL_BLOCKS] = side.records;
+    side.blocks_filled++;
+    cond_signal_compat(&side.block_filled);
+
+    while ((side.blocks_filled - side.blocks_processed) >= SIDE_CHANNEL_BLOCKS)
+    {
+        cond_wait_compat(&side.block_processed, &side.lock);
+    }
+
+    mutex_unlock_compat(&side.lock);
+
+    side.current = side.block[side.blocks_filled % SIDE_CHANNEL_BLOCKS];
+    side.records = 0;
+}
+
+
+/**
+ * @brief Adds a record to the current block or processes it immediately if the
+ *        side channel thread is not running.
+ *
+ * @param record  Pointer to the record
+ */
+
+static void put_side_record(const side_record_t *record)
+{
+    if (!side.running)
+    {
+        process_side_record(record);
+        return;
+    }
+
+    side.current[side.records++] = *record;
+
+    if (side.records >= SIDE_CHANNEL_BLOCK_RECORDS)
+    {
+        hand_over_side_block();
+    }
+}
+
+
+/**
+ * @brief Starts the side channel thread if Timestamps.csv or value statistics are enabled.
+ *        The thread is started only once for all binary data files (-batch).
+ */
+
+void start_side_channel(void)
+{
+    if (side.running
+        || (!g_msg.param.create_timestamp_file && !g_msg.param.value_statistics_enabled))
+    {
+        return;
+    }
+
+    for (unsigned i = 0; i < SIDE_CHANNEL_BLOCKS; i++)
+    {
+        side.block[i] = (side_record_t *)allocate_memory(
+            SIDE_CHANNEL_BLOCK_RECORDS * sizeof(side_record_t), "sideBlk");
+    }
+
+    mutex_init_compat(&side.lock);
+    cond_init_compat(&side.block_filled);
+    cond_init_compat(&side.block_processed);
+    side.current = side.block[0];
+    side.records = 0;
+    side.running = thread_create_compat(&side.thread, side_channel_thread, NULL);
+}
+
+
+/**
+ * @brief Logs the timestamp of a message to the Timestamps.csv file.
+ *
+ * @param message_no       Number of the message
+ * @param timestamp        Timestamp of the message [time units]
+ * @param time_difference  Time since the previous message [time units]
+ */
+
+void side_channel_timestamp(uint32_t message_no, double timestamp, double time_difference)
+{
+    side_record_t record =
+    {
+        .stat = NULL,
+        .value = timestamp,
+        .time_difference = time_difference,
+        .message_no = message_no
+    };
+
+    put_side_record(&record);
+}
+
+
+/**
+ * @brief Adds a value to the value statistics.
+ *
+ * @param stat        Pointer to the value statistics
+ * @param value       Value
+ * @param message_no  Number of the message which contains the value
+ */
+
+void side_channel_value(value_stats_t *stat, double value, uint32_t message_no)
+{
+    side_record_t record =
+    {
+        .stat = stat,
+        .value = value,
+        .time_difference = 0,
+        .message_no = message_no
+    };
+
+    put_side_record(&record);
+}
+
+
+/**
+ * @brief Adds the elements of an array value [nn:mmF*K] to the value statistics.
+ *
+ * @param stat        Pointer to the value statistics
+ * @param values      Array of values
+ * @param count       Number of values
+ * @param message_no  Number of the message which contains the values
+ */
+
+void side_channel_values(value_stats_t *stat, const double *values, uint32_t count, uint32_t message_no)
+{
+    side_record_t record =
+    {
+        .stat = stat,
+        .value = 0,
+        .time_difference = 0,
+        .message_no = message_no
+    };
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        record.value = values[i];
+        put_side_record(&record);
+    }
+}
+
+
+/**
+ * @brief Waits until all records have been processed by the side channel thread.
+ *        Must be called before Timestamps.csv is closed and the value statistics are
+ *        used outside of the message decoding.
+ */
+
+void flush_side_channel(void)
+{
+    if (!side.running)
+    {
+        return;
+    }
+
+    hand_over_side_block();
+
+    mutex_lock_compat(&side.lock);
+
+    while (side.blocks_processed != side.blocks_filled)
+    {
+        cond_wait_compat(&side.block_processed, &side.lock);
+    }
+
+    mutex_unlock_compat(&side.lock);
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    side_channel.h
+ * @author  B. Premzel
+ * @brief   Header file for the Timestamps.csv and value statistics side channel.
+ ******************************************************************************/
+
+#ifndef _SIDE_CHANNEL_H
+#define _SIDE_CHANNEL_H
+
+#include <stdint.h>
+#include "format.h"
+
+
+/***** Function declarations *****/
+void start_side_channel(void);
+void side_channel_timestamp(uint32_t message_no, double timestamp, double time_difference);
+void side_channel_value(value_stats_t *stat, double value, uint32_t message_no);
+void side_channel_values(value_stats_t *stat, const double *values, uint32_t count, uint32_t message_no);
+void flush_side_channel(void);
+
+#endif  // _SIDE_CHANNEL_H
+
+/*==== End of file ====*/
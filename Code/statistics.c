@@ -23,6 +23,8 @@
 #include "statistics.h"
 #include "print_message.h"
 #include "print_helper.h"
+#include "rate_stats.h"
+#include "loss_report.h"
 
 
 /**
@@ -136,34 +138,82 @@ static void determine_maximal_value(double *max_values, uint32_t *msg_numbers, d
 
 
 /**
- * @brief Process the value statistics for the currently processed value
+ * @brief Adds a value to the value statistics (called by the side channel - see side_channel.c)
  *
- * @param p_fmt    Pointer to the structure with current message formatting parameters
- * @param format   Pointer to the structure with current value parameters
+ * @param stat        Pointer to the value statistics
+ * @param value       Value
+ * @param message_no  Number of the message which contains the value
  */
 
-void value_statistic(msg_data_t *p_fmt, value_format_t *format)
+void value_statistic(value_stats_t *stat, double value, uint32_t message_no)
 {
-    if ((format == NULL) || (p_fmt == NULL))
+    if (stat == NULL)
     {
         return;
     }
 
-    value_stats_t *stat = format->value_stat;
+    determine_minimal_value(stat->min, stat->min_msg_no, value, message_no, stat->counter);
+    determine_maximal_value(stat->max, stat->max_msg_no, value, message_no, stat->counter);
 
-    if (stat == NULL)
+    // Prepare data for the average value
+    stat->counter++;
+    stat->sum += value;
+
+    if (stat->quantiles)
     {
-        return;
+        if (stat->sketch == NULL)
+        {
+            stat->sketch = create_quantile_sketch();
+        }
+
+        add_to_quantile_sketch(stat->sketch, value);
     }
+}
 
-    determine_minimal_value(stat->min, stat->min_msg_no, g_msg.value.data_double, g_msg.message_cnt,
-                            stat->counter);
-    determine_maximal_value(stat->max, stat->max_msg_no, g_msg.value.data_double, g_msg.message_cnt,
-                            stat->counter);
 
-    // Prepare data for the average value
-    stat->counter++;
-    stat->sum += g_msg.value.data_double;
+/**
+ * @brief Print the estimated quantiles and histogram for one of the values ("|name:q|")
+ *
+ * @param out     Pointer to the output file
+ * @param sketch  Pointer to the quantile sketch of the value
+ */
+
+static void write_quantiles_for_one_value(FILE *out, const quantile_sketch_t *sketch)
+{
+    static const double quantiles[] = { 0.5, 0.9, 0.95, 0.99, 0.999 };
+    const unsigned no_quantiles = sizeof(quantiles) / sizeof(quantiles[0]);
+
+    fprintf(out, get_message_text(MSG_VALUE_STATISTICS_QUANTILES));
+
+    for (unsigned i = 0; i < no_quantiles; i++)
+    {
+        fprintf(out, ";%g%%", 100.0 * quantiles[i]);
+    }
+
+    fprintf(out, get_message_text(MSG_VALUE_STATISTICS_QUANTILE_VALUES));
+
+    for (unsigned i = 0; i < no_quantiles; i++)
+    {
+        fprintf(out, ";%g", get_sketch_quantile(sketch, quantiles[i]));
+    }
+
+    uint32_t bin_count[QUANTILE_HISTOGRAM_BINS];
+    get_sketch_histogram(sketch, bin_count, QUANTILE_HISTOGRAM_BINS);
+    double bin_width = (sketch->max - sketch->min) / (double)QUANTILE_HISTOGRAM_BINS;
+
+    fprintf(out, get_message_text(MSG_VALUE_STATISTICS_HISTOGRAM));
+
+    for (unsigned i = 0; i < QUANTILE_HISTOGRAM_BINS; i++)
+    {
+        fprintf(out, ";%g", sketch->min + (double)i * bin_width);
+    }
+
+    fprintf(out, get_message_text(MSG_VALUE_STATISTICS_HISTOGRAM_COUNT));
+
+    for (unsigned i = 0; i < QUANTILE_HISTOGRAM_BINS; i++)
+    {
+        fprintf(out, ";%u", bin_count[i]);
+    }
 }
 
 
@@ -231,6 +281,11 @@ static void write_data_for_one_value(FILE *out, const char *message_name, value_
         fputc(';', out);
     }
 
+    if (p_val->value_stat->sketch != NULL)
+    {
+        write_quantiles_for_one_value(out, p_val->value_stat->sketch);
+    }
+
     fprintf(out, get_message_text(MSG_VALUE_STATISTICS_MSG_AVERAGE),
         p_val->value_stat->sum / (double)p_val->value_stat->counter, p_val->value_stat->counter);
 }
@@ -533,6 +588,8 @@ void print_common_statistics(void)
         print_messages_with_top_frequencies();
         print_messages_with_top_buffer_usage();
     }
+
+    print_rate_statistics(out);
 }
 
 
@@ -603,9 +660,11 @@ void write_statistics_to_file(void)
 {
     // Add all counter values to the counter_total to get correct statistical data
     reset_statistics();
+    finish_rate_statistics();
 
     open_output_folder();
     print_common_statistics();
+    write_loss_report();
 
     if (g_msg.param.message_statistics_enabled)
     {
@@ -17,7 +17,7 @@
 
 void print_value_statistics(void);
 void print_common_statistics(void);
-void value_statistic(msg_data_t *p_fmt, value_format_t *format);
+void value_statistic(value_stats_t *stat, double value, uint32_t message_no);
 void write_statistics_to_file(void);
 void reset_statistics(void);
 void print_message_frequency_statistics(void);
@@ -14,6 +14,9 @@
 #define _TSTAMP_H
 
 #include "format.h"
+#include "read_bin_data.h"
+#include "profile.h"
+#include "loss_report.h"
 
 
 /**
@@ -142,12 +145,231 @@ small_tstamp_difference(uint32_t *tstamp_h_counter, uint32_t *old_tstamp_l, uint
 }
 
 
+/**
+ * @brief  Updates the timestamp.h with the long timestamp value if the value can be used.
+ *
+ * @param timestamp_h     Value of the long timestamp
+ * @param counter_before  Number of timestamp.l overflows before the long timestamp message
+ * @param difference_ok   true - the timestamp difference to the previous message is small
+ * @param counter_after   Number of timestamp.l overflows including the long timestamp message
+ *
+ * @return  true - long timestamp used, false - the value cannot be used
+ */
+
+static inline bool use_long_timestamp(uint32_t timestamp_h, uint32_t counter_before,
+    bool difference_ok, uint32_t counter_after)
+{
+    if ((timestamp_h >= counter_before) && difference_ok) // The calculated value should not be negative
+    {
+        g_msg.timestamp.h = timestamp_h - counter_after;
+        return true;    // Long timestamp found and the value is OK
+    }
+
+    /* Do not use this long timestamp if the timestamp difference from the previous
+     * timestamp is large (transmissions or logging have been interrupted). */
+    return false;
+}
+
+
+/**
+ * @brief  Finds the first saved state of the last long timestamp search at or after the
+ *         position where the new search starts. The states can be used only if the
+ *         loaded data did not change.
+ *
+ * @param search    Saved search for the current half of the timestamp period
+ * @param position  Start position of the new search (already_processed_data + index)
+ *
+ * @return  Pointer to the saved state or NULL if no saved state can be used
+ */
+
+static inline tstamp_checkpoint_t *find_tstamp_checkpoint(tstamp_search_t *search, size_t position)
+{
+    if ((!search->valid) || (search->checkpoints == 0)
+        || (position < search->checkpoint[0].position)
+        || (position > search->checkpoint[search->checkpoints - 1u].position))
+    {
+        return NULL;
+    }
+
+    if ((search->end == TSTAMP_SEARCH_END_OF_DATA)
+        && (search->data_end != g_msg.already_processed_data + g_msg.in_size))
+    {
+        return NULL;    // Additional data has been loaded since the search was finished
+    }
+
+    uint32_t first = 0;
+    uint32_t last = search->checkpoints - 1u;
+
+    while (first < last)
+    {
+        uint32_t middle = (first + last) / 2u;
+
+        if (search->checkpoint[middle].position < position)
+        {
+            first = middle + 1u;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    return &search->checkpoint[first];
+}
+
+
+/**
+ * @brief  Checks if the current search reached a saved state of the last search.
+ *         From such a state the search continues exactly as the saved one.
+ *
+ * @param search            Saved search
+ * @param pp_checkpoint     Pointer to the next saved state (set to NULL if no more states follow)
+ * @param position          Current search position
+ * @param old_timestamp_l   Current timestamp for the check of the difference to the next message
+ *
+ * @return  true - the result of the last search can be used
+ */
+
+static inline bool tstamp_checkpoint_reached(const tstamp_search_t *search, tstamp_checkpoint_t **pp_checkpoint,
+    size_t position, uint32_t old_timestamp_l)
+{
+    tstamp_checkpoint_t *checkpoint = *pp_checkpoint;
+    tstamp_checkpoint_t *end = &search->checkpoint[search->checkpoints];
+
+    while ((checkpoint < end) && (checkpoint->position < position))
+    {
+        checkpoint++;
+    }
+
+    *pp_checkpoint = (checkpoint < end) ? checkpoint : NULL;
+
+    return (checkpoint < end) && (checkpoint->position == position)
+        && (checkpoint->old_timestamp_l == old_timestamp_l);
+}
+
+
+/**
+ * @brief  Returns the result of the last search continued from the saved state.
+ *         The number of timestamp.l overflows from the start of the current
+ *         search differs from the saved one by a constant value.
+ *
+ * @param search            Saved search
+ * @param checkpoint        Saved state reached by the current search
+ * @param tstamp_h_counter  Number of overflows in the current search up to this state
+ *
+ * @return  true - long timestamp found
+ *          false - long timestamp not found
+ */
+
+static inline bool use_saved_tstamp_search(const tstamp_search_t *search, const tstamp_checkpoint_t *checkpoint,
+    uint32_t tstamp_h_counter)
+{
+    uint32_t offset = tstamp_h_counter - checkpoint->tstamp_h_counter;
+    g_msg.timestamp.searched_to_index = (uint32_t)(search->end_position - g_msg.already_processed_data);
+
+    if (search->end != TSTAMP_SEARCH_LONG_TSTAMP)
+    {
+        return false;
+    }
+
+    return use_long_timestamp(search->timestamp_h, search->counter_before + offset,
+        search->difference_ok, search->counter_after + offset);
+}
+
+
+/**
+ * @brief  Starts saving the states of a new long timestamp search.
+ *
+ * @param search  Saved search for the current half of the timestamp period
+ */
+
+static inline void start_tstamp_search_recording(tstamp_search_t *search)
+{
+
+    if (search->checkpoint == NULL)
+    {
+        search->checkpoint = (tstamp_checkpoint_t *)allocate_memory(
+            LONG_TSTAMP_CHECKPOINTS * sizeof(tstamp_checkpoint_t), "tsSearch");
+    }
+
+    search->valid = false;
+    search->checkpoints = 0;
+    search->messages = 0;
+    search->interval = LONG_TSTAMP_CHECKPOINT_INTERVAL;
+}
+
+
+/**
+ * @brief  Saves the search state after every 'interval' messages. Every second state is
+ *         removed and the interval is doubled if all states are used.
+ *
+ * @param search            Saved search
+ * @param position          Current search position
+ * @param old_timestamp_l   Current timestamp for the check of the difference to the next message
+ * @param tstamp_h_counter  Number of timestamp.l overflows from the start of the search
+ */
+
+static inline void save_tstamp_checkpoint(tstamp_search_t *search, size_t position,
+    uint32_t old_timestamp_l, uint32_t tstamp_h_counter)
+{
+
+    if ((search->checkpoints > 0) && (++search->messages < search->interval))
+    {
+        return;
+    }
+
+    if (search->checkpoints >= LONG_TSTAMP_CHECKPOINTS)
+    {
+        for (uint32_t i = 0; i < (LONG_TSTAMP_CHECKPOINTS / 2u); i++)
+        {
+            search->checkpoint[i] = search->checkpoint[2u * i];
+        }
+
+        search->checkpoints = LONG_TSTAMP_CHECKPOINTS / 2u;
+        search->interval *= 2u;
+    }
+
+    tstamp_checkpoint_t *checkpoint = &search->checkpoint[search->checkpoints++];
+    checkpoint->position = position;
+    checkpoint->old_timestamp_l = old_timestamp_l;
+    checkpoint->tstamp_h_counter = tstamp_h_counter;
+    search->messages = 0;
+}
+
+
+/**
+ * @brief  Saves the result of the long timestamp search if its states have been saved.
+ *
+ * @param search     Saved search - NULL if the states of the search have not been saved
+ * @param end        How the search ended
+ * @param index      Index after the last word checked
+ *
+ * @return  Always false (long timestamp not found) - for the use in the return statements
+ */
+
+static inline bool tstamp_search_finished(tstamp_search_t *search, tstamp_search_end_t end, uint32_t index)
+{
+    if (search != NULL)
+    {
+        search->end = end;
+        search->end_position = g_msg.already_processed_data + index;
+        search->data_end = g_msg.already_processed_data + g_msg.in_size;
+        search->valid = true;
+    }
+
+    return false;
+}
+
+
 /**
  * @brief  Find a message with a long timestamp and update the timestamp.h if found.
  * The search for the long timestamp is stopped if:
  *      - a long timestamp is found (or rte_restart_timing = 0xFFFFFFFF)
  *      - end of buffer is reached
  *      - message with a too large difference from the previous timestamp is found
+ * The states of the search are saved. A search that continues as the saved one from one of
+ * the states (e.g. searches after consecutive decoding errors) uses the saved result instead
+ * of going through the same data again.
  *
  * @return  true - long timestamp found
  *          false - long timestamp not found
@@ -171,10 +393,26 @@ static inline bool long_timestamp_found(void)
         return false;
     }
 
+    tstamp_search_t *search = &g_msg.timestamp.search[g_msg.timestamp.old >= (NORMALIZED_TSTAMP_PERIOD / 2ull)];
+    size_t position = g_msg.already_processed_data + g_msg.index;
+    tstamp_checkpoint_t *checkpoint = find_tstamp_checkpoint(search, position);
+    tstamp_search_t *recording = NULL;      // Saved search if the states of this search are saved
+
+    if (checkpoint == NULL)
+    {
+        recording = search;
+        start_tstamp_search_recording(recording);
+        save_tstamp_checkpoint(recording, position, old_timestamp_l, tstamp_h_counter);
+    }
+    else if (tstamp_checkpoint_reached(search, &checkpoint, position, old_timestamp_l))
+    {
+        return use_saved_tstamp_search(search, checkpoint, tstamp_h_counter);
+    }
+
     for (uint32_t index = g_msg.index; index < g_msg.in_size; )
     {
         uint32_t previous_data = data;
-        data = g_msg.rte_buffer[index];
+        data = get_bin_word(index);
         index++;
         g_msg.timestamp.searched_to_index = index;
 
@@ -184,7 +422,7 @@ static inline bool long_timestamp_found(void)
             {
                 /* Invalid message - max. 4 data words possible.
                  * Stop the search for a long_timestamp if faulty data is found. */
-                return false;
+                return tstamp_search_finished(recording, TSTAMP_SEARCH_STOPPED, index);
             }
 
             continue;
@@ -205,7 +443,7 @@ static inline bool long_timestamp_found(void)
         if ((fmt_id == MSG1_SYS_STREAMING_MODE_LOGGING) && (data_words == 1))
         {
             // We do not check if the streaming mode is correct here (will be done during the message decoding)
-            return false;
+            return tstamp_search_finished(recording, TSTAMP_SEARCH_STOPPED, index);
         }
 
         // The long timestamp is used for time synchronization
@@ -216,23 +454,22 @@ static inline bool long_timestamp_found(void)
 
             if (timestamp_h == 0xFFFFFFFFul)    // The value is logged by the rte_restart_timing()
             {
-                return false;
+                return tstamp_search_finished(recording, TSTAMP_SEARCH_STOPPED, index);
             }
 
-            if (timestamp_h >= tstamp_h_counter)    // The calculated value should not be negative
+            uint32_t counter_before = tstamp_h_counter;
+            bool difference_ok = small_tstamp_difference(&tstamp_h_counter, &old_timestamp_l, new_timestamp_l);
+
+            if (recording != NULL)
             {
-                if (small_tstamp_difference(&tstamp_h_counter, &old_timestamp_l, new_timestamp_l) == false)
-                {
-                    /* Do not use this long timestamp since the timestamp difference from the previous
-                     * timestamp is large (transmissions or logging have been interrupted). */
-                    return false;
-                }
-
-                g_msg.timestamp.h = timestamp_h - tstamp_h_counter;
-                return true;    // Long timestamp found and the value is OK
+                recording->timestamp_h = timestamp_h;
+                recording->counter_before = counter_before;
+                recording->counter_after = tstamp_h_counter;
+                recording->difference_ok = difference_ok;
+                (void)tstamp_search_finished(recording, TSTAMP_SEARCH_LONG_TSTAMP, index);
             }
 
-            return false;
+            return use_long_timestamp(timestamp_h, counter_before, difference_ok, tstamp_h_counter);
         }
 
         /* Check if the timestamp difference between the preceding and current message is large.
@@ -241,13 +478,23 @@ static inline bool long_timestamp_found(void)
          * message is decoded. */
         if (small_tstamp_difference(&tstamp_h_counter, &old_timestamp_l, new_timestamp_l) == false)
         {
-            return false;
+            return tstamp_search_finished(recording, TSTAMP_SEARCH_STOPPED, index);
         }
 
         data_words = 0;
+        position = g_msg.already_processed_data + index;
+
+        if (recording != NULL)
+        {
+            save_tstamp_checkpoint(recording, position, old_timestamp_l, tstamp_h_counter);
+        }
+        else if ((checkpoint != NULL) && tstamp_checkpoint_reached(search, &checkpoint, position, old_timestamp_l))
+        {
+            return use_saved_tstamp_search(search, checkpoint, tstamp_h_counter);
+        }
     }
 
-    return false;
+    return tstamp_search_finished(recording, TSTAMP_SEARCH_END_OF_DATA, g_msg.in_size);
 }
 
 
@@ -318,6 +565,11 @@ static inline void process_timestamp_value(uint64_t *p_new_timestamp)
          * Assume data transmission or logging was interrupted. */
         search_next_long_tstamp = true;
         g_msg.timestamp.mark_problematic_tstamps = !g_msg.timestamp.no_previous_tstamp;
+
+        if (!g_msg.timestamp.no_previous_tstamp)
+        {
+            report_data_loss(LOSS_TIMESTAMP_GAP);
+        }
     }
 
     if (update_old_tstamp_value || g_msg.timestamp.no_previous_tstamp)
@@ -330,7 +582,11 @@ static inline void process_timestamp_value(uint64_t *p_new_timestamp)
         || g_msg.timestamp.no_previous_tstamp)
     {
         // Search for the next long timestamp
-        if (long_timestamp_found())
+        uint64_t start = profile_start();
+        bool found = long_timestamp_found();
+        profile_stop(PROFILE_LONG_TIMESTAMP, start);
+
+        if (found)
         {
             /* Update the current message timestamp based on the next long timestamp.
              * The long_timestamp_found() function updates the high part of the timestamp. */
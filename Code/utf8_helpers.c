@@ -262,4 +262,31 @@ int utf8_chdir(const char *dir_name)
     return _wchdir(dir_path);
 }
 
+
+/**
+ * @brief Creates the specified directory.
+ *        The UTF-8 type directory name is converted to the wide char version.
+ *        The _wmkdir() function is used to create the directory.
+ *
+ * @param dir_name   Pointer to the UTF-8 or ASCII string with the name of the directory
+ *
+ * @return 0 if successful or -1 if failure (errno = EEXIST if the directory already exists)
+ */
+
+int utf8_mkdir(const char *dir_name)
+{
+    size_t dir_len = strlen(dir_name);
+
+    if ((dir_len == 0) || (dir_len >= MAX_FILEPATH_LENGTH))
+    {
+        return -1;      // Error
+    }
+
+    wchar_t dir_path[MAX_FILEPATH_LENGTH];
+    int len = MultiByteToWideChar(CP_UTF8, 0, dir_name, (int)dir_len, dir_path, MAX_FILEPATH_LENGTH);
+    dir_path[len] = L'\0';
+
+    return _wmkdir(dir_path);
+}
+
 /*==== End of file ====*/
@@ -21,6 +21,7 @@ void utf8_print_string(const char *text, size_t length);
 int utf8_remove(const char *name);
 int utf8_rename(const char *old_name, const char *new_name);
 int utf8_chdir(const char *dir_name);
+int utf8_mkdir(const char *dir_name);
 size_t utf8_truncate(const char *text, size_t length);
 
 #endif // _UTF8_HELPERS_H
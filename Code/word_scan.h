@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    word_scan.h
+ * @author  B. Premzel
+ * @brief   Search for the erased words (0xFFFFFFFF) and FMT words (bit 0 set)
+ *          in the binary data. The SSE2, AVX2 or NEON instructions are used if
+ *          available at compile time (AVX2 e.g. with -mavx2 or /arch:AVX2).
+ ******************************************************************************/
+
+#ifndef _WORD_SCAN_H
+#define _WORD_SCAN_H
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WORD_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define WORD_SCAN_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define WORD_SCAN_NEON
+#endif
+
+
+/**
+ * @brief Counts the erased words (0xFFFFFFFF - not written by the embedded system)
+ *        at the start of the buffer.
+ *
+ * @param words  Pointer to the binary data.
+ * @param size   Number of words to check.
+ *
+ * @return Number of consecutive erased words (equal to size if all words are erased).
+ */
+
+static inline uint32_t count_erased_words(const uint32_t *words, uint32_t size)
+{
+    uint32_t i = 0;
+
+#if defined(WORD_SCAN_AVX2)
+    const __m256i erased = _mm256_set1_epi32(-1);
+
+    for ( ; (i + 16u) <= size; i += 16u)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&words[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i *)&words[i + 8u]);
+
+        if (!_mm256_testc_si256(_mm256_and_si256(a, b), erased))
+        {
+            break;      // A word different from 0xFFFFFFFF is in this block
+        }
+    }
+#elif defined(WORD_SCAN_SSE2)
+    const __m128i erased = _mm_set1_epi32(-1);
+
+    for ( ; (i + 8u) <= size; i += 8u)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)&words[i]);
+        __m128i b = _mm_loadu_si128((const __m128i *)&words[i + 4u]);
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(a, b), erased)) != 0xFFFF)
+        {
+            break;
+        }
+    }
+#elif defined(WORD_SCAN_NEON)
+    for ( ; (i + 8u) <= size; i += 8u)
+    {
+        uint32x4_t a = vld1q_u32(&words[i]);
+        uint32x4_t b = vld1q_u32(&words[i + 4u]);
+
+        if (vminvq_u32(vandq_u32(a, b)) != 0xFFFFFFFFuL)
+        {
+            break;
+        }
+    }
+#endif
+
+    // The remaining words or the block containing the first non-erased word
+    for ( ; i < size; i++)
+    {
+        if (words[i] != 0xFFFFFFFFuL)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+
+/**
+ * @brief Finds the first word with the bit 0 set - FMT word or erased word (0xFFFFFFFF).
+ *
+ * @param words  Pointer to the binary data.
+ * @param size   Number of words to check.
+ *
+ * @return Index of the word found (equal to size if no such word is found).
+ */
+
+static inline uint32_t find_word_with_bit0(const uint32_t *words, uint32_t size)
+{
+    uint32_t i = 0;
+
+#if defined(WORD_SCAN_AVX2)
+    for ( ; (i + 16u) <= size; i += 16u)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&words[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i *)&words[i + 8u]);
+
+        // The bit 0 is moved to the sign bit
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_or_si256(a, b), 31))) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(WORD_SCAN_SSE2)
+    for ( ; (i + 8u) <= size; i += 8u)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)&words[i]);
+        __m128i b = _mm_loadu_si128((const __m128i *)&words[i + 4u]);
+
+        if (_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_or_si128(a, b), 31))) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(WORD_SCAN_NEON)
+    for ( ; (i + 8u) <= size; i += 8u)
+    {
+        uint32x4_t a = vld1q_u32(&words[i]);
+        uint32x4_t b = vld1q_u32(&words[i + 4u]);
+
+        if (vmaxvq_u32(vandq_u32(vorrq_u32(a, b), vdupq_n_u32(1u))) != 0)
+        {
+            break;
+        }
+    }
+#endif
+
+    for ( ; i < size; i++)
+    {
+        if ((words[i] & 1u) != 0)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+#endif  // _WORD_SCAN_H
+
+/*==== End of file ====*/
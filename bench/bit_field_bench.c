@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    bit_field_bench.c
+ * @author  B. Premzel
+ * @brief   Microbenchmark for the bit field extraction from the message data.
+ *          Compares the extract_bit_field() with the previous byte-by-byte and
+ *          bit-by-bit extraction loops and verifies that the results are equal.
+ *
+ *          Usage: bit_field_bench [number_of_extractions]
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "bit_field.h"
+
+#define MESSAGE_SIZE    256u    // Message buffer size in bytes (incl. padding)
+#define MESSAGE_BITS    ((MESSAGE_SIZE - 8u) * 8u)  // Max. value end address
+#define CASES           4096u   // Number of different size/address pairs
+
+typedef struct
+{
+    uint32_t address;
+    uint32_t size;
+} bit_field_t;
+
+static uint8_t message[MESSAGE_SIZE];
+static bit_field_t fields[CASES];
+
+
+/**
+ * @brief Previous value extraction - byte-by-byte loop for the byte-aligned values
+ *        and bit-by-bit loop for all other values.
+ *
+ * @param message   Pointer to the message data.
+ * @param address   Bit address of the value.
+ * @param size      Size of the value in bits (1 ... 64).
+ *
+ * @return Value aligned to the highest bit (bit 63).
+ */
+
+static uint64_t extract_with_loops(const uint8_t *message, uint32_t address, uint32_t size)
+{
+    uint64_t value = 0;
+
+    if (((size | address) & 7u) == 0)
+    {
+        message += address >> 3u;
+        size >>= 3u;
+
+        do
+        {
+            value >>= 8u;
+            value |= ((uint64_t)*message) << (64u - 8u);
+            message++;
+        } while (--size != 0);
+
+        return value;
+    }
+
+    while (size > 0)
+    {
+        value >>= 1;
+
+        if (message[address >> 3u] & (1u << (address & 7u)))
+        {
+            value |= (1uLL << 63u);
+        }
+
+        address++;
+        size--;
+    }
+
+    return value;
+}
+
+
+/**
+ * @brief Simple xorshift pseudo random number generator (repeatable results).
+ *
+ * @return Pseudo random number.
+ */
+
+static uint32_t next_random(void)
+{
+    static uint32_t state = 0x12345678u;
+
+    state ^= state << 13u;
+    state ^= state >> 17u;
+    state ^= state << 5u;
+    return state;
+}
+
+
+/**
+ * @brief Prepares random message data and random value sizes and addresses.
+ *        Every fourth value is byte-aligned (typical for the 8/16/32/64-bit values).
+ */
+
+static void prepare_test_data(void)
+{
+    for (uint32_t i = 0; i < (MESSAGE_SIZE - 8u); i++)
+    {
+        message[i] = (uint8_t)next_random();
+    }
+
+    for (uint32_t i = 0; i < CASES; i++)
+    {
+        uint32_t size = 1u + next_random() % 64u;
+        uint32_t address = next_random() % (MESSAGE_BITS - size);
+
+        if ((i & 3u) == 0)
+        {
+            size = 8u << (next_random() & 3u);
+            address &= ~7u;
+        }
+
+        fields[i].size = size;
+        fields[i].address = address;
+    }
+}
+
+
+/**
+ * @brief Returns the current time in seconds.
+ */
+
+static double time_now(void)
+{
+    struct timespec ts;
+    (void)timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * @brief Checks all prepared value sizes and addresses plus all possible
+ *        size / address combinations in the first 16 bytes of the message.
+ *
+ * @return true if both extraction methods return the same results.
+ */
+
+static bool verify_results(void)
+{
+    for (uint32_t i = 0; i < CASES; i++)
+    {
+        if (extract_bit_field(message, fields[i].address, fields[i].size)
+            != extract_with_loops(message, fields[i].address, fields[i].size))
+        {
+            printf("Mismatch: address %u, size %u\n", fields[i].address, fields[i].size);
+            return false;
+        }
+    }
+
+    for (uint32_t address = 0; address < 64u; address++)
+    {
+        for (uint32_t size = 1; size <= 64u; size++)
+        {
+            if (extract_bit_field(message, address, size)
+                != extract_with_loops(message, address, size))
+            {
+                printf("Mismatch: address %u, size %u\n", address, size);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned long long count = 100000000uLL;
+
+    if (argc > 1)
+    {
+        count = strtoull(argv[1], NULL, 10);
+    }
+
+    prepare_test_data();
+
+    if (!verify_results())
+    {
+        return 1;
+    }
+
+    volatile uint64_t sink = 0;
+    uint64_t sum = 0;
+    double start = time_now();
+
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        const bit_field_t *f = &fields[i % CASES];
+        sum += extract_with_loops(message, f->address, f->size);
+    }
+
+    double t_loops = time_now() - start;
+    sink = sum;
+    sum = 0;
+    start = time_now();
+
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        const bit_field_t *f = &fields[i % CASES];
+        sum += extract_bit_field(message, f->address, f->size);
+    }
+
+    double t_field = time_now() - start;
+    sink += sum;
+    (void)sink;
+
+    printf("Extractions:         %llu\n", count);
+    printf("Loops:               %8.3f s (%6.2f ns/value)\n", t_loops, t_loops * 1e9 / (double)count);
+    printf("extract_bit_field(): %8.3f s (%6.2f ns/value)\n", t_field, t_field * 1e9 / (double)count);
+    printf("Speedup:             %8.2fx\n", (t_field > 0) ? t_loops / t_field : 0.0);
+    return 0;
+}
+
+/*==== End of file ====*/
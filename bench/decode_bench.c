@@ -0,0 +1,890 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    decode_bench.c
+ * @author  B. Premzel
+ * @brief   Decoding benchmark for the RTEmsg. Generates a synthetic RTEdbg
+ *          capture file (post-mortem or streaming mode) and the matching format
+ *          definition file, runs the complete decoding with the RTEmsg and
+ *          reports the decoding throughput.
+ *
+ *          Usage: decode_bench RTEmsg_path work_folder {options} {-- RTEmsg options}
+ *
+ *          Options:
+ *            -n=x       Number of generated messages (default 1000000)
+ *            -N=x       Number of format ID bits (9 ... 16, default 10)
+ *            -blocks=x  Max. number of message blocks for MSGN/MSGX (1 ... 256, default 4)
+ *            -mode=x    Capture type: pm (post-mortem, default) or stream
+ *            -wrap=x    Post-mortem circular buffer of x words - the newer messages
+ *                       overwrite the older ones (default 0 - buffer without wrapping)
+ *            -corrupt=x Overwrite x pseudo randomly selected words of the capture data
+ *            -longts    Use long timestamps (MSG1_SYS_LONG_TIMESTAMP messages)
+ *            -mix=a,b,c,d,e,f,g,h
+ *                       Relative frequency of the MSG0, MSG1, MSG2, MSG3, MSG4,
+ *                       MSGN, MSGX and EXT_MSG messages (default 1,4,2,1,1,1,1,1)
+ *            -repeat=x  Number of decoding runs - the fastest one is reported (default 3)
+ *            -seed=x    Seed for the pseudo random data (default 1)
+ *            -profile   Decode once more with the RTEmsg -profile option and print the
+ *                       execution profile (time of the decoding stages, messages and values)
+ *            -generate=name  Only generate the capture file "name" and the format
+ *                       definitions (fmt folder) in the work folder - no benchmark
+ *                       (used by the decoding regression tests - see tests/)
+ *          The arguments after "--" are passed to the RTEmsg (e.g. -threads=4 -stat=all).
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "rtedbg.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define make_folder(name)   (void)_mkdir(name)
+#else
+#include <sys/stat.h>
+#define make_folder(name)   (void)mkdir(name, 0777)
+#endif
+
+#define MAX_PATH_LENGTH     1024u
+#define MAX_COMMAND_LENGTH  4096u
+#define MESSAGE_TYPES       8u          // MSG0, MSG1, MSG2, MSG3, MSG4, MSGN, MSGX, EXT_MSG
+#define TIMESTAMP_FREQUENCY 1000000u    // Timestamp counter frequency [Hz]
+
+/*@brief Benchmark parameters */
+typedef struct
+{
+    const char *rtemsg;                 // Path to the RTEmsg executable
+    const char *work_folder;            // Folder for the generated and decoded files
+    unsigned long messages;             // Number of generated messages
+    unsigned fmt_id_bits;               // Number of format ID bits
+    unsigned max_msg_blocks;            // Max. number of blocks for MSGN/MSGX messages
+    bool streaming;                     // Generate a streaming mode capture
+    uint32_t wrap_words;                // Size of the wrapped post-mortem buffer (0 - no wrapping)
+    unsigned corrupt_words;             // Number of overwritten capture words
+    const char *generate;               // Name of the generated capture file (NULL - benchmark)
+    bool long_timestamps;               // Generate the long timestamp messages
+    bool profile;                       // Print the RTEmsg execution profile
+    unsigned mix[MESSAGE_TYPES];        // Relative frequency of message types
+    unsigned repeat;                    // Number of decoding runs
+    uint32_t seed;                      // Seed for the pseudo random numbers
+    char rtemsg_args[MAX_COMMAND_LENGTH];   // Additional RTEmsg arguments
+} bench_param_t;
+
+/*@brief Format IDs assigned by the RTEmsg */
+typedef struct
+{
+    const char *name;
+    uint32_t fmt_id;
+} bench_msg_t;
+
+enum bench_msg_index
+{
+    B_LONG_TIMESTAMP, B_FREQUENCY,
+    B_MSG0, B_MSG1_UINT, B_MSG1_FLOAT, B_MSG2, B_MSG3, B_MSG4, B_MSGN, B_MSGX, B_EXT_MSG,
+    B_LAST
+};
+
+static bench_msg_t bench_msg[B_LAST] =
+{
+    { "MSG1_SYS_LONG_TIMESTAMP", 0 },
+    { "MSG1_SYS_TSTAMP_FREQUENCY", 0 },
+    { "MSG0_BENCH_EVENT", 0 },
+    { "MSG1_BENCH_COUNTER", 0 },
+    { "MSG1_BENCH_FLOAT", 0 },
+    { "MSG2_BENCH_PAIR", 0 },
+    { "MSG3_BENCH_BITS", 0 },
+    { "MSG4_BENCH_VALUES", 0 },
+    { "MSGN_BENCH_TEXT", 0 },
+    { "MSGX_BENCH_DATA", 0 },
+    { "EXT_MSG1_4_BENCH_EXT", 0 },
+};
+
+// Format definitions for the generated messages
+static const char bench_fmt_file[] =
+    "// FILTER(F_SYSTEM, \"System messages\")\n"
+    "// FILTER(F_BENCH, \"Benchmark messages\")\n"
+    "// MSG1_SYS_LONG_TIMESTAMP\n"
+    "// \"Long timestamp: %u\"\n"
+    "// MSG1_SYS_TSTAMP_FREQUENCY\n"
+    "// \"Frequency: %u Hz\"\n"
+    "// MSG0_BENCH_EVENT\n"
+    "// \"event %t\"\n"
+    "// MSG1_BENCH_COUNTER\n"
+    "// \"counter=%u (0x%[0:32u]08X)\"\n"
+    "// MSG1_BENCH_FLOAT\n"
+    "// \"f=%|bench_float|[32f]8.3f\"\n"
+    "// MSG2_BENCH_PAIR\n"
+    "// \"a=%u b=%d\"\n"
+    "// MSG3_BENCH_BITS\n"
+    "// \"x=%[8u]u y=%[4:12i]d z=%[-2:20u]x bin=%[16:16u]B\"\n"
+    "// MSG4_BENCH_VALUES\n"
+    "// \"id=%04X v=%u w=%d g=%[32f]g\"\n"
+    "// MSGN_BENCH_TEXT\n"
+    "// \"text=%s\"\n"
+    "// MSGX_BENCH_DATA\n"
+    "// \"msgx first=%u\"\n"
+    "// EXT_MSG1_4_BENCH_EXT\n"
+    "// \"ext: v=%u ext=%[32:4u]u\"\n";
+
+static bench_param_t param =
+{
+    .messages = 1000000uL,
+    .fmt_id_bits = 10u,
+    .max_msg_blocks = 4u,
+    .mix = { 1u, 4u, 2u, 1u, 1u, 1u, 1u, 1u },
+    .repeat = 3u,
+    .seed = 1u,
+};
+
+static uint32_t *capture;           // Generated data words (without the header)
+static size_t capture_words;
+static size_t capture_size;         // Number of allocated words
+static uint64_t timestamp;          // Timestamp counter of the generated messages
+static uint64_t timestamp_h;        // High part of the last logged long timestamp
+
+
+/**
+ * @brief Simple xorshift pseudo random number generator (repeatable results).
+ *
+ * @return Pseudo random number.
+ */
+
+static uint32_t next_random(void)
+{
+    param.seed ^= param.seed << 13u;
+    param.seed ^= param.seed >> 17u;
+    param.seed ^= param.seed << 5u;
+    return param.seed;
+}
+
+
+/**
+ * @brief Prints the error message and stops the benchmark.
+ *
+ * @param text    Error message.
+ * @param detail  Additional information.
+ */
+
+static void bench_error(const char *text, const char *detail)
+{
+    fprintf(stderr, "decode_bench: %s%s\n", text, (detail != NULL) ? detail : "");
+    exit(1);
+}
+
+
+/**
+ * @brief Processes the command line arguments.
+ *
+ * @param argc  Number of command line arguments.
+ * @param argv  Array of command line argument strings.
+ */
+
+static void process_arguments(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        bench_error("Usage: decode_bench RTEmsg_path work_folder {options} {-- RTEmsg options}", NULL);
+    }
+
+    param.rtemsg = argv[1];
+    param.work_folder = argv[2];
+
+    for (int i = 3; i < argc; i++)
+    {
+        const char *arg = argv[i];
+
+        if (strcmp(arg, "--") == 0)
+        {
+            for (i++; i < argc; i++)
+            {
+                if ((strlen(param.rtemsg_args) + strlen(argv[i]) + 2u) >= MAX_COMMAND_LENGTH)
+                {
+                    bench_error("Too many RTEmsg arguments", NULL);
+                }
+
+                strcat(param.rtemsg_args, " ");
+                strcat(param.rtemsg_args, argv[i]);
+            }
+        }
+        else if (strncmp(arg, "-n=", 3) == 0)
+        {
+            param.messages = strtoul(&arg[3], NULL, 10);
+        }
+        else if (strncmp(arg, "-N=", 3) == 0)
+        {
+            param.fmt_id_bits = (unsigned)strtoul(&arg[3], NULL, 10);
+        }
+        else if (strncmp(arg, "-blocks=", 8) == 0)
+        {
+            param.max_msg_blocks = (unsigned)strtoul(&arg[8], NULL, 10);
+        }
+        else if (strcmp(arg, "-mode=pm") == 0)
+        {
+            param.streaming = false;
+        }
+        else if (strcmp(arg, "-mode=stream") == 0)
+        {
+            param.streaming = true;
+        }
+        else if (strncmp(arg, "-wrap=", 6) == 0)
+        {
+            param.wrap_words = (uint32_t)strtoul(&arg[6], NULL, 10);
+        }
+        else if (strncmp(arg, "-corrupt=", 9) == 0)
+        {
+            param.corrupt_words = (unsigned)strtoul(&arg[9], NULL, 10);
+        }
+        else if (strncmp(arg, "-generate=", 10) == 0)
+        {
+            param.generate = &arg[10];
+        }
+        else if (strcmp(arg, "-longts") == 0)
+        {
+            param.long_timestamps = true;
+        }
+        else if (strcmp(arg, "-profile") == 0)
+        {
+            param.profile = true;
+        }
+        else if (strncmp(arg, "-mix=", 5) == 0)
+        {
+            const char *p = &arg[5];
+
+            for (unsigned t = 0; t < MESSAGE_TYPES; t++)
+            {
+                char *end;
+                param.mix[t] = (unsigned)strtoul(p, &end, 10);
+                p = (*end == ',') ? end + 1 : end;
+            }
+        }
+        else if (strncmp(arg, "-repeat=", 8) == 0)
+        {
+            param.repeat = (unsigned)strtoul(&arg[8], NULL, 10);
+        }
+        else if (strncmp(arg, "-seed=", 6) == 0)
+        {
+            param.seed = (uint32_t)strtoul(&arg[6], NULL, 10);
+        }
+        else
+        {
+            bench_error("Unknown argument: ", arg);
+        }
+    }
+
+    if ((param.fmt_id_bits < 9u) || (param.fmt_id_bits > 16u))
+    {
+        bench_error("The -N=x value must be 9 ... 16", NULL);
+    }
+
+    if ((param.max_msg_blocks < 1u) || (param.max_msg_blocks > 256u))
+    {
+        bench_error("The -blocks=x value must be 1 ... 256", NULL);
+    }
+
+    if ((param.messages == 0) || (param.repeat == 0) || (param.seed == 0))
+    {
+        bench_error("The -n, -repeat and -seed values must not be 0", NULL);
+    }
+
+    if ((param.wrap_words != 0) && (param.streaming || (param.wrap_words < 64u)))
+    {
+        bench_error("The -wrap=x value must be at least 64 (post-mortem capture only)", NULL);
+    }
+
+    unsigned total_mix = 0;
+
+    for (unsigned t = 0; t < MESSAGE_TYPES; t++)
+    {
+        total_mix += param.mix[t];
+    }
+
+    if (total_mix == 0)
+    {
+        bench_error("At least one of the -mix values must not be 0", NULL);
+    }
+}
+
+
+/**
+ * @brief Prepares the path of a file in the work folder.
+ *
+ * @param path  Buffer for the path (MAX_PATH_LENGTH characters).
+ * @param name  File or folder name.
+ */
+
+static void work_path(char *path, const char *name)
+{
+    snprintf(path, MAX_PATH_LENGTH, "%s/%s", param.work_folder, name);
+}
+
+
+/**
+ * @brief Runs the RTEmsg with the specified arguments.
+ *
+ * @param arguments  Arguments after the output and format folder names.
+ *
+ * @return Execution time [s].
+ */
+
+static double run_rtemsg(const char *arguments)
+{
+    char out_folder[MAX_PATH_LENGTH];
+    char fmt_folder[MAX_PATH_LENGTH];
+    char command[MAX_COMMAND_LENGTH * 2u + MAX_PATH_LENGTH * 3u];
+    work_path(out_folder, "out");
+    work_path(fmt_folder, "fmt");
+    snprintf(command, sizeof(command), "\"%s\" \"%s\" \"%s\" -N=%u %s",
+        param.rtemsg, out_folder, fmt_folder, param.fmt_id_bits, arguments);
+
+    struct timespec start;
+    struct timespec end;
+    (void)timespec_get(&start, TIME_UTC);
+    int rez = system(command);
+    (void)timespec_get(&end, TIME_UTC);
+
+    if (rez == -1)
+    {
+        bench_error("Could not start the RTEmsg: ", command);
+    }
+
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+
+/**
+ * @brief Creates the format definition file and lets the RTEmsg assign the format IDs
+ *        (-c option). The assigned IDs are read from the #define lines of the updated file.
+ */
+
+static void prepare_format_definitions(void)
+{
+    char path[MAX_PATH_LENGTH];
+    make_folder(param.work_folder);
+    work_path(path, "out");
+    make_folder(path);
+    work_path(path, "fmt");
+    make_folder(path);
+    work_path(path, "fmt/rte_main_fmt.h");
+
+    FILE *fmt = fopen(path, "w");
+
+    if (fmt == NULL)
+    {
+        bench_error("Could not create ", path);
+    }
+
+    fputs(bench_fmt_file, fmt);
+    fclose(fmt);
+    (void)run_rtemsg("-c");
+
+    fmt = fopen(path, "r");
+
+    if (fmt == NULL)
+    {
+        bench_error("Could not open ", path);
+    }
+
+    char line[256];
+    unsigned found = 0;
+
+    while (fgets(line, sizeof(line), fmt) != NULL)
+    {
+        char name[128];
+        unsigned value;
+
+        if (sscanf(line, "#define %127s %uU", name, &value) != 2)
+        {
+            continue;
+        }
+
+        for (unsigned i = 0; i < B_LAST; i++)
+        {
+            if (strcmp(name, bench_msg[i].name) == 0)
+            {
+                bench_msg[i].fmt_id = value;
+                found++;
+            }
+        }
+    }
+
+    fclose(fmt);
+
+    if (found != B_LAST)
+    {
+        bench_error("Format IDs not assigned - check the Errors.log in ", param.work_folder);
+    }
+}
+
+
+/**
+ * @brief Adds a word to the generated capture data.
+ *
+ * @param word  Data or FMT word.
+ */
+
+static void add_word(uint32_t word)
+{
+    if (capture_words >= capture_size)
+    {
+        capture_size = (capture_size == 0) ? 0x100000u : capture_size * 2u;
+        capture = realloc(capture, capture_size * sizeof(uint32_t));
+
+        if (capture == NULL)
+        {
+            bench_error("Out of memory", NULL);
+        }
+    }
+
+    capture[capture_words++] = word;
+}
+
+
+/**
+ * @brief Adds a message to the capture data. The message is split into packets with up
+ *        to four DATA words. The highest bits of DATA words are stored in the FMT word
+ *        as done by the RTEdbg library functions.
+ *
+ * @param fmt_id     Format ID of the message.
+ * @param words      Message data.
+ * @param no_words   Number of data words.
+ * @param ext_data   Extended data (EXT_MSG) stored in the FMT word.
+ * @param ext_bits   Number of extended data bits (0 = none).
+ */
+
+static void add_message(uint32_t fmt_id, const uint32_t *words, unsigned no_words,
+    uint32_t ext_data, unsigned ext_bits)
+{
+    unsigned shift = 32u - param.fmt_id_bits;
+    uint32_t tstamp = (uint32_t)(timestamp & ((1uLL << (shift - 1u)) - 1u));
+    unsigned index = 0;
+
+    do
+    {
+        unsigned packet_words = no_words - index;
+
+        if (packet_words > 4u)
+        {
+            packet_words = 4u;
+        }
+
+        uint32_t fmt = fmt_id;
+
+        for (unsigned k = 0; k < packet_words; k++)
+        {
+            uint32_t w = words[index + k];
+            fmt |= (w >> 31u) << (packet_words - 1u - k);
+            add_word(w << 1u);
+        }
+
+        if (ext_bits != 0)
+        {
+            fmt |= ext_data << packet_words;
+        }
+
+        add_word((fmt << shift) | (tstamp << 1u) | 1u);
+        index += packet_words;
+    } while (index < no_words);
+}
+
+
+/**
+ * @brief Selects the message type according to the -mix weights.
+ *
+ * @return Message type (0 = MSG0, ... 7 = EXT_MSG).
+ */
+
+static unsigned select_message_type(void)
+{
+    unsigned total = 0;
+
+    for (unsigned t = 0; t < MESSAGE_TYPES; t++)
+    {
+        total += param.mix[t];
+    }
+
+    unsigned r = next_random() % total;
+    unsigned t = 0;
+
+    while (r >= param.mix[t])
+    {
+        r -= param.mix[t];
+        t++;
+    }
+
+    return t;
+}
+
+
+/**
+ * @brief Converts a float value to the 32-bit word.
+ */
+
+static uint32_t float_word(float value)
+{
+    uint32_t word;
+    memcpy(&word, &value, sizeof(word));
+    return word;
+}
+
+
+/**
+ * @brief Generates a single message with pseudo random data.
+ */
+
+static void generate_message(void)
+{
+    uint32_t words[256 * 4];
+    unsigned max_words = 4u * param.max_msg_blocks;
+    timestamp += 1u + next_random() % 3000u;
+
+    if (param.long_timestamps)
+    {
+        uint64_t high = timestamp >> (31u - param.fmt_id_bits);
+
+        if (high != timestamp_h)
+        {
+            // The RTEdbg library logs the long timestamp after the timestamp counter overflow
+            timestamp_h = high;
+            words[0] = (uint32_t)high;
+            add_message(bench_msg[B_LONG_TIMESTAMP].fmt_id, words, 1u, 0, 0);
+        }
+    }
+
+    switch (select_message_type())
+    {
+        case 0:
+            add_message(bench_msg[B_MSG0].fmt_id, words, 0, 0, 0);
+            break;
+
+        case 1:
+            if (next_random() & 1u)
+            {
+                words[0] = next_random();
+                add_message(bench_msg[B_MSG1_UINT].fmt_id, words, 1u, 0, 0);
+            }
+            else
+            {
+                words[0] = float_word((float)(next_random() % 2000000u) / 1000.0f - 1000.0f);
+                add_message(bench_msg[B_MSG1_FLOAT].fmt_id, words, 1u, 0, 0);
+            }
+            break;
+
+        case 2:
+            words[0] = next_random();
+            words[1] = next_random();
+            add_message(bench_msg[B_MSG2].fmt_id, words, 2u, 0, 0);
+            break;
+
+        case 3:
+            for (unsigned i = 0; i < 3u; i++)
+            {
+                words[i] = next_random();
+            }
+
+            add_message(bench_msg[B_MSG3].fmt_id, words, 3u, 0, 0);
+            break;
+
+        case 4:
+            words[0] = next_random() & 0xFFFFu;
+            words[1] = next_random();
+            words[2] = next_random();
+            words[3] = float_word((float)next_random() * 1e-6f);
+            add_message(bench_msg[B_MSG4].fmt_id, words, 4u, 0, 0);
+            break;
+
+        case 5:
+        {
+            // Zero terminated text padded to the word size
+            unsigned length = 1u + next_random() % (max_words * 4u - 1u);
+            char *text = (char *)words;
+            memset(words, 0, sizeof(words));
+
+            for (unsigned i = 0; i < length - 1u; i++)
+            {
+                text[i] = "abcdefghij klmnopqrst"[next_random() % 21u];
+            }
+
+            add_message(bench_msg[B_MSGN].fmt_id, words, (length + 3u) / 4u, 0, 0);
+            break;
+        }
+
+        case 6:
+        {
+            // The highest byte of the last DATA word contains the message size in bytes
+            unsigned max_size = (max_words * 4u - 1u < 255u) ? (max_words * 4u - 1u) : 255u;
+            unsigned size = (max_size > 4u) ? (4u + next_random() % (max_size - 3u)) : 4u;
+            uint8_t *data = (uint8_t *)words;
+            unsigned length = size / 4u + 1u;
+            memset(words, 0, length * sizeof(uint32_t));
+
+            for (unsigned i = 0; i < size; i++)
+            {
+                data[i] = (uint8_t)next_random();
+            }
+
+            words[length - 1u] |= (uint32_t)size << 24u;
+            add_message(bench_msg[B_MSGX].fmt_id, words, length, 0, 0);
+            break;
+        }
+
+        default:
+            words[0] = next_random();
+            add_message(bench_msg[B_EXT_MSG].fmt_id, words, 1u, next_random() & 0x0Fu, 4u);
+            break;
+    }
+}
+
+
+/**
+ * @brief Writes the generated messages to a circular buffer of param.wrap_words words as
+ *        done by the RTEdbg library. A packet (DATA words and the FMT word) may continue
+ *        into the four additional words at the end of the buffer. The next packet is then
+ *        written to the start of the buffer.
+ *
+ * @return Index after the last packet written (last_index of the header).
+ */
+
+static uint32_t wrap_capture(void)
+{
+    size_t buffer_words = (size_t)param.wrap_words + 4u;
+    uint32_t *buffer = malloc(buffer_words * sizeof(uint32_t));
+
+    if (buffer == NULL)
+    {
+        bench_error("Out of memory", NULL);
+    }
+
+    memset(buffer, 0xFF, buffer_words * sizeof(uint32_t));
+    size_t index = 0;
+
+    for (size_t i = 0; i < capture_words; i++)
+    {
+        buffer[index++] = capture[i];
+
+        if (((capture[i] & 1u) != 0) && (index >= param.wrap_words))
+        {
+            index = 0;      // The packet ends with the FMT word
+        }
+    }
+
+    free(capture);
+    capture = buffer;
+    capture_words = buffer_words;
+    capture_size = buffer_words;
+    return (uint32_t)index;
+}
+
+
+/**
+ * @brief Overwrites pseudo randomly selected words of the capture data (-corrupt=x).
+ */
+
+static void corrupt_capture(void)
+{
+    for (unsigned i = 0; (i < param.corrupt_words) && (capture_words > 0); i++)
+    {
+        capture[next_random() % capture_words] = next_random();
+    }
+}
+
+
+/**
+ * @brief Generates the capture file with the header and message data.
+ *
+ * @param name      File name in the work folder.
+ * @param messages  Number of messages.
+ *
+ * @return File size [bytes].
+ */
+
+static uint64_t generate_capture_file(const char *name, unsigned long messages)
+{
+    capture_words = 0;
+    timestamp = 0;
+    timestamp_h = 0;
+
+    uint32_t frequency = TIMESTAMP_FREQUENCY;
+    add_message(bench_msg[B_FREQUENCY].fmt_id, &frequency, 1u, 0, 0);
+
+    for (unsigned long i = 0; i < messages; i++)
+    {
+        generate_message();
+    }
+
+    rtedbg_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.filter = 0xFFFFFFFFu;
+    header.rte_cfg = ((uint32_t)(sizeof(rtedbg_header_t) / 4u) << 24u)
+        | ((param.max_msg_blocks & 0xFFu) << 16u)
+        | ((param.fmt_id_bits - 9u) << 12u)
+        | ((param.long_timestamps ? 1u : 0u) << 4u)
+        | (1u << 1u);       // RTE_MSG_FILTERING_ENABLED
+    header.timestamp_frequency = TIMESTAMP_FREQUENCY;
+
+    if (param.streaming)
+    {
+        header.buffer_size = 0xFFFFFFF0u;   // Streaming mode
+    }
+    else if (param.wrap_words != 0)
+    {
+        header.last_index = wrap_capture();
+        header.filter_copy = 0xFFFFFFFFu;
+        header.buffer_size = (uint32_t)capture_words;
+    }
+    else
+    {
+        // Post-mortem buffer (the erased part at the end of buffer contains at least 4 words)
+        header.last_index = (uint32_t)capture_words;
+        header.filter_copy = 0xFFFFFFFFu;
+
+        for (unsigned i = 0; i < 4u; i++)
+        {
+            add_word(0xFFFFFFFFu);
+        }
+
+        header.buffer_size = (uint32_t)capture_words;
+    }
+
+    corrupt_capture();
+
+    char path[MAX_PATH_LENGTH];
+    work_path(path, name);
+    FILE *out = fopen(path, "wb");
+
+    if (out == NULL)
+    {
+        bench_error("Could not create ", path);
+    }
+
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(capture, sizeof(uint32_t), capture_words, out);
+    fclose(out);
+    return sizeof(header) + capture_words * sizeof(uint32_t);
+}
+
+
+/**
+ * @brief Decodes the capture file several times and returns the fastest time.
+ *
+ * @param name  File name in the work folder.
+ *
+ * @return Execution time [s].
+ */
+
+static double decode_capture_file(const char *name)
+{
+    char path[MAX_PATH_LENGTH];
+    char arguments[MAX_COMMAND_LENGTH + MAX_PATH_LENGTH + 8u];
+    work_path(path, name);
+    snprintf(arguments, sizeof(arguments), "%s \"%s\"", param.rtemsg_args, path);
+    double best = 0;
+
+    for (unsigned i = 0; i < param.repeat; i++)
+    {
+        double time = run_rtemsg(arguments);
+
+        if ((i == 0) || (time < best))
+        {
+            best = time;
+        }
+    }
+
+    return best;
+}
+
+
+/**
+ * @brief Decodes the capture file with the RTEmsg -profile option (not included in the
+ *        measured time) and prints the execution profile written to the Stat_main.log.
+ *
+ * @param name  File name in the work folder.
+ */
+
+static void print_execution_profile(const char *name)
+{
+    char path[MAX_PATH_LENGTH];
+    char arguments[MAX_COMMAND_LENGTH + MAX_PATH_LENGTH + 16u];
+    work_path(path, name);
+    snprintf(arguments, sizeof(arguments), "-profile%s \"%s\"", param.rtemsg_args, path);
+    (void)run_rtemsg(arguments);
+
+    work_path(path, "out/Stat_main.log");
+    FILE *stat = fopen(path, "r");
+
+    if (stat == NULL)
+    {
+        bench_error("Could not open ", path);
+    }
+
+    char line[1024];
+    bool profile_found = false;
+
+    while (fgets(line, sizeof(line), stat) != NULL)
+    {
+        if (strncmp(line, "Execution profile", 17) == 0)
+        {
+            profile_found = true;
+            printf("\n");
+        }
+
+        if (profile_found)
+        {
+            fputs(line, stdout);
+        }
+    }
+
+    fclose(stat);
+}
+
+
+int main(int argc, char *argv[])
+{
+    process_arguments(argc, argv);
+    prepare_format_definitions();
+
+    if (param.generate != NULL)
+    {
+        (void)generate_capture_file(param.generate, param.messages);
+        free(capture);
+        return 0;
+    }
+
+    // The decoding time of a capture with a single message is the startup overhead
+    (void)generate_capture_file("startup.bin", 1u);
+    double startup_time = decode_capture_file("startup.bin");
+
+    uint64_t file_size = generate_capture_file("bench.bin", param.messages);
+    double time = decode_capture_file("bench.bin");
+    double decode_time = time - startup_time;
+
+    if (decode_time <= 0)
+    {
+        decode_time = time;
+    }
+
+    printf("\nCapture:        %s, %lu messages, %.2f MB, N=%u, %u blocks%s\n",
+        param.streaming ? "streaming" : "post-mortem", param.messages, (double)file_size / 1e6,
+        param.fmt_id_bits, param.max_msg_blocks, param.long_timestamps ? ", long timestamps" : "");
+    printf("RTEmsg options:%s\n", param.rtemsg_args);
+    printf("Total time:     %.3f s (startup and format parsing %.3f s)\n", time, startup_time);
+    printf("Messages/s:     %.0f\n", (double)param.messages / decode_time);
+    printf("MB/s:           %.2f\n", (double)file_size / 1e6 / decode_time);
+    printf("ns/message:     %.1f\n", decode_time * 1e9 / (double)param.messages);
+
+    if (param.profile)
+    {
+        print_execution_profile("bench.bin");
+    }
+
+    free(capture);
+    return 0;
+}
+
+/*==== End of file ====*/
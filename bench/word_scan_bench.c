@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) Branko Premzel.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*******************************************************************************
+ * @file    word_scan_bench.c
+ * @author  B. Premzel
+ * @brief   Microbenchmark for the search of the erased words and FMT words.
+ *          Compares the count_erased_words() and find_word_with_bit0() with the
+ *          previous word-by-word loops and verifies that the results are equal.
+ *          The buffer is erased except for its last word (mostly empty
+ *          post-mortem buffer).
+ *
+ *          Usage: word_scan_bench [number_of_scans]
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "word_scan.h"
+
+#define BUFFER_WORDS    (1024u * 1024u)     // 4 MB buffer
+
+
+/**
+ * @brief Previous search loop for the first word different from 0xFFFFFFFF.
+ */
+
+static uint32_t count_erased_with_loop(const uint32_t *words, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        if (words[i] != 0xFFFFFFFFuL)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+
+/**
+ * @brief Previous search loop for the first word with the bit 0 set.
+ */
+
+static uint32_t find_bit0_with_loop(const uint32_t *words, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        if ((words[i] & 1u) != 0)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+
+/**
+ * @brief Returns the current time in seconds.
+ */
+
+static double time_now(void)
+{
+    struct timespec ts;
+    (void)timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * @brief Checks both search functions for all buffer sizes and positions of
+ *        the word found in the first 64 words of the buffer.
+ *
+ * @return true if both search methods return the same results.
+ */
+
+static bool verify_results(uint32_t *words)
+{
+    for (uint32_t size = 0; size <= 64u; size++)
+    {
+        for (uint32_t pos = 0; pos <= size; pos++)
+        {
+            for (uint32_t i = 0; i < 64u; i++)
+            {
+                words[i] = 0xFFFFFFFFuL;
+            }
+
+            words[pos] = 0x12345678uL;
+
+            if (count_erased_words(words, size) != count_erased_with_loop(words, size))
+            {
+                printf("Mismatch: count_erased_words(), size %u, position %u\n", size, pos);
+                return false;
+            }
+
+            for (uint32_t i = 0; i < 64u; i++)
+            {
+                words[i] = 0xFFFFFFFEuL;
+            }
+
+            words[pos] = 0x12345679uL;
+
+            if (find_word_with_bit0(words, size) != find_bit0_with_loop(words, size))
+            {
+                printf("Mismatch: find_word_with_bit0(), size %u, position %u\n", size, pos);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned long long count = 200uLL;
+
+    if (argc > 1)
+    {
+        count = strtoull(argv[1], NULL, 10);
+    }
+
+    uint32_t *words = (uint32_t *)malloc((BUFFER_WORDS + 64u) * sizeof(uint32_t));
+
+    if ((words == NULL) || !verify_results(words))
+    {
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < BUFFER_WORDS; i++)
+    {
+        words[i] = 0xFFFFFFFFuL;
+    }
+
+    words[BUFFER_WORDS - 1u] = 0;
+
+    volatile uint64_t sink = 0;
+    uint64_t sum = 0;
+    double start = time_now();
+
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        sum += count_erased_with_loop(words, BUFFER_WORDS);
+    }
+
+    double t_loop = time_now() - start;
+    sink = sum;
+    sum = 0;
+    start = time_now();
+
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        sum += count_erased_words(words, BUFFER_WORDS);
+    }
+
+    double t_scan = time_now() - start;
+    sink += sum;
+
+    // DATA words only (bit 0 = 0) - the FMT word is the last one
+    for (uint32_t i = 0; i < BUFFER_WORDS; i++)
+    {
+        words[i] = 0xFFFFFFFEuL;
+    }
+
+    words[BUFFER_WORDS - 1u] = 1u;
+    sum = 0;
+    start = time_now();
+
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        sum += find_bit0_with_loop(words, BUFFER_WORDS);
+    }
+
+    double t_bit0_loop = time_now() - start;
+    sink += sum;
+    sum = 0;
+    start = time_now();
+
+    for (unsigned long long i = 0; i < count; i++)
+    {
+        sum += find_word_with_bit0(words, BUFFER_WORDS);
+    }
+
+    double t_bit0_scan = time_now() - start;
+    sink += sum;
+    (void)sink;
+    free(words);
+
+    double words_scanned = (double)count * BUFFER_WORDS;
+    printf("Words scanned:          %.0f\n", words_scanned);
+    printf("Erased word loop:       %8.3f s (%6.3f ns/word)\n", t_loop, t_loop * 1e9 / words_scanned);
+    printf("count_erased_words():   %8.3f s (%6.3f ns/word)\n", t_scan, t_scan * 1e9 / words_scanned);
+    printf("Speedup:                %8.2fx\n", (t_scan > 0) ? t_loop / t_scan : 0.0);
+    printf("FMT word loop:          %8.3f s (%6.3f ns/word)\n", t_bit0_loop, t_bit0_loop * 1e9 / words_scanned);
+    printf("find_word_with_bit0():  %8.3f s (%6.3f ns/word)\n", t_bit0_scan, t_bit0_scan * 1e9 / words_scanned);
+    printf("Speedup:                %8.2fx\n", (t_bit0_scan > 0) ? t_bit0_loop / t_bit0_scan : 0.0);
+    return 0;
+}
+
+/*==== End of file ====*/
@@ -0,0 +1,149 @@
+# Copyright (c) Branko Premzel.
+#
+# SPDX-License-Identifier: MIT
+
+#-------------------------------------------------------------------------------
+# Decoding regression test (run by the CTest - see CMakeLists.txt).
+#
+# The decode_bench generates a capture file and the matching format definitions.
+# The capture is decoded with the RTEmsg and the Main.log and Errors.log files are
+# compared with the reference files. The lines which depend on the build, the date
+# and the execution time are removed before the comparison.
+#
+# The RTEmsg is copied to the work folder together with the Messages.txt file
+# generated from the message texts in Code/messages.h. The result does not depend
+# on the Messages.txt file installed next to the RTEmsg executable.
+#
+# Parameters (-D...):
+#   RTEMSG            Path to the RTEmsg executable
+#   DECODE_BENCH      Path to the decode_bench executable (capture generator)
+#   MESSAGES_H        Path to the Code/messages.h
+#   WORK_DIR          Work folder of the test (removed at the start)
+#   REFERENCE_DIR     Folder with the reference Main.log and Errors.log
+#   GENERATE_ARGS     decode_bench arguments (e.g. "-n=500 -wrap=2000")
+#   RTEMSG_ARGS       Additional RTEmsg arguments (e.g. "-threads=4")
+#   UPDATE_REFERENCE  ON - write the results to the REFERENCE_DIR instead of comparing
+#-------------------------------------------------------------------------------
+
+cmake_minimum_required(VERSION 3.10)
+
+foreach(PARAMETER RTEMSG DECODE_BENCH MESSAGES_H WORK_DIR REFERENCE_DIR)
+    if(NOT DEFINED ${PARAMETER})
+        message(FATAL_ERROR "The parameter ${PARAMETER} is not defined")
+    endif()
+endforeach()
+
+separate_arguments(GENERATE_ARGS_LIST UNIX_COMMAND "${GENERATE_ARGS}")
+separate_arguments(RTEMSG_ARGS_LIST UNIX_COMMAND "${RTEMSG_ARGS}")
+
+
+# Writes the Messages.txt file - one line for every message of the enum in the messages.h.
+# The semicolons and brackets are replaced before the file is split into the CMake list of lines.
+function(generate_messages_file MESSAGES_H MESSAGES_TXT)
+    file(READ "${MESSAGES_H}" CONTENT)
+    string(REPLACE "\r" "" CONTENT "${CONTENT}")
+    string(REPLACE ";" "@SEMICOLON@" CONTENT "${CONTENT}")
+    string(REPLACE "[" "@OPEN@" CONTENT "${CONTENT}")
+    string(REPLACE "]" "@CLOSE@" CONTENT "${CONTENT}")
+    string(REPLACE "\n" ";" LINES "${CONTENT}")
+
+    set(MESSAGES "")
+    set(IN_ENUM FALSE)
+
+    foreach(LINE IN LISTS LINES)
+        if(LINE MATCHES "^enum error_and_other_messages")
+            set(IN_ENUM TRUE)
+        elseif(IN_ENUM AND (LINE MATCHES "^[ \t]*TOTAL_MESSAGES"))
+            break()
+        elseif(IN_ENUM AND (LINE MATCHES "^[ \t]*[A-Za-z_][A-Za-z0-9_]*[^,/]*,[ \t]*//[ \t]*\"(.*)\"[ \t]*$"))
+            set(TEXT "${CMAKE_MATCH_1}")
+
+            if(TEXT STREQUAL "")
+                set(TEXT " ")
+            endif()
+
+            string(APPEND MESSAGES "${TEXT}\n")
+        elseif(IN_ENUM AND (LINE MATCHES "^[ \t]*[A-Za-z_][A-Za-z0-9_]*[^,/]*,"))
+            string(APPEND MESSAGES " \n")
+        endif()
+    endforeach()
+
+    string(REPLACE "@SEMICOLON@" ";" MESSAGES "${MESSAGES}")
+    string(REPLACE "@OPEN@" "[" MESSAGES "${MESSAGES}")
+    string(REPLACE "@CLOSE@" "]" MESSAGES "${MESSAGES}")
+    file(WRITE "${MESSAGES_TXT}" "${MESSAGES}")
+endfunction()
+
+
+# Removes the lines which differ between the runs and the work folder path.
+function(normalize_log FILE_NAME RESULT)
+    file(READ "${FILE_NAME}" TEXT)
+    string(REPLACE "\r" "" TEXT "${TEXT}")
+    string(REPLACE "${WORK_DIR}" "<work>" TEXT "${TEXT}")
+    string(REGEX REPLACE "(^|\n)(RTEmsg v|Binary file date/time:|Arguments:|Execution time:)[^\n]*" "\\1" TEXT "${TEXT}")
+    set(${RESULT} "${TEXT}" PARENT_SCOPE)
+endfunction()
+
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/bin")
+file(COPY "${RTEMSG}" DESTINATION "${WORK_DIR}/bin")
+get_filename_component(RTEMSG_NAME "${RTEMSG}" NAME)
+set(TEST_RTEMSG "${WORK_DIR}/bin/${RTEMSG_NAME}")
+generate_messages_file("${MESSAGES_H}" "${WORK_DIR}/bin/Messages.txt")
+
+execute_process(
+    COMMAND "${DECODE_BENCH}" "${TEST_RTEMSG}" "${WORK_DIR}" ${GENERATE_ARGS_LIST} -generate=capture.bin
+    RESULT_VARIABLE GENERATE_RESULT
+    OUTPUT_QUIET
+)
+
+if(NOT GENERATE_RESULT EQUAL 0)
+    message(FATAL_ERROR "The capture file could not be generated (decode_bench ${GENERATE_ARGS})")
+endif()
+
+# Only the output of the decoding is compared (not of the format ID assignment by the decode_bench)
+file(REMOVE_RECURSE "${WORK_DIR}/out")
+file(MAKE_DIRECTORY "${WORK_DIR}/out")
+
+execute_process(
+    COMMAND "${TEST_RTEMSG}" "${WORK_DIR}/out" "${WORK_DIR}/fmt" -N=10 ${RTEMSG_ARGS_LIST} "${WORK_DIR}/capture.bin"
+    RESULT_VARIABLE DECODE_RESULT
+    OUTPUT_QUIET
+)
+
+if(NOT DECODE_RESULT MATCHES "^[0-9]+$")
+    message(FATAL_ERROR "The RTEmsg could not be started: ${DECODE_RESULT}")
+endif()
+
+set(DIFFERENT_FILES "")
+
+foreach(LOG_FILE Main.log Errors.log)
+    if(NOT EXISTS "${WORK_DIR}/out/${LOG_FILE}")
+        message(FATAL_ERROR "The ${LOG_FILE} has not been written (RTEmsg exit code ${DECODE_RESULT})")
+    endif()
+
+    normalize_log("${WORK_DIR}/out/${LOG_FILE}" RESULT_TEXT)
+
+    if(UPDATE_REFERENCE)
+        file(WRITE "${REFERENCE_DIR}/${LOG_FILE}" "${RESULT_TEXT}")
+        continue()
+    endif()
+
+    if(NOT EXISTS "${REFERENCE_DIR}/${LOG_FILE}")
+        message(FATAL_ERROR "The reference file ${REFERENCE_DIR}/${LOG_FILE} does not exist")
+    endif()
+
+    file(READ "${REFERENCE_DIR}/${LOG_FILE}" REFERENCE_TEXT)
+    string(REPLACE "\r" "" REFERENCE_TEXT "${REFERENCE_TEXT}")
+
+    if(NOT RESULT_TEXT STREQUAL REFERENCE_TEXT)
+        file(WRITE "${WORK_DIR}/${LOG_FILE}" "${RESULT_TEXT}")
+        list(APPEND DIFFERENT_FILES "${WORK_DIR}/${LOG_FILE}")
+    endif()
+endforeach()
+
+if(DIFFERENT_FILES)
+    message(FATAL_ERROR "The decoding results differ from the references in ${REFERENCE_DIR}:\n"
+        "compare ${DIFFERENT_FILES} (normalized) with the reference files.")
+endif()